@@ -17,6 +17,21 @@
 #define BUFFER_SIZE 10
 #define SMALL_NUMBER 1e-90
 
+// Allocate the partial derivative arrays for the current number of elements
+static int jacobian_allocate_partials(Jacobian *jac) {
+  jac->production_partials =
+      (CampSum *)malloc(jac->num_elem * sizeof(CampSum));
+  jac->loss_partials = (CampSum *)malloc(jac->num_elem * sizeof(CampSum));
+#ifdef CAMP_USE_COMPENSATED_SUM
+  jac->production_partials_comp =
+      (double *)malloc(jac->num_elem * sizeof(double));
+  jac->loss_partials_comp = (double *)malloc(jac->num_elem * sizeof(double));
+  if (!jac->production_partials_comp || !jac->loss_partials_comp) return 0;
+#endif
+  if (!jac->production_partials || !jac->loss_partials) return 0;
+  return 1;
+}
+
 int jacobian_initialize_empty(Jacobian *jac, unsigned int num_spec) {
   jac->num_spec = num_spec;
   jac->num_elem = 0;
@@ -40,6 +55,10 @@ int jacobian_initialize_empty(Jacobian *jac, unsigned int num_spec) {
   jac->row_ids = NULL;
   jac->production_partials = NULL;
   jac->loss_partials = NULL;
+#ifdef CAMP_USE_COMPENSATED_SUM
+  jac->production_partials_comp = NULL;
+  jac->loss_partials_comp = NULL;
+#endif
   return 1;
 }
 
@@ -59,18 +78,9 @@ int jacobian_initialize(Jacobian *jac, unsigned int num_spec,
     free(jac->col_ptrs);
     return 0;
   }
-  jac->production_partials =
-      (long double *)malloc(num_elem * sizeof(long double));
-  if (!jac->production_partials) {
-    free(jac->col_ptrs);
-    free(jac->row_ids);
-    return 0;
-  }
-  jac->loss_partials = (long double *)malloc(num_elem * sizeof(long double));
-  if (!jac->loss_partials) {
-    free(jac->col_ptrs);
-    free(jac->row_ids);
-    free(jac->production_partials);
+  jac->elements = NULL;
+  if (!jacobian_allocate_partials(jac)) {
+    jacobian_free(jac);
     return 0;
   }
 
@@ -87,6 +97,25 @@ int jacobian_initialize(Jacobian *jac, unsigned int num_spec,
   return 1;
 }
 
+int jacobian_initialize_copy(Jacobian *jac, Jacobian source) {
+  jac->num_spec = source.num_spec;
+  jac->num_elem = source.num_elem;
+  jac->elements = NULL;
+  jac->col_ptrs =
+      (unsigned int *)malloc((jac->num_spec + 1) * sizeof(unsigned int));
+  jac->row_ids = (unsigned int *)malloc(jac->num_elem * sizeof(unsigned int));
+  if (!jacobian_allocate_partials(jac) || !jac->col_ptrs || !jac->row_ids) {
+    jacobian_free(jac);
+    return 0;
+  }
+  for (unsigned int i_col = 0; i_col <= jac->num_spec; ++i_col)
+    jac->col_ptrs[i_col] = source.col_ptrs[i_col];
+  for (unsigned int i_elem = 0; i_elem < jac->num_elem; ++i_elem)
+    jac->row_ids[i_elem] = source.row_ids[i_elem];
+  jacobian_reset(*jac);
+  return 1;
+}
+
 // Add buffer space for Jacobian column elements (returns 1 on success, 0
 // otherwise)
 int jacobian_column_elements_add_space(JacobianColumnElements *column) {
@@ -166,15 +195,7 @@ unsigned int jacobian_build_matrix(Jacobian *jac) {
            i_elem, jac->num_elem);
     exit(EXIT_FAILURE);
   }
-  jac->production_partials =
-      (long double *)malloc(jac->num_elem * sizeof(long double));
-  if (!jac->production_partials) {
-    jacobian_free(jac);
-    return 0;
-  }
-  jac->loss_partials =
-      (long double *)malloc(jac->num_elem * sizeof(long double));
-  if (!jac->loss_partials) {
+  if (!jacobian_allocate_partials(jac)) {
     jacobian_free(jac);
     return 0;
   }
@@ -217,6 +238,10 @@ void jacobian_reset(Jacobian jac) {
   for (unsigned int i_elem = 0; i_elem < jac.num_elem; ++i_elem) {
     jac.production_partials[i_elem] = 0.0;
     jac.loss_partials[i_elem] = 0.0;
+#ifdef CAMP_USE_COMPENSATED_SUM
+    jac.production_partials_comp[i_elem] = 0.0;
+    jac.loss_partials_comp[i_elem] = 0.0;
+#endif
   }
 }
 
@@ -224,20 +249,22 @@ void jacobian_output(Jacobian jac, double *dest_array) {
   for (unsigned int i_col = 0; i_col < jac.num_spec; ++i_col) {
     for (unsigned int i_elem = jac.col_ptrs[i_col];
          i_elem < jac.col_ptrs[i_col + 1]; ++i_elem) {
-      long double drf_dy = jac.production_partials[i_elem];
-      long double drr_dy = jac.loss_partials[i_elem];
-      dest_array[i_elem] = drf_dy - drr_dy;
+      dest_array[i_elem] = CAMP_SUM_DIFF(
+          jac.production_partials, jac.production_partials_comp,
+          jac.loss_partials, jac.loss_partials_comp, i_elem);
     }
   }
 }
 
 void jacobian_add_value(Jacobian jac, unsigned int elem_id,
                         unsigned int prod_or_loss,
-                        long double jac_contribution) {
+                        CampSum jac_contribution) {
   if (prod_or_loss == JACOBIAN_PRODUCTION)
-    jac.production_partials[elem_id] += jac_contribution;
+    CAMP_SUM_ADD(jac.production_partials, jac.production_partials_comp,
+                 elem_id, jac_contribution);
   if (prod_or_loss == JACOBIAN_LOSS)
-    jac.loss_partials[elem_id] += jac_contribution;
+    CAMP_SUM_ADD(jac.loss_partials, jac.loss_partials_comp, elem_id,
+                 jac_contribution);
 }
 
 void jacobian_print(Jacobian jac) {
@@ -261,8 +288,12 @@ void jacobian_print(Jacobian jac) {
       for (unsigned int i_elem = jac.col_ptrs[i_col];
            i_elem < jac.col_ptrs[i_col + 1]; ++i_elem) {
         printf("\n  col = %6d row = %6d production = %Le loss = %Le", i_col,
-               jac.row_ids[i_elem], jac.production_partials[i_elem],
-               jac.loss_partials[i_elem]);
+               jac.row_ids[i_elem],
+               (long double)CAMP_SUM_VALUE(jac.production_partials,
+                                           jac.production_partials_comp,
+                                           i_elem),
+               (long double)CAMP_SUM_VALUE(jac.loss_partials,
+                                           jac.loss_partials_comp, i_elem));
       }
     }
   } else {
@@ -295,6 +326,12 @@ void jacobian_free(Jacobian *jac) {
     free(jac->loss_partials);
     jac->loss_partials = NULL;
   }
+#ifdef CAMP_USE_COMPENSATED_SUM
+  free(jac->production_partials_comp);
+  jac->production_partials_comp = NULL;
+  free(jac->loss_partials_comp);
+  jac->loss_partials_comp = NULL;
+#endif
   if (jac->elements) {
     for (unsigned int i_col = 0; i_col < jac->num_spec; ++i_col) {
       jacobian_column_elements_free(&(jac->elements[i_col]));
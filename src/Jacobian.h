@@ -13,6 +13,7 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include "compensated_sum.h"
 
 // Flags for specifying production or loss elements
 #define JACOBIAN_PRODUCTION 0
@@ -33,9 +34,14 @@ typedef struct {
   unsigned int num_elem;   // Number of potentially non-zero Jacobian elements
   unsigned int *col_ptrs;  // Index of start/end of each column in data array
   unsigned int *row_ids;   // Row id of each Jacobian element in data array
-  long double
-      *production_partials;    // Data array for productions rate partial derivs
-  long double *loss_partials;  // Data array for loss rate partial derivs
+  CampSum *production_partials;  // Data array for productions rate partial
+                                 // derivs
+  CampSum *loss_partials;        // Data array for loss rate partial derivs
+#ifdef CAMP_USE_COMPENSATED_SUM
+  double *production_partials_comp;  // Compensations for the production rate
+                                     // partial derivs
+  double *loss_partials_comp;  // Compensations for the loss rate partial derivs
+#endif
   JacobianColumnElements *elements;  // Jacobian elements flagged for inclusion
 } Jacobian;
 
@@ -63,6 +69,18 @@ int jacobian_initialize_empty(Jacobian *jac, unsigned int num_spec);
 int jacobian_initialize(Jacobian *jac, unsigned int num_spec,
                         unsigned int **jac_struct);
 
+/** \brief Initialize a Jacobian with the structure of a built Jacobian
+ *
+ * The new Jacobian gets its own copy of the sparse matrix structure and its
+ * own arrays of production and loss partial derivatives.
+ *
+ * \param jac Pointer to the Jacobian object to initialize
+ * \param source Built Jacobian whose structure will be copied
+ * \return Flag indicating whether the Jacobian was successfully initialized
+ *         (0 = false; 1 = true)
+ */
+int jacobian_initialize_copy(Jacobian *jac, Jacobian source);
+
 /** \brief Adds an element to the sparse matrix
  *
  * \param jac Jacobian object
@@ -138,7 +156,7 @@ void jacobian_output(Jacobian jac, double *dest_array);
  */
 void jacobian_add_value(Jacobian jac, unsigned int elem_id,
                         unsigned int prod_or_loss,
-                        long double jac_contribution);
+                        CampSum jac_contribution);
 
 /** \brief Prints the Jacobian structure
  *
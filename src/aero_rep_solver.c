@@ -13,6 +13,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "aero_reps.h"
+#include "solver_profile.h"
 
 // Aerosol representations (Must match parameters defined in
 // camp_aero_rep_factory
@@ -147,6 +148,7 @@ void aero_rep_update_env_state(ModelData *model_data) {
 void aero_rep_update_state(ModelData *model_data) {
   // Get the number of aerosol representations
   int n_aero_rep = model_data->n_aero_rep;
+  double profile_start = solver_profile_start(model_data->profile);
 
   // Loop through the aerosol representations to update the state
   // advancing the aero_rep_data pointer each time
@@ -179,6 +181,9 @@ void aero_rep_update_state(ModelData *model_data) {
         break;
     }
   }
+
+  solver_profile_stop(model_data->profile, CAMP_PROFILE_AERO_REP_UPDATE,
+                      profile_start);
 }
 
 /** \brief Get the effective particle radius, \f$r_{eff}\f$ (m)
@@ -499,6 +504,10 @@ void aero_rep_update_data(int cell_id, int *aero_rep_id,
   model_data->grid_cell_aero_rep_env_data = &(
       model_data->aero_rep_env_data[cell_id * model_data->n_aero_rep_env_data]);
 
+  // Recalculate the environment-dependent data of the grid cell on the next
+  // call to the solver
+  model_data->last_env[cell_id * CAMP_NUM_ENV_PARAM_] = NAN;
+
   // Get the number of aerosol representations
   int n_aero_rep = model_data->n_aero_rep;
 
@@ -0,0 +1,277 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Block-diagonal KLU linear solver
+ *
+ */
+/** \file
+ * \brief Block-diagonal KLU linear solver
+ */
+#include "block_klu_solver.h"
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Reciprocal condition number estimate below which a block is fully
+// refactored instead of reusing the pivot order of its last factorization
+#define BLOCK_KLU_RCOND_THRESHOLD pow(DBL_EPSILON, 2.0 / 3.0)
+
+int block_diagonal_check_pattern(SUNMatrix A, int n_blocks) {
+  int n_rows = SM_ROWS_S(A);
+  int block_size, block_nnz;
+
+  if (SM_SPARSETYPE_S(A) != CSC_MAT || n_blocks < 1 ||
+      SM_COLUMNS_S(A) != n_rows || n_rows % n_blocks != 0)
+    return 0;
+  block_size = n_rows / n_blocks;
+  block_nnz = SM_INDEXPTRS_S(A)[block_size];
+  if (SM_INDEXPTRS_S(A)[n_rows] != n_blocks * block_nnz) return 0;
+
+  for (int i_block = 1; i_block < n_blocks; ++i_block) {
+    int col_offset = i_block * block_size;
+    int elem_offset = i_block * block_nnz;
+    for (int i_col = 0; i_col < block_size; ++i_col)
+      if (SM_INDEXPTRS_S(A)[col_offset + i_col] !=
+          elem_offset + SM_INDEXPTRS_S(A)[i_col])
+        return 0;
+    for (int i_elem = 0; i_elem < block_nnz; ++i_elem)
+      if (SM_INDEXVALS_S(A)[elem_offset + i_elem] !=
+          col_offset + SM_INDEXVALS_S(A)[i_elem])
+        return 0;
+  }
+  return 1;
+}
+
+SUNLinearSolver SUNBlockKLU(N_Vector y, SUNMatrix A, int n_blocks) {
+  SUNLinearSolver S;
+  SUNLinearSolver_Ops ops;
+  BlockKLUContent *content;
+
+  // Check the compatibility of the matrix and vector
+  if (block_diagonal_check_pattern(A, n_blocks) == 0) {
+    printf(
+        "\n\nERROR Block KLU solver requires a block-diagonal CSC matrix "
+        "with identical blocks\n\n");
+    return NULL;
+  }
+  if (NV_LENGTH_S(y) != SM_ROWS_S(A)) {
+    printf("\n\nERROR Block KLU solver vector and matrix sizes differ\n\n");
+    return NULL;
+  }
+
+  // Create the linear solver and its operations
+  S = (SUNLinearSolver)malloc(sizeof *S);
+  if (S == NULL) return NULL;
+  ops = (SUNLinearSolver_Ops)malloc(sizeof(struct _generic_SUNLinearSolver_Ops));
+  if (ops == NULL) {
+    free(S);
+    return NULL;
+  }
+  ops->gettype = SUNLinSolGetType_BlockKLU;
+  ops->setatimes = NULL;
+  ops->setpreconditioner = NULL;
+  ops->setscalingvectors = NULL;
+  ops->initialize = SUNLinSolInitialize_BlockKLU;
+  ops->setup = SUNLinSolSetup_BlockKLU;
+  ops->solve = SUNLinSolSolve_BlockKLU;
+  ops->numiters = NULL;
+  ops->resnorm = NULL;
+  ops->lastflag = SUNLinSolLastFlag_BlockKLU;
+  ops->space = SUNLinSolSpace_BlockKLU;
+  ops->resid = NULL;
+  ops->free = SUNLinSolFree_BlockKLU;
+  S->ops = ops;
+
+  // Set up the solver content
+  content = (BlockKLUContent *)malloc(sizeof(BlockKLUContent));
+  if (content == NULL) {
+    free(ops);
+    free(S);
+    return NULL;
+  }
+  S->content = content;
+  content->n_blocks = n_blocks;
+  content->block_size = SM_ROWS_S(A) / n_blocks;
+  content->block_nnz = SM_INDEXPTRS_S(A)[content->block_size];
+  content->symbolic = NULL;
+  content->last_flag = SUNLS_SUCCESS;
+  content->col_ptrs = (int *)malloc((content->block_size + 1) * sizeof(int));
+  content->row_ids = (int *)malloc(
+      (content->block_nnz > 0 ? content->block_nnz : 1) * sizeof(int));
+  content->numeric = (klu_numeric **)calloc(n_blocks, sizeof(klu_numeric *));
+  content->common = (klu_common *)malloc(n_blocks * sizeof(klu_common));
+  if (content->col_ptrs == NULL || content->row_ids == NULL ||
+      content->numeric == NULL || content->common == NULL) {
+    SUNLinSolFree_BlockKLU(S);
+    return NULL;
+  }
+
+  // Save the pattern of the first block (SUNDIALS index types may differ
+  // from the KLU index type)
+  for (int i_col = 0; i_col <= content->block_size; ++i_col)
+    content->col_ptrs[i_col] = (int)SM_INDEXPTRS_S(A)[i_col];
+  for (int i_elem = 0; i_elem < content->block_nnz; ++i_elem)
+    content->row_ids[i_elem] = (int)SM_INDEXVALS_S(A)[i_elem];
+
+  // Analyze the per-block pattern once for all blocks
+  for (int i_block = 0; i_block < n_blocks; ++i_block)
+    klu_defaults(&(content->common[i_block]));
+  content->symbolic = klu_analyze(content->block_size, content->col_ptrs,
+                                  content->row_ids, &(content->common[0]));
+  if (content->symbolic == NULL) {
+    printf("\n\nERROR Block KLU symbolic analysis failed\n\n");
+    SUNLinSolFree_BlockKLU(S);
+    return NULL;
+  }
+
+  return S;
+}
+
+int SUNBlockKLUReInit(SUNLinearSolver S) {
+  BlockKLUContent *content = BLOCK_KLU_CONTENT(S);
+
+  for (int i_block = 0; i_block < content->n_blocks; ++i_block)
+    if (content->numeric[i_block] != NULL)
+      klu_free_numeric(&(content->numeric[i_block]),
+                       &(content->common[i_block]));
+  content->last_flag = SUNLS_SUCCESS;
+  return SUNLS_SUCCESS;
+}
+
+SUNLinearSolver_Type SUNLinSolGetType_BlockKLU(SUNLinearSolver S) {
+  return SUNLINEARSOLVER_DIRECT;
+}
+
+int SUNLinSolInitialize_BlockKLU(SUNLinearSolver S) {
+  return SUNBlockKLUReInit(S);
+}
+
+/** \brief Factor one diagonal block
+ *
+ * \param content Block KLU solver content
+ * \param i_block Index of the block to factor
+ * \param data Data array of the full block-diagonal matrix
+ * \return SUNLS_SUCCESS, SUNLS_LUFACT_FAIL for a singular block, or
+ *         SUNLS_PACKAGE_FAIL_UNREC for other KLU failures
+ */
+static int block_klu_factor(BlockKLUContent *content, int i_block,
+                            double *data) {
+  double *block_data = &(data[i_block * content->block_nnz]);
+  klu_common *common = &(content->common[i_block]);
+
+  // Reuse the pivot order of the last factorization of the block while it
+  // remains numerically acceptable
+  if (content->numeric[i_block] != NULL) {
+    if (klu_refactor(content->col_ptrs, content->row_ids, block_data,
+                     content->symbolic, content->numeric[i_block], common) &&
+        klu_rcond(content->symbolic, content->numeric[i_block], common) &&
+        common->rcond > BLOCK_KLU_RCOND_THRESHOLD)
+      return SUNLS_SUCCESS;
+    klu_free_numeric(&(content->numeric[i_block]), common);
+  }
+
+  content->numeric[i_block] =
+      klu_factor(content->col_ptrs, content->row_ids, block_data,
+                 content->symbolic, common);
+  if (content->numeric[i_block] == NULL)
+    return common->status == KLU_SINGULAR ? SUNLS_LUFACT_FAIL
+                                          : SUNLS_PACKAGE_FAIL_UNREC;
+  return SUNLS_SUCCESS;
+}
+
+int SUNLinSolSetup_BlockKLU(SUNLinearSolver S, SUNMatrix A) {
+  BlockKLUContent *content = BLOCK_KLU_CONTENT(S);
+  double *data = SM_DATA_S(A);
+  int n_singular = 0;
+  int n_failed = 0;
+
+  if (SM_NNZ_S(A) != content->n_blocks * content->block_nnz) {
+    content->last_flag = SUNLS_ILL_INPUT;
+    return SUNLS_ILL_INPUT;
+  }
+
+#ifdef CAMP_USE_OPENMP
+#pragma omp parallel for schedule(static) reduction(+ : n_singular, n_failed)
+#endif
+  for (int i_block = 0; i_block < content->n_blocks; ++i_block) {
+    int flag = block_klu_factor(content, i_block, data);
+    if (flag == SUNLS_LUFACT_FAIL) ++n_singular;
+    if (flag == SUNLS_PACKAGE_FAIL_UNREC) ++n_failed;
+  }
+
+  if (n_failed > 0) {
+    content->last_flag = SUNLS_PACKAGE_FAIL_UNREC;
+  } else if (n_singular > 0) {
+    content->last_flag = SUNLS_LUFACT_FAIL;
+  } else {
+    content->last_flag = SUNLS_SUCCESS;
+  }
+  return content->last_flag;
+}
+
+int SUNLinSolSolve_BlockKLU(SUNLinearSolver S, SUNMatrix A, N_Vector x,
+                            N_Vector b, realtype tol) {
+  BlockKLUContent *content = BLOCK_KLU_CONTENT(S);
+  double *x_data;
+  int n_failed = 0;
+
+  // Solve in place on the solution vector
+  N_VScale(1.0, b, x);
+  x_data = N_VGetArrayPointer(x);
+
+#ifdef CAMP_USE_OPENMP
+#pragma omp parallel for schedule(static) reduction(+ : n_failed)
+#endif
+  for (int i_block = 0; i_block < content->n_blocks; ++i_block) {
+    if (content->numeric[i_block] == NULL ||
+        !klu_solve(content->symbolic, content->numeric[i_block],
+                   content->block_size, 1,
+                   &(x_data[i_block * content->block_size]),
+                   &(content->common[i_block])))
+      ++n_failed;
+  }
+
+  content->last_flag = n_failed > 0 ? SUNLS_PACKAGE_FAIL_REC : SUNLS_SUCCESS;
+  return content->last_flag;
+}
+
+long int SUNLinSolLastFlag_BlockKLU(SUNLinearSolver S) {
+  return BLOCK_KLU_CONTENT(S)->last_flag;
+}
+
+int SUNLinSolSpace_BlockKLU(SUNLinearSolver S, long int *lenrwLS,
+                            long int *leniwLS) {
+  BlockKLUContent *content = BLOCK_KLU_CONTENT(S);
+
+  // Numeric factorizations are held by KLU and are not included
+  *lenrwLS = 0;
+  *leniwLS = 3 + content->block_size + 1 + content->block_nnz;
+  return SUNLS_SUCCESS;
+}
+
+int SUNLinSolFree_BlockKLU(SUNLinearSolver S) {
+  BlockKLUContent *content;
+
+  if (S == NULL) return SUNLS_SUCCESS;
+  content = BLOCK_KLU_CONTENT(S);
+  if (content != NULL) {
+    if (content->numeric != NULL) {
+      for (int i_block = 0; i_block < content->n_blocks; ++i_block)
+        if (content->numeric[i_block] != NULL)
+          klu_free_numeric(&(content->numeric[i_block]),
+                           &(content->common[i_block]));
+      free(content->numeric);
+    }
+    if (content->symbolic != NULL)
+      klu_free_symbolic(&(content->symbolic), &(content->common[0]));
+    free(content->col_ptrs);
+    free(content->row_ids);
+    free(content->common);
+    free(content);
+  }
+  free(S->ops);
+  free(S);
+  return SUNLS_SUCCESS;
+}
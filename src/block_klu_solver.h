@@ -0,0 +1,79 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Header for the block-diagonal KLU linear solver
+ *
+ */
+/** \file
+ * \brief Header for the block-diagonal KLU linear solver
+ *
+ * The multi-cell solver Jacobian is block diagonal, with one block per grid
+ * cell, and every block has the same sparsity pattern. This SUNLinearSolver
+ * performs a single symbolic analysis of the per-cell pattern and then
+ * factors and solves each block independently, reusing the pivot order of
+ * the previous factorization of the block where possible.
+ */
+#ifndef BLOCK_KLU_SOLVER_H_
+#define BLOCK_KLU_SOLVER_H_
+
+#include <klu.h>
+#include <nvector/nvector_serial.h>
+#include <sundials/sundials_linearsolver.h>
+#include <sunmatrix/sunmatrix_sparse.h>
+
+/* Block-diagonal KLU linear solver data */
+typedef struct {
+  int n_blocks;            // Number of diagonal blocks
+  int block_size;          // Number of rows (and columns) in each block
+  int block_nnz;           // Number of non-zero elements in each block
+  int *col_ptrs;           // Column pointers for the per-block pattern
+  int *row_ids;            // Row indices for the per-block pattern
+  klu_symbolic *symbolic;  // Symbolic analysis shared by all blocks
+  klu_numeric **numeric;   // Numeric factorization of each block
+  klu_common *common;      // KLU settings and status for each block
+  long int last_flag;      // Last error flag
+} BlockKLUContent;
+
+#define BLOCK_KLU_CONTENT(S) ((BlockKLUContent *)(S->content))
+
+/** \brief Create a block-diagonal KLU linear solver
+ *
+ * \param y Solver state vector (used to check dimensions)
+ * \param A Block-diagonal CSC matrix with the sparsity pattern of the
+ *          linear systems to solve
+ * \param n_blocks Number of diagonal blocks in A, each with the same
+ *                 sparsity pattern
+ * \return New SUNLinearSolver, or NULL if the matrix is not block diagonal
+ *         with identical blocks or memory allocation fails
+ */
+SUNLinearSolver SUNBlockKLU(N_Vector y, SUNMatrix A, int n_blocks);
+
+/** \brief Discard the numeric factorizations so that the next setup
+ *         computes new pivot orders for all blocks
+ *
+ * \param S Block-diagonal KLU linear solver
+ * \return SUNLS_SUCCESS
+ */
+int SUNBlockKLUReInit(SUNLinearSolver S);
+
+/** \brief Check that a matrix is block diagonal with identical blocks
+ *
+ * \param A CSC matrix to check
+ * \param n_blocks Number of diagonal blocks
+ * \return 1 if A is block diagonal with identical blocks, 0 otherwise
+ */
+int block_diagonal_check_pattern(SUNMatrix A, int n_blocks);
+
+/* SUNLinearSolver operations */
+SUNLinearSolver_Type SUNLinSolGetType_BlockKLU(SUNLinearSolver S);
+int SUNLinSolInitialize_BlockKLU(SUNLinearSolver S);
+int SUNLinSolSetup_BlockKLU(SUNLinearSolver S, SUNMatrix A);
+int SUNLinSolSolve_BlockKLU(SUNLinearSolver S, SUNMatrix A, N_Vector x,
+                            N_Vector b, realtype tol);
+long int SUNLinSolLastFlag_BlockKLU(SUNLinearSolver S);
+int SUNLinSolSpace_BlockKLU(SUNLinearSolver S, long int *lenrwLS,
+                            long int *leniwLS);
+int SUNLinSolFree_BlockKLU(SUNLinearSolver S);
+
+#endif
@@ -0,0 +1,626 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Cell-interleaved block-diagonal sparse LU linear solver
+ *
+ */
+/** \file
+ * \brief Cell-interleaved block-diagonal sparse LU linear solver
+ */
+#include "block_lu_solver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "block_klu_solver.h"
+
+// Loops over the interleaved grid cells of a group have no dependencies
+// between iterations
+#ifdef CAMP_USE_OPENMP
+#define BLOCK_LU_SIMD _Pragma("omp simd")
+#else
+#define BLOCK_LU_SIMD
+#endif
+
+// Index of an interleaved element for a grid cell in a group
+#define BLOCK_LU_ID(i_elem, i_lane) ((i_elem)*BLOCK_LU_VECTOR_WIDTH + (i_lane))
+
+/** \brief Free the arrays of an elimination program
+ *
+ * \param program Elimination program to free
+ */
+static void block_lu_program_free(BlockLUProgram *program) {
+  free(program->perm);
+  free(program->input_elem);
+  free(program->diag_elem);
+  free(program->l_col_ptrs);
+  free(program->l_row_ids);
+  free(program->l_elem);
+  free(program->u_col_ptrs);
+  free(program->u_row_ids);
+  free(program->u_elem);
+  free(program->update_ptrs);
+  free(program->update_target);
+  free(program->update_l);
+  free(program->update_u);
+  memset(program, 0, sizeof(BlockLUProgram));
+}
+
+/** \brief Choose a fill-reducing pivot order for a block pattern
+ *
+ * Pivots are taken from the diagonal. At each elimination step the
+ * remaining diagonal element with the lowest Markowitz count
+ * \f$(r-1)(c-1)\f$, where \f$r\f$ and \f$c\f$ are the numbers of
+ * non-zero elements in its active column and row, is chosen and the fill-in
+ * of its elimination is added to the active pattern. Ties go to the lowest
+ * index, so patterns without fill-in keep their natural order.
+ *
+ * \param A Block-diagonal CSC matrix whose first block has the pattern to
+ *          analyze
+ * \param size Number of rows (and columns) in each block
+ * \param perm Original row (and column) of each pivot [size]
+ * \return 1 on success, 0 if memory allocation fails
+ */
+static int block_lu_markowitz_order(SUNMatrix A, int size, int *perm) {
+  char *pattern;
+  char *eliminated;
+
+  pattern = (char *)calloc((size_t)size * size > 0 ? (size_t)size * size : 1,
+                           sizeof(char));
+  eliminated = (char *)calloc(size > 0 ? size : 1, sizeof(char));
+  if (pattern == NULL || eliminated == NULL) {
+    free(pattern);
+    free(eliminated);
+    return 0;
+  }
+  for (int i_col = 0; i_col < size; ++i_col)
+    for (int i_elem = SM_INDEXPTRS_S(A)[i_col];
+         i_elem < SM_INDEXPTRS_S(A)[i_col + 1]; ++i_elem)
+      pattern[SM_INDEXVALS_S(A)[i_elem] * size + i_col] = 1;
+
+  for (int k = 0; k < size; ++k) {
+    int pivot = -1;
+    long int min_count = 0;
+
+    // Find the remaining diagonal element with the lowest Markowitz count
+    for (int p = 0; p < size; ++p) {
+      long int n_col = 0, n_row = 0;
+      if (eliminated[p]) continue;
+      for (int i = 0; i < size; ++i) {
+        if (eliminated[i] || i == p) continue;
+        n_col += pattern[i * size + p];
+        n_row += pattern[p * size + i];
+      }
+      if (pivot < 0 || n_col * n_row < min_count) {
+        pivot = p;
+        min_count = n_col * n_row;
+      }
+    }
+    perm[k] = pivot;
+    eliminated[pivot] = 1;
+
+    // Add the fill-in of the elimination step
+    for (int i = 0; i < size; ++i) {
+      if (eliminated[i] || !pattern[i * size + pivot]) continue;
+      for (int j = 0; j < size; ++j)
+        if (!eliminated[j] && pattern[pivot * size + j])
+          pattern[i * size + j] = 1;
+    }
+  }
+
+  free(pattern);
+  free(eliminated);
+  return 1;
+}
+
+/** \brief Generate the static elimination program for a block pattern
+ *
+ * The rows and columns of the block are symmetrically permuted to the
+ * Markowitz pivot order. The symbolic factorization is then done on a dense
+ * map of the permuted block, which is only used during initialization. The
+ * LU elements, including fill-in, are numbered in column-major order of the
+ * permuted block. Without fill-in, the updates of elements outside the input
+ * pattern are dropped, which gives the incomplete factorization ILU(0).
+ *
+ * \param program Elimination program to set up
+ * \param A Block-diagonal CSC matrix whose first block has the pattern to
+ *          analyze
+ * \param size Number of rows (and columns) in each block
+ * \param fill_in Flag indicating whether to add the fill-in (1) or to keep
+ *                the pattern of the input block (0)
+ * \return 1 on success, 0 if a diagonal element is missing from the pattern
+ *         or memory allocation fails
+ */
+static int block_lu_program_new(BlockLUProgram *program, SUNMatrix A,
+                                int size, int fill_in) {
+  int *elem_id;
+  int *row_elem;
+  int *inv_perm;
+  int n_l = 0, n_u = 0, n_update = 0;
+
+  memset(program, 0, sizeof(BlockLUProgram));
+  program->size = size;
+  program->n_input_elem = SM_INDEXPTRS_S(A)[size];
+
+  elem_id = (int *)malloc((size_t)size * size * sizeof(int));
+  row_elem = (int *)malloc((size > 0 ? size : 1) * sizeof(int));
+  inv_perm = (int *)malloc((size > 0 ? size : 1) * sizeof(int));
+  program->perm = (int *)malloc((size > 0 ? size : 1) * sizeof(int));
+  if (elem_id == NULL || row_elem == NULL || inv_perm == NULL ||
+      program->perm == NULL) {
+    block_lu_program_free(program);
+    free(elem_id);
+    free(row_elem);
+    free(inv_perm);
+    return 0;
+  }
+
+  // Check the diagonal, which provides the pivots, and choose their order
+  for (int i = 0; i < size; ++i) row_elem[i] = 0;
+  for (int i_col = 0; i_col < size; ++i_col)
+    for (int i_elem = SM_INDEXPTRS_S(A)[i_col];
+         i_elem < SM_INDEXPTRS_S(A)[i_col + 1]; ++i_elem)
+      if (SM_INDEXVALS_S(A)[i_elem] == i_col) row_elem[i_col] = 1;
+  for (int i = 0; i < size; ++i) {
+    if (row_elem[i] == 0) {
+      block_lu_program_free(program);
+      free(elem_id);
+      free(row_elem);
+      free(inv_perm);
+      return 0;
+    }
+  }
+  if (block_lu_markowitz_order(A, size, program->perm) == 0) {
+    block_lu_program_free(program);
+    free(elem_id);
+    free(row_elem);
+    free(inv_perm);
+    return 0;
+  }
+  for (int k = 0; k < size; ++k) inv_perm[program->perm[k]] = k;
+
+  // Mark the permuted input pattern (elem_id[i_row * size + i_col])
+  for (int i = 0; i < size * size; ++i) elem_id[i] = -1;
+  for (int i_col = 0; i_col < size; ++i_col)
+    for (int i_elem = SM_INDEXPTRS_S(A)[i_col];
+         i_elem < SM_INDEXPTRS_S(A)[i_col + 1]; ++i_elem)
+      elem_id[inv_perm[SM_INDEXVALS_S(A)[i_elem]] * size + inv_perm[i_col]] =
+          0;
+
+  // Add the fill-in of each elimination step and count the updates
+  for (int k = 0; k < size; ++k) {
+    int n_row = 0;
+    for (int j = k + 1; j < size; ++j)
+      if (elem_id[k * size + j] >= 0) row_elem[n_row++] = j;
+    for (int i = k + 1; i < size; ++i) {
+      if (elem_id[i * size + k] < 0) continue;
+      for (int i_row = 0; i_row < n_row; ++i_row) {
+        if (fill_in) elem_id[i * size + row_elem[i_row]] = 0;
+        if (elem_id[i * size + row_elem[i_row]] >= 0) ++n_update;
+      }
+    }
+  }
+
+  // Number the LU elements in column-major order
+  program->n_elem = 0;
+  for (int j = 0; j < size; ++j)
+    for (int i = 0; i < size; ++i)
+      if (elem_id[i * size + j] >= 0) {
+        elem_id[i * size + j] = program->n_elem++;
+        if (i > j) ++n_l;
+        if (i < j) ++n_u;
+      }
+
+  program->input_elem =
+      (int *)malloc((program->n_input_elem > 0 ? program->n_input_elem : 1) *
+                    sizeof(int));
+  program->diag_elem = (int *)malloc((size > 0 ? size : 1) * sizeof(int));
+  program->l_col_ptrs = (int *)malloc((size + 1) * sizeof(int));
+  program->l_row_ids = (int *)malloc((n_l > 0 ? n_l : 1) * sizeof(int));
+  program->l_elem = (int *)malloc((n_l > 0 ? n_l : 1) * sizeof(int));
+  program->u_col_ptrs = (int *)malloc((size + 1) * sizeof(int));
+  program->u_row_ids = (int *)malloc((n_u > 0 ? n_u : 1) * sizeof(int));
+  program->u_elem = (int *)malloc((n_u > 0 ? n_u : 1) * sizeof(int));
+  program->update_ptrs = (int *)malloc((size + 1) * sizeof(int));
+  program->update_target =
+      (int *)malloc((n_update > 0 ? n_update : 1) * sizeof(int));
+  program->update_l =
+      (int *)malloc((n_update > 0 ? n_update : 1) * sizeof(int));
+  program->update_u =
+      (int *)malloc((n_update > 0 ? n_update : 1) * sizeof(int));
+  if (program->input_elem == NULL || program->diag_elem == NULL ||
+      program->l_col_ptrs == NULL || program->l_row_ids == NULL ||
+      program->l_elem == NULL || program->u_col_ptrs == NULL ||
+      program->u_row_ids == NULL || program->u_elem == NULL ||
+      program->update_ptrs == NULL || program->update_target == NULL ||
+      program->update_l == NULL || program->update_u == NULL) {
+    block_lu_program_free(program);
+    free(elem_id);
+    free(row_elem);
+    free(inv_perm);
+    return 0;
+  }
+
+  // Map the input elements to the LU elements
+  for (int i_col = 0; i_col < size; ++i_col)
+    for (int i_elem = SM_INDEXPTRS_S(A)[i_col];
+         i_elem < SM_INDEXPTRS_S(A)[i_col + 1]; ++i_elem)
+      program->input_elem[i_elem] =
+          elem_id[inv_perm[SM_INDEXVALS_S(A)[i_elem]] * size +
+                  inv_perm[i_col]];
+
+  // Save the diagonal and the columns of L and U
+  n_l = 0;
+  n_u = 0;
+  for (int j = 0; j < size; ++j) {
+    program->diag_elem[j] = elem_id[j * size + j];
+    program->l_col_ptrs[j] = n_l;
+    program->u_col_ptrs[j] = n_u;
+    for (int i = 0; i < size; ++i) {
+      if (elem_id[i * size + j] < 0) continue;
+      if (i > j) {
+        program->l_row_ids[n_l] = i;
+        program->l_elem[n_l++] = elem_id[i * size + j];
+      } else if (i < j) {
+        program->u_row_ids[n_u] = i;
+        program->u_elem[n_u++] = elem_id[i * size + j];
+      }
+    }
+  }
+  program->l_col_ptrs[size] = n_l;
+  program->u_col_ptrs[size] = n_u;
+
+  // Generate the multiply-subtract updates of each elimination step
+  n_update = 0;
+  for (int k = 0; k < size; ++k) {
+    int n_row = 0;
+    program->update_ptrs[k] = n_update;
+    for (int j = k + 1; j < size; ++j)
+      if (elem_id[k * size + j] >= 0) row_elem[n_row++] = j;
+    for (int i_l = program->l_col_ptrs[k]; i_l < program->l_col_ptrs[k + 1];
+         ++i_l) {
+      int i = program->l_row_ids[i_l];
+      for (int i_row = 0; i_row < n_row; ++i_row) {
+        int j = row_elem[i_row];
+        if (elem_id[i * size + j] < 0) continue;
+        program->update_target[n_update] = elem_id[i * size + j];
+        program->update_l[n_update] = program->l_elem[i_l];
+        program->update_u[n_update++] = elem_id[k * size + j];
+      }
+    }
+  }
+  program->update_ptrs[size] = n_update;
+
+  free(elem_id);
+  free(row_elem);
+  free(inv_perm);
+  return 1;
+}
+
+/** \brief Load the blocks of a group into the interleaved LU array
+ *
+ * Grid cells past the last block of the matrix are set to the identity.
+ *
+ * \param content Block LU solver content
+ * \param i_group Index of the group to load
+ * \param data Data array of the full block-diagonal matrix
+ */
+static void block_lu_load_group(BlockLUContent *content, int i_group,
+                                double *data) {
+  BlockLUProgram *program = &(content->program);
+  double *lu = &(content->lu_data[(size_t)i_group * program->n_elem *
+                                  BLOCK_LU_VECTOR_WIDTH]);
+
+  memset(lu, 0, (size_t)program->n_elem * BLOCK_LU_VECTOR_WIDTH *
+                    sizeof(double));
+  for (int i_lane = 0; i_lane < BLOCK_LU_VECTOR_WIDTH; ++i_lane) {
+    int i_block = i_group * BLOCK_LU_VECTOR_WIDTH + i_lane;
+    if (i_block < content->n_blocks) {
+      double *block_data = &(data[(size_t)i_block * content->block_nnz]);
+      for (int i_elem = 0; i_elem < content->block_nnz; ++i_elem)
+        lu[BLOCK_LU_ID(program->input_elem[i_elem], i_lane)] =
+            block_data[i_elem];
+    } else {
+      for (int i = 0; i < program->size; ++i)
+        lu[BLOCK_LU_ID(program->diag_elem[i], i_lane)] = 1.0;
+    }
+  }
+}
+
+/** \brief Factor the interleaved blocks of a group
+ *
+ * \param program Elimination program
+ * \param lu Interleaved matrix elements of the group, replaced by the LU
+ *           factors
+ * \return Number of elimination steps with a zero pivot in any grid cell
+ */
+static int block_lu_factor_group(BlockLUProgram *program, double *lu) {
+  int n_zero_pivot = 0;
+
+  for (int k = 0; k < program->size; ++k) {
+    double *diag = &(lu[BLOCK_LU_ID(program->diag_elem[k], 0)]);
+    double inv_diag[BLOCK_LU_VECTOR_WIDTH];
+    int is_zero = 0;
+
+    for (int i_lane = 0; i_lane < BLOCK_LU_VECTOR_WIDTH; ++i_lane)
+      if (diag[i_lane] == 0.0) is_zero = 1;
+    if (is_zero) {
+      ++n_zero_pivot;
+      continue;
+    }
+    BLOCK_LU_SIMD
+    for (int i_lane = 0; i_lane < BLOCK_LU_VECTOR_WIDTH; ++i_lane)
+      inv_diag[i_lane] = 1.0 / diag[i_lane];
+
+    // Multipliers (column k of L)
+    for (int i_l = program->l_col_ptrs[k]; i_l < program->l_col_ptrs[k + 1];
+         ++i_l) {
+      double *l = &(lu[BLOCK_LU_ID(program->l_elem[i_l], 0)]);
+      BLOCK_LU_SIMD
+      for (int i_lane = 0; i_lane < BLOCK_LU_VECTOR_WIDTH; ++i_lane)
+        l[i_lane] *= inv_diag[i_lane];
+    }
+
+    // Update the remaining submatrix
+    for (int i_up = program->update_ptrs[k]; i_up < program->update_ptrs[k + 1];
+         ++i_up) {
+      double *target = &(lu[BLOCK_LU_ID(program->update_target[i_up], 0)]);
+      const double *l = &(lu[BLOCK_LU_ID(program->update_l[i_up], 0)]);
+      const double *u = &(lu[BLOCK_LU_ID(program->update_u[i_up], 0)]);
+      BLOCK_LU_SIMD
+      for (int i_lane = 0; i_lane < BLOCK_LU_VECTOR_WIDTH; ++i_lane)
+        target[i_lane] -= l[i_lane] * u[i_lane];
+    }
+  }
+  return n_zero_pivot;
+}
+
+/** \brief Solve the interleaved systems of a group in place
+ *
+ * \param program Elimination program
+ * \param lu Interleaved LU factors of the group
+ * \param x Interleaved right-hand side of the group, replaced by the
+ *          solution
+ */
+static void block_lu_solve_group(BlockLUProgram *program, const double *lu,
+                                 double *x) {
+  // Forward substitution with the unit lower triangular factor
+  for (int k = 0; k < program->size; ++k) {
+    const double *x_k = &(x[BLOCK_LU_ID(k, 0)]);
+    for (int i_l = program->l_col_ptrs[k]; i_l < program->l_col_ptrs[k + 1];
+         ++i_l) {
+      double *x_i = &(x[BLOCK_LU_ID(program->l_row_ids[i_l], 0)]);
+      const double *l = &(lu[BLOCK_LU_ID(program->l_elem[i_l], 0)]);
+      BLOCK_LU_SIMD
+      for (int i_lane = 0; i_lane < BLOCK_LU_VECTOR_WIDTH; ++i_lane)
+        x_i[i_lane] -= l[i_lane] * x_k[i_lane];
+    }
+  }
+
+  // Back substitution with the upper triangular factor
+  for (int k = program->size - 1; k >= 0; --k) {
+    double *x_k = &(x[BLOCK_LU_ID(k, 0)]);
+    const double *diag = &(lu[BLOCK_LU_ID(program->diag_elem[k], 0)]);
+    BLOCK_LU_SIMD
+    for (int i_lane = 0; i_lane < BLOCK_LU_VECTOR_WIDTH; ++i_lane)
+      x_k[i_lane] /= diag[i_lane];
+    for (int i_u = program->u_col_ptrs[k]; i_u < program->u_col_ptrs[k + 1];
+         ++i_u) {
+      double *x_i = &(x[BLOCK_LU_ID(program->u_row_ids[i_u], 0)]);
+      const double *u = &(lu[BLOCK_LU_ID(program->u_elem[i_u], 0)]);
+      BLOCK_LU_SIMD
+      for (int i_lane = 0; i_lane < BLOCK_LU_VECTOR_WIDTH; ++i_lane)
+        x_i[i_lane] -= u[i_lane] * x_k[i_lane];
+    }
+  }
+}
+
+/** \brief Create a cell-interleaved block-diagonal sparse LU linear solver
+ *
+ * \param y Solver state vector (used to check dimensions)
+ * \param A Block-diagonal CSC matrix with the sparsity pattern of the
+ *          linear systems to solve
+ * \param n_blocks Number of diagonal blocks in A
+ * \param fill_in Flag indicating whether to do the complete (1) or the
+ *                incomplete ILU(0) (0) factorization
+ * \return New SUNLinearSolver, or NULL on failure
+ */
+static SUNLinearSolver block_lu_new(N_Vector y, SUNMatrix A, int n_blocks,
+                                    int fill_in) {
+  SUNLinearSolver S;
+  SUNLinearSolver_Ops ops;
+  BlockLUContent *content;
+  int block_size;
+
+  // Check the compatibility of the matrix and vector
+  if (block_diagonal_check_pattern(A, n_blocks) == 0) {
+    printf(
+        "\n\nERROR Block LU solver requires a block-diagonal CSC matrix "
+        "with identical blocks\n\n");
+    return NULL;
+  }
+  if (NV_LENGTH_S(y) != SM_ROWS_S(A)) {
+    printf("\n\nERROR Block LU solver vector and matrix sizes differ\n\n");
+    return NULL;
+  }
+  block_size = SM_ROWS_S(A) / n_blocks;
+
+  // Create the linear solver and its operations
+  S = (SUNLinearSolver)malloc(sizeof *S);
+  if (S == NULL) return NULL;
+  ops = (SUNLinearSolver_Ops)malloc(sizeof(struct _generic_SUNLinearSolver_Ops));
+  if (ops == NULL) {
+    free(S);
+    return NULL;
+  }
+  ops->gettype = SUNLinSolGetType_BlockLU;
+  ops->setatimes = NULL;
+  ops->setpreconditioner = NULL;
+  ops->setscalingvectors = NULL;
+  ops->initialize = SUNLinSolInitialize_BlockLU;
+  ops->setup = SUNLinSolSetup_BlockLU;
+  ops->solve = SUNLinSolSolve_BlockLU;
+  ops->numiters = NULL;
+  ops->resnorm = NULL;
+  ops->lastflag = SUNLinSolLastFlag_BlockLU;
+  ops->space = SUNLinSolSpace_BlockLU;
+  ops->resid = NULL;
+  ops->free = SUNLinSolFree_BlockLU;
+  S->ops = ops;
+
+  // Set up the solver content
+  content = (BlockLUContent *)calloc(1, sizeof(BlockLUContent));
+  if (content == NULL) {
+    free(ops);
+    free(S);
+    return NULL;
+  }
+  S->content = content;
+  content->n_blocks = n_blocks;
+  content->n_groups =
+      (n_blocks + BLOCK_LU_VECTOR_WIDTH - 1) / BLOCK_LU_VECTOR_WIDTH;
+  content->block_nnz = SM_INDEXPTRS_S(A)[block_size];
+  content->last_flag = SUNLS_SUCCESS;
+
+  // Generate the elimination program from the per-block pattern
+  if (block_lu_program_new(&(content->program), A, block_size, fill_in) ==
+      0) {
+    printf(
+        "\n\nERROR Block LU solver requires all diagonal elements in the "
+        "sparsity pattern\n\n");
+    SUNLinSolFree_BlockLU(S);
+    return NULL;
+  }
+
+  content->lu_data = (double *)malloc((size_t)content->n_groups *
+                                      content->program.n_elem *
+                                      BLOCK_LU_VECTOR_WIDTH * sizeof(double));
+  content->work = (double *)malloc((size_t)content->n_groups * block_size *
+                                   BLOCK_LU_VECTOR_WIDTH * sizeof(double));
+  if (content->lu_data == NULL || content->work == NULL) {
+    SUNLinSolFree_BlockLU(S);
+    return NULL;
+  }
+
+  return S;
+}
+
+SUNLinearSolver SUNBlockLU(N_Vector y, SUNMatrix A, int n_blocks) {
+  return block_lu_new(y, A, n_blocks, 1);
+}
+
+SUNLinearSolver SUNBlockILU(N_Vector y, SUNMatrix A, int n_blocks) {
+  return block_lu_new(y, A, n_blocks, 0);
+}
+
+SUNLinearSolver_Type SUNLinSolGetType_BlockLU(SUNLinearSolver S) {
+  return SUNLINEARSOLVER_DIRECT;
+}
+
+int SUNLinSolInitialize_BlockLU(SUNLinearSolver S) {
+  BLOCK_LU_CONTENT(S)->last_flag = SUNLS_SUCCESS;
+  return SUNLS_SUCCESS;
+}
+
+int SUNLinSolSetup_BlockLU(SUNLinearSolver S, SUNMatrix A) {
+  BlockLUContent *content = BLOCK_LU_CONTENT(S);
+  double *data = SM_DATA_S(A);
+  int n_singular = 0;
+
+  if (SM_NNZ_S(A) != content->n_blocks * content->block_nnz) {
+    content->last_flag = SUNLS_ILL_INPUT;
+    return SUNLS_ILL_INPUT;
+  }
+
+#ifdef CAMP_USE_OPENMP
+#pragma omp parallel for schedule(static) reduction(+ : n_singular)
+#endif
+  for (int i_group = 0; i_group < content->n_groups; ++i_group) {
+    block_lu_load_group(content, i_group, data);
+    n_singular += block_lu_factor_group(
+        &(content->program),
+        &(content->lu_data[(size_t)i_group * content->program.n_elem *
+                           BLOCK_LU_VECTOR_WIDTH]));
+  }
+
+  content->last_flag = n_singular > 0 ? SUNLS_LUFACT_FAIL : SUNLS_SUCCESS;
+  return content->last_flag;
+}
+
+int SUNLinSolSolve_BlockLU(SUNLinearSolver S, SUNMatrix A, N_Vector x,
+                           N_Vector b, realtype tol) {
+  BlockLUContent *content = BLOCK_LU_CONTENT(S);
+  int size = content->program.size;
+  const int *perm = content->program.perm;
+  double *x_data = N_VGetArrayPointer(x);
+  double *b_data = N_VGetArrayPointer(b);
+
+#ifdef CAMP_USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int i_group = 0; i_group < content->n_groups; ++i_group) {
+    double *work =
+        &(content->work[(size_t)i_group * size * BLOCK_LU_VECTOR_WIDTH]);
+    int first_block = i_group * BLOCK_LU_VECTOR_WIDTH;
+    int n_lanes = content->n_blocks - first_block < BLOCK_LU_VECTOR_WIDTH
+                      ? content->n_blocks - first_block
+                      : BLOCK_LU_VECTOR_WIDTH;
+
+    // Interleave the right-hand side of the group in pivot order
+    memset(work, 0, (size_t)size * BLOCK_LU_VECTOR_WIDTH * sizeof(double));
+    for (int i_lane = 0; i_lane < n_lanes; ++i_lane)
+      for (int i = 0; i < size; ++i)
+        work[BLOCK_LU_ID(i, i_lane)] =
+            b_data[(size_t)(first_block + i_lane) * size + perm[i]];
+
+    block_lu_solve_group(
+        &(content->program),
+        &(content->lu_data[(size_t)i_group * content->program.n_elem *
+                           BLOCK_LU_VECTOR_WIDTH]),
+        work);
+
+    for (int i_lane = 0; i_lane < n_lanes; ++i_lane)
+      for (int i = 0; i < size; ++i)
+        x_data[(size_t)(first_block + i_lane) * size + perm[i]] =
+            work[BLOCK_LU_ID(i, i_lane)];
+  }
+
+  content->last_flag = SUNLS_SUCCESS;
+  return content->last_flag;
+}
+
+long int SUNLinSolLastFlag_BlockLU(SUNLinearSolver S) {
+  return BLOCK_LU_CONTENT(S)->last_flag;
+}
+
+int SUNLinSolSpace_BlockLU(SUNLinearSolver S, long int *lenrwLS,
+                           long int *leniwLS) {
+  BlockLUContent *content = BLOCK_LU_CONTENT(S);
+  BlockLUProgram *program = &(content->program);
+  int size = program->size;
+  int n_l = program->l_col_ptrs[size];
+  int n_u = program->u_col_ptrs[size];
+  int n_update = program->update_ptrs[size];
+
+  *lenrwLS = (long int)content->n_groups * BLOCK_LU_VECTOR_WIDTH *
+             (program->n_elem + size);
+  *leniwLS = 6 + program->n_input_elem + 5 * size + 3 +
+             2 * (n_l + n_u) + 3 * n_update;
+  return SUNLS_SUCCESS;
+}
+
+int SUNLinSolFree_BlockLU(SUNLinearSolver S) {
+  BlockLUContent *content;
+
+  if (S == NULL) return SUNLS_SUCCESS;
+  content = BLOCK_LU_CONTENT(S);
+  if (content != NULL) {
+    block_lu_program_free(&(content->program));
+    free(content->lu_data);
+    free(content->work);
+    free(content);
+  }
+  free(S->ops);
+  free(S);
+  return SUNLS_SUCCESS;
+}
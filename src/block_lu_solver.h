@@ -0,0 +1,116 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Header for the cell-interleaved block-diagonal sparse LU linear solver
+ *
+ */
+/** \file
+ * \brief Header for the cell-interleaved block-diagonal sparse LU linear
+ *        solver
+ *
+ * All the diagonal blocks of the multi-cell solver Jacobian share the
+ * sparsity pattern of a single grid cell. This SUNLinearSolver analyzes that
+ * pattern once, chooses a fill-reducing (Markowitz) order for the diagonal
+ * pivots, derives the fill-in and generates a static elimination program
+ * (the sequence of divisions and multiply-subtract updates of the LU
+ * factorization without numerical pivoting). The numeric factorization and the
+ * forward and back substitutions then execute this program on groups of
+ * \c BLOCK_LU_VECTOR_WIDTH grid cells whose matrix elements are stored
+ * interleaved, so that each step of the program operates on contiguous
+ * data across the grid cells of a group and can be vectorized by the
+ * compiler.
+ *
+ * The same solver can instead do the incomplete factorization ILU(0), which
+ * keeps the sparsity pattern of the blocks and drops the fill-in. This is
+ * cheaper than the complete factorization and is meant for preconditioning
+ * an iterative linear solver.
+ */
+#ifndef BLOCK_LU_SOLVER_H_
+#define BLOCK_LU_SOLVER_H_
+
+#include <nvector/nvector_serial.h>
+#include <sundials/sundials_linearsolver.h>
+#include <sunmatrix/sunmatrix_sparse.h>
+
+// Number of grid cells whose matrix elements are stored interleaved
+#ifndef BLOCK_LU_VECTOR_WIDTH
+#define BLOCK_LU_VECTOR_WIDTH 8
+#endif
+
+/* Static elimination program for the per-block sparsity pattern */
+typedef struct {
+  int size;           // Number of rows (and columns) in each block
+  int n_elem;         // Number of elements in the LU factors (incl. fill-in)
+  int n_input_elem;   // Number of non-zero elements in each input block
+  int *perm;          // Original row (and column) of each pivot
+  int *input_elem;    // LU element index for each input block element
+  int *diag_elem;     // LU element index for each diagonal element
+  int *l_col_ptrs;    // Start of each column of L in l_row_ids/l_elem
+  int *l_row_ids;     // Row index for each (strictly lower) element of L
+  int *l_elem;        // LU element index for each element of L
+  int *u_col_ptrs;    // Start of each column of U in u_row_ids/u_elem
+  int *u_row_ids;     // Row index for each (strictly upper) element of U
+  int *u_elem;        // LU element index for each element of U
+  int *update_ptrs;   // Start of the updates for each pivot in update_*
+  int *update_target; // LU element updated by each multiply-subtract
+  int *update_l;      // L element (multiplier) for each multiply-subtract
+  int *update_u;      // U element for each multiply-subtract
+} BlockLUProgram;
+
+/* Cell-interleaved block-diagonal sparse LU linear solver data */
+typedef struct {
+  int n_blocks;            // Number of diagonal blocks
+  int n_groups;            // Number of groups of interleaved blocks
+  int block_nnz;           // Number of non-zero elements in each block
+  BlockLUProgram program;  // Elimination program shared by all blocks
+  double *lu_data;         // Interleaved LU factors for each group
+  double *work;            // Interleaved right-hand side for each group
+  long int last_flag;      // Last error flag
+} BlockLUContent;
+
+#define BLOCK_LU_CONTENT(S) ((BlockLUContent *)(S->content))
+
+/** \brief Create a cell-interleaved block-diagonal sparse LU linear solver
+ *
+ * \param y Solver state vector (used to check dimensions)
+ * \param A Block-diagonal CSC matrix with the sparsity pattern of the
+ *          linear systems to solve
+ * \param n_blocks Number of diagonal blocks in A, each with the same
+ *                 sparsity pattern and a non-zero diagonal
+ * \return New SUNLinearSolver, or NULL if the matrix is not block diagonal
+ *         with identical blocks, a diagonal element is missing from the
+ *         pattern, or memory allocation fails
+ */
+SUNLinearSolver SUNBlockLU(N_Vector y, SUNMatrix A, int n_blocks);
+
+/** \brief Create a cell-interleaved block-diagonal sparse ILU(0) solver
+ *
+ * The pivot order and the requirements on A are those of \c SUNBlockLU(),
+ * but the updates of elements outside the sparsity pattern of the blocks
+ * are dropped, so the solves are only exact when the complete factorization
+ * has no fill-in.
+ *
+ * \param y Solver state vector (used to check dimensions)
+ * \param A Block-diagonal CSC matrix with the sparsity pattern of the
+ *          linear systems to solve
+ * \param n_blocks Number of diagonal blocks in A, each with the same
+ *                 sparsity pattern and a non-zero diagonal
+ * \return New SUNLinearSolver, or NULL if the matrix is not block diagonal
+ *         with identical blocks, a diagonal element is missing from the
+ *         pattern, or memory allocation fails
+ */
+SUNLinearSolver SUNBlockILU(N_Vector y, SUNMatrix A, int n_blocks);
+
+/* SUNLinearSolver operations */
+SUNLinearSolver_Type SUNLinSolGetType_BlockLU(SUNLinearSolver S);
+int SUNLinSolInitialize_BlockLU(SUNLinearSolver S);
+int SUNLinSolSetup_BlockLU(SUNLinearSolver S, SUNMatrix A);
+int SUNLinSolSolve_BlockLU(SUNLinearSolver S, SUNMatrix A, N_Vector x,
+                           N_Vector b, realtype tol);
+long int SUNLinSolLastFlag_BlockLU(SUNLinearSolver S);
+int SUNLinSolSpace_BlockLU(SUNLinearSolver S, long int *lenrwLS,
+                           long int *leniwLS);
+int SUNLinSolFree_BlockLU(SUNLinearSolver S);
+
+#endif
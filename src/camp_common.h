@@ -11,6 +11,7 @@
 #ifndef CAMP_COMMON_H
 #define CAMP_COMMON_H
 
+#include <pthread.h>
 #include <time.h>
 #include "Jacobian.h"
 #include "time_derivative.h"
@@ -26,6 +27,8 @@
 #include <sundials/sundials_math.h>  /* SUNDIALS math function macros       */
 #include <sundials/sundials_types.h> /* definition of types                 */
 #include <sunlinsol/sunlinsol_klu.h> /* KLU SUNLinearSolver                 */
+#include <sunlinsol/sunlinsol_spgmr.h> /* SPGMR SUNLinearSolver             */
+#include <cvode/cvode_spils.h>       /* CVSpils interface                   */
 #include <sunmatrix/sunmatrix_sparse.h> /* sparse SUNMatrix                    */
 #endif
 
@@ -50,12 +53,63 @@
 /* Number of environmental parameters */
 #define CAMP_NUM_ENV_PARAM_ 2 // !!! Must match the value in camp_state.f90 !!!
 
+/* Linear solvers (Must match parameters defined in camp_camp_solver_data
+ * module) */
+#define CAMP_LINEAR_SOLVER_KLU 0       // KLU (block-by-block for multi-cell)
+#define CAMP_LINEAR_SOLVER_BLOCK_LU 1  // Cell-interleaved static sparse LU
+#define CAMP_LINEAR_SOLVER_SPGMR 2     // Matrix-free GMRES with a block
+                                       // ILU(0) preconditioner
+
+/* Integrators (Must match parameters defined in camp_camp_solver_data
+ * module) */
+#define CAMP_INTEGRATOR_BDF 0     // CVODE variable-order BDF
+#define CAMP_INTEGRATOR_ROS2 1    // 2-stage, 2nd-order Rosenbrock
+#define CAMP_INTEGRATOR_ROS3 2    // 3-stage, 3rd-order Rosenbrock
+#define CAMP_INTEGRATOR_RODAS3 3  // 4-stage, 3rd-order Rosenbrock
+#define CAMP_INTEGRATOR_RODAS4 4  // 6-stage, 4th-order Rosenbrock
+
+/* Error norms for multi-cell systems (Must match parameters defined in
+ * camp_camp_solver_data module) */
+#define CAMP_ERROR_NORM_GLOBAL 0    // WRMS norm of all solver variables
+#define CAMP_ERROR_NORM_CELL_MAX 1  // Largest WRMS norm of the grid cells
+
+/* Solver phases timed by the profiler (Must match parameters defined in
+ * camp_solver_stats module) */
+#define CAMP_PROFILE_ENV_UPDATE 0       // Environment-dependent data updates
+#define CAMP_PROFILE_DERIV 1            // Calls to f()
+#define CAMP_PROFILE_JAC 2              // Calls to Jac() (Jacobian assembly)
+#define CAMP_PROFILE_AERO_REP_UPDATE 3  // Aerosol representation updates
+#define CAMP_PROFILE_SUB_MODEL_CALC 4   // Sub model calculations
+#define CAMP_PROFILE_RXN_DERIV 5        // Reaction contributions to f()
+#define CAMP_PROFILE_LS_SETUP 6         // Linear solver setups
+#define CAMP_PROFILE_LS_SOLVE 7         // Linear solves
+#define CAMP_PROFILE_GUESS_HELPER 8     // Guess helper
+#define CAMP_PROFILE_NUM_PHASES 9
+
+/* Number of reaction types timed by the profiler. Reactions are timed by
+ * their type id (RXN_*), with the reactions of a generated kernel or of the
+ * structure-of-arrays tables under id 0. */
+#define CAMP_PROFILE_NUM_RXN_TYPES 20
+
 /* boolean definition */
 // CUDA/C++ already has bool definition: Avoid issues disabling it for GPU
 #ifndef CAMP_GPU_SOLVER_H_
 typedef enum { false, true } bool;
 #endif
 
+/* Solver profile: timers and counters accumulated while profiling is
+ * enabled */
+typedef struct SolverProfile {
+  bool enabled;  // Flag indicating whether the timers are running
+  double phase_time[CAMP_PROFILE_NUM_PHASES];     // Time in each phase (s)
+  long int phase_calls[CAMP_PROFILE_NUM_PHASES];  // Timed calls of each phase
+  double rxn_time[CAMP_PROFILE_NUM_RXN_TYPES];  // Time in the f() reaction
+                                                // contributions of each
+                                                // reaction type (s)
+  long int rxn_calls[CAMP_PROFILE_NUM_RXN_TYPES];  // Reaction contributions
+                                                   // of each type calculated
+} SolverProfile;
+
 /* Jacobian map */
 typedef struct {
   int solver_id;  // solver Jacobian id
@@ -78,6 +132,8 @@ typedef struct {
                     // integration tolerances
   int *var_type;    // pointer to array of state variable types (solver,
                     // constant, PSSA)
+  int *var_state_id;  // state array index of each solver variable in a
+                      // grid cell
 #ifdef CAMP_USE_SUNDIALS
   SUNMatrix J_init;    // sparse solver Jacobian matrix with used elements
                        // initialized to 1.0
@@ -100,6 +156,9 @@ typedef struct {
                            // rxn_id    = jac_id[i_dep][i_ind]
                            // param_id  = jac_id[i_ind][j_ind]
   int n_mapped_values;     // Number of Jacobian map elements
+  int n_direct_mapped_values;  // Number of Jacobian map elements at the
+                               // beginning of jac_map that do not depend
+                               // on sub-model parameters (param_id = 0)
   int n_mapped_params;     // Number of Jacobian map elements for sub models
 
   int grid_cell_id;         // Index of the current grid cell
@@ -109,6 +168,11 @@ typedef struct {
   double *grid_cell_env;    // Pointer to the current grid cell being solved
                             // on the total_env state array
   double *total_env;        // Total (multi-cell) environmental state array
+  double *last_env;  // Total (multi-cell) environmental state for which the
+                     // environment-dependent parameters were last calculated
+                     // (NAN for grid cells whose parameters must be
+                     // recalculated; NULL for batch solvers, whose
+                     // parameters are calculated by the parent solver)
   double *grid_cell_rxn_env_data;  // Environment-dependent parameters for the
                                    // current grid cell
   double *rxn_env_data;            // Total (multi-cell) reaction environment-
@@ -176,14 +240,83 @@ typedef struct {
                                  // for the current grid cell
   int n_sub_model_env_data;      // Number of sub model environmental parameters
                                  // from all sub models
+  struct RxnKernel *rxn_kernel;  // Generated kernel for reaction
+                                 // contributions (NULL to use the generic
+                                 // reaction functions only)
+  struct RxnSoA *rxn_soa;        // Structure-of-arrays tables of the
+                                 // mass-action reactions (NULL to use the
+                                 // generic reaction functions only)
+  struct RateTable *rate_table;  // Tabulated temperature- and
+                                 // pressure-dependent reaction parameters
+                                 // (NULL to calculate them directly)
+  struct RxnEnvBatch *rxn_env_batch;  // Rate expression parameters for
+                                      // batch evaluation of rate constants
+                                      // (NULL to use the reaction update
+                                      // functions only)
+  SolverProfile *profile;  // Profile to accumulate the timers of calculations
+                           // on this model data in (NULL for none)
 } ModelData;
 
-/* Solver data structure */
+/* Per-thread view of the model data for calculations on one grid cell */
+typedef struct {
+  ModelData model_data;  // Copy of the model data with the grid cell pointers
+                         // set for the current grid cell. When more than one
+                         // view is used, the parameter arrays that are
+                         // modified during solving are private to the view.
+#ifdef CAMP_USE_SUNDIALS
+  TimeDerivative time_deriv;  // Working TimeDerivative for the grid cell
+  Jacobian jac;               // Working reaction Jacobian for the grid cell
+  double *chunk_state;  // Species-major ([species][grid cell]) state of the
+                        // current chunk of grid cells (NULL when reaction
+                        // rates are calculated one grid cell at a time)
+  double *chunk_rxn_env_data;  // Species-major reaction environment-dependent
+                               // data of the current chunk of grid cells
+  TimeDerivative chunk_deriv;  // Species-major TimeDerivative of the current
+                               // chunk of grid cells
+#endif
+  SolverProfile profile;  // Timers of the calculations run on this view
+} GridCellView;
+
+/* Stiffness estimate of a grid cell, used to sort grid cells into groups */
 typedef struct {
+  double stiffness;  // Stiffness estimate (1/s)
+  int cell_id;       // Grid cell index
+} CellStiffness;
+
+/* Grouping of grid cells with similar stiffness into the same batches. The
+ * batches integrate contiguous grid cells of the grouped arrays, which hold
+ * the per-cell data in the order of the groups. */
+typedef struct CellGroups {
+  int *cell_order;    // Grid cell at each position of the grouped arrays
+  double *stiffness;  // Stiffness estimate of each grid cell from the last
+                      // call to the solver (1/s)
+  double *grouped_stiffness;  // Stiffness estimates in grouped order, set by
+                              // the batches during solving
+  CellStiffness *sorted;      // Work array for sorting the grid cells
+  double *state;              // State array in grouped order
+  double *env;                // Environmental state array in grouped order
+  double *rxn_env_data;       // Reaction environment-dependent data in
+                              // grouped order
+  double *aero_rep_env_data;  // Aerosol representation environment-dependent
+                              // data in grouped order
+  double *sub_model_env_data;  // Sub model environment-dependent data in
+                               // grouped order
+} CellGroups;
+
+/* Solver data structure */
+typedef struct SolverData {
 #ifdef CAMP_USE_SUNDIALS
   N_Vector abs_tol_nv;        // abosolute tolerance vector
   N_Vector y;                 // vector of solver variables
   SUNLinearSolver ls;         // linear solver
+  SUNLinearSolver prec_ls;    // Block-diagonal ILU(0) solver for the
+                              // preconditioner of the iterative linear
+                              // solver (NULL for direct linear solvers)
+  SUNLinearSolver ls_profiled;  // Linear solver passed to the integrator,
+                                // which times the calls to ls
+  SUNMatrix P;                // Preconditioner matrix (I - gamma J)
+  N_Vector ls_tmp1;           // Work vectors for Jacobian evaluations by
+  N_Vector ls_tmp2;           // the iterative linear solver
   TimeDerivative time_deriv;  // CAMP derivative structure for use in
                               // calculating deriv
   Jacobian jac;               // CAMP Jacobian structure for use in
@@ -196,10 +329,47 @@ typedef struct {
                        // is current
   realtype J_guess_t;  // Last time (t) for which J_guess was calculated
   int Jac_eval_fails;  // Number of Jacobian evaluation failures
+  double warm_start_tol;  // Maximum relative change in the solver variables
+                          // between calls for which the integrator state of
+                          // the last call is reused (0 disables warm starts)
+  N_Vector y_last;        // Solver variables at the end of the last call
+  realtype h_last;        // Next step size at the end of the last call (0 if
+                          // there is no integrator state to reuse)
+  double *env_data_last;  // Environmental state and environment-dependent
+                          // model data at the end of the last call
+  bool reuse_jac;         // Flag indicating that the next Jacobian evaluation
+                          // reuses the last Jacobian of the last call
+  double rate_table_tol;  // Maximum relative interpolation error of the
+                          // tabulated reaction parameters (0 calculates
+                          // them directly)
+  bool vector_rate_constants;  // Flag indicating whether to evaluate rate
+                               // constants in vectorized batches
   int solver_flag;     // Last flag returned by a call to CVode()
   int output_precision;  // Flag indicating whether to output precision loss
   int use_deriv_est;     // Flag indicating whether to use an estimated
                          // derivative in the f() calculations
+  int n_cell_views;          // Number of grid cell views (one per thread)
+  int n_active_cells;        // Number of grid cells integrated during the
+                             // current call to the solver
+  int *active_cells;         // Indices of the grid cells integrated during
+                             // the current call to the solver (the others
+                             // are held constant)
+  GridCellView *cell_views;  // Grid cell views used in the f() and Jac()
+                             // grid cell loops
+  double *cell_stiffness;    // Stiffness estimate of each grid cell at the
+                             // beginning of the last call to the solver
+                             // (NULL if not needed)
+  bool integrated;           // Flag indicating whether the integrator was run
+                             // during the last call to the solver
+  double run_time;           // Wall time of the last call to the solver (s)
+  double *cell_calc_time;    // Profiled time of the f() and Jac() grid cell
+                             // calculations of each grid cell during the last
+                             // call to the solver (s)
+  int *cell_fails_start;     // Error test failures of each grid cell before
+                             // the last call to the solver (NULL for batches)
+  int *cell_fails_end;       // Work array for the error test failures of each
+                             // grid cell after the last call to the solver
+                             // (NULL for batches)
 #ifdef CAMP_DEBUG
   booleantype debug_out;  // Output debugging information during solving
   booleantype eval_Jac;   // Evalute Jacobian data during solving
@@ -216,6 +386,50 @@ typedef struct {
   bool no_solve;  // Flag to indicate whether to run the solver needs to be
                   // run. Set to true when no reactions are present.
   double init_time_step;  // Initial time step (s)
+  int n_cells_per_batch;  // Number of grid cells integrated together by each
+                          // independent solver instance (0 to integrate all
+                          // grid cells as a single system)
+  int n_batches;          // Number of independent solver instances
+  struct SolverData *batches;  // Independent solver instances for batches of
+                               // grid cells (NULL when all grid cells are
+                               // integrated as a single system)
+  bool group_cells;  // Flag indicating whether to group grid cells into
+                     // batches by stiffness
+  int n_batch_threads;  // Number of threads integrating batches concurrently
+                        // (1 to integrate them one after another)
+  CellGroups *cell_groups;  // Grouping of the grid cells into batches (NULL
+                            // when batches are in the host order)
+  int first_cell;  // Index of the first grid cell integrated by this solver
+                   // instance
+  int linear_solver;  // Linear solver (CAMP_LINEAR_SOLVER_*)
+  int integrator;     // Integrator (CAMP_INTEGRATOR_*)
+  struct RosenbrockMem *ros_mem;  // Rosenbrock integrator (NULL when
+                                  // integrating with CVODE)
+  int error_norm;  // Error norm for multi-cell systems (CAMP_ERROR_NORM_*)
+  struct CellNorm *cell_norm;  // Per-grid-cell error norm data (NULL when
+                               // using the global error norm)
+  int n_cells_per_chunk;  // Number of grid cells whose reaction rates are
+                          // calculated together in f() (0 to calculate
+                          // them one grid cell at a time)
+  bool async_in_flight;  // Flag indicating whether an asynchronous call to
+                         // the solver has been started and not yet waited on
+  SolverProfile profile;  // Timers of the solver phases run outside the grid
+                          // cell views
 } SolverData;
 
+/* Asynchronous call to the solver */
+typedef struct {
+  SolverData *sd;         // Solver data (owned by the call while in flight)
+  double *state;          // Full state array (owned by the call while in
+                          // flight)
+  double *env;            // Full environmental state array (owned by the
+                          // call while in flight)
+  double t_initial;       // Initial time (s)
+  double t_final;         // Final time (s)
+  pthread_t thread;       // Worker thread running the solver
+  pthread_mutex_t mutex;  // Protects the completion flag
+  bool done;              // Flag indicating whether the solver has returned
+  int status;             // Flag returned by the solver (CAMP_SOLVER_*)
+} SolverAsync;
+
 #endif
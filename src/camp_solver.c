@@ -16,10 +16,22 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include "aero_rep_solver.h"
 #include "rxn_solver.h"
+#include "solver_profile.h"
 #include "sub_model_solver.h"
+#ifdef CAMP_USE_SUNDIALS
+#include "block_klu_solver.h"
+#include "block_lu_solver.h"
+#include "cell_norm.h"
+#include "rate_table.h"
+#include "rosenbrock_solver.h"
+#include "rxn_codegen.h"
+#include "rxn_env_batch.h"
+#include "rxn_soa.h"
+#endif
 #ifdef CAMP_USE_GPU
 #include "cuda/camp_gpu_solver.h"
 #endif
@@ -29,6 +41,9 @@
 #include <gsl/gsl_roots.h>
 #endif
 #include "camp_debug.h"
+#ifdef CAMP_USE_OPENMP
+#include <omp.h>
+#endif
 
 // Default solver initial time step relative to total integration time
 #define DEFAULT_TIME_STEP 1.0
@@ -44,6 +59,10 @@
 #define MAX_TIMESTEP_WARNINGS -1
 // Maximum number of steps in discreet addition guess helper
 #define GUESS_MAX_ITER 5
+// Number of environmental data arrays compared for warm starts
+#define WARM_START_ENV_ARRAYS 4
+// Maximum dimension of the Krylov subspace for the SPGMR linear solver
+#define SPGMR_MAX_KRYLOV_DIM 5
 
 // Status codes for calls to camp_solver functions
 #define CAMP_SOLVER_SUCCESS 0
@@ -111,6 +130,54 @@ void *solver_new(int n_state_var, int n_cells, int *var_type, int n_rxn,
   // Use the Jacobian estimated derivative in f() by default
   sd->use_deriv_est = 1;
 
+  // Integrate all grid cells as a single system by default
+  sd->n_cells_per_batch = 0;
+  sd->n_batches = 0;
+  sd->batches = NULL;
+  sd->first_cell = 0;
+  sd->cvode_mem = NULL;
+
+  // Keep the grid cells of each batch in the host order by default
+  sd->group_cells = false;
+  sd->cell_groups = NULL;
+
+  // Integrate batches one after another by default
+  sd->n_batch_threads = 1;
+
+  // Solve multi-cell systems with KLU by default
+  sd->linear_solver = CAMP_LINEAR_SOLVER_KLU;
+
+  // Integrate with CVODE BDF by default
+  sd->integrator = CAMP_INTEGRATOR_BDF;
+  sd->ros_mem = NULL;
+
+  // Use the WRMS norm of all the solver variables for error tests by default
+  sd->error_norm = CAMP_ERROR_NORM_GLOBAL;
+  sd->cell_norm = NULL;
+
+  // Start each call to the solver from scratch by default
+  sd->warm_start_tol = 0.0;
+  sd->y_last = NULL;
+  sd->h_last = ZERO;
+  sd->env_data_last = NULL;
+  sd->reuse_jac = false;
+
+  // Calculate the temperature- and pressure-dependent reaction parameters
+  // directly by default
+  sd->rate_table_tol = 0.0;
+  sd->vector_rate_constants = false;
+
+  // Calculate reaction rates one grid cell at a time by default
+  sd->n_cells_per_chunk = 0;
+
+  // No asynchronous call to the solver is in flight
+  sd->async_in_flight = false;
+
+  // Do not profile the solver by default
+  memset(&(sd->profile), 0, sizeof(SolverProfile));
+  sd->profile.enabled = false;
+  sd->model_data.profile = &(sd->profile);
+
   // Save the number of state variables per grid cell
   sd->model_data.n_per_cell_state_var = n_state_var;
 
@@ -134,6 +201,19 @@ void *solver_new(int n_state_var, int n_cells, int *var_type, int n_rxn,
   // Save the number of solver variables per grid cell
   sd->model_data.n_per_cell_dep_var = n_dep_var;
 
+  // Save the state array index of each solver variable, so the solver
+  // variables can be gathered from and scattered to the state array without
+  // checking the variable types
+  sd->model_data.var_state_id =
+      (int *)malloc((n_dep_var > 0 ? n_dep_var : 1) * sizeof(int));
+  if (sd->model_data.var_state_id == NULL) {
+    printf("\n\nERROR allocating space for solver variable ids\n\n");
+    exit(EXIT_FAILURE);
+  }
+  for (int i = 0, i_dep_var = 0; i < n_state_var; i++)
+    if (var_type[i] == CHEM_SPEC_VARIABLE)
+      sd->model_data.var_state_id[i_dep_var++] = i;
+
 #ifdef CAMP_USE_SUNDIALS
   // Set up a TimeDerivative object to use during solving
   if (time_derivative_initialize(&(sd->time_deriv), n_dep_var) != 1) {
@@ -144,6 +224,39 @@ void *solver_new(int n_state_var, int n_cells, int *var_type, int n_rxn,
   // Set up the solver variable array and helper derivative array
   sd->y = N_VNew_Serial(n_dep_var * n_cells);
   sd->deriv = N_VNew_Serial(n_dep_var * n_cells);
+
+  // The integrator, linear solver and grid cell views are created during
+  // initialization
+  sd->abs_tol_nv = NULL;
+  sd->ls = NULL;
+  sd->ls_profiled = NULL;
+  sd->prec_ls = NULL;
+  sd->P = NULL;
+  sd->ls_tmp1 = NULL;
+  sd->ls_tmp2 = NULL;
+  sd->n_cell_views = 0;
+  sd->cell_views = NULL;
+  sd->cell_stiffness = NULL;
+
+  // Set up the list of grid cells to integrate
+  sd->active_cells = (int *)malloc(n_cells * sizeof(int));
+  if (sd->active_cells == NULL) {
+    printf("\n\nERROR allocating space for active grid cells\n\n");
+    exit(EXIT_FAILURE);
+  }
+  solver_set_all_cells_active(sd);
+
+  // Set up the per-grid-cell statistics
+  sd->integrated = false;
+  sd->run_time = 0.0;
+  sd->cell_calc_time = (double *)calloc(n_cells, sizeof(double));
+  sd->cell_fails_start = (int *)calloc(n_cells, sizeof(int));
+  sd->cell_fails_end = (int *)calloc(n_cells, sizeof(int));
+  if (sd->cell_calc_time == NULL || sd->cell_fails_start == NULL ||
+      sd->cell_fails_end == NULL) {
+    printf("\n\nERROR allocating space for grid cell statistics\n\n");
+    exit(EXIT_FAILURE);
+  }
 #endif
 
   // Allocate space for the reaction data and set the number
@@ -170,6 +283,19 @@ void *solver_new(int n_state_var, int n_cells, int *var_type, int n_rxn,
     exit(EXIT_FAILURE);
   }
 
+  // Allocate space for the environmental state of the last update of the
+  // environment-dependent data (none of the grid cells are up to date)
+  sd->model_data.last_env =
+      (double *)malloc(n_cells * CAMP_NUM_ENV_PARAM_ * sizeof(double));
+  if (sd->model_data.last_env == NULL) {
+    printf(
+        "\n\nERROR allocating space for the last environmental "
+        "state\n\n");
+    exit(EXIT_FAILURE);
+  }
+  for (int i = 0; i < n_cells * CAMP_NUM_ENV_PARAM_; ++i)
+    sd->model_data.last_env[i] = NAN;
+
   // Allocate space for the reaction data pointers
   sd->model_data.rxn_int_indices = (int *)malloc((n_rxn + 1) * sizeof(int *));
   if (sd->model_data.rxn_int_indices == NULL) {
@@ -191,6 +317,10 @@ void *solver_new(int n_state_var, int n_cells, int *var_type, int n_rxn,
 
   sd->model_data.n_rxn = n_rxn;
   sd->model_data.n_added_rxns = 0;
+  sd->model_data.rxn_kernel = NULL;
+  sd->model_data.rxn_soa = NULL;
+  sd->model_data.rate_table = NULL;
+  sd->model_data.rxn_env_batch = NULL;
   sd->model_data.n_rxn_env_data = 0;
   sd->model_data.rxn_int_indices[0] = 0;
   sd->model_data.rxn_float_indices[0] = 0;
@@ -374,20 +504,133 @@ void *solver_new(int n_state_var, int n_cells, int *var_type, int n_rxn,
 void solver_initialize(void *solver_data, double *abs_tol, double rel_tol,
                        int max_steps, int max_conv_fails) {
 #ifdef CAMP_USE_SUNDIALS
-  SolverData *sd;   // SolverData object
-  int flag;         // return code from SUNDIALS functions
-  int n_dep_var;    // number of dependent variables per grid cell
-  int i_dep_var;    // index of dependent variables in loops
-  int n_state_var;  // number of variables on the state array per
-                    // grid cell
-  int n_cells;      // number of cells to solve simultaneously
-  int *var_type;    // state variable types
+  SolverData *sd;     // SolverData object
+  int n_cells;        // number of cells to solve simultaneously
+  int n_batch_cells;  // number of cells in a batch of grid cells
 
   // Seed the random number generator
   srand((unsigned int)100);
 
   // Get a pointer to the SolverData
   sd = (SolverData *)solver_data;
+  n_cells = sd->model_data.n_cells;
+
+  // Add a pointer in the model data to the absolute tolerances for use during
+  // solving. TODO find a better way to do this
+  sd->model_data.abs_tol = abs_tol;
+
+  // Get the structure of the Jacobian matrix
+  sd->J = get_jac_init(sd);
+  sd->model_data.J_init = SUNMatClone(sd->J);
+  SUNMatCopy(sd->J, sd->model_data.J_init);
+
+  // Repack the mass-action reactions, whose derivative and Jacobian ids are
+  // now set, into structure-of-arrays tables
+  sd->model_data.rxn_soa = rxn_soa_new(&(sd->model_data));
+
+  // Tabulate the temperature- and pressure-dependent reaction parameters
+  if (sd->rate_table_tol > 0.0)
+    sd->model_data.rate_table =
+        rate_table_new(&(sd->model_data), sd->rate_table_tol);
+
+  // Repack the rate expressions for vectorized evaluation
+  if (sd->vector_rate_constants)
+    sd->model_data.rxn_env_batch = rxn_env_batch_new(&(sd->model_data));
+
+  // Create a Jacobian matrix for correcting negative predicted concentrations
+  // during solving
+  sd->J_guess = SUNMatClone(sd->J);
+  SUNMatCopy(sd->J, sd->J_guess);
+
+  if (sd->n_cells_per_batch > 0 && sd->n_cells_per_batch < n_cells) {
+    // Set up an independent solver for each batch of grid cells
+    sd->n_batches =
+        (n_cells + sd->n_cells_per_batch - 1) / sd->n_cells_per_batch;
+    sd->batches = (SolverData *)malloc(sd->n_batches * sizeof(SolverData));
+    if (sd->batches == NULL) {
+      printf("\n\nERROR allocating space for solver batches\n\n");
+      exit(EXIT_FAILURE);
+    }
+    if (sd->group_cells) {
+      sd->cell_groups = solver_new_cell_groups(sd);
+      // Accumulate the error test failures of the batches by grid cell
+      if (sd->error_norm == CAMP_ERROR_NORM_CELL_MAX)
+        sd->cell_norm =
+            cell_norm_new(n_cells, sd->model_data.n_per_cell_dep_var);
+    }
+    for (int i_batch = 0; i_batch < sd->n_batches; ++i_batch) {
+      int first_cell = i_batch * sd->n_cells_per_batch;
+      n_batch_cells = n_cells - first_cell < sd->n_cells_per_batch
+                          ? n_cells - first_cell
+                          : sd->n_cells_per_batch;
+      solver_new_batch(sd, &(sd->batches[i_batch]), first_cell,
+                       n_batch_cells);
+      solver_initialize_cell_views(&(sd->batches[i_batch]));
+      solver_initialize_integrator(&(sd->batches[i_batch]), rel_tol,
+                                   max_steps, max_conv_fails);
+    }
+  } else {
+    // Integrate all grid cells as a single system
+    sd->n_cells_per_batch = 0;
+    sd->n_batch_threads = 1;
+    solver_initialize_cell_views(sd);
+    solver_initialize_integrator(sd, rel_tol, max_steps, max_conv_fails);
+  }
+
+// Allocate Jacobian on GPU
+#ifdef CAMP_USE_GPU
+  allocate_jac_gpu(sd->model_data.n_per_cell_solver_jac_elem, n_cells);
+#endif
+
+// Set gpu rxn values
+#ifdef CAMP_USE_GPU
+  solver_set_rxn_data_gpu(&(sd->model_data));
+#endif
+
+#endif
+}
+
+#ifdef CAMP_USE_SUNDIALS
+/** \brief Create and set up the selected integrator for a SolverData object
+ *
+ * \param sd Pointer to the SolverData object
+ * \param rel_tol Relative integration tolerance
+ * \param max_steps Maximum number of internal integration steps
+ * \param max_conv_fails Maximum number of convergence failures (CVODE only)
+ */
+void solver_initialize_integrator(SolverData *sd, double rel_tol,
+                                  int max_steps, int max_conv_fails) {
+  // Use the per-grid-cell error norm for the solver variables and all the
+  // integrator vectors cloned from them
+  int n_cells = sd->model_data.n_cells;
+  if (sd->error_norm == CAMP_ERROR_NORM_CELL_MAX && n_cells > 1) {
+    sd->cell_norm = cell_norm_new(n_cells, sd->model_data.n_per_cell_dep_var);
+    if (cell_norm_attach(sd->y, sd->cell_norm) != 0) {
+      printf("\n\nERROR setting the per-grid-cell error norm\n\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if (sd->integrator == CAMP_INTEGRATOR_BDF) {
+    solver_initialize_cvode(sd, rel_tol, max_steps, max_conv_fails);
+  } else {
+    solver_initialize_rosenbrock(sd, rel_tol, max_steps);
+  }
+}
+
+/** \brief Create and set up the CVODE integrator for a SolverData object
+ *
+ * The Jacobian structure and the absolute tolerances must already be set on
+ * the SolverData object.
+ *
+ * \param sd Pointer to the SolverData object
+ * \param rel_tol Relative integration tolerance
+ * \param max_steps Maximum number of internal integration steps
+ * \param max_conv_fails Maximum number of convergence failures
+ */
+void solver_initialize_cvode(SolverData *sd, double rel_tol, int max_steps,
+                             int max_conv_fails) {
+  int flag;  // return code from SUNDIALS functions
 
   // Create a new solver object
   sd->cvode_mem = CVodeCreate(CV_BDF
@@ -399,13 +642,6 @@ void solver_initialize(void *solver_data, double *abs_tol, double rel_tol,
   );
   check_flag_fail((void *)sd->cvode_mem, "CVodeCreate", 0);
 
-  // Get the number of total and dependent variables on the state array,
-  // and the type of each state variable. All values are per-grid-cell.
-  n_state_var = sd->model_data.n_per_cell_state_var;
-  n_dep_var = sd->model_data.n_per_cell_dep_var;
-  var_type = sd->model_data.var_type;
-  n_cells = sd->model_data.n_cells;
-
   // Set the solver data
   flag = CVodeSetUserData(sd->cvode_mem, sd);
   check_flag_fail(&flag, "CVodeSetUserData", 1);
@@ -417,19 +653,10 @@ void solver_initialize(void *solver_data, double *abs_tol, double rel_tol,
   check_flag_fail(&flag, "CVodeInit", 1);
 
   // Set the relative and absolute tolerances
-  sd->abs_tol_nv = N_VNew_Serial(n_dep_var * n_cells);
-  i_dep_var = 0;
-  for (int i_cell = 0; i_cell < n_cells; ++i_cell)
-    for (int i_spec = 0; i_spec < n_state_var; ++i_spec)
-      if (var_type[i_spec] == CHEM_SPEC_VARIABLE)
-        NV_Ith_S(sd->abs_tol_nv, i_dep_var++) = (realtype)abs_tol[i_spec];
+  solver_set_abs_tol_nv(sd);
   flag = CVodeSVtolerances(sd->cvode_mem, (realtype)rel_tol, sd->abs_tol_nv);
   check_flag_fail(&flag, "CVodeSVtolerances", 1);
 
-  // Add a pointer in the model data to the absolute tolerances for use during
-  // solving. TODO find a better way to do this
-  sd->model_data.abs_tol = abs_tol;
-
   // Set the maximum number of iterations
   flag = CVodeSetMaxNumSteps(sd->cvode_mem, max_steps);
   check_flag_fail(&flag, "CVodeSetMaxNumSteps", 1);
@@ -446,207 +673,983 @@ void solver_initialize(void *solver_data, double *abs_tol, double rel_tol,
   flag = CVodeSetMaxHnilWarns(sd->cvode_mem, MAX_TIMESTEP_WARNINGS);
   check_flag_fail(&flag, "CVodeSetMaxHnilWarns", 1);
 
-  // Get the structure of the Jacobian matrix
-  sd->J = get_jac_init(sd);
-  sd->model_data.J_init = SUNMatClone(sd->J);
-  SUNMatCopy(sd->J, sd->model_data.J_init);
-
-  // Create a Jacobian matrix for correcting negative predicted concentrations
-  // during solving
-  sd->J_guess = SUNMatClone(sd->J);
-  SUNMatCopy(sd->J, sd->J_guess);
-
-  // Create a KLU SUNLinearSolver
-  sd->ls = SUNKLU(sd->y, sd->J);
-  check_flag_fail((void *)sd->ls, "SUNKLU", 0);
+  if (sd->linear_solver == CAMP_LINEAR_SOLVER_SPGMR) {
+    // Use matrix-free GMRES with a block ILU(0) preconditioner
+    solver_initialize_spgmr(sd);
+  } else {
+    // Create the linear solver
+    solver_new_direct_linear_solver(sd);
 
-  // Attach the linear solver and Jacobian to the CVodeMem object
-  flag = CVDlsSetLinearSolver(sd->cvode_mem, sd->ls, sd->J);
-  check_flag_fail(&flag, "CVDlsSetLinearSolver", 1);
+    // Attach the linear solver and Jacobian to the CVodeMem object
+    flag = CVDlsSetLinearSolver(sd->cvode_mem, sd->ls_profiled, sd->J);
+    check_flag_fail(&flag, "CVDlsSetLinearSolver", 1);
 
-  // Set the Jacobian function to Jac
-  flag = CVDlsSetJacFn(sd->cvode_mem, Jac);
-  check_flag_fail(&flag, "CVDlsSetJacFn", 1);
+    // Set the Jacobian function to Jac
+    flag = CVDlsSetJacFn(sd->cvode_mem, Jac);
+    check_flag_fail(&flag, "CVDlsSetJacFn", 1);
 
 #ifdef CAMP_CUSTOM_CVODE
-  // Set a function to improve guesses for y sent to the linear solver
-  flag = CVodeSetDlsGuessHelper(sd->cvode_mem, guess_helper);
-  check_flag_fail(&flag, "CVodeSetDlsGuessHelper", 1);
-#endif
-
-// Allocate Jacobian on GPU
-#ifdef CAMP_USE_GPU
-  allocate_jac_gpu(sd->model_data.n_per_cell_solver_jac_elem, n_cells);
-#endif
-
-// Set gpu rxn values
-#ifdef CAMP_USE_GPU
-  solver_set_rxn_data_gpu(&(sd->model_data));
+    // Set a function to improve guesses for y sent to the linear solver
+    flag = CVodeSetDlsGuessHelper(sd->cvode_mem, guess_helper);
+    check_flag_fail(&flag, "CVodeSetDlsGuessHelper", 1);
 #endif
+  }
 
 #ifndef FAILURE_DETAIL
   // Set a custom error handling function
   flag = CVodeSetErrHandlerFn(sd->cvode_mem, error_handler, (void *)sd);
   check_flag_fail(&flag, "CVodeSetErrHandlerFn", 0);
 #endif
+}
 
-#endif
+/** \brief Set up the SPGMR linear solver and its preconditioner
+ *
+ * The Jacobian-vector products are approximated by CVODE with difference
+ * quotients of f(), so the Jacobian is not assembled for them. The left
+ * preconditioner is the incomplete ILU(0) factorization of
+ * \f$I - \gamma J\f$ for each grid cell (see \c SUNBlockILU()), which
+ * costs less than the complete factorization of the direct linear solvers.
+ * The Jacobian is only re-evaluated when CVODE indicates that the saved one
+ * is out of date, so between Jacobian updates a preconditioner setup only
+ * refactors the blocks for the new \f$\gamma\f$.
+ *
+ * \param sd Pointer to the SolverData object with the integrator created
+ */
+void solver_initialize_spgmr(SolverData *sd) {
+  int flag;
+  int n_cells = sd->model_data.n_cells;
+
+  // Create the iterative linear solver
+  sd->ls = SUNSPGMR(sd->y, PREC_LEFT, SPGMR_MAX_KRYLOV_DIM);
+  check_flag_fail((void *)sd->ls, "SUNSPGMR", 0);
+  sd->ls_profiled = SUNProfiledLinSol(sd->ls, &(sd->profile));
+  check_flag_fail((void *)sd->ls_profiled, "SUNProfiledLinSol", 0);
+  flag = CVSpilsSetLinearSolver(sd->cvode_mem, sd->ls_profiled);
+  check_flag_fail(&flag, "CVSpilsSetLinearSolver", 1);
+
+  // Create the preconditioner matrix and block-diagonal ILU(0) solver
+  // (the saved Jacobian is kept in sd->J, which the integrator does not use
+  // with an iterative linear solver)
+  sd->P = SUNMatClone(sd->J);
+  SUNMatCopy(sd->J, sd->P);
+  sd->ls_tmp1 = N_VClone(sd->y);
+  sd->ls_tmp2 = N_VClone(sd->y);
+  sd->prec_ls = SUNBlockILU(sd->y, sd->P, n_cells);
+  check_flag_fail((void *)sd->prec_ls, "SUNBlockILU", 0);
+  flag = CVSpilsSetPreconditioner(sd->cvode_mem, Precond_setup, Precond_solve);
+  check_flag_fail(&flag, "CVSpilsSetPreconditioner", 1);
 }
 
-#ifdef CAMP_DEBUG
-/** \brief Set the flag indicating whether to output debugging information
+/** \brief Set up a Rosenbrock integrator for a SolverData object
  *
- * \param solver_data A pointer to the solver data
- * \param do_output Whether to output debugging information during solving
+ * The Rosenbrock integrators use the same f() and Jac() functions, Jacobian
+ * structure and direct linear solvers as CVODE, so they apply to single-
+ * and multi-cell systems and to batches of grid cells. The Jacobian and
+ * matrix factorization are updated once per step.
+ *
+ * \param sd Pointer to the SolverData object
+ * \param rel_tol Relative integration tolerance
+ * \param max_steps Maximum number of integration steps per call to the
+ *                  solver
  */
-int solver_set_debug_out(void *solver_data, bool do_output) {
-#ifdef CAMP_USE_SUNDIALS
-  SolverData *sd = (SolverData *)solver_data;
+void solver_initialize_rosenbrock(SolverData *sd, double rel_tol,
+                                  int max_steps) {
+  int method_id;
+
+  switch (sd->integrator) {
+    case CAMP_INTEGRATOR_ROS2:
+      method_id = ROS_METHOD_ROS2;
+      break;
+    case CAMP_INTEGRATOR_ROS3:
+      method_id = ROS_METHOD_ROS3;
+      break;
+    case CAMP_INTEGRATOR_RODAS3:
+      method_id = ROS_METHOD_RODAS3;
+      break;
+    case CAMP_INTEGRATOR_RODAS4:
+      method_id = ROS_METHOD_RODAS4;
+      break;
+    default:
+      printf("\n\nERROR Invalid integrator type: %d\n\n", sd->integrator);
+      exit(EXIT_FAILURE);
+  }
+  if (sd->linear_solver == CAMP_LINEAR_SOLVER_SPGMR) {
+    printf(
+        "\n\nERROR The Rosenbrock integrators require a direct linear "
+        "solver\n\n");
+    exit(EXIT_FAILURE);
+  }
 
-  sd->debug_out = do_output == true ? SUNTRUE : SUNFALSE;
-  return CAMP_SOLVER_SUCCESS;
-#else
-  return 0;
-#endif
+  solver_set_abs_tol_nv(sd);
+  solver_new_direct_linear_solver(sd);
+  sd->ros_mem =
+      rosenbrock_create(method_id, sd->y, sd->J, sd->ls_profiled, f, Jac, sd,
+                        rel_tol, sd->abs_tol_nv, max_steps);
+  check_flag_fail((void *)sd->ros_mem, "rosenbrock_create", 0);
 }
-#endif
 
-#ifdef CAMP_DEBUG
-/** \brief Set the flag indicating whether to evalute the Jacobian during
- **        solving
+/** \brief Set the absolute tolerance vector for the solver variables
  *
- * \param solver_data A pointer to the solver data
- * \param eval_Jac Flag indicating whether to evaluate the Jacobian during
- *                 solving
+ * \param sd Pointer to the SolverData object with the absolute tolerances
+ *           for each state variable set on the model data
  */
-int solver_set_eval_jac(void *solver_data, bool eval_Jac) {
-#ifdef CAMP_USE_SUNDIALS
-  SolverData *sd = (SolverData *)solver_data;
+void solver_set_abs_tol_nv(SolverData *sd) {
+  int n_dep_var = sd->model_data.n_per_cell_dep_var;
+  int n_cells = sd->model_data.n_cells;
+  int *var_state_id = sd->model_data.var_state_id;
+  double *abs_tol = sd->model_data.abs_tol;
 
-  sd->eval_Jac = eval_Jac == true ? SUNTRUE : SUNFALSE;
-  return CAMP_SOLVER_SUCCESS;
-#else
-  return 0;
-#endif
+  sd->abs_tol_nv = N_VNew_Serial(n_dep_var * n_cells);
+  for (int i_cell = 0; i_cell < n_cells; ++i_cell)
+    for (int i_dep_var = 0; i_dep_var < n_dep_var; ++i_dep_var)
+      NV_Ith_S(sd->abs_tol_nv, i_cell * n_dep_var + i_dep_var) =
+          (realtype)abs_tol[var_state_id[i_dep_var]];
 }
-#endif
 
-/** \brief Solve for a given timestep
+/** \brief Create the direct linear solver for a SolverData object
  *
- * \param solver_data A pointer to the initialized solver data
- * \param state A pointer to the full state array (all grid cells)
- * \param env A pointer to the full array of environmental conditions
- *            (all grid cells)
- * \param t_initial Initial time (s)
- * \param t_final (s)
- * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ * The block-diagonal Jacobian of multi-cell systems is solved block by
+ * block, with a single analysis of the per-cell sparsity pattern. The
+ * integrator is given \c sd->ls_profiled, while \c sd->ls remains
+ * available to reinitialize the solver.
+ *
+ * \param sd Pointer to the SolverData object with the Jacobian structure set
  */
-int solver_run(void *solver_data, double *state, double *env, double t_initial,
-               double t_final) {
-#ifdef CAMP_USE_SUNDIALS
-  SolverData *sd = (SolverData *)solver_data;
-  ModelData *md = &(sd->model_data);
-  int n_state_var = sd->model_data.n_per_cell_state_var;
+void solver_new_direct_linear_solver(SolverData *sd) {
   int n_cells = sd->model_data.n_cells;
-  int flag;
 
-  // Update the dependent variables
-  int i_dep_var = 0;
-  for (int i_cell = 0; i_cell < n_cells; i_cell++)
-    for (int i_spec = 0; i_spec < n_state_var; i_spec++)
-      if (sd->model_data.var_type[i_spec] == CHEM_SPEC_VARIABLE) {
-        NV_Ith_S(sd->y, i_dep_var++) =
-            state[i_spec + i_cell * n_state_var] > TINY
-                ? (realtype)state[i_spec + i_cell * n_state_var]
-                : TINY;
-      } else if (md->var_type[i_spec] == CHEM_SPEC_CONSTANT) {
-        state[i_spec + i_cell * n_state_var] =
-            state[i_spec + i_cell * n_state_var] > TINY
-                ? state[i_spec + i_cell * n_state_var]
-                : TINY;
-      }
+  if (n_cells > 1 && sd->linear_solver == CAMP_LINEAR_SOLVER_BLOCK_LU) {
+    sd->ls = SUNBlockLU(sd->y, sd->J, n_cells);
+    check_flag_fail((void *)sd->ls, "SUNBlockLU", 0);
+  } else if (n_cells > 1) {
+    sd->ls = SUNBlockKLU(sd->y, sd->J, n_cells);
+    check_flag_fail((void *)sd->ls, "SUNBlockKLU", 0);
+  } else {
+    sd->ls = SUNKLU(sd->y, sd->J);
+    check_flag_fail((void *)sd->ls, "SUNKLU", 0);
+  }
 
-  // Update model data pointers
-  sd->model_data.total_state = state;
-  sd->model_data.total_env = env;
+  // The integrator calls the linear solver through a wrapper that times
+  // its setups and solves
+  sd->ls_profiled = SUNProfiledLinSol(sd->ls, &(sd->profile));
+  check_flag_fail((void *)sd->ls_profiled, "SUNProfiledLinSol", 0);
+}
 
-#ifdef CAMP_DEBUG
-  // Update the debug output flag in CVODES and the linear solver
-  flag = CVodeSetDebugOut(sd->cvode_mem, sd->debug_out);
-  check_flag_fail(&flag, "CVodeSetDebugOut", 1);
-  flag = SUNKLUSetDebugOut(sd->ls, sd->debug_out);
-  check_flag_fail(&flag, "SUNKLUSetDebugOut", 1);
-#endif
+/** \brief Set up an independent solver for a batch of grid cells
+ *
+ * The batch shares the reaction, aerosol phase, aerosol representation and
+ * sub-model data of the parent solver, and points to the parent's
+ * environment-dependent data for its grid cells. It gets its own solver
+ * vectors, Jacobian matrices and working objects so that it can be
+ * integrated with its own step-size history and error test.
+ *
+ * \param sd Pointer to the parent SolverData with the Jacobian structure
+ *           already set up
+ * \param batch Pointer to the SolverData object to set up for the batch
+ * \param first_cell Index of the first grid cell in the batch
+ * \param n_cells Number of grid cells in the batch
+ */
+void solver_new_batch(SolverData *sd, SolverData *batch, int first_cell,
+                      int n_cells) {
+  ModelData *md = &(batch->model_data);
+  int n_dep_var = sd->model_data.n_per_cell_dep_var;
+  int n_dep_var_total = n_dep_var * n_cells;
 
-  // Reset the counter of Jacobian evaluation failures
-  sd->Jac_eval_fails = 0;
+  // Start from the parent solver data to share the model data and options
+  *batch = *sd;
+  batch->n_cells_per_batch = 0;
+  batch->n_batches = 0;
+  batch->batches = NULL;
+  batch->cell_groups = NULL;
+  batch->first_cell = first_cell;
+  batch->cvode_mem = NULL;
+  batch->ros_mem = NULL;
+  batch->cell_norm = NULL;
+  batch->y_last = NULL;
+  batch->h_last = ZERO;
+  batch->env_data_last = NULL;
+  batch->reuse_jac = false;
+  batch->abs_tol_nv = NULL;
+  batch->ls = NULL;
+  batch->ls_profiled = NULL;
+  batch->prec_ls = NULL;
+  batch->P = NULL;
+  batch->ls_tmp1 = NULL;
+  batch->ls_tmp2 = NULL;
+  batch->n_cell_views = 0;
+  batch->cell_views = NULL;
+
+  // Each batch accumulates its own timers
+  solver_profile_reset(&(batch->profile));
+  md->profile = &(batch->profile);
+
+  // Point to the environment-dependent data for the batch grid cells
+  // (in grouped order when the grid cells are grouped by stiffness)
+  CellGroups *groups = sd->cell_groups;
+  double *rxn_env_data =
+      groups != NULL ? groups->rxn_env_data : sd->model_data.rxn_env_data;
+  double *aero_rep_env_data = groups != NULL
+                                  ? groups->aero_rep_env_data
+                                  : sd->model_data.aero_rep_env_data;
+  double *sub_model_env_data = groups != NULL
+                                   ? groups->sub_model_env_data
+                                   : sd->model_data.sub_model_env_data;
+  md->n_cells = n_cells;
+  md->rxn_env_data = &(rxn_env_data[first_cell * md->n_rxn_env_data]);
+  md->aero_rep_env_data =
+      &(aero_rep_env_data[first_cell * md->n_aero_rep_env_data]);
+  md->sub_model_env_data =
+      &(sub_model_env_data[first_cell * md->n_sub_model_env_data]);
+  md->last_env = NULL;
+  batch->cell_stiffness =
+      groups != NULL ? &(groups->grouped_stiffness[first_cell]) : NULL;
+
+  // Batches integrated concurrently need private copies of the parameters
+  // that are modified during solving
+  if (sd->n_batch_threads > 1) {
+    md->rxn_float_data = solver_copy_float_data(
+        md->rxn_float_data, md->rxn_float_indices[md->n_rxn]);
+    md->aero_rep_float_data = solver_copy_float_data(
+        md->aero_rep_float_data, md->aero_rep_float_indices[md->n_aero_rep]);
+    md->sub_model_float_data = solver_copy_float_data(
+        md->sub_model_float_data, md->sub_model_float_indices[md->n_sub_model]);
+  }
 
-  // Update data for new environmental state
-  // (This is set up to assume the environmental variables do not change during
-  //  solving. This can be changed in the future if necessary.)
-  for (int i_cell = 0; i_cell < md->n_cells; ++i_cell) {
-    // Set the grid cell state pointers
-    md->grid_cell_id = i_cell;
-    md->grid_cell_state = &(md->total_state[i_cell * md->n_per_cell_state_var]);
-    md->grid_cell_env = &(md->total_env[i_cell * CAMP_NUM_ENV_PARAM_]);
-    md->grid_cell_rxn_env_data =
-        &(md->rxn_env_data[i_cell * md->n_rxn_env_data]);
-    md->grid_cell_aero_rep_env_data =
-        &(md->aero_rep_env_data[i_cell * md->n_aero_rep_env_data]);
-    md->grid_cell_sub_model_env_data =
-        &(md->sub_model_env_data[i_cell * md->n_sub_model_env_data]);
+  // Set up the solver variable array and helper derivative array
+  batch->y = N_VNew_Serial(n_dep_var_total);
+  batch->deriv = N_VNew_Serial(n_dep_var_total);
 
-    // Update the model for the current environmental state
-    aero_rep_update_env_state(md);
-    sub_model_update_env_state(md);
-    rxn_update_env_state(md);
+  // Set up the list of grid cells to integrate
+  batch->active_cells = (int *)malloc(n_cells * sizeof(int));
+  if (batch->active_cells == NULL) {
+    printf("\n\nERROR allocating space for active grid cells\n\n");
+    exit(EXIT_FAILURE);
+  }
+  solver_set_all_cells_active(batch);
+
+  // Each batch times its own grid cells. Error test failures are reported
+  // by grid cell through the parent solver.
+  batch->integrated = false;
+  batch->run_time = 0.0;
+  batch->cell_calc_time = (double *)calloc(n_cells, sizeof(double));
+  if (batch->cell_calc_time == NULL) {
+    printf("\n\nERROR allocating space for grid cell statistics\n\n");
+    exit(EXIT_FAILURE);
   }
+  batch->cell_fails_start = NULL;
+  batch->cell_fails_end = NULL;
 
-  CAMP_DEBUG_JAC_STRUCT(sd->model_data.J_init, "Begin solving");
+  // Set up working TimeDerivative and Jacobian objects for the batch
+  if (time_derivative_initialize(&(batch->time_deriv), n_dep_var) != 1) {
+    printf("\n\nERROR initializing the TimeDerivative for a batch\n\n");
+    exit(EXIT_FAILURE);
+  }
+  if (jacobian_initialize_copy(&(batch->jac), sd->jac) != 1) {
+    printf("\n\nERROR initializing the Jacobian for a batch\n\n");
+    exit(EXIT_FAILURE);
+  }
 
-  // Reset the flag indicating a current J_guess
-  sd->curr_J_guess = false;
+  // Copy the block-diagonal Jacobian structure for the batch grid cells
+  batch->J = get_jac_init_cells(sd->J, n_dep_var_total);
+  batch->J_guess = get_jac_init_cells(sd->J_guess, n_dep_var_total);
+  md->J_init = get_jac_init_cells(sd->model_data.J_init, n_dep_var_total);
+  md->J_solver = get_jac_init_cells(sd->model_data.J_solver, n_dep_var_total);
 
-  // Set the initial time step
-  sd->init_time_step = (t_final - t_initial) * DEFAULT_TIME_STEP;
+  // Create vectors to store Jacobian state and derivative data
+  md->J_state = N_VClone(batch->y);
+  md->J_deriv = N_VClone(batch->y);
+  md->J_tmp = N_VClone(batch->y);
+  md->J_tmp2 = N_VClone(batch->y);
+  N_VConst(0.0, md->J_state);
+  N_VConst(0.0, md->J_deriv);
+}
 
-  // Check whether there is anything to solve (filters empty air masses with no
-  // emissions)
-  if (is_anything_going_on_here(sd, t_initial, t_final) == false)
-    return CAMP_SOLVER_SUCCESS;
+/** \brief Create the grouping of grid cells into batches by stiffness
+ *
+ * The grid cells start in the host order, as no stiffness estimates are
+ * available before the first call to the solver.
+ *
+ * \param sd Pointer to the SolverData with the model data set up
+ * \return New grouping of the grid cells
+ */
+CellGroups *solver_new_cell_groups(SolverData *sd) {
+  ModelData *md = &(sd->model_data);
+  int n_cells = md->n_cells;
+  CellGroups *groups = (CellGroups *)malloc(sizeof(CellGroups));
 
-  // Reinitialize the solver
-  flag = CVodeReInit(sd->cvode_mem, t_initial, sd->y);
-  check_flag_fail(&flag, "CVodeReInit", 1);
+  if (groups == NULL) {
+    printf("\n\nERROR allocating space for the grid cell groups\n\n");
+    exit(EXIT_FAILURE);
+  }
+  groups->cell_order = (int *)malloc(n_cells * sizeof(int));
+  groups->stiffness = (double *)calloc(n_cells, sizeof(double));
+  groups->grouped_stiffness = (double *)calloc(n_cells, sizeof(double));
+  groups->sorted = (CellStiffness *)malloc(n_cells * sizeof(CellStiffness));
+  groups->state =
+      (double *)malloc(n_cells * md->n_per_cell_state_var * sizeof(double));
+  groups->env =
+      (double *)malloc(n_cells * CAMP_NUM_ENV_PARAM_ * sizeof(double));
+  groups->rxn_env_data =
+      (double *)calloc(n_cells * md->n_rxn_env_data + 1, sizeof(double));
+  groups->aero_rep_env_data =
+      (double *)calloc(n_cells * md->n_aero_rep_env_data + 1, sizeof(double));
+  groups->sub_model_env_data = (double *)calloc(
+      n_cells * md->n_sub_model_env_data + 1, sizeof(double));
+  if (groups->cell_order == NULL || groups->stiffness == NULL ||
+      groups->grouped_stiffness == NULL || groups->sorted == NULL ||
+      groups->state == NULL || groups->env == NULL ||
+      groups->rxn_env_data == NULL || groups->aero_rep_env_data == NULL ||
+      groups->sub_model_env_data == NULL) {
+    printf("\n\nERROR allocating space for the grid cell groups\n\n");
+    exit(EXIT_FAILURE);
+  }
+  for (int i_cell = 0; i_cell < n_cells; ++i_cell)
+    groups->cell_order[i_cell] = i_cell;
+  return groups;
+}
 
-  // Reinitialize the linear solver
-  flag = SUNKLUReInit(sd->ls, sd->J, SM_NNZ_S(sd->J), SUNKLU_REINIT_PARTIAL);
-  check_flag_fail(&flag, "SUNKLUReInit", 1);
+/** \brief Order grid cells by decreasing stiffness
+ *
+ * Grid cells with the same stiffness estimate stay in the host order.
+ */
+static int solver_compare_cell_stiffness(const void *a, const void *b) {
+  const CellStiffness *cell_a = (const CellStiffness *)a;
+  const CellStiffness *cell_b = (const CellStiffness *)b;
 
-  // Set the inital time step
-  flag = CVodeSetInitStep(sd->cvode_mem, sd->init_time_step);
-  check_flag_fail(&flag, "CVodeSetInitStep", 1);
+  if (cell_a->stiffness > cell_b->stiffness) return -1;
+  if (cell_a->stiffness < cell_b->stiffness) return 1;
+  return cell_a->cell_id - cell_b->cell_id;
+}
 
-  // Run the solver
-  realtype t_rt = (realtype)t_initial;
-  if (!sd->no_solve) {
-    flag = CVode(sd->cvode_mem, (realtype)t_final, sd->y, &t_rt, CV_NORMAL);
-    sd->solver_flag = flag;
-#ifndef FAILURE_DETAIL
-    if (flag < 0) {
-#else
-    if (check_flag(&flag, "CVode", 1) == CAMP_SOLVER_FAIL) {
-      if (flag == -6) {
-        long int lsflag;
-        int lastflag = CVDlsGetLastFlag(sd->cvode_mem, &lsflag);
-        printf("\nLinear Solver Setup Fail: %d %ld", lastflag, lsflag);
+/** \brief Group the grid cells by stiffness and copy their data to the
+ *         grouped arrays
+ *
+ * The grid cells are sorted by the stiffness estimates from the last call to
+ * the solver, so consecutive batches get grid cells with similar stiffness.
+ *
+ * \param sd Pointer to the SolverData with the grid cell groups
+ * \param state Pointer to the state array (all grid cells)
+ * \param env Pointer to the environmental state array (all grid cells)
+ */
+void solver_group_cells(SolverData *sd, double *state, double *env) {
+  ModelData *md = &(sd->model_data);
+  CellGroups *groups = sd->cell_groups;
+  int n_cells = md->n_cells;
+  int n_state_var = md->n_per_cell_state_var;
+
+  for (int i_cell = 0; i_cell < n_cells; ++i_cell) {
+    groups->sorted[i_cell].stiffness = groups->stiffness[i_cell];
+    groups->sorted[i_cell].cell_id = i_cell;
+  }
+  qsort(groups->sorted, n_cells, sizeof(CellStiffness),
+        solver_compare_cell_stiffness);
+
+  for (int i_pos = 0; i_pos < n_cells; ++i_pos) {
+    int i_cell = groups->sorted[i_pos].cell_id;
+    groups->cell_order[i_pos] = i_cell;
+    groups->grouped_stiffness[i_pos] = groups->stiffness[i_cell];
+    memcpy(&(groups->state[i_pos * n_state_var]),
+           &(state[i_cell * n_state_var]), n_state_var * sizeof(double));
+    memcpy(&(groups->env[i_pos * CAMP_NUM_ENV_PARAM_]),
+           &(env[i_cell * CAMP_NUM_ENV_PARAM_]),
+           CAMP_NUM_ENV_PARAM_ * sizeof(double));
+    memcpy(&(groups->rxn_env_data[i_pos * md->n_rxn_env_data]),
+           &(md->rxn_env_data[i_cell * md->n_rxn_env_data]),
+           md->n_rxn_env_data * sizeof(double));
+    memcpy(&(groups->aero_rep_env_data[i_pos * md->n_aero_rep_env_data]),
+           &(md->aero_rep_env_data[i_cell * md->n_aero_rep_env_data]),
+           md->n_aero_rep_env_data * sizeof(double));
+    memcpy(&(groups->sub_model_env_data[i_pos * md->n_sub_model_env_data]),
+           &(md->sub_model_env_data[i_cell * md->n_sub_model_env_data]),
+           md->n_sub_model_env_data * sizeof(double));
+  }
+}
+
+/** \brief Copy the results of the batches from the grouped arrays back to
+ *         the host order
+ *
+ * The new state, the environment-dependent data (which includes data set
+ * with the update functions) and the stiffness estimates of each grid cell
+ * are copied back.
+ *
+ * \param sd Pointer to the SolverData with the grid cell groups
+ * \param state Pointer to the state array (all grid cells)
+ */
+void solver_ungroup_cells(SolverData *sd, double *state) {
+  ModelData *md = &(sd->model_data);
+  CellGroups *groups = sd->cell_groups;
+  int n_state_var = md->n_per_cell_state_var;
+
+  for (int i_pos = 0; i_pos < md->n_cells; ++i_pos) {
+    int i_cell = groups->cell_order[i_pos];
+    groups->stiffness[i_cell] = groups->grouped_stiffness[i_pos];
+    memcpy(&(state[i_cell * n_state_var]),
+           &(groups->state[i_pos * n_state_var]), n_state_var * sizeof(double));
+    memcpy(&(md->rxn_env_data[i_cell * md->n_rxn_env_data]),
+           &(groups->rxn_env_data[i_pos * md->n_rxn_env_data]),
+           md->n_rxn_env_data * sizeof(double));
+    memcpy(&(md->aero_rep_env_data[i_cell * md->n_aero_rep_env_data]),
+           &(groups->aero_rep_env_data[i_pos * md->n_aero_rep_env_data]),
+           md->n_aero_rep_env_data * sizeof(double));
+    memcpy(&(md->sub_model_env_data[i_cell * md->n_sub_model_env_data]),
+           &(groups->sub_model_env_data[i_pos * md->n_sub_model_env_data]),
+           md->n_sub_model_env_data * sizeof(double));
+  }
+}
+
+/** \brief Free the grouping of grid cells
+ *
+ * \param groups Grid cell groups to free
+ */
+void solver_free_cell_groups(CellGroups *groups) {
+  if (groups == NULL) return;
+  free(groups->cell_order);
+  free(groups->stiffness);
+  free(groups->grouped_stiffness);
+  free(groups->sorted);
+  free(groups->state);
+  free(groups->env);
+  free(groups->rxn_env_data);
+  free(groups->aero_rep_env_data);
+  free(groups->sub_model_env_data);
+  free(groups);
+}
+
+/** \brief Set up the grid cell views used in the f() and Jac() grid cell loops
+ *
+ * One view is created for each OpenMP thread, up to the number of grid cells.
+ * A single view shares the parameter arrays of the model data. With more than
+ * one view, each view gets private copies of the reaction, aerosol
+ * representation and sub model floating-point parameters, which some
+ * reactions and sub models use to store intermediate values during solving.
+ *
+ * \param sd Pointer to the SolverData with the Jacobian structure already set
+ *           up
+ */
+void solver_initialize_cell_views(SolverData *sd) {
+  ModelData *md = &(sd->model_data);
+  int n_views = 1;
+
+  // The debugging counters and timers are not thread safe, so the grid cell
+  // loops are run serially in debug builds
+#if defined(CAMP_USE_OPENMP) && !defined(CAMP_DEBUG) && !defined(CAMP_USE_GPU)
+  n_views = omp_get_max_threads();
+  if (n_views > md->n_cells) n_views = md->n_cells;
+  if (n_views < 1) n_views = 1;
+
+  // Batches integrated concurrently each run on a single thread
+  if (sd->n_batch_threads > 1) n_views = 1;
+#endif
+
+  // Chunks are limited to the grid cells of the solver instance
+  if (sd->n_cells_per_chunk > md->n_cells)
+    sd->n_cells_per_chunk = md->n_cells;
+  if (sd->n_cells_per_chunk < 2) sd->n_cells_per_chunk = 0;
+
+  sd->n_cell_views = n_views;
+  sd->cell_views = (GridCellView *)malloc(n_views * sizeof(GridCellView));
+  if (sd->cell_views == NULL) {
+    printf("\n\nERROR allocating space for grid cell views\n\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (int i_view = 0; i_view < n_views; ++i_view) {
+    GridCellView *view = &(sd->cell_views[i_view]);
+    ModelData *view_md = &(view->model_data);
+
+    // Start from the model data to share the model parameters
+    *view_md = *md;
+
+    // Each thread accumulates its timers on its own view
+    memset(&(view->profile), 0, sizeof(SolverProfile));
+    view->profile.enabled = sd->profile.enabled;
+    view_md->profile = &(view->profile);
+
+    // Set up working Jacobian matrices and objects for the view
+    view_md->J_rxn = SUNMatClone(md->J_rxn);
+    SUNMatCopy(md->J_rxn, view_md->J_rxn);
+    view_md->J_params = SUNMatClone(md->J_params);
+    SUNMatCopy(md->J_params, view_md->J_params);
+    if (time_derivative_initialize(&(view->time_deriv),
+                                   md->n_per_cell_dep_var) != 1) {
+      printf(
+          "\n\nERROR initializing the TimeDerivative for a grid cell "
+          "view\n\n");
+      exit(EXIT_FAILURE);
+    }
+    if (jacobian_initialize_copy(&(view->jac), sd->jac) != 1) {
+      printf("\n\nERROR initializing the Jacobian for a grid cell view\n\n");
+      exit(EXIT_FAILURE);
+    }
+
+    // Set up the species-major arrays for chunks of grid cells
+    view->chunk_state = NULL;
+    view->chunk_rxn_env_data = NULL;
+    if (sd->n_cells_per_chunk > 0) {
+      int n_chunk = sd->n_cells_per_chunk;
+      view->chunk_state = (double *)malloc(
+          (size_t)n_chunk * md->n_per_cell_state_var * sizeof(double));
+      view->chunk_rxn_env_data = (double *)malloc(
+          (size_t)n_chunk * (md->n_rxn_env_data > 0 ? md->n_rxn_env_data : 1) *
+          sizeof(double));
+      if (view->chunk_state == NULL || view->chunk_rxn_env_data == NULL ||
+          time_derivative_initialize(&(view->chunk_deriv),
+                                     n_chunk * md->n_per_cell_dep_var) != 1) {
+        printf("\n\nERROR allocating space for grid cell chunks\n\n");
+        exit(EXIT_FAILURE);
+      }
+    }
+
+    // Set up private copies of parameters that are modified during solving
+    if (n_views > 1) {
+      view_md->rxn_float_data = solver_copy_float_data(
+          md->rxn_float_data, md->rxn_float_indices[md->n_rxn]);
+      view_md->aero_rep_float_data = solver_copy_float_data(
+          md->aero_rep_float_data, md->aero_rep_float_indices[md->n_aero_rep]);
+      view_md->sub_model_float_data = solver_copy_float_data(
+          md->sub_model_float_data,
+          md->sub_model_float_indices[md->n_sub_model]);
+    }
+  }
+}
+
+/** \brief Allocate a copy of a floating-point parameter array
+ *
+ * \param data Array to copy
+ * \param n_data Number of elements in the array
+ * \return Pointer to the new array
+ */
+double *solver_copy_float_data(double *data, int n_data) {
+  double *copy = (double *)malloc((n_data > 0 ? n_data : 1) * sizeof(double));
+  if (copy == NULL) {
+    printf("\n\nERROR allocating space for grid cell view parameters\n\n");
+    exit(EXIT_FAILURE);
+  }
+  memcpy(copy, data, n_data * sizeof(double));
+  return copy;
+}
+
+/** \brief Update the environment-dependent data of grid cells whose
+ *         environmental state has changed
+ *
+ * The aerosol representation, sub model and reaction parameters of a grid
+ * cell that depend on temperature and pressure (e.g., rate constants) are
+ * only recalculated when the environmental state of the grid cell differs
+ * from that of their last calculation, or when the data of the grid cell
+ * were changed with an update function since then. The total state and
+ * environmental state pointers must be set. Does nothing for batch solvers,
+ * whose data are updated by the parent solver.
+ *
+ * \param sd Pointer to the SolverData
+ */
+void solver_update_env_state(SolverData *sd) {
+  ModelData *md = &(sd->model_data);
+
+  if (md->last_env == NULL) return;
+  double profile_start = solver_profile_start(&(sd->profile));
+
+  // Changed grid cells whose tabulated reaction parameters are interpolated
+  // and whose rate constants are evaluated in batches
+  RateTable *table = md->rate_table;
+  RxnEnvBatch *batch = md->rxn_env_batch;
+  int n_table_cells = 0, n_batch_cells = 0;
+
+  for (int i_cell = 0; i_cell < md->n_cells; ++i_cell) {
+    double *cell_env = &(md->total_env[i_cell * CAMP_NUM_ENV_PARAM_]);
+    double *last_env = &(md->last_env[i_cell * CAMP_NUM_ENV_PARAM_]);
+
+    // Skip grid cells whose data are up to date (NAN never compares equal)
+    bool changed = false;
+    for (int i_param = 0; i_param < CAMP_NUM_ENV_PARAM_; ++i_param)
+      if (cell_env[i_param] != last_env[i_param]) changed = true;
+    if (!changed) continue;
+
+    // Set the grid cell state pointers
+    md->grid_cell_id = i_cell;
+    md->grid_cell_state = &(md->total_state[i_cell * md->n_per_cell_state_var]);
+    md->grid_cell_env = cell_env;
+    md->grid_cell_rxn_env_data =
+        &(md->rxn_env_data[i_cell * md->n_rxn_env_data]);
+    md->grid_cell_aero_rep_env_data =
+        &(md->aero_rep_env_data[i_cell * md->n_aero_rep_env_data]);
+    md->grid_cell_sub_model_env_data =
+        &(md->sub_model_env_data[i_cell * md->n_sub_model_env_data]);
+
+    // Update the model for the current environmental state
+    aero_rep_update_env_state(md);
+    sub_model_update_env_state(md);
+    rxn_update_env_state(md);
+    if (table != NULL && rate_table_covers(table, cell_env))
+      table->cell_ids[n_table_cells++] = i_cell;
+    else if (batch != NULL)
+      batch->cell_ids[n_batch_cells++] = i_cell;
+
+    memcpy(last_env, cell_env, CAMP_NUM_ENV_PARAM_ * sizeof(double));
+  }
+
+  if (n_table_cells > 0) {
+    rate_table_update_cells(table, md, table->cell_ids, n_table_cells);
+    if (batch != NULL)
+      rxn_env_batch_update_cells(batch, md, table->cell_ids, n_table_cells,
+                                 true);
+  }
+  if (n_batch_cells > 0)
+    rxn_env_batch_update_cells(batch, md, batch->cell_ids, n_batch_cells,
+                               false);
+
+  solver_profile_stop(&(sd->profile), CAMP_PROFILE_ENV_UPDATE, profile_start);
+}
+
+/** \brief Update the private parameters of the grid cell views
+ *
+ * Must be called after any change to the model parameters (e.g., from
+ * updates to reaction, aerosol representation or sub model data) and before
+ * the grid cell views are used.
+ *
+ * \param sd Pointer to the SolverData
+ */
+void solver_update_cell_views(SolverData *sd) {
+  ModelData *md = &(sd->model_data);
+
+  if (sd->n_cell_views < 2) return;
+  for (int i_view = 0; i_view < sd->n_cell_views; ++i_view) {
+    ModelData *view_md = &(sd->cell_views[i_view].model_data);
+    memcpy(view_md->rxn_float_data, md->rxn_float_data,
+           md->rxn_float_indices[md->n_rxn] * sizeof(double));
+    memcpy(view_md->aero_rep_float_data, md->aero_rep_float_data,
+           md->aero_rep_float_indices[md->n_aero_rep] * sizeof(double));
+    memcpy(view_md->sub_model_float_data, md->sub_model_float_data,
+           md->sub_model_float_indices[md->n_sub_model] * sizeof(double));
+  }
+}
+
+/** \brief Update the private parameters of a batch integrated concurrently
+ *         with other batches
+ *
+ * \param sd Pointer to the parent SolverData
+ * \param batch Pointer to the SolverData of the batch
+ */
+void solver_update_batch_params(SolverData *sd, SolverData *batch) {
+  ModelData *md = &(sd->model_data);
+  ModelData *batch_md = &(batch->model_data);
+
+  memcpy(batch_md->rxn_float_data, md->rxn_float_data,
+         md->rxn_float_indices[md->n_rxn] * sizeof(double));
+  memcpy(batch_md->aero_rep_float_data, md->aero_rep_float_data,
+         md->aero_rep_float_indices[md->n_aero_rep] * sizeof(double));
+  memcpy(batch_md->sub_model_float_data, md->sub_model_float_data,
+         md->sub_model_float_indices[md->n_sub_model] * sizeof(double));
+}
+
+/** \brief Get the grid cell view for the current thread set up for a given
+ *         grid cell
+ *
+ * The view is selected by the OpenMP thread number, so this may only be
+ * called outside parallel regions or from the grid cell loops, whose teams
+ * have at most \c n_cell_views threads. Code that runs elsewhere (e.g., on
+ * a batch thread) must pass a view to \c solver_set_cell_view() instead.
+ *
+ * \param sd Pointer to the SolverData
+ * \param i_cell Index of the grid cell
+ * \return Pointer to the grid cell view
+ */
+GridCellView *solver_get_cell_view(SolverData *sd, int i_cell) {
+#ifdef CAMP_USE_OPENMP
+  int i_view = omp_get_thread_num();
+  if (i_view >= sd->n_cell_views) {
+    printf("\n\nERROR No grid cell view for thread %d (%d views)\n\n",
+           i_view, sd->n_cell_views);
+    exit(EXIT_FAILURE);
+  }
+  GridCellView *view = &(sd->cell_views[i_view]);
+#else
+  GridCellView *view = sd->cell_views;
+#endif
+  return solver_set_cell_view(sd, view, i_cell);
+}
+
+/** \brief Set up a grid cell view for a given grid cell
+ *
+ * \param sd Pointer to the SolverData
+ * \param view Pointer to the grid cell view
+ * \param i_cell Index of the grid cell
+ * \return Pointer to the grid cell view
+ */
+GridCellView *solver_set_cell_view(SolverData *sd, GridCellView *view,
+                                   int i_cell) {
+  ModelData *md = &(sd->model_data);
+  ModelData *cell_md = &(view->model_data);
+
+  // Set the grid cell state pointers
+  cell_md->rxn_kernel = md->rxn_kernel;
+  cell_md->grid_cell_id = i_cell;
+  cell_md->total_state = md->total_state;
+  cell_md->total_env = md->total_env;
+  cell_md->grid_cell_state =
+      &(md->total_state[i_cell * md->n_per_cell_state_var]);
+  cell_md->grid_cell_env = &(md->total_env[i_cell * CAMP_NUM_ENV_PARAM_]);
+  cell_md->grid_cell_rxn_env_data =
+      &(md->rxn_env_data[i_cell * md->n_rxn_env_data]);
+  cell_md->grid_cell_aero_rep_env_data =
+      &(md->aero_rep_env_data[i_cell * md->n_aero_rep_env_data]);
+  cell_md->grid_cell_sub_model_env_data =
+      &(md->sub_model_env_data[i_cell * md->n_sub_model_env_data]);
+
+  return view;
+}
+
+/** \brief Free the grid cell views
+ *
+ * \param sd Pointer to the SolverData
+ */
+void solver_free_cell_views(SolverData *sd) {
+  for (int i_view = 0; i_view < sd->n_cell_views; ++i_view) {
+    GridCellView *view = &(sd->cell_views[i_view]);
+    SUNMatDestroy(view->model_data.J_rxn);
+    SUNMatDestroy(view->model_data.J_params);
+    time_derivative_free(view->time_deriv);
+    jacobian_free(&(view->jac));
+    free(view->chunk_state);
+    free(view->chunk_rxn_env_data);
+    if (sd->n_cells_per_chunk > 0) time_derivative_free(view->chunk_deriv);
+    if (sd->n_cell_views > 1) {
+      free(view->model_data.rxn_float_data);
+      free(view->model_data.aero_rep_float_data);
+      free(view->model_data.sub_model_float_data);
+    }
+  }
+  free(sd->cell_views);
+  sd->cell_views = NULL;
+  sd->n_cell_views = 0;
+}
+#endif
+
+#ifdef CAMP_DEBUG
+/** \brief Set the flag indicating whether to output debugging information
+ *
+ * \param solver_data A pointer to the solver data
+ * \param do_output Whether to output debugging information during solving
+ */
+int solver_set_debug_out(void *solver_data, bool do_output) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  sd->debug_out = do_output == true ? SUNTRUE : SUNFALSE;
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return 0;
+#endif
+}
+#endif
+
+#ifdef CAMP_DEBUG
+/** \brief Set the flag indicating whether to evalute the Jacobian during
+ **        solving
+ *
+ * \param solver_data A pointer to the solver data
+ * \param eval_Jac Flag indicating whether to evaluate the Jacobian during
+ *                 solving
+ */
+int solver_set_eval_jac(void *solver_data, bool eval_Jac) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  sd->eval_Jac = eval_Jac == true ? SUNTRUE : SUNFALSE;
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return 0;
+#endif
+}
+#endif
+
+/** \brief Set the flag indicating whether to profile the solver
+ *
+ * While enabled, the wall time and number of calls of the solver phases
+ * (CAMP_PROFILE_*) and the time spent in the time derivative contributions
+ * of each reaction type are accumulated until the timers are reset with
+ * \c solver_reset_timers(). The results are returned by
+ * \c solver_get_statistics(). Can be called at any time.
+ *
+ * \param solver_data A pointer to the solver data
+ * \param enabled Flag indicating whether to profile the solver
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_set_profiling(void *solver_data, bool enabled) {
+  SolverData *sd = (SolverData *)solver_data;
+
+  sd->profile.enabled = enabled;
+#ifdef CAMP_USE_SUNDIALS
+  for (int i_view = 0; i_view < sd->n_cell_views; ++i_view)
+    sd->cell_views[i_view].profile.enabled = enabled;
+  for (int i_batch = 0; i_batch < sd->n_batches; ++i_batch)
+    solver_set_profiling(&(sd->batches[i_batch]), enabled);
+#endif
+  return CAMP_SOLVER_SUCCESS;
+}
+
+#ifdef CAMP_USE_SUNDIALS
+/** \brief Integrate the grid cells of a solver over a given timestep
+ *
+ * Arguments and return value are the same as for \c solver_run()
+ */
+static int solver_integrate(void *solver_data, double *state, double *env,
+                            double t_initial, double t_final) {
+  SolverData *sd = (SolverData *)solver_data;
+  ModelData *md = &(sd->model_data);
+  int n_state_var = sd->model_data.n_per_cell_state_var;
+  int n_cells = sd->model_data.n_cells;
+  int flag;
+
+  // Integrate each batch of grid cells with its own solver
+  sd->integrated = false;
+  if (sd->n_batches > 0)
+    return solver_run_batches(sd, state, env, t_initial, t_final);
+
+  // Reset the grid cell timers
+  for (int i_cell = 0; i_cell < n_cells; ++i_cell)
+    sd->cell_calc_time[i_cell] = 0.0;
+
+  // Update the dependent variables
+  int n_dep_var = md->n_per_cell_dep_var;
+  int *var_state_id = md->var_state_id;
+  for (int i_cell = 0; i_cell < n_cells; i_cell++) {
+    double *cell_state = &(state[i_cell * n_state_var]);
+    realtype *cell_y = &(NV_Ith_S(sd->y, i_cell * n_dep_var));
+    for (int i_dep_var = 0; i_dep_var < n_dep_var; i_dep_var++)
+      cell_y[i_dep_var] = cell_state[var_state_id[i_dep_var]] > TINY
+                              ? (realtype)cell_state[var_state_id[i_dep_var]]
+                              : TINY;
+    for (int i_spec = 0; i_spec < n_state_var; i_spec++)
+      if (md->var_type[i_spec] == CHEM_SPEC_CONSTANT)
+        cell_state[i_spec] = cell_state[i_spec] > TINY ? cell_state[i_spec]
+                                                       : TINY;
+  }
+
+  // Update model data pointers
+  sd->model_data.total_state = state;
+  sd->model_data.total_env = env;
+
+#ifdef CAMP_DEBUG
+  // Update the debug output flag in CVODES and the linear solver
+  if (sd->cvode_mem != NULL) {
+    flag = CVodeSetDebugOut(sd->cvode_mem, sd->debug_out);
+    check_flag_fail(&flag, "CVodeSetDebugOut", 1);
+  }
+  if (n_cells == 1 && sd->linear_solver != CAMP_LINEAR_SOLVER_SPGMR) {
+    flag = SUNKLUSetDebugOut(sd->ls, sd->debug_out);
+    check_flag_fail(&flag, "SUNKLUSetDebugOut", 1);
+  }
+#endif
+
+  // Reset the counter of Jacobian evaluation failures
+  sd->Jac_eval_fails = 0;
+
+  // Update data for new environmental state
+  // (This is set up to assume the environmental variables do not change during
+  //  solving. This can be changed in the future if necessary.)
+  solver_update_env_state(sd);
+
+  // Update the parameters used by the grid cell views
+  solver_update_cell_views(sd);
+
+  CAMP_DEBUG_JAC_STRUCT(sd->model_data.J_init, "Begin solving");
+
+  // Reset the flag indicating a current J_guess
+  sd->curr_J_guess = false;
+
+  // Check whether the integrator state of the last call can be reused, and
+  // whether its last Jacobian still applies
+  bool warm_start = solver_can_warm_start(sd);
+  sd->reuse_jac = warm_start && solver_env_data_unchanged(sd);
+
+  // Set the initial time step
+  sd->init_time_step = (t_final - t_initial) * DEFAULT_TIME_STEP;
+  if (warm_start && sd->h_last < sd->init_time_step)
+    sd->init_time_step = sd->h_last;
+
+  // Check whether there is anything to solve (filters empty air masses with no
+  // emissions)
+  if (is_anything_going_on_here(sd, t_initial, t_final) == false)
+    return CAMP_SOLVER_SUCCESS;
+  sd->integrated = !sd->no_solve;
+
+  // Only reuse the last Jacobian when all the grid cells are integrated, as
+  // they were in the last call
+  if (sd->n_active_cells < n_cells) sd->reuse_jac = false;
+
+  // Reinitialize the solver (the Rosenbrock integrators keep no state
+  // between calls)
+  if (sd->ros_mem == NULL) {
+    flag = CVodeReInit(sd->cvode_mem, t_initial, sd->y);
+    check_flag_fail(&flag, "CVodeReInit", 1);
+    if (sd->cell_norm != NULL) sd->cell_norm->n_fails_counted = 0;
+  }
+
+  // Reinitialize the linear solver (the block LU solver keeps no state
+  // between setups). On warm starts the symbolic analysis and pivot order
+  // of the last factorization are kept for the refactorizations.
+  if (!warm_start) {
+    if (sd->linear_solver == CAMP_LINEAR_SOLVER_SPGMR) {
+      flag = SUNLinSolInitialize_BlockLU(sd->prec_ls);
+      check_flag_fail(&flag, "SUNLinSolInitialize_BlockLU", 1);
+    } else if (n_cells > 1 &&
+               sd->linear_solver == CAMP_LINEAR_SOLVER_BLOCK_LU) {
+      flag = SUNLinSolInitialize_BlockLU(sd->ls);
+      check_flag_fail(&flag, "SUNLinSolInitialize_BlockLU", 1);
+    } else if (n_cells > 1) {
+      flag = SUNBlockKLUReInit(sd->ls);
+      check_flag_fail(&flag, "SUNBlockKLUReInit", 1);
+    } else {
+      flag = SUNKLUReInit(sd->ls, sd->J, SM_NNZ_S(sd->J),
+                          SUNKLU_REINIT_PARTIAL);
+      check_flag_fail(&flag, "SUNKLUReInit", 1);
+    }
+  }
+
+  // Set the inital time step
+  if (sd->ros_mem == NULL) {
+    flag = CVodeSetInitStep(sd->cvode_mem, sd->init_time_step);
+    check_flag_fail(&flag, "CVodeSetInitStep", 1);
+  }
+
+  // Run the solver
+  realtype t_rt = (realtype)t_initial;
+  if (!sd->no_solve) {
+    if (sd->ros_mem != NULL) {
+      flag = rosenbrock_integrate(sd->ros_mem, (realtype)t_initial,
+                                  (realtype)t_final, sd->init_time_step,
+                                  sd->y);
+    } else {
+      flag = CVode(sd->cvode_mem, (realtype)t_final, sd->y, &t_rt, CV_NORMAL);
+    }
+    sd->solver_flag = flag;
+
+    // Attribute the steps rejected at the end of the integration
+    if (sd->cell_norm != NULL) solver_count_cell_error_test_fails(sd);
+
+    // Save the integrator state for a warm start of the next call
+    if (flag < 0) {
+      sd->h_last = ZERO;
+    } else {
+      solver_save_warm_start(sd);
+    }
+#ifndef FAILURE_DETAIL
+    if (flag < 0) {
+#else
+    if (check_flag(&flag,
+                   sd->ros_mem != NULL ? "rosenbrock_integrate" : "CVode",
+                   1) == CAMP_SOLVER_FAIL) {
+      if (sd->ros_mem == NULL && flag == -6) {
+        long int lsflag;
+        int lastflag = CVDlsGetLastFlag(sd->cvode_mem, &lsflag);
+        printf("\nLinear Solver Setup Fail: %d %ld", lastflag, lsflag);
       }
       N_Vector deriv = N_VClone(sd->y);
       flag = f(t_initial, sd->y, deriv, sd);
       if (flag != 0)
         printf("\nCall to f() at failed state failed with flag %d\n", flag);
       for (int i_cell = 0; i_cell < md->n_cells; ++i_cell) {
-        printf("\n Cell: %d ", i_cell);
+        printf("\n Cell: %d ", sd->first_cell + i_cell);
         printf("temp = %le pressure = %le\n", env[i_cell * CAMP_NUM_ENV_PARAM_],
                env[i_cell * CAMP_NUM_ENV_PARAM_ + 1]);
         for (int i_spec = 0, i_dep_var = 0; i_spec < md->n_per_cell_state_var;
@@ -662,30 +1665,770 @@ int solver_run(void *solver_data, double *state, double *env, double t_initial,
                    state[i_cell * md->n_per_cell_state_var + i_spec]);
           }
       }
-      solver_print_stats(sd->cvode_mem);
+      if (sd->ros_mem == NULL) solver_print_stats(sd->cvode_mem);
+      if (sd->cell_norm != NULL) {
+        printf("\nError test failures by grid cell:");
+        for (int i_cell = 0; i_cell < md->n_cells; ++i_cell)
+          if (sd->cell_norm->n_err_test_fails[i_cell] > 0)
+            printf("\n Cell: %d fails = %ld", sd->first_cell + i_cell,
+                   sd->cell_norm->n_err_test_fails[i_cell]);
+        printf("\n Last cell with the largest error: %d\n",
+               sd->first_cell + sd->cell_norm->last_worst_cell);
+      }
+#endif
+      return CAMP_SOLVER_FAIL;
+    }
+  }
+
+  // Update the species concentrations on the state array
+  for (int i_cell = 0; i_cell < n_cells; i_cell++) {
+    double *cell_state = &(state[i_cell * n_state_var]);
+    realtype *cell_y = &(NV_Ith_S(sd->y, i_cell * n_dep_var));
+    for (int i_dep_var = 0; i_dep_var < n_dep_var; i_dep_var++)
+      cell_state[var_state_id[i_dep_var]] =
+          (double)(cell_y[i_dep_var] > 0.0 ? cell_y[i_dep_var] : 0.0);
+  }
+
+  // Re-run the pre-derivative calculations to update equilibrium species
+  // and apply adjustments to final state. The grid cell pointers are set
+  // for the state array of this call, independently of the environmental
+  // state updates, which skip unchanged grid cells and are done by the
+  // parent solver for batches. This runs outside the parallel grid cell
+  // loops (and possibly on a batch thread), so the first view is used.
+  for (int i_cell = 0; i_cell < n_cells; i_cell++) {
+    GridCellView *view =
+        solver_set_cell_view(sd, &(sd->cell_views[0]), i_cell);
+    aero_rep_update_state(&(view->model_data));
+    sub_model_calculate(&(view->model_data));
+  }
+
+  return CAMP_SOLVER_SUCCESS;
+}
+#endif
+
+/** \brief Solve for a given timestep
+ *
+ * The wall time of each call is kept for the per-grid-cell statistics (see
+ * \c solver_get_cell_statistics()).
+ *
+ * \param solver_data A pointer to the initialized solver data
+ * \param state A pointer to the full state array (all grid cells)
+ * \param env A pointer to the full array of environmental conditions
+ *            (all grid cells)
+ * \param t_initial Initial time (s)
+ * \param t_final (s)
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_run(void *solver_data, double *state, double *env, double t_initial,
+               double t_final) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+  double start = solver_profile_now();
+
+  // Keep the error test failures of each grid cell from earlier calls, so
+  // the failures of this call can be reported by grid cell
+  if (sd->cell_fails_start != NULL &&
+      sd->error_norm == CAMP_ERROR_NORM_CELL_MAX)
+    solver_get_cell_error_test_fails(sd, sd->cell_fails_start);
+
+  int status = solver_integrate(sd, state, env, t_initial, t_final);
+  sd->run_time = solver_profile_now() - start;
+  return status;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
+
+/** \brief Run the solver for an asynchronous call on its worker thread
+ *
+ * \param async_ptr A pointer to the asynchronous call
+ * \return NULL
+ */
+static void *solver_run_async_worker(void *async_ptr) {
+  SolverAsync *async = (SolverAsync *)async_ptr;
+  int status = solver_run(async->sd, async->state, async->env,
+                          async->t_initial, async->t_final);
+  pthread_mutex_lock(&(async->mutex));
+  async->status = status;
+  async->done = true;
+  pthread_mutex_unlock(&(async->mutex));
+  return NULL;
+}
+
+/** \brief Start solving for a given timestep without waiting for the result
+ *
+ * The solver runs on a worker thread, so the host model can work on other
+ * grid cells (e.g., transport or halo exchanges) while the chemistry is
+ * solved. Use \c solver_run_async_test() to check whether the call has
+ * finished and \c solver_run_async_wait() to get its result.
+ *
+ * Until \c solver_run_async_wait() returns, the call owns the solver data
+ * and the \c state and \c env arrays: the host must not read or modify the
+ * arrays, must not free them, and must not pass the solver data to any other
+ * solver function (including updates to the model data). Independent
+ * solver data objects can be solved at the same time with their own calls.
+ *
+ * \param solver_data A pointer to the initialized solver data
+ * \param state A pointer to the full state array (all grid cells)
+ * \param env A pointer to the full array of environmental conditions
+ *            (all grid cells)
+ * \param t_initial Initial time (s)
+ * \param t_final (s)
+ * \return A handle for the asynchronous call, or NULL if it could not be
+ *         started
+ */
+void *solver_run_async_start(void *solver_data, double *state, double *env,
+                             double t_initial, double t_final) {
+  SolverData *sd = (SolverData *)solver_data;
+
+  if (sd->async_in_flight) {
+    printf(
+        "\n\nERROR An asynchronous call to the solver is already in "
+        "flight\n\n");
+    return NULL;
+  }
+
+  SolverAsync *async = (SolverAsync *)malloc(sizeof(SolverAsync));
+  if (async == NULL) {
+    printf("\n\nERROR allocating space for an asynchronous solver call\n\n");
+    return NULL;
+  }
+  async->sd = sd;
+  async->state = state;
+  async->env = env;
+  async->t_initial = t_initial;
+  async->t_final = t_final;
+  async->done = false;
+  async->status = CAMP_SOLVER_FAIL;
+  pthread_mutex_init(&(async->mutex), NULL);
+
+  sd->async_in_flight = true;
+  if (pthread_create(&(async->thread), NULL, solver_run_async_worker,
+                     async) != 0) {
+    printf("\n\nERROR starting the asynchronous solver call\n\n");
+    sd->async_in_flight = false;
+    pthread_mutex_destroy(&(async->mutex));
+    free(async);
+    return NULL;
+  }
+  return async;
+}
+
+/** \brief Check whether an asynchronous call to the solver has finished
+ *
+ * Does not block. The arrays and solver data still belong to the call until
+ * \c solver_run_async_wait() is called, even after it has finished.
+ *
+ * \param async A handle returned by \c solver_run_async_start()
+ * \return 1 if the solver has returned, 0 otherwise
+ */
+int solver_run_async_test(void *async) {
+  SolverAsync *call = (SolverAsync *)async;
+  pthread_mutex_lock(&(call->mutex));
+  bool done = call->done;
+  pthread_mutex_unlock(&(call->mutex));
+  return done ? 1 : 0;
+}
+
+/** \brief Wait for an asynchronous call to the solver to finish
+ *
+ * Returns ownership of the solver data and the state and environmental
+ * arrays to the host and frees the handle, which must not be used again.
+ *
+ * \param async A handle returned by \c solver_run_async_start()
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_run_async_wait(void *async) {
+  SolverAsync *call = (SolverAsync *)async;
+  pthread_join(call->thread, NULL);
+  int status = call->status;
+  call->sd->async_in_flight = false;
+  pthread_mutex_destroy(&(call->mutex));
+  free(call);
+  return status;
+}
+
+#ifdef CAMP_USE_SUNDIALS
+/** \brief Solve for a given timestep with an independent solver for each
+ *         batch of grid cells
+ *
+ * Each batch is integrated with its own step-size history, error test and
+ * Newton iteration. All batches are integrated even if the solver fails for
+ * one of them, so that a single stiff grid cell does not prevent the
+ * remaining grid cells from being updated.
+ *
+ * Batches are integrated one after the other, or concurrently by
+ * \c n_batch_threads threads. Concurrent batches are handed out one at a
+ * time to the next idle thread, so threads that get cheap batches go on to
+ * the remaining ones while others finish expensive batches. With grid cells
+ * grouped by stiffness the most expensive batches are started first.
+ *
+ * \param sd Pointer to the parent solver data
+ * \param state A pointer to the full state array (all grid cells)
+ * \param env A pointer to the full array of environmental conditions
+ *            (all grid cells)
+ * \param t_initial Initial time (s)
+ * \param t_final (s)
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_run_batches(SolverData *sd, double *state, double *env,
+                       double t_initial, double t_final) {
+  int n_state_var = sd->model_data.n_per_cell_state_var;
+  int status = CAMP_SOLVER_SUCCESS;
+
+  // Update model data pointers
+  sd->model_data.total_state = state;
+  sd->model_data.total_env = env;
+
+  // Update the environment-dependent data of all the grid cells in the host
+  // order, before they are handed to the batches
+  solver_update_env_state(sd);
+
+  // Reset the counter of Jacobian evaluation failures
+  sd->Jac_eval_fails = 0;
+  sd->solver_flag = CV_SUCCESS;
+
+  // Integrate the grid cells in the order of the stiffness groups
+  double *batch_state = state;
+  double *batch_env = env;
+  if (sd->cell_groups != NULL) {
+    solver_group_cells(sd, state, env);
+    batch_state = sd->cell_groups->state;
+    batch_env = sd->cell_groups->env;
+  }
+
+  int n_failed = 0;
+#ifdef CAMP_USE_OPENMP
+#pragma omp parallel for num_threads(sd->n_batch_threads) \
+    schedule(dynamic, 1) if (sd->n_batch_threads > 1) reduction(+ : n_failed)
+#endif
+  for (int i_batch = 0; i_batch < sd->n_batches; ++i_batch) {
+    SolverData *batch = &(sd->batches[i_batch]);
+
+#ifdef CAMP_DEBUG
+    batch->debug_out = sd->debug_out;
+    batch->eval_Jac = sd->eval_Jac;
+#endif
+
+    if (sd->n_batch_threads > 1) solver_update_batch_params(sd, batch);
+    batch->solver_flag = CV_SUCCESS;
+    if (solver_run(batch, &(batch_state[batch->first_cell * n_state_var]),
+                   &(batch_env[batch->first_cell * CAMP_NUM_ENV_PARAM_]),
+                   t_initial, t_final) != CAMP_SOLVER_SUCCESS)
+      ++n_failed;
+  }
+  if (n_failed > 0) status = CAMP_SOLVER_FAIL;
+
+  for (int i_batch = 0; i_batch < sd->n_batches; ++i_batch) {
+    SolverData *batch = &(sd->batches[i_batch]);
+
+    // Report the flag from the first failing batch
+    if (batch->solver_flag < 0 && sd->solver_flag == CV_SUCCESS)
+      sd->solver_flag = batch->solver_flag;
+    sd->Jac_eval_fails += batch->Jac_eval_fails;
+
+    // Move the error test failures of the batch to the grid cells in the
+    // host order
+    if (sd->cell_groups != NULL && sd->cell_norm != NULL &&
+        batch->cell_norm != NULL) {
+      for (int i_cell = 0; i_cell < batch->model_data.n_cells; ++i_cell) {
+        int cell_id = sd->cell_groups->cell_order[batch->first_cell + i_cell];
+        sd->cell_norm->n_err_test_fails[cell_id] +=
+            batch->cell_norm->n_err_test_fails[i_cell];
+        batch->cell_norm->n_err_test_fails[i_cell] = 0;
+      }
+    }
+  }
+
+  if (sd->cell_groups != NULL) solver_ungroup_cells(sd, state);
+
+  return status;
+}
+#endif
+
+/** \brief Set the number of grid cells integrated together by each
+ *         independent solver instance
+ *
+ * By default all grid cells are integrated as a single system, so that the
+ * step size and error test are controlled by the stiffest grid cell. With a
+ * batch size \f$k\f$ (\f$0 < k < n_{cells}\f$) the grid cells are split into
+ * \f$\lceil n_{cells}/k \rceil\f$ batches that are each integrated by their own
+ * CVODE instance. Must be called before \c solver_initialize().
+ *
+ * \param solver_data A pointer to the solver data
+ * \param n_cells_per_batch Number of grid cells per batch (0 to integrate all
+ *                          grid cells as a single system)
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_set_cell_batch_size(void *solver_data, int n_cells_per_batch) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  if (sd->cvode_mem != NULL || sd->ros_mem != NULL || sd->n_batches > 0) {
+    printf(
+        "\n\nERROR The solver batch size must be set before the solver is "
+        "initialized\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  if (n_cells_per_batch < 0) {
+    printf("\n\nERROR Invalid number of grid cells per solver batch: %d\n\n",
+           n_cells_per_batch);
+    return CAMP_SOLVER_FAIL;
+  }
+#ifdef CAMP_USE_GPU
+  if (n_cells_per_batch > 0) {
+    printf(
+        "\n\nERROR Independent solver batches are not available with GPU "
+        "solving\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+#endif
+  sd->n_cells_per_batch = n_cells_per_batch;
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
+
+/** \brief Set whether to group grid cells into batches by stiffness
+ *
+ * With grouping, the grid cells are sorted before each call to the solver by
+ * a stiffness estimate from the last call (the inverse of the shortest time
+ * scale of the solver variables at the beginning of the call) and split into
+ * batches in that order, so each batch integrates grid cells that need
+ * similar step sizes (e.g., sunlit or cloudy grid cells are not integrated
+ * together with dark or clear ones). Only applies to independent batches of
+ * grid cells (see \c solver_set_cell_batch_size()). Must be called before
+ * \c solver_initialize().
+ *
+ * \param solver_data A pointer to the solver data
+ * \param group_cells Flag indicating whether to group grid cells by
+ *                    stiffness
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_set_cell_grouping(void *solver_data, bool group_cells) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  if (sd->cvode_mem != NULL || sd->ros_mem != NULL || sd->n_batches > 0) {
+    printf(
+        "\n\nERROR Grid cell grouping must be set before the solver is "
+        "initialized\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  sd->group_cells = group_cells;
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
+
+/** \brief Set the number of threads that integrate batches of grid cells
+ *         concurrently
+ *
+ * With more than one thread, the batches of grid cells are integrated
+ * concurrently, each by a single thread, and are handed out one at a time so
+ * that the threads stay busy until the slowest batch is done. The batch
+ * size (see \c solver_set_cell_batch_size()) sets the granularity of the
+ * load balancing. The integrators, linear solvers and work arrays of each
+ * batch are created once and reused by whichever thread integrates the
+ * batch. With one thread, batches are integrated one after another, each
+ * using all threads for its grid cell loops. More than one thread requires
+ * a build with OpenMP (ENABLE_OPENMP) and is an error otherwise. Debug
+ * builds (CAMP_DEBUG) always integrate the batches one after another,
+ * because the debugging counters and timers are not thread safe. Must be
+ * called before \c solver_initialize().
+ *
+ * \param solver_data A pointer to the solver data
+ * \param n_batch_threads Number of threads integrating batches
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_set_batch_threads(void *solver_data, int n_batch_threads) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  if (sd->cvode_mem != NULL || sd->ros_mem != NULL || sd->n_batches > 0) {
+    printf(
+        "\n\nERROR The number of batch threads must be set before the solver "
+        "is initialized\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  if (n_batch_threads < 1) {
+    printf("\n\nERROR Invalid number of batch threads: %d\n\n",
+           n_batch_threads);
+    return CAMP_SOLVER_FAIL;
+  }
+#ifndef CAMP_USE_OPENMP
+  if (n_batch_threads > 1) {
+    printf(
+        "\n\nERROR Integrating batches with %d threads requires OpenMP "
+        "(ENABLE_OPENMP)\n\n",
+        n_batch_threads);
+    return CAMP_SOLVER_FAIL;
+  }
+#endif
+#ifdef CAMP_DEBUG
+  // The debugging counters and timers are not thread safe
+  n_batch_threads = 1;
+#endif
+  sd->n_batch_threads = n_batch_threads;
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
+
+/** \brief Set the linear solver
+ *
+ * The direct solvers apply to multi-cell systems; single-cell systems are
+ * then always solved with KLU. The iterative solver
+ * (CAMP_LINEAR_SOLVER_SPGMR) is used for any number of grid cells. Must be
+ * called before \c solver_initialize().
+ *
+ * \param solver_data A pointer to the solver data
+ * \param linear_solver Linear solver type (CAMP_LINEAR_SOLVER_KLU,
+ *                      CAMP_LINEAR_SOLVER_BLOCK_LU or
+ *                      CAMP_LINEAR_SOLVER_SPGMR)
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_set_linear_solver(void *solver_data, int linear_solver) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  if (sd->cvode_mem != NULL || sd->ros_mem != NULL || sd->n_batches > 0) {
+    printf(
+        "\n\nERROR The linear solver must be set before the solver is "
+        "initialized\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  if (linear_solver != CAMP_LINEAR_SOLVER_KLU &&
+      linear_solver != CAMP_LINEAR_SOLVER_BLOCK_LU &&
+      linear_solver != CAMP_LINEAR_SOLVER_SPGMR) {
+    printf("\n\nERROR Invalid linear solver type: %d\n\n", linear_solver);
+    return CAMP_SOLVER_FAIL;
+  }
+  sd->linear_solver = linear_solver;
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
+
+/** \brief Set the integrator
+ *
+ * The Rosenbrock integrators use the direct linear solvers and can be
+ * combined with independent batches of grid cells. Must be called before
+ * \c solver_initialize().
+ *
+ * \param solver_data A pointer to the solver data
+ * \param integrator Integrator type (CAMP_INTEGRATOR_BDF,
+ *                   CAMP_INTEGRATOR_ROS2, CAMP_INTEGRATOR_ROS3,
+ *                   CAMP_INTEGRATOR_RODAS3 or CAMP_INTEGRATOR_RODAS4)
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_set_integrator(void *solver_data, int integrator) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  if (sd->cvode_mem != NULL || sd->ros_mem != NULL || sd->n_batches > 0) {
+    printf(
+        "\n\nERROR The integrator must be set before the solver is "
+        "initialized\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  if (integrator != CAMP_INTEGRATOR_BDF &&
+      integrator != CAMP_INTEGRATOR_ROS2 &&
+      integrator != CAMP_INTEGRATOR_ROS3 &&
+      integrator != CAMP_INTEGRATOR_RODAS3 &&
+      integrator != CAMP_INTEGRATOR_RODAS4) {
+    printf("\n\nERROR Invalid integrator type: %d\n\n", integrator);
+    return CAMP_SOLVER_FAIL;
+  }
+#ifdef CAMP_USE_GPU
+  if (integrator != CAMP_INTEGRATOR_BDF) {
+    printf(
+        "\n\nERROR The Rosenbrock integrators are not available with GPU "
+        "solving\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+#endif
+  if (integrator != CAMP_INTEGRATOR_BDF &&
+      sd->linear_solver == CAMP_LINEAR_SOLVER_SPGMR) {
+    printf(
+        "\n\nERROR The Rosenbrock integrators require a direct linear "
+        "solver\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  sd->integrator = integrator;
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
+
+/** \brief Set the tolerance for warm starts of the integrator
+ *
+ * When warm starts are enabled, a call to the solver whose solver variables
+ * differ from those at the end of the last successful call by no more than
+ * \c warm_start_tol (relative to the last values plus the absolute
+ * tolerance) starts with the last step size of that call instead of the
+ * default initial step, and keeps the symbolic analysis and pivot order of
+ * the last factorization of the linear solver. When the environmental state
+ * and environment-dependent model data (e.g., photolysis rates) are also
+ * unchanged, the first Jacobian evaluation of the call returns the last
+ * Jacobian of that call instead. CVODE always restarts at first order, and
+ * evaluates the Jacobian again when the Newton iteration fails to converge.
+ * With independent batches of grid cells the checks are done for each
+ * batch. Must be called before \c solver_initialize().
+ *
+ * \param solver_data A pointer to the solver data
+ * \param warm_start_tol Maximum relative change in the solver variables for
+ *                       a warm start (0 to disable warm starts)
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_set_warm_start(void *solver_data, double warm_start_tol) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  if (sd->cvode_mem != NULL || sd->ros_mem != NULL || sd->n_batches > 0) {
+    printf(
+        "\n\nERROR Warm starts must be set before the solver is "
+        "initialized\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  if (warm_start_tol < 0.0) {
+    printf("\n\nERROR Invalid warm start tolerance: %le\n\n",
+           warm_start_tol);
+    return CAMP_SOLVER_FAIL;
+  }
+  sd->warm_start_tol = warm_start_tol;
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
+
+/** \brief Set the tolerance for tabulated reaction parameters
+ *
+ * When enabled, the temperature- and pressure-dependent parameters of the
+ * reactions that only depend on the environmental state (Arrhenius, Troe,
+ * CMAQ, ternary chemical activation, Wennberg and aqueous equilibrium) are
+ * tabulated during \c solver_initialize() and interpolated for grid cells
+ * within the table range, instead of being calculated directly. Reactions
+ * whose interpolated parameters cannot be kept within \c rate_table_tol of
+ * the calculated ones are still calculated directly. The tolerance is
+ * enforced at the points 1/4, 1/2 and 3/4 of every grid interval in
+ * temperature and pressure, where the error must be within half of
+ * \c rate_table_tol as a safety factor for the error between these points.
+ * Must be called before \c solver_initialize().
+ *
+ * \param solver_data A pointer to the solver data
+ * \param rate_table_tol Maximum relative interpolation error of the
+ *                       tabulated parameters (0 to calculate all parameters
+ *                       directly)
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_set_rate_table(void *solver_data, double rate_table_tol) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  if (sd->cvode_mem != NULL || sd->ros_mem != NULL || sd->n_batches > 0) {
+    printf(
+        "\n\nERROR Rate tables must be set before the solver is "
+        "initialized\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  if (rate_table_tol < 0.0) {
+    printf("\n\nERROR Invalid rate table tolerance: %le\n\n",
+           rate_table_tol);
+    return CAMP_SOLVER_FAIL;
+  }
+  sd->rate_table_tol = rate_table_tol;
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
+
+/** \brief Set whether to evaluate rate constants in vectorized batches
+ *
+ * When enabled, the rate constants of the Arrhenius, Troe, ternary chemical
+ * activation and Wennberg tunneling reactions are calculated for all the
+ * reactions of each rate expression together, with vectorizable
+ * exponential and logarithm functions, instead of by the update function of
+ * each reaction. Results differ only by rounding. Must be called before
+ * \c solver_initialize().
+ *
+ * \param solver_data A pointer to the solver data
+ * \param vector_rate_constants Flag indicating whether to evaluate rate
+ *                              constants in vectorized batches
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_set_vector_rate_constants(void *solver_data,
+                                     bool vector_rate_constants) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  if (sd->cvode_mem != NULL || sd->ros_mem != NULL || sd->n_batches > 0) {
+    printf(
+        "\n\nERROR Vectorized rate constants must be set before the solver "
+        "is initialized\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  sd->vector_rate_constants = vector_rate_constants;
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
 #endif
-      return CAMP_SOLVER_FAIL;
-    }
+}
+
+/** \brief Set the error norm for multi-cell systems
+ *
+ * With \c CAMP_ERROR_NORM_CELL_MAX, the error tests of the integrators use
+ * the largest of the weighted root-mean-square norms of the grid cells
+ * instead of the norm of all the solver variables, so a large error in one
+ * grid cell is not averaged out by the other grid cells. Steps rejected by
+ * the error test are attributed to the grid cell with the largest error,
+ * and can be retrieved with \c solver_get_cell_error_test_fails(). The
+ * option has no effect on single-cell systems. Must be called before
+ * \c solver_initialize().
+ *
+ * \param solver_data A pointer to the solver data
+ * \param error_norm Error norm (CAMP_ERROR_NORM_GLOBAL or
+ *                   CAMP_ERROR_NORM_CELL_MAX)
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_set_error_norm(void *solver_data, int error_norm) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  if (sd->cvode_mem != NULL || sd->ros_mem != NULL || sd->n_batches > 0) {
+    printf(
+        "\n\nERROR The error norm must be set before the solver is "
+        "initialized\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  if (error_norm != CAMP_ERROR_NORM_GLOBAL &&
+      error_norm != CAMP_ERROR_NORM_CELL_MAX) {
+    printf("\n\nERROR Invalid error norm type: %d\n\n", error_norm);
+    return CAMP_SOLVER_FAIL;
+  }
+#ifdef CAMP_USE_GPU
+  if (error_norm != CAMP_ERROR_NORM_GLOBAL) {
+    printf(
+        "\n\nERROR The per-grid-cell error norm is not available with GPU "
+        "solving\n\n");
+    return CAMP_SOLVER_FAIL;
   }
+#endif
+  sd->error_norm = error_norm;
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
 
-  // Update the species concentrations on the state array
-  i_dep_var = 0;
-  for (int i_cell = 0; i_cell < n_cells; i_cell++) {
-    for (int i_spec = 0; i_spec < n_state_var; i_spec++) {
-      if (md->var_type[i_spec] == CHEM_SPEC_VARIABLE) {
-        state[i_spec + i_cell * n_state_var] =
-            (double)(NV_Ith_S(sd->y, i_dep_var) > 0.0
-                         ? NV_Ith_S(sd->y, i_dep_var)
-                         : 0.0);
-        i_dep_var++;
-      }
-    }
+/** \brief Set the number of grid cells whose reaction rates are calculated
+ *         together
+ *
+ * With chunks of more than one grid cell, f() copies the state of each chunk
+ * to a species-major array and calculates the contributions of the
+ * mass-action reactions with the innermost loops over the grid cells. Must
+ * be called before \c solver_initialize().
+ *
+ * \param solver_data A pointer to the solver data
+ * \param n_cells_per_chunk Number of grid cells per chunk (0 to calculate
+ *                          reaction rates one grid cell at a time)
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_set_cell_chunk_size(void *solver_data, int n_cells_per_chunk) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  if (sd->cvode_mem != NULL || sd->ros_mem != NULL || sd->n_batches > 0) {
+    printf(
+        "\n\nERROR The grid cell chunk size must be set before the solver is "
+        "initialized\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  if (n_cells_per_chunk < 0) {
+    printf("\n\nERROR Invalid number of grid cells per chunk: %d\n\n",
+           n_cells_per_chunk);
+    return CAMP_SOLVER_FAIL;
+  }
+#ifdef CAMP_USE_GPU
+  if (n_cells_per_chunk > 0) {
+    printf(
+        "\n\nERROR Grid cell chunks are not available with GPU solving\n\n");
+    return CAMP_SOLVER_FAIL;
   }
+#endif
+  sd->n_cells_per_chunk = n_cells_per_chunk;
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
 
-  // Re-run the pre-derivative calculations to update equilibrium species
-  // and apply adjustments to final state
-  sub_model_calculate(md);
+/** \brief Write the C source for a kernel with the reactions unrolled
+ *
+ * Must be called after \c solver_initialize(). The kernel includes the
+ * gas-phase mass-action reactions of the solver; see rxn_codegen.h.
+ *
+ * \param solver_data A pointer to the solver data
+ * \param file_path Path to the source file to write
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_write_rxn_kernel(void *solver_data, const char *file_path) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
 
+  if (sd->cvode_mem == NULL && sd->ros_mem == NULL && sd->n_batches == 0) {
+    printf(
+        "\n\nERROR The solver must be initialized before writing a "
+        "reaction kernel\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  if (rxn_codegen_write_source(&(sd->model_data), file_path) == 0) {
+    printf("\n\nERROR Cannot write reaction kernel to '%s'\n\n", file_path);
+    return CAMP_SOLVER_FAIL;
+  }
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
+
+/** \brief Load a compiled reaction kernel in place of the generic reaction
+ *         functions for the reactions it includes
+ *
+ * Must be called after \c solver_initialize(). The kernel must have been
+ * generated by \c solver_write_rxn_kernel() for the same reaction data, and
+ * is validated against the generic reaction functions before it is used.
+ *
+ * \param solver_data A pointer to the solver data
+ * \param lib_path Path to the shared library with the compiled kernel
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_load_rxn_kernel(void *solver_data, const char *lib_path) {
+#if defined(CAMP_USE_SUNDIALS) && !defined(CAMP_USE_GPU)
+  SolverData *sd = (SolverData *)solver_data;
+  RxnKernel *kernel;
+
+  if (sd->cvode_mem == NULL && sd->ros_mem == NULL && sd->n_batches == 0) {
+    printf(
+        "\n\nERROR The solver must be initialized before loading a "
+        "reaction kernel\n\n");
+    return CAMP_SOLVER_FAIL;
+  }
+  kernel = rxn_codegen_load(&(sd->model_data), lib_path);
+  if (kernel == NULL) return CAMP_SOLVER_FAIL;
+
+  // Replace any previously loaded kernel
+  rxn_codegen_free(sd->model_data.rxn_kernel);
+  sd->model_data.rxn_kernel = kernel;
+  for (int i_batch = 0; i_batch < sd->n_batches; ++i_batch)
+    sd->batches[i_batch].model_data.rxn_kernel = kernel;
   return CAMP_SOLVER_SUCCESS;
 #else
   return CAMP_SOLVER_FAIL;
@@ -721,6 +2464,21 @@ int solver_run(void *solver_data, double *state, double *env, double t_initial,
  * \param Jac_time__s           Compute time for calls to Jac() [s]
  * \param max_loss_precision    Indicators of loss of precision in derivative
  *                              calculation for each species
+ * \param phase_time__s         Profiled time of each solver phase [s]
+ *                              [CAMP_PROFILE_NUM_PHASES]
+ * \param phase_calls           Profiled number of calls of each solver phase
+ *                              [CAMP_PROFILE_NUM_PHASES]
+ * \param rxn_time__s           Profiled time of the time derivative
+ *                              contributions of each reaction type [s]
+ *                              [CAMP_PROFILE_NUM_RXN_TYPES]
+ * \param rxn_calls             Profiled number of time derivative
+ *                              contributions of each reaction type
+ *                              [CAMP_PROFILE_NUM_RXN_TYPES]
+ *
+ * When grid cells are integrated in independent batches, counters are summed
+ * over the batches and the time step sizes are the smallest of any batch.
+ * Without CAMP_DEBUG, the total calls to and time of f() and Jac() are taken
+ * from the profiler when it has been enabled.
  */
 void solver_get_statistics(void *solver_data, int *solver_flag, int *num_steps,
                            int *RHS_evals, int *LS_setups,
@@ -730,106 +2488,680 @@ void solver_get_statistics(void *solver_data, int *solver_flag, int *num_steps,
                            double *next_time_step__s, int *Jac_eval_fails,
                            int *RHS_evals_total, int *Jac_evals_total,
                            double *RHS_time__s, double *Jac_time__s,
-                           double *max_loss_precision) {
-#ifdef CAMP_USE_SUNDIALS
+                           double *max_loss_precision, double *phase_time__s,
+                           long int *phase_calls, double *rxn_time__s,
+                           long int *rxn_calls) {
   SolverData *sd = (SolverData *)solver_data;
+  SolverProfile profile;
+
+  // Combine the profiles of the solver, its grid cell views and its batches
+  memset(&profile, 0, sizeof(SolverProfile));
+  solver_add_profile(sd, &profile);
+  for (int i = 0; i < CAMP_PROFILE_NUM_PHASES; ++i) {
+    phase_time__s[i] = profile.phase_time[i];
+    phase_calls[i] = profile.phase_calls[i];
+  }
+  for (int i = 0; i < CAMP_PROFILE_NUM_RXN_TYPES; ++i) {
+    rxn_time__s[i] = profile.rxn_time[i];
+    rxn_calls[i] = profile.rxn_calls[i];
+  }
+
+#ifdef CAMP_USE_SUNDIALS
   long int nst, nfe, nsetups, nje, nfeLS, nni, ncfn, netf, nge;
   realtype last_h, curr_h;
   int flag;
 
-  *solver_flag = sd->solver_flag;
-  flag = CVodeGetNumSteps(sd->cvode_mem, &nst);
-  if (check_flag(&flag, "CVodeGetNumSteps", 1) == CAMP_SOLVER_FAIL) return;
-  *num_steps = (int)nst;
-  flag = CVodeGetNumRhsEvals(sd->cvode_mem, &nfe);
-  if (check_flag(&flag, "CVodeGetNumRhsEvals", 1) == CAMP_SOLVER_FAIL) return;
-  *RHS_evals = (int)nfe;
-  flag = CVodeGetNumLinSolvSetups(sd->cvode_mem, &nsetups);
-  if (check_flag(&flag, "CVodeGetNumLinSolveSetups", 1) == CAMP_SOLVER_FAIL)
-    return;
-  *LS_setups = (int)nsetups;
-  flag = CVodeGetNumErrTestFails(sd->cvode_mem, &netf);
-  if (check_flag(&flag, "CVodeGetNumErrTestFails", 1) == CAMP_SOLVER_FAIL)
+  if (sd->n_batches > 0) {
+    solver_get_batch_statistics(
+        sd, solver_flag, num_steps, RHS_evals, LS_setups, error_test_fails,
+        NLS_iters, NLS_convergence_fails, DLS_Jac_evals, DLS_RHS_evals,
+        last_time_step__s, next_time_step__s, Jac_eval_fails, RHS_evals_total,
+        Jac_evals_total, RHS_time__s, Jac_time__s, max_loss_precision);
+    solver_set_profiled_eval_stats(&profile, RHS_evals_total, Jac_evals_total,
+                                   RHS_time__s, Jac_time__s);
     return;
-  *error_test_fails = (int)netf;
-  flag = CVodeGetNumNonlinSolvIters(sd->cvode_mem, &nni);
-  if (check_flag(&flag, "CVodeGetNonlinSolvIters", 1) == CAMP_SOLVER_FAIL)
+  }
+
+  *solver_flag = sd->solver_flag;
+  if (sd->ros_mem != NULL) {
+    // Rosenbrock integrators have no nonlinear solver and evaluate f(t,y)
+    // with the Jacobian at the beginning of each step
+    *num_steps = (int)sd->ros_mem->n_steps;
+    *RHS_evals = (int)sd->ros_mem->n_rhs_evals;
+    *LS_setups = (int)sd->ros_mem->n_lin_setups;
+    *error_test_fails = (int)sd->ros_mem->n_err_test_fails;
+    *NLS_iters = 0;
+    *NLS_convergence_fails = 0;
+    *DLS_Jac_evals = (int)sd->ros_mem->n_jac_evals;
+    *DLS_RHS_evals = 0;
+    *last_time_step__s = (double)sd->ros_mem->h_last;
+    *next_time_step__s = (double)sd->ros_mem->h;
+  } else {
+    flag = CVodeGetNumSteps(sd->cvode_mem, &nst);
+    if (check_flag(&flag, "CVodeGetNumSteps", 1) == CAMP_SOLVER_FAIL) return;
+    *num_steps = (int)nst;
+    flag = CVodeGetNumRhsEvals(sd->cvode_mem, &nfe);
+    if (check_flag(&flag, "CVodeGetNumRhsEvals", 1) == CAMP_SOLVER_FAIL) return;
+    *RHS_evals = (int)nfe;
+    flag = CVodeGetNumLinSolvSetups(sd->cvode_mem, &nsetups);
+    if (check_flag(&flag, "CVodeGetNumLinSolveSetups", 1) == CAMP_SOLVER_FAIL)
+      return;
+    *LS_setups = (int)nsetups;
+    flag = CVodeGetNumErrTestFails(sd->cvode_mem, &netf);
+    if (check_flag(&flag, "CVodeGetNumErrTestFails", 1) == CAMP_SOLVER_FAIL)
+      return;
+    *error_test_fails = (int)netf;
+    flag = CVodeGetNumNonlinSolvIters(sd->cvode_mem, &nni);
+    if (check_flag(&flag, "CVodeGetNonlinSolvIters", 1) == CAMP_SOLVER_FAIL)
+      return;
+    *NLS_iters = (int)nni;
+    flag = CVodeGetNumNonlinSolvConvFails(sd->cvode_mem, &ncfn);
+    if (check_flag(&flag, "CVodeGetNumNonlinSolvConvFails", 1) ==
+        CAMP_SOLVER_FAIL)
+      return;
+    *NLS_convergence_fails = ncfn;
+    flag = CVDlsGetNumJacEvals(sd->cvode_mem, &nje);
+    if (check_flag(&flag, "CVDlsGetNumJacEvals", 1) == CAMP_SOLVER_FAIL) return;
+    *DLS_Jac_evals = (int)nje;
+    flag = CVDlsGetNumRhsEvals(sd->cvode_mem, &nfeLS);
+    if (check_flag(&flag, "CVDlsGetNumRhsEvals", 1) == CAMP_SOLVER_FAIL) return;
+    *DLS_RHS_evals = (int)nfeLS;
+    flag = CVodeGetLastStep(sd->cvode_mem, &last_h);
+    if (check_flag(&flag, "CVodeGetLastStep", 1) == CAMP_SOLVER_FAIL) return;
+    *last_time_step__s = (double)last_h;
+    flag = CVodeGetCurrentStep(sd->cvode_mem, &curr_h);
+    if (check_flag(&flag, "CVodeGetCurrentStep", 1) == CAMP_SOLVER_FAIL) return;
+    *next_time_step__s = (double)curr_h;
+  }
+  *Jac_eval_fails = sd->Jac_eval_fails;
+#ifdef CAMP_DEBUG
+  *RHS_evals_total = sd->counterDeriv;
+  *Jac_evals_total = sd->counterJac;
+  *RHS_time__s = ((double)sd->timeDeriv) / CLOCKS_PER_SEC;
+  *Jac_time__s = ((double)sd->timeJac) / CLOCKS_PER_SEC;
+  *max_loss_precision = sd->max_loss_precision;
+#else
+  *RHS_evals_total = -1;
+  *Jac_evals_total = -1;
+  *RHS_time__s = 0.0;
+  *Jac_time__s = 0.0;
+  *max_loss_precision = 0.0;
+#endif
+  solver_set_profiled_eval_stats(&profile, RHS_evals_total, Jac_evals_total,
+                                 RHS_time__s, Jac_time__s);
+#endif
+}
+
+/** \brief Add the profiles of a solver, its grid cell views and its batches
+ *         to a total
+ *
+ * \param sd Pointer to the SolverData
+ * \param total Profile to add to
+ */
+void solver_add_profile(SolverData *sd, SolverProfile *total) {
+  solver_profile_add(total, &(sd->profile));
+#ifdef CAMP_USE_SUNDIALS
+  for (int i_view = 0; i_view < sd->n_cell_views; ++i_view)
+    solver_profile_add(total, &(sd->cell_views[i_view].profile));
+  for (int i_batch = 0; i_batch < sd->n_batches; ++i_batch)
+    solver_add_profile(&(sd->batches[i_batch]), total);
+#endif
+}
+
+/** \brief Set the total calls to and time of f() and Jac() from a profile
+ *
+ * The values are only set without CAMP_DEBUG (which counts them directly)
+ * and when the profile has calls to f() or Jac().
+ *
+ * \param profile Combined profile of the solver
+ * \param RHS_evals_total Pointer to set to the total calls to f()
+ * \param Jac_evals_total Pointer to set to the total calls to Jac()
+ * \param RHS_time__s Pointer to set to the time of the calls to f() [s]
+ * \param Jac_time__s Pointer to set to the time of the calls to Jac() [s]
+ */
+void solver_set_profiled_eval_stats(const SolverProfile *profile,
+                                    int *RHS_evals_total, int *Jac_evals_total,
+                                    double *RHS_time__s, double *Jac_time__s) {
+#ifndef CAMP_DEBUG
+  if (profile->phase_calls[CAMP_PROFILE_DERIV] == 0 &&
+      profile->phase_calls[CAMP_PROFILE_JAC] == 0)
     return;
-  *NLS_iters = (int)nni;
-  flag = CVodeGetNumNonlinSolvConvFails(sd->cvode_mem, &ncfn);
+  *RHS_evals_total = (int)profile->phase_calls[CAMP_PROFILE_DERIV];
+  *Jac_evals_total = (int)profile->phase_calls[CAMP_PROFILE_JAC];
+  *RHS_time__s = profile->phase_time[CAMP_PROFILE_DERIV];
+  *Jac_time__s = profile->phase_time[CAMP_PROFILE_JAC];
+#endif
+}
+
+/** \brief Get the number of integration steps rejected by the error test
+ *         for each grid cell
+ *
+ * Each step rejected by the error test is attributed to the grid cell with
+ * the largest error norm. The counts are accumulated over all calls to the
+ * solver and are only available with the per-grid-cell error norm (see
+ * \c solver_set_error_norm()).
+ *
+ * \param solver_data A pointer to the solver data
+ * \param n_fails Number of rejected steps for each grid cell [n_cells]
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_get_cell_error_test_fails(void *solver_data, int *n_fails) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+
+  // With grid cell groups the failures are accumulated by the parent solver
+  if (sd->n_batches > 0 && sd->cell_groups == NULL) {
+    for (int i_batch = 0; i_batch < sd->n_batches; ++i_batch) {
+      SolverData *batch = &(sd->batches[i_batch]);
+      if (solver_get_cell_error_test_fails(
+              batch, &(n_fails[batch->first_cell - sd->first_cell])) !=
+          CAMP_SOLVER_SUCCESS)
+        return CAMP_SOLVER_FAIL;
+    }
+    return CAMP_SOLVER_SUCCESS;
+  }
+  if (sd->cell_norm == NULL) return CAMP_SOLVER_FAIL;
+  for (int i_cell = 0; i_cell < sd->cell_norm->n_cells; ++i_cell)
+    n_fails[i_cell] = (int)sd->cell_norm->n_err_test_fails[i_cell];
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
+
+#ifdef CAMP_USE_SUNDIALS
+/* Integrator counters of a solver instance for the last call to the solver */
+typedef struct {
+  long int n_steps;           // Integration steps
+  long int n_rhs_evals;       // Right-hand side evaluations
+  long int n_jac_evals;       // Jacobian evaluations
+  long int n_nls_iters;       // Nonlinear solver iterations
+  long int n_nls_conv_fails;  // Nonlinear solver convergence failures
+  long int n_err_test_fails;  // Error test failures
+  realtype h_last;            // Last time step (s)
+} IntegratorCounts;
+
+/** \brief Get the integrator counters of a solver instance for the last
+ *         call to the solver
+ *
+ * The counters are zero when the instance had nothing to integrate.
+ *
+ * \param sd Pointer to the solver data of a single solver instance
+ * \param counts Counters to set
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+static int solver_get_integrator_counts(SolverData *sd,
+                                        IntegratorCounts *counts) {
+  int flag;
+
+  memset(counts, 0, sizeof(IntegratorCounts));
+  if (!sd->integrated) return CAMP_SOLVER_SUCCESS;
+  if (sd->ros_mem != NULL) {
+    counts->n_steps = sd->ros_mem->n_steps;
+    counts->n_rhs_evals = sd->ros_mem->n_rhs_evals;
+    counts->n_jac_evals = sd->ros_mem->n_jac_evals;
+    counts->n_err_test_fails = sd->ros_mem->n_err_test_fails;
+    counts->h_last = sd->ros_mem->h_last;
+    return CAMP_SOLVER_SUCCESS;
+  }
+  flag = CVodeGetNumSteps(sd->cvode_mem, &(counts->n_steps));
+  if (check_flag(&flag, "CVodeGetNumSteps", 1) == CAMP_SOLVER_FAIL)
+    return CAMP_SOLVER_FAIL;
+  flag = CVodeGetNumRhsEvals(sd->cvode_mem, &(counts->n_rhs_evals));
+  if (check_flag(&flag, "CVodeGetNumRhsEvals", 1) == CAMP_SOLVER_FAIL)
+    return CAMP_SOLVER_FAIL;
+  flag = CVDlsGetNumJacEvals(sd->cvode_mem, &(counts->n_jac_evals));
+  if (check_flag(&flag, "CVDlsGetNumJacEvals", 1) == CAMP_SOLVER_FAIL)
+    return CAMP_SOLVER_FAIL;
+  flag = CVodeGetNumNonlinSolvIters(sd->cvode_mem, &(counts->n_nls_iters));
+  if (check_flag(&flag, "CVodeGetNumNonlinSolvIters", 1) == CAMP_SOLVER_FAIL)
+    return CAMP_SOLVER_FAIL;
+  flag = CVodeGetNumNonlinSolvConvFails(sd->cvode_mem,
+                                        &(counts->n_nls_conv_fails));
   if (check_flag(&flag, "CVodeGetNumNonlinSolvConvFails", 1) ==
       CAMP_SOLVER_FAIL)
-    return;
-  *NLS_convergence_fails = ncfn;
-  flag = CVDlsGetNumJacEvals(sd->cvode_mem, &nje);
-  if (check_flag(&flag, "CVDlsGetNumJacEvals", 1) == CAMP_SOLVER_FAIL) return;
-  *DLS_Jac_evals = (int)nje;
-  flag = CVDlsGetNumRhsEvals(sd->cvode_mem, &nfeLS);
-  if (check_flag(&flag, "CVDlsGetNumRhsEvals", 1) == CAMP_SOLVER_FAIL) return;
-  *DLS_RHS_evals = (int)nfeLS;
-  flag = CVodeGetLastStep(sd->cvode_mem, &last_h);
-  if (check_flag(&flag, "CVodeGetLastStep", 1) == CAMP_SOLVER_FAIL) return;
-  *last_time_step__s = (double)last_h;
-  flag = CVodeGetCurrentStep(sd->cvode_mem, &curr_h);
-  if (check_flag(&flag, "CVodeGetCurrentStep", 1) == CAMP_SOLVER_FAIL) return;
-  *next_time_step__s = (double)curr_h;
+    return CAMP_SOLVER_FAIL;
+  flag = CVodeGetNumErrTestFails(sd->cvode_mem, &(counts->n_err_test_fails));
+  if (check_flag(&flag, "CVodeGetNumErrTestFails", 1) == CAMP_SOLVER_FAIL)
+    return CAMP_SOLVER_FAIL;
+  flag = CVodeGetLastStep(sd->cvode_mem, &(counts->h_last));
+  if (check_flag(&flag, "CVodeGetLastStep", 1) == CAMP_SOLVER_FAIL)
+    return CAMP_SOLVER_FAIL;
+  return CAMP_SOLVER_SUCCESS;
+}
+#endif
+
+/** \brief Get the solver statistics of each grid cell for the last call to
+ *         the solver
+ *
+ * Grid cells integrated as one system share its integrator, so the counters,
+ * the last time step and the solve time of a grid cell are those of the
+ * system (all grid cells, or the batch of the grid cell when grid cells are
+ * integrated in independent batches). With the per-grid-cell error norm
+ * (see \c solver_set_error_norm()), error test failures are attributed to
+ * the grid cell with the largest error norm instead. The calculation time
+ * of each grid cell is the time of its f() and Jac() calculations, and is
+ * only measured while the profiler is enabled (see
+ * \c solver_set_profiling()).
+ *
+ * All arrays are in the host order of the grid cells.
+ *
+ * \param solver_data           A pointer to the solver data
+ * \param num_steps             Number of integration steps [n_cells]
+ * \param RHS_evals             Number of right-hand side evaluations
+ *                              [n_cells]
+ * \param Jac_evals             Number of Jacobian evaluations [n_cells]
+ * \param NLS_iters             Number of non-linear solver iterations
+ *                              [n_cells]
+ * \param NLS_convergence_fails Number of non-linear solver convergence
+ *                              failures [n_cells]
+ * \param error_test_fails      Number of error test failures [n_cells]
+ * \param last_time_step__s     Last time step size [s] [n_cells]
+ * \param solve_time__s         Wall time of the last call to the solver
+ *                              that integrated the grid cell [s] [n_cells]
+ * \param calc_time__s          Profiled time of the f() and Jac()
+ *                              calculations [s] [n_cells]
+ * \return Flag indicating CAMP_SOLVER_SUCCESS or CAMP_SOLVER_FAIL
+ */
+int solver_get_cell_statistics(void *solver_data, int *num_steps,
+                               int *RHS_evals, int *Jac_evals, int *NLS_iters,
+                               int *NLS_convergence_fails,
+                               int *error_test_fails,
+                               double *last_time_step__s,
+                               double *solve_time__s, double *calc_time__s) {
+#ifdef CAMP_USE_SUNDIALS
+  SolverData *sd = (SolverData *)solver_data;
+  int n_instances = sd->n_batches > 0 ? sd->n_batches : 1;
+
+  for (int i_inst = 0; i_inst < n_instances; ++i_inst) {
+    SolverData *inst = sd->n_batches > 0 ? &(sd->batches[i_inst]) : sd;
+    IntegratorCounts counts;
+    if (solver_get_integrator_counts(inst, &counts) != CAMP_SOLVER_SUCCESS)
+      return CAMP_SOLVER_FAIL;
+    for (int i_cell = 0; i_cell < inst->model_data.n_cells; ++i_cell) {
+      int cell_id = inst->first_cell - sd->first_cell + i_cell;
+      if (sd->cell_groups != NULL)
+        cell_id = sd->cell_groups->cell_order[cell_id];
+      num_steps[cell_id] = (int)counts.n_steps;
+      RHS_evals[cell_id] = (int)counts.n_rhs_evals;
+      Jac_evals[cell_id] = (int)counts.n_jac_evals;
+      NLS_iters[cell_id] = (int)counts.n_nls_iters;
+      NLS_convergence_fails[cell_id] = (int)counts.n_nls_conv_fails;
+      error_test_fails[cell_id] = (int)counts.n_err_test_fails;
+      last_time_step__s[cell_id] = (double)counts.h_last;
+      solve_time__s[cell_id] = inst->run_time;
+      calc_time__s[cell_id] = inst->cell_calc_time[i_cell];
+    }
+  }
+
+  // Report the error test failures of this call attributed to each grid
+  // cell, when they are available for all the grid cells
+  if (sd->cell_fails_start == NULL ||
+      sd->error_norm != CAMP_ERROR_NORM_CELL_MAX)
+    return CAMP_SOLVER_SUCCESS;
+  int *n_fails = sd->cell_fails_end;
+  if (solver_get_cell_error_test_fails(sd, n_fails) == CAMP_SOLVER_SUCCESS) {
+    for (int i_cell = 0; i_cell < sd->model_data.n_cells; ++i_cell)
+      error_test_fails[i_cell] = n_fails[i_cell] - sd->cell_fails_start[i_cell];
+  }
+  return CAMP_SOLVER_SUCCESS;
+#else
+  return CAMP_SOLVER_FAIL;
+#endif
+}
+
+#ifdef CAMP_USE_SUNDIALS
+/** \brief Combine the solver statistics of independent batches of grid cells
+ *
+ * Arguments are the same as for \c solver_get_statistics()
+ */
+void solver_get_batch_statistics(
+    SolverData *sd, int *solver_flag, int *num_steps, int *RHS_evals,
+    int *LS_setups, int *error_test_fails, int *NLS_iters,
+    int *NLS_convergence_fails, int *DLS_Jac_evals, int *DLS_RHS_evals,
+    double *last_time_step__s, double *next_time_step__s, int *Jac_eval_fails,
+    int *RHS_evals_total, int *Jac_evals_total, double *RHS_time__s,
+    double *Jac_time__s, double *max_loss_precision) {
+  int b_solver_flag, b_num_steps, b_RHS_evals, b_LS_setups,
+      b_error_test_fails, b_NLS_iters, b_NLS_convergence_fails,
+      b_DLS_Jac_evals, b_DLS_RHS_evals, b_Jac_eval_fails, b_RHS_evals_total,
+      b_Jac_evals_total;
+  double b_last_time_step__s, b_next_time_step__s, b_RHS_time__s,
+      b_Jac_time__s, b_max_loss_precision;
+  double b_phase_time__s[CAMP_PROFILE_NUM_PHASES],
+      b_rxn_time__s[CAMP_PROFILE_NUM_RXN_TYPES];
+  long int b_phase_calls[CAMP_PROFILE_NUM_PHASES],
+      b_rxn_calls[CAMP_PROFILE_NUM_RXN_TYPES];
+
+  *num_steps = 0;
+  *RHS_evals = 0;
+  *LS_setups = 0;
+  *error_test_fails = 0;
+  *NLS_iters = 0;
+  *NLS_convergence_fails = 0;
+  *DLS_Jac_evals = 0;
+  *DLS_RHS_evals = 0;
+  *RHS_evals_total = 0;
+  *Jac_evals_total = 0;
+  *RHS_time__s = 0.0;
+  *Jac_time__s = 0.0;
+  *max_loss_precision = 0.0;
+  for (int i_batch = 0; i_batch < sd->n_batches; ++i_batch) {
+    solver_get_statistics(
+        &(sd->batches[i_batch]), &b_solver_flag, &b_num_steps, &b_RHS_evals,
+        &b_LS_setups, &b_error_test_fails, &b_NLS_iters,
+        &b_NLS_convergence_fails, &b_DLS_Jac_evals, &b_DLS_RHS_evals,
+        &b_last_time_step__s, &b_next_time_step__s, &b_Jac_eval_fails,
+        &b_RHS_evals_total, &b_Jac_evals_total, &b_RHS_time__s,
+        &b_Jac_time__s, &b_max_loss_precision, b_phase_time__s, b_phase_calls,
+        b_rxn_time__s, b_rxn_calls);
+    *num_steps += b_num_steps;
+    *RHS_evals += b_RHS_evals;
+    *LS_setups += b_LS_setups;
+    *error_test_fails += b_error_test_fails;
+    *NLS_iters += b_NLS_iters;
+    *NLS_convergence_fails += b_NLS_convergence_fails;
+    *DLS_Jac_evals += b_DLS_Jac_evals;
+    *DLS_RHS_evals += b_DLS_RHS_evals;
+    if (i_batch == 0 || b_last_time_step__s < *last_time_step__s)
+      *last_time_step__s = b_last_time_step__s;
+    if (i_batch == 0 || b_next_time_step__s < *next_time_step__s)
+      *next_time_step__s = b_next_time_step__s;
+    *RHS_evals_total += b_RHS_evals_total;
+    *Jac_evals_total += b_Jac_evals_total;
+    *RHS_time__s += b_RHS_time__s;
+    *Jac_time__s += b_Jac_time__s;
+    if (b_max_loss_precision > *max_loss_precision)
+      *max_loss_precision = b_max_loss_precision;
+  }
+  *solver_flag = sd->solver_flag;
   *Jac_eval_fails = sd->Jac_eval_fails;
+#ifndef CAMP_DEBUG
+  *RHS_evals_total = -1;
+  *Jac_evals_total = -1;
+#endif
+}
+
+/** \brief Update the model state from the current solver state
+ *
+ * \param solver_state Solver state vector
+ * \param model_data Pointer to the model data (including the state array)
+ * \param threshhold A lower limit for model concentrations below which the
+ *                   solver value is replaced with a replacement value
+ * \param replacement_value Replacement value for low concentrations
+ * \return CAMP_SOLVER_SUCCESS for successful update or
+ *         CAMP_SOLVER_FAIL for negative concentration
+ */
+int camp_solver_update_model_state(N_Vector solver_state, ModelData *model_data,
+                                   realtype threshhold,
+                                   realtype replacement_value) {
+  int n_state_var = model_data->n_per_cell_state_var;
+  int n_dep_var = model_data->n_per_cell_dep_var;
+  int n_cells = model_data->n_cells;
+  int *var_state_id = model_data->var_state_id;
+
+  for (int i_cell = 0; i_cell < n_cells; i_cell++) {
+    double *cell_state = &(model_data->total_state[i_cell * n_state_var]);
+    realtype *cell_y = &(NV_DATA_S(solver_state)[i_cell * n_dep_var]);
+    for (int i_dep_var = 0; i_dep_var < n_dep_var; ++i_dep_var) {
+      if (cell_y[i_dep_var] < -SMALL) {
+#ifdef FAILURE_DETAIL
+        printf("\nFailed model state update: [spec %d] = %le",
+               var_state_id[i_dep_var], cell_y[i_dep_var]);
+#endif
+        return CAMP_SOLVER_FAIL;
+      }
+      // Assign model state to solver_state
+      cell_state[var_state_id[i_dep_var]] = cell_y[i_dep_var] > threshhold
+                                                ? cell_y[i_dep_var]
+                                                : replacement_value;
+    }
+  }
+  return CAMP_SOLVER_SUCCESS;
+}
+
+/** \brief Calculate the time derivative for a chunk of grid cells
+ *
+ * The contributions of the reactions in the structure-of-arrays tables are
+ * calculated for all grid cells in the chunk at once from species-major
+ * copies of their state and reaction environment-dependent data. The
+ * remaining reactions are calculated one grid cell at a time, after the
+ * aerosol representations and sub models are updated for that grid cell.
+ *
+ * \param sd Pointer to the SolverData
+ * \param cell_ids Indices of the grid cells in the chunk
+ * \param n_cells Number of grid cells in the chunk
+ * \param time_step Current integrator time step (s)
+ * \param deriv_data Derivative array to update
+ * \param jac_deriv_data Jacobian-estimated derivative array
+ */
+void solver_calc_deriv_cell_chunk(SolverData *sd, const int *cell_ids,
+                                  int n_cells, realtype time_step,
+                                  double *deriv_data, double *jac_deriv_data) {
+  ModelData *md = &(sd->model_data);
+  int stride = sd->n_cells_per_chunk;
+  int n_state_var = md->n_per_cell_state_var;
+  int n_dep_var = md->n_per_cell_dep_var;
+  int n_env = md->n_rxn_env_data;
+  GridCellView *view = solver_get_cell_view(sd, cell_ids[0]);
+  SolverProfile *profile = &(view->profile);
+
+  for (int i_cell = 0; i_cell < n_cells; ++i_cell) {
+    ModelData *cell_md =
+        &(solver_get_cell_view(sd, cell_ids[i_cell])->model_data);
+    double *cell_state = cell_md->grid_cell_state;
+    double *cell_rxn_env_data = cell_md->grid_cell_rxn_env_data;
+    double cell_start = solver_profile_start(profile);
+
+    // Update the aerosol representations
+    aero_rep_update_state(cell_md);
+
+    // Run the sub models
+    sub_model_calculate(cell_md);
+
+    // Copy the grid cell data to the species-major arrays
+    for (int i_spec = 0; i_spec < n_state_var; ++i_spec)
+      view->chunk_state[i_spec * stride + i_cell] = cell_state[i_spec];
+    for (int i_env = 0; i_env < n_env; ++i_env)
+      view->chunk_rxn_env_data[i_env * stride + i_cell] =
+          cell_rxn_env_data[i_env];
+    if (profile->enabled)
+      sd->cell_calc_time[cell_ids[i_cell]] += solver_profile_now() - cell_start;
+  }
+
+  // Calculate the contributions of the reaction tables (their time is
+  // shared evenly by the grid cells of the chunk)
+  double profile_start = solver_profile_start(profile);
+  time_derivative_reset(view->chunk_deriv);
+  rxn_soa_calc_deriv_cells(md->rxn_soa, view->chunk_state,
+                           view->chunk_rxn_env_data, view->chunk_deriv,
+                           n_cells, stride, time_step);
+  if (profile->enabled) {
+    double now = solver_profile_stop_rxn(
+        profile, 0, (md->n_rxn - md->rxn_soa->n_generic_rxn) * n_cells,
+        profile_start);
+    solver_profile_stop(profile, CAMP_PROFILE_RXN_DERIV, profile_start);
+    for (int i_cell = 0; i_cell < n_cells; ++i_cell)
+      sd->cell_calc_time[cell_ids[i_cell]] += (now - profile_start) / n_cells;
+  }
+
+  for (int i_cell = 0; i_cell < n_cells; ++i_cell) {
+    int cell_id = cell_ids[i_cell];
+    ModelData *cell_md = &(solver_get_cell_view(sd, cell_id)->model_data);
+    double cell_start = solver_profile_start(profile);
+
+    // The aerosol representations and sub models keep the values calculated
+    // for a grid cell in the shared float data, which now hold those of the
+    // last grid cell of the chunk, so recalculate them for this grid cell
+    if (i_cell < n_cells - 1 && md->rxn_soa->n_generic_rxn > 0) {
+      aero_rep_update_state(cell_md);
+      sub_model_calculate(cell_md);
+    }
+
+    // Add the contributions of the remaining reactions
+    time_derivative_set_from(view->time_deriv, view->chunk_deriv, i_cell,
+                             stride);
+    rxn_calc_deriv_generic(cell_md, view->time_deriv, (double)time_step);
+
+    // Update the deriv array
+    time_derivative_output(
+        view->time_deriv, &(deriv_data[cell_id * n_dep_var]),
+        sd->use_deriv_est == 1 ? &(jac_deriv_data[cell_id * n_dep_var]) : NULL,
+        sd->output_precision);
+
 #ifdef CAMP_DEBUG
-  *RHS_evals_total = sd->counterDeriv;
-  *Jac_evals_total = sd->counterJac;
-  *RHS_time__s = ((double)sd->timeDeriv) / CLOCKS_PER_SEC;
-  *Jac_time__s = ((double)sd->timeJac) / CLOCKS_PER_SEC;
-  *max_loss_precision = sd->max_loss_precision;
-#else
-  *RHS_evals_total = -1;
-  *Jac_evals_total = -1;
-  *RHS_time__s = 0.0;
-  *Jac_time__s = 0.0;
-  *max_loss_precision = 0.0;
-#endif
+    sd->max_loss_precision =
+        time_derivative_max_loss_precision(view->time_deriv);
 #endif
+
+    if (profile->enabled)
+      sd->cell_calc_time[cell_id] += solver_profile_now() - cell_start;
+  }
 }
 
-#ifdef CAMP_USE_SUNDIALS
+/** \brief Get the current integrator time step
+ *
+ * On the first call to f(), the time step hasn't been set yet, so the
+ * default value is used.
+ *
+ * \param sd Pointer to the solver data
+ * \return Current time step (s)
+ */
+realtype solver_get_current_step(SolverData *sd) {
+  realtype time_step = ZERO;
 
-/** \brief Update the model state from the current solver state
+  if (sd->ros_mem != NULL) {
+    time_step = sd->ros_mem->h;
+  } else {
+    CVodeGetCurrentStep(sd->cvode_mem, &time_step);
+  }
+  return time_step > ZERO ? time_step : sd->init_time_step;
+}
+
+/** \brief Check whether the integrator state of the last call can be
+ *         reused
  *
- * \param solver_state Solver state vector
- * \param model_data Pointer to the model data (including the state array)
- * \param threshhold A lower limit for model concentrations below which the
- *                   solver value is replaced with a replacement value
- * \param replacement_value Replacement value for low concentrations
- * \return CAMP_SOLVER_SUCCESS for successful update or
- *         CAMP_SOLVER_FAIL for negative concentration
+ * \param sd Pointer to the solver data with the new solver variables set
+ * \return True if warm starts are enabled, the last call succeeded and no
+ *         solver variable changed by more than the warm start tolerance
  */
-int camp_solver_update_model_state(N_Vector solver_state, ModelData *model_data,
-                                   realtype threshhold,
-                                   realtype replacement_value) {
-  int n_state_var = model_data->n_per_cell_state_var;
-  int n_dep_var = model_data->n_per_cell_dep_var;
-  int n_cells = model_data->n_cells;
+bool solver_can_warm_start(SolverData *sd) {
+  if (sd->warm_start_tol <= 0.0 || sd->y_last == NULL || sd->h_last <= ZERO)
+    return false;
 
-  int i_dep_var = 0;
-  for (int i_cell = 0; i_cell < n_cells; i_cell++) {
-    for (int i_spec = 0; i_spec < n_state_var; ++i_spec) {
-      if (model_data->var_type[i_spec] == CHEM_SPEC_VARIABLE) {
-        if (NV_DATA_S(solver_state)[i_dep_var] < -SMALL) {
-#ifdef FAILURE_DETAIL
-          printf("\nFailed model state update: [spec %d] = %le", i_spec,
-                 NV_DATA_S(solver_state)[i_dep_var]);
-#endif
-          return CAMP_SOLVER_FAIL;
-        }
-        // Assign model state to solver_state
-        model_data->total_state[i_spec + i_cell * n_state_var] =
-            NV_DATA_S(solver_state)[i_dep_var] > threshhold
-                ? NV_DATA_S(solver_state)[i_dep_var]
-                : replacement_value;
-        i_dep_var++;
-      }
+  realtype *y = NV_DATA_S(sd->y);
+  realtype *y_last = NV_DATA_S(sd->y_last);
+  realtype *abs_tol = NV_DATA_S(sd->abs_tol_nv);
+  for (int i = 0; i < NV_LENGTH_S(sd->y); ++i)
+    if (fabs(y[i] - y_last[i]) >
+        sd->warm_start_tol * (fabs(y_last[i]) + abs_tol[i]))
+      return false;
+  return true;
+}
+
+/** \brief Get the environmental state and environment-dependent model data
+ *         arrays of the grid cells
+ *
+ * Together with the solver variables, these data determine the Jacobian.
+ *
+ * \param sd Pointer to the solver data
+ * \param data Set to the arrays (WARM_START_ENV_ARRAYS elements)
+ * \param size Set to the number of elements of each array
+ * \return Total number of elements of the arrays
+ */
+int solver_get_env_data(SolverData *sd, double **data, int *size) {
+  ModelData *md = &(sd->model_data);
+  int n_cells = md->n_cells;
+
+  data[0] = md->total_env;
+  size[0] = n_cells * CAMP_NUM_ENV_PARAM_;
+  data[1] = md->rxn_env_data;
+  size[1] = n_cells * md->n_rxn_env_data;
+  data[2] = md->aero_rep_env_data;
+  size[2] = n_cells * md->n_aero_rep_env_data;
+  data[3] = md->sub_model_env_data;
+  size[3] = n_cells * md->n_sub_model_env_data;
+  return size[0] + size[1] + size[2] + size[3];
+}
+
+/** \brief Check whether the environmental state and environment-dependent
+ *         model data are the same as at the end of the last call
+ *
+ * \param sd Pointer to the solver data
+ * \return True if data of the last call are saved and none of them changed
+ */
+bool solver_env_data_unchanged(SolverData *sd) {
+  double *data[WARM_START_ENV_ARRAYS];
+  int size[WARM_START_ENV_ARRAYS];
+
+  if (sd->env_data_last == NULL) return false;
+  solver_get_env_data(sd, data, size);
+  double *last = sd->env_data_last;
+  for (int i_array = 0; i_array < WARM_START_ENV_ARRAYS; ++i_array) {
+    if (size[i_array] > 0 &&
+        memcmp(last, data[i_array], size[i_array] * sizeof(double)) != 0)
+      return false;
+    last += size[i_array];
+  }
+  return true;
+}
+
+/** \brief Save the integrator state at the end of a successful call for a
+ *         warm start of the next call
+ *
+ * The last Jacobian of the call is kept by the model data (\c J_solver).
+ *
+ * \param sd Pointer to the solver data
+ */
+void solver_save_warm_start(SolverData *sd) {
+  double *data[WARM_START_ENV_ARRAYS];
+  int size[WARM_START_ENV_ARRAYS];
+
+  if (sd->warm_start_tol <= 0.0) return;
+  if (sd->y_last == NULL) sd->y_last = N_VClone(sd->y);
+  N_VScale(1.0, sd->y, sd->y_last);
+  if (sd->ros_mem != NULL) {
+    sd->h_last = sd->ros_mem->h;
+  } else if (CVodeGetCurrentStep(sd->cvode_mem, &(sd->h_last)) != CV_SUCCESS) {
+    sd->h_last = ZERO;
+  }
+
+  // The Jacobian has no blocks for grid cells held constant during the call
+  if (sd->n_active_cells < sd->model_data.n_cells) {
+    free(sd->env_data_last);
+    sd->env_data_last = NULL;
+    return;
+  }
+  int n_data = solver_get_env_data(sd, data, size);
+  if (sd->env_data_last == NULL) {
+    sd->env_data_last = (double *)malloc((n_data + 1) * sizeof(double));
+    if (sd->env_data_last == NULL) {
+      printf("\n\nERROR allocating space for the warm start state\n\n");
+      exit(EXIT_FAILURE);
     }
   }
-  return CAMP_SOLVER_SUCCESS;
+  double *last = sd->env_data_last;
+  for (int i_array = 0; i_array < WARM_START_ENV_ARRAYS; ++i_array) {
+    if (size[i_array] > 0)
+      memcpy(last, data[i_array], size[i_array] * sizeof(double));
+    last += size[i_array];
+  }
+}
+
+/** \brief Attribute new error test failures of the integrator to the grid
+ *         cell with the largest error in the last error norm evaluation
+ *
+ * \param sd Pointer to the solver data with the per-grid-cell error norm
+ */
+void solver_count_cell_error_test_fails(SolverData *sd) {
+  long int n_fails = 0;
+
+  if (sd->ros_mem != NULL) {
+    n_fails = sd->ros_mem->n_err_test_fails;
+  } else if (CVodeGetNumErrTestFails(sd->cvode_mem, &n_fails) != CV_SUCCESS) {
+    return;
+  }
+  cell_norm_count_fails(sd->cell_norm, n_fails);
 }
 
 /** \brief Compute the time derivative f(t,y)
@@ -840,7 +3172,8 @@ int camp_solver_update_model_state(N_Vector solver_state, ModelData *model_data,
  * \param solver_data Pointer to the solver data
  * \return Status code
  */
-int f(realtype t, N_Vector y, N_Vector deriv, void *solver_data) {
+static int solver_calc_deriv(realtype t, N_Vector y, N_Vector deriv,
+                             void *solver_data) {
   SolverData *sd = (SolverData *)solver_data;
   ModelData *md = &(sd->model_data);
   realtype time_step;
@@ -849,6 +3182,10 @@ int f(realtype t, N_Vector y, N_Vector deriv, void *solver_data) {
   sd->counterDeriv++;
 #endif
 
+  // Attribute the steps rejected since the last evaluation to the grid cell
+  // that failed the error test
+  if (sd->cell_norm != NULL) solver_count_cell_error_test_fails(sd);
+
   // Get a pointer to the derivative data
   double *deriv_data = N_VGetArrayPointer(deriv);
 
@@ -857,15 +3194,10 @@ int f(realtype t, N_Vector y, N_Vector deriv, void *solver_data) {
 
   // Get the grid cell dimensions
   int n_cells = md->n_cells;
-  int n_state_var = md->n_per_cell_state_var;
   int n_dep_var = md->n_per_cell_dep_var;
 
   // Get the current integrator time step (s)
-  CVodeGetCurrentStep(sd->cvode_mem, &time_step);
-
-  // On the first call to f(), the time step hasn't been set yet, so use the
-  // default value
-  time_step = time_step > ZERO ? time_step : sd->init_time_step;
+  time_step = solver_get_current_step(sd);
 
   // Update the state array with the current dependent variable values.
   // Signal a recoverable error (positive return value) for negative
@@ -878,6 +3210,10 @@ int f(realtype t, N_Vector y, N_Vector deriv, void *solver_data) {
   SUNMatMatvec(md->J_solver, md->J_tmp, md->J_tmp2);
   N_VLinearSum(1.0, md->J_deriv, 1.0, md->J_tmp2, md->J_tmp);
 
+  // Grid cells that are not integrated during this call are held constant
+  int n_active_cells = sd->n_active_cells;
+  if (n_active_cells < n_cells) N_VConst(ZERO, deriv);
+
 #ifdef CAMP_DEBUG
   // Measure calc_deriv time execution
   clock_t start = clock();
@@ -897,24 +3233,54 @@ int f(realtype t, N_Vector y, N_Vector deriv, void *solver_data) {
   sd->timeDeriv += (end - start);
 #endif
 
+#ifndef CAMP_USE_GPU
+  // Calculate the derivative for chunks of grid cells, when the reaction
+  // contributions are not calculated by a generated kernel
+  if (sd->n_cells_per_chunk > 0 && md->rxn_kernel == NULL &&
+      md->rxn_soa != NULL) {
+    int n_chunks = (n_active_cells + sd->n_cells_per_chunk - 1) /
+                   sd->n_cells_per_chunk;
+#ifdef CAMP_DEBUG
+    clock_t start_chunks = clock();
+#endif
+#ifdef CAMP_USE_OPENMP
+#pragma omp parallel for num_threads(sd->n_cell_views) \
+    schedule(static) if (sd->n_cell_views > 1)
+#endif
+    for (int i_chunk = 0; i_chunk < n_chunks; ++i_chunk) {
+      int first = i_chunk * sd->n_cells_per_chunk;
+      solver_calc_deriv_cell_chunk(
+          sd, &(sd->active_cells[first]),
+          n_active_cells - first < sd->n_cells_per_chunk
+              ? n_active_cells - first
+              : sd->n_cells_per_chunk,
+          time_step, deriv_data, jac_deriv_data);
+    }
+#ifdef CAMP_DEBUG
+    sd->timeDeriv += (clock() - start_chunks);
+#endif
+    return (0);
+  }
+#endif
+
   // Loop through the grid cells and update the derivative array
-  for (int i_cell = 0; i_cell < n_cells; ++i_cell) {
-    // Set the grid cell state pointers
-    md->grid_cell_id = i_cell;
-    md->grid_cell_state = &(md->total_state[i_cell * n_state_var]);
-    md->grid_cell_env = &(md->total_env[i_cell * CAMP_NUM_ENV_PARAM_]);
-    md->grid_cell_rxn_env_data =
-        &(md->rxn_env_data[i_cell * md->n_rxn_env_data]);
-    md->grid_cell_aero_rep_env_data =
-        &(md->aero_rep_env_data[i_cell * md->n_aero_rep_env_data]);
-    md->grid_cell_sub_model_env_data =
-        &(md->sub_model_env_data[i_cell * md->n_sub_model_env_data]);
+#ifdef CAMP_USE_OPENMP
+#pragma omp parallel for num_threads(sd->n_cell_views) \
+    schedule(static) if (sd->n_cell_views > 1)
+#endif
+  for (int i_active = 0; i_active < n_active_cells; ++i_active) {
+    int i_cell = sd->active_cells[i_active];
+
+    // Set up the grid cell view for the current thread
+    GridCellView *view = solver_get_cell_view(sd, i_cell);
+    ModelData *cell_md = &(view->model_data);
+    double cell_start = solver_profile_start(&(view->profile));
 
     // Update the aerosol representations
-    aero_rep_update_state(md);
+    aero_rep_update_state(cell_md);
 
     // Run the sub models
-    sub_model_calculate(md);
+    sub_model_calculate(cell_md);
 
 #ifdef CAMP_DEBUG
     // Measure calc_deriv time execution
@@ -923,41 +3289,61 @@ int f(realtype t, N_Vector y, N_Vector deriv, void *solver_data) {
 
 #ifndef CAMP_USE_GPU
     // Reset the TimeDerivative
-    time_derivative_reset(sd->time_deriv);
+    time_derivative_reset(view->time_deriv);
 
     // Calculate the time derivative f(t,y)
-    rxn_calc_deriv(md, sd->time_deriv, (double)time_step);
+    rxn_calc_deriv(cell_md, view->time_deriv, (double)time_step);
 
     // Update the deriv array
     if (sd->use_deriv_est == 1) {
-      time_derivative_output(sd->time_deriv, deriv_data, jac_deriv_data,
-                             sd->output_precision);
+      time_derivative_output(
+          view->time_deriv, &(deriv_data[i_cell * n_dep_var]),
+          &(jac_deriv_data[i_cell * n_dep_var]), sd->output_precision);
     } else {
-      time_derivative_output(sd->time_deriv, deriv_data, NULL,
+      time_derivative_output(view->time_deriv,
+                             &(deriv_data[i_cell * n_dep_var]), NULL,
                              sd->output_precision);
     }
 #else
     // Add contributions from reactions not implemented on GPU
     // FIXME need to fix this to use TimeDerivative
-    rxn_calc_deriv_specific_types(md, sd->time_deriv, (double)time_step);
+    rxn_calc_deriv_specific_types(cell_md, view->time_deriv,
+                                  (double)time_step);
 #endif
 
 #ifdef CAMP_DEBUG
     clock_t end2 = clock();
     sd->timeDeriv += (end2 - start2);
-    sd->max_loss_precision = time_derivative_max_loss_precision(sd->time_deriv);
+    sd->max_loss_precision =
+        time_derivative_max_loss_precision(view->time_deriv);
 #endif
 
-    // Advance the derivative for the next cell
-    deriv_data += n_dep_var;
-    jac_deriv_data += n_dep_var;
+    if (view->profile.enabled)
+      sd->cell_calc_time[i_cell] += solver_profile_now() - cell_start;
   }
 
   // Return 0 if success
   return (0);
 }
 
+/** \brief Compute the time derivative f(t,y), timed by the profiler
+ *
+ * Arguments and return value are the same as for \c solver_calc_deriv()
+ */
+int f(realtype t, N_Vector y, N_Vector deriv, void *solver_data) {
+  SolverData *sd = (SolverData *)solver_data;
+  double profile_start = solver_profile_start(&(sd->profile));
+  int flag = solver_calc_deriv(t, y, deriv, solver_data);
+  solver_profile_stop(&(sd->profile), CAMP_PROFILE_DERIV, profile_start);
+  return flag;
+}
+
 /** \brief Compute the Jacobian
+ *
+ * The time derivative for y, which CVODE expects in deriv, is calculated in
+ * the same pass over the grid cells as the Jacobian: the aerosol
+ * representations and sub models are updated once per grid cell and each
+ * reaction adds its derivative and Jacobian contributions together.
  *
  * \param t Current model time (s)
  * \param y Dependent variable array
@@ -969,8 +3355,9 @@ int f(realtype t, N_Vector y, N_Vector deriv, void *solver_data) {
  * \param tmp3 Unused vector
  * \return Status code
  */
-int Jac(realtype t, N_Vector y, N_Vector deriv, SUNMatrix J, void *solver_data,
-        N_Vector tmp1, N_Vector tmp2, N_Vector tmp3) {
+static int solver_calc_jac(realtype t, N_Vector y, N_Vector deriv, SUNMatrix J,
+                           void *solver_data, N_Vector tmp1, N_Vector tmp2,
+                           N_Vector tmp3) {
   SolverData *sd = (SolverData *)solver_data;
   ModelData *md = &(sd->model_data);
   realtype time_step;
@@ -979,28 +3366,20 @@ int Jac(realtype t, N_Vector y, N_Vector deriv, SUNMatrix J, void *solver_data,
   sd->counterJac++;
 #endif
 
+  // Attribute the steps rejected since the last evaluation to the grid cell
+  // that failed the error test
+  if (sd->cell_norm != NULL) solver_count_cell_error_test_fails(sd);
+
   // Get the grid cell dimensions
-  int n_state_var = md->n_per_cell_state_var;
   int n_dep_var = md->n_per_cell_dep_var;
   int n_cells = md->n_cells;
 
-  // Get pointers to the rxn and parameter Jacobian arrays
-  double *J_param_data = SM_DATA_S(md->J_params);
-  double *J_rxn_data = SM_DATA_S(md->J_rxn);
-  // Initialize the sparse matrix (sized for one grid cell)
-  // solver_data->model_data.J_rxn =
-  //    SUNSparseMatrix(n_state_var, n_state_var, n_jac_elem_rxn, CSC_MAT);
-
-  // TODO: use this instead of saving all this jacs
-  // double J_rxn_data[md->n_per_cell_dep_var];
-  // memset(J_rxn_data, 0, md->n_per_cell_dep_var * sizeof(double));
-
-  // double *J_rxn_data = (double*)calloc(md->n_per_cell_state_var,
-  // sizeof(double));
+  // The rxn and parameter Jacobian arrays are held by the grid cell views
 
   // !!!! Do not use tmp2 - it is the same as y !!!! //
   // FIXME Find out why cvode is sending tmp2 as y
 
+#ifdef CAMP_USE_GPU
   // Calculate the the derivative for the current state y without
   // the estimated derivative from the last Jacobian calculation
   sd->use_deriv_est = 0;
@@ -1010,6 +3389,10 @@ int Jac(realtype t, N_Vector y, N_Vector deriv, SUNMatrix J, void *solver_data,
     return 1;
   }
   sd->use_deriv_est = 1;
+#endif
+
+  // Get a pointer to the derivative data
+  double *deriv_data = N_VGetArrayPointer(deriv);
 
   // Update the state array with the current dependent variable values
   // Signal a recoverable error (positive return value) for negative
@@ -1018,7 +3401,7 @@ int Jac(realtype t, N_Vector y, N_Vector deriv, SUNMatrix J, void *solver_data,
     return 1;
 
   // Get the current integrator time step (s)
-  CVodeGetCurrentStep(sd->cvode_mem, &time_step);
+  time_step = solver_get_current_step(sd);
 
   // Reset the primary Jacobian
   /// \todo #83 Figure out how to stop CVODE from resizing the Jacobian
@@ -1048,63 +3431,101 @@ int Jac(realtype t, N_Vector y, N_Vector deriv, SUNMatrix J, void *solver_data,
 
   // Solving on CPU only
 
-  // Loop over the grid cells to calculate sub-model and rxn Jacobians
-  for (int i_cell = 0; i_cell < n_cells; ++i_cell) {
-    // Set the grid cell state pointers
-    md->grid_cell_id = i_cell;
-    md->grid_cell_state = &(md->total_state[i_cell * n_state_var]);
-    md->grid_cell_env = &(md->total_env[i_cell * CAMP_NUM_ENV_PARAM_]);
-    md->grid_cell_rxn_env_data =
-        &(md->rxn_env_data[i_cell * md->n_rxn_env_data]);
-    md->grid_cell_aero_rep_env_data =
-        &(md->aero_rep_env_data[i_cell * md->n_aero_rep_env_data]);
-    md->grid_cell_sub_model_env_data =
-        &(md->sub_model_env_data[i_cell * md->n_sub_model_env_data]);
+  // Grid cells that are not integrated during this call are held constant
+  // (zero derivative and Jacobian blocks)
+  if (sd->n_active_cells < n_cells) N_VConst(ZERO, deriv);
+
+  // Loop over the grid cells to calculate the derivative and the sub-model
+  // and rxn Jacobians
+#ifdef CAMP_USE_OPENMP
+#pragma omp parallel for num_threads(sd->n_cell_views) \
+    schedule(static) if (sd->n_cell_views > 1)
+#endif
+  for (int i_active = 0; i_active < sd->n_active_cells; ++i_active) {
+    int i_cell = sd->active_cells[i_active];
 
-    // Reset the sub-model and reaction Jacobians
-    for (int i = 0; i < SM_NNZ_S(md->J_params); ++i)
-      SM_DATA_S(md->J_params)[i] = 0.0;
-    jacobian_reset(sd->jac);
+    // Set up the grid cell view for the current thread
+    GridCellView *view = solver_get_cell_view(sd, i_cell);
+    ModelData *cell_md = &(view->model_data);
+    double *J_param_data = SM_DATA_S(cell_md->J_params);
+    double *J_cell_data =
+        &(SM_DATA_S(J)[i_cell * md->n_per_cell_solver_jac_elem]);
+    Jacobian rxn_jac = view->jac;
+    double cell_start = solver_profile_start(&(view->profile));
 
-    // Update the aerosol representations
-    aero_rep_update_state(md);
+    // Reset the reaction Jacobian
+    jacobian_reset(rxn_jac);
 
-    // Run the sub models and get the sub-model Jacobian
-    sub_model_calculate(md);
-    sub_model_get_jac_contrib(md, J_param_data, time_step);
-    CAMP_DEBUG_JAC(md->J_params, "sub-model Jacobian");
+    // Update the aerosol representations
+    aero_rep_update_state(cell_md);
+
+    // Run the sub models and get the sub-model Jacobian, if any solver
+    // Jacobian elements depend on it
+    sub_model_calculate(cell_md);
+    if (md->n_mapped_values > md->n_direct_mapped_values) {
+      for (int i = 0; i < SM_NNZ_S(cell_md->J_params); ++i)
+        J_param_data[i] = 0.0;
+      sub_model_get_jac_contrib(cell_md, J_param_data, time_step);
+      CAMP_DEBUG_JAC(cell_md->J_params, "sub-model Jacobian");
+    }
 
 #ifdef CAMP_DEBUG
     clock_t start = clock();
 #endif
 
 #ifndef CAMP_USE_GPU
-    // Calculate the reaction Jacobian
-    rxn_calc_jac(md, sd->jac, time_step);
+    // Calculate the time derivative and the reaction Jacobian
+    time_derivative_reset(view->time_deriv);
+    rxn_calc_deriv_jac(cell_md, view->time_deriv, view->jac, time_step);
+
+    // Update the deriv array without the estimated derivative from the last
+    // Jacobian calculation
+    time_derivative_output(view->time_deriv,
+                           &(deriv_data[i_cell * n_dep_var]), NULL,
+                           sd->output_precision);
 #else
     // Add contributions from reactions not implemented on GPU
-    rxn_calc_jac_specific_types(md, sd->jac, time_step);
+    rxn_calc_jac_specific_types(cell_md, view->jac, time_step);
 #endif
 
 // rxn_calc_jac_specific_types(md, J_rxn_data, time_step);
 #ifdef CAMP_DEBUG
     clock_t end = clock();
     sd->timeJac += (end - start);
+#ifndef CAMP_USE_GPU
+    sd->max_loss_precision =
+        time_derivative_max_loss_precision(view->time_deriv);
+#endif
 #endif
 
+#ifdef CAMP_DEBUG
     // Output the Jacobian to the SUNDIALS J_rxn
-    jacobian_output(sd->jac, SM_DATA_S(md->J_rxn));
-    CAMP_DEBUG_JAC(md->J_rxn, "reaction Jacobian");
+    jacobian_output(rxn_jac, SM_DATA_S(cell_md->J_rxn));
+    CAMP_DEBUG_JAC(cell_md->J_rxn, "reaction Jacobian");
+#endif
 
-    // Set the solver Jacobian using the reaction and sub-model Jacobians
+    // Add the reaction Jacobian elements that do not depend on sub-model
+    // parameters directly to their solver Jacobian elements
     JacMap *jac_map = md->jac_map;
-    SM_DATA_S(md->J_params)[0] = 1.0;  // dummy value for non-sub model calcs
-    for (int i_map = 0; i_map < md->n_mapped_values; ++i_map)
-      SM_DATA_S(J)
-      [i_cell * md->n_per_cell_solver_jac_elem + jac_map[i_map].solver_id] +=
-          SM_DATA_S(md->J_rxn)[jac_map[i_map].rxn_id] *
-          SM_DATA_S(md->J_params)[jac_map[i_map].param_id];
+    for (int i_map = 0; i_map < md->n_direct_mapped_values; ++i_map)
+      J_cell_data[jac_map[i_map].solver_id] += (double)CAMP_SUM_DIFF(
+          rxn_jac.production_partials, rxn_jac.production_partials_comp,
+          rxn_jac.loss_partials, rxn_jac.loss_partials_comp,
+          jac_map[i_map].rxn_id);
+
+    // Map the remaining elements through the sub-model Jacobian
+    for (int i_map = md->n_direct_mapped_values; i_map < md->n_mapped_values;
+         ++i_map)
+      J_cell_data[jac_map[i_map].solver_id] +=
+          (double)CAMP_SUM_DIFF(
+              rxn_jac.production_partials, rxn_jac.production_partials_comp,
+              rxn_jac.loss_partials, rxn_jac.loss_partials_comp,
+              jac_map[i_map].rxn_id) *
+          J_param_data[jac_map[i_map].param_id];
     CAMP_DEBUG_JAC(J, "solver Jacobian");
+
+    if (view->profile.enabled)
+      sd->cell_calc_time[i_cell] += solver_profile_now() - cell_start;
   }
 
   // Save the Jacobian for use with derivative calculations
@@ -1125,6 +3546,96 @@ int Jac(realtype t, N_Vector y, N_Vector deriv, SUNMatrix J, void *solver_data,
   return (0);
 }
 
+/** \brief Compute the Jacobian, timed by the profiler
+ *
+ * On warm starts (see \c solver_set_warm_start()), the first evaluation of
+ * a call returns the last Jacobian of the previous call instead. The
+ * Rosenbrock integrators also get f(t,y) from this function, so it is still
+ * calculated for them.
+ *
+ * Arguments and return value are the same as for \c solver_calc_jac()
+ */
+int Jac(realtype t, N_Vector y, N_Vector deriv, SUNMatrix J, void *solver_data,
+        N_Vector tmp1, N_Vector tmp2, N_Vector tmp3) {
+  SolverData *sd = (SolverData *)solver_data;
+  ModelData *md = &(sd->model_data);
+  double profile_start = solver_profile_start(&(sd->profile));
+  int flag = 0;
+
+  if (sd->reuse_jac) {
+    sd->reuse_jac = false;
+    SM_NNZ_S(J) = SM_NNZ_S(md->J_init);
+    for (int i = 0; i <= SM_NP_S(J); i++)
+      (SM_INDEXPTRS_S(J))[i] = (SM_INDEXPTRS_S(md->J_init))[i];
+    for (int i = 0; i < SM_NNZ_S(J); i++) {
+      (SM_INDEXVALS_S(J))[i] = (SM_INDEXVALS_S(md->J_init))[i];
+      (SM_DATA_S(J))[i] = SM_DATA_S(md->J_solver)[i];
+    }
+    if (sd->ros_mem != NULL) flag = f(t, y, deriv, solver_data);
+  } else {
+    flag = solver_calc_jac(t, y, deriv, J, solver_data, tmp1, tmp2, tmp3);
+  }
+  solver_profile_stop(&(sd->profile), CAMP_PROFILE_JAC, profile_start);
+  return flag;
+}
+
+/** \brief Set up the block ILU(0) preconditioner
+ *
+ * \param t Current model time (s)
+ * \param y Dependent variable array
+ * \param fy Time derivative vector f(t,y)
+ * \param jok Flag indicating whether the saved Jacobian can be reused
+ * \param jcurPtr Set to indicate whether the Jacobian was re-evaluated
+ * \param gamma Scalar in the Newton matrix \f$I - \gamma J\f$
+ * \param solver_data Pointer to the solver data
+ * \return Status code
+ */
+int Precond_setup(realtype t, N_Vector y, N_Vector fy, booleantype jok,
+                  booleantype *jcurPtr, realtype gamma, void *solver_data) {
+  SolverData *sd = (SolverData *)solver_data;
+  int flag;
+
+  // Re-evaluate the Jacobian only when the saved one is out of date
+  if (jok == SUNFALSE) {
+    if (Jac(t, y, sd->deriv, sd->J, solver_data, sd->ls_tmp1, y,
+            sd->ls_tmp2) != 0)
+      return 1;
+    *jcurPtr = SUNTRUE;
+  } else {
+    *jcurPtr = SUNFALSE;
+  }
+
+  // Build and factor P = I - gamma J
+  SUNMatCopy(sd->J, sd->P);
+  SUNMatScaleAddI(-gamma, sd->P);
+  flag = SUNLinSolSetup(sd->prec_ls, sd->P);
+  if (flag == SUNLS_SUCCESS) return 0;
+  return flag > 0 ? 1 : -1;
+}
+
+/** \brief Solve the preconditioner system Pz = r
+ *
+ * \param t Current model time (s)
+ * \param y Dependent variable array
+ * \param fy Time derivative vector f(t,y)
+ * \param r Right-hand side vector
+ * \param z Solution vector
+ * \param gamma Scalar in the Newton matrix \f$I - \gamma J\f$
+ * \param delta Tolerance for an iterative solution (unused)
+ * \param lr Flag indicating a left (1) or right (2) preconditioner solve
+ * \param solver_data Pointer to the solver data
+ * \return Status code
+ */
+int Precond_solve(realtype t, N_Vector y, N_Vector fy, N_Vector r, N_Vector z,
+                  realtype gamma, realtype delta, int lr, void *solver_data) {
+  SolverData *sd = (SolverData *)solver_data;
+  int flag;
+
+  flag = SUNLinSolSolve(sd->prec_ls, sd->P, z, r, delta);
+  if (flag == SUNLS_SUCCESS) return 0;
+  return flag > 0 ? 1 : -1;
+}
+
 /** \brief Check a Jacobian for accuracy
  *
  * This function compares Jacobian elements against differences in derivative
@@ -1318,9 +3829,10 @@ double gsl_f(double x, void *param) {
  * \return 1 if corrections were calculated, 0 if not
  */
 #ifdef CAMP_CUSTOM_CVODE
-int guess_helper(const realtype t_n, const realtype h_n, N_Vector y_n,
-                 N_Vector y_n1, N_Vector hf, void *solver_data, N_Vector tmp1,
-                 N_Vector corr) {
+static int solver_improve_guess(const realtype t_n, const realtype h_n,
+                                N_Vector y_n, N_Vector y_n1, N_Vector hf,
+                                void *solver_data, N_Vector tmp1,
+                                N_Vector corr) {
   SolverData *sd = (SolverData *)solver_data;
   realtype *ay_n = NV_DATA_S(y_n);
   realtype *ay_n1 = NV_DATA_S(y_n1);
@@ -1406,6 +3918,24 @@ int guess_helper(const realtype t_n, const realtype h_n, N_Vector y_n,
 
   return 1;
 }
+
+/** \brief Improve the guess for y sent to the linear solver, timed by the
+ *         profiler
+ *
+ * Arguments and return value are the same as for
+ * \c solver_improve_guess()
+ */
+int guess_helper(const realtype t_n, const realtype h_n, N_Vector y_n,
+                 N_Vector y_n1, N_Vector hf, void *solver_data, N_Vector tmp1,
+                 N_Vector corr) {
+  SolverData *sd = (SolverData *)solver_data;
+  double profile_start = solver_profile_start(&(sd->profile));
+  int flag = solver_improve_guess(t_n, h_n, y_n, y_n1, hf, solver_data, tmp1,
+                                  corr);
+  solver_profile_stop(&(sd->profile), CAMP_PROFILE_GUESS_HELPER,
+                      profile_start);
+  return flag;
+}
 #endif
 
 /** \brief Create a sparse Jacobian matrix based on model data
@@ -1682,16 +4212,38 @@ SUNMatrix get_jac_init(SolverData *solver_data) {
     }
   }
 
-  SolverData *sd = solver_data;
-  CAMP_DEBUG_JAC_STRUCT(sd->model_data.J_params, "Param struct");
-  CAMP_DEBUG_JAC_STRUCT(sd->model_data.J_rxn, "Reaction struct");
-  CAMP_DEBUG_JAC_STRUCT(M, "Solver struct");
-
   if (i_mapped_value != n_mapped_values) {
     printf("[ERROR-340355266] Internal error");
     exit(EXIT_FAILURE);
   }
 
+  // Move the map elements that do not depend on sub-model parameters to the
+  // front of the map, keeping the order of each set
+  JacMap *sub_model_map = (JacMap *)malloc(
+      sizeof(JacMap) * (n_mapped_values > 0 ? n_mapped_values : 1));
+  if (sub_model_map == NULL) {
+    printf("\n\nERROR allocating space for jacobian map\n\n");
+    exit(EXIT_FAILURE);
+  }
+  int n_direct_mapped_values = 0;
+  int n_sub_model_mapped_values = 0;
+  for (int i_map = 0; i_map < n_mapped_values; ++i_map) {
+    if (map[i_map].param_id == 0) {
+      map[n_direct_mapped_values++] = map[i_map];
+    } else {
+      sub_model_map[n_sub_model_mapped_values++] = map[i_map];
+    }
+  }
+  for (int i_map = 0; i_map < n_sub_model_mapped_values; ++i_map)
+    map[n_direct_mapped_values + i_map] = sub_model_map[i_map];
+  solver_data->model_data.n_direct_mapped_values = n_direct_mapped_values;
+  free(sub_model_map);
+
+  SolverData *sd = solver_data;
+  CAMP_DEBUG_JAC_STRUCT(sd->model_data.J_params, "Param struct");
+  CAMP_DEBUG_JAC_STRUCT(sd->model_data.J_rxn, "Reaction struct");
+  CAMP_DEBUG_JAC_STRUCT(M, "Solver struct");
+
   // Create vectors to store Jacobian state and derivative data
   solver_data->model_data.J_state = N_VClone(solver_data->y);
   solver_data->model_data.J_deriv = N_VClone(solver_data->y);
@@ -1711,6 +4263,30 @@ SUNMatrix get_jac_init(SolverData *solver_data) {
   return M;
 }
 
+/** \brief Copy the leading grid cells of a block-diagonal Jacobian matrix
+ *
+ * The solver Jacobian is block diagonal with one block per grid cell, so the
+ * first \c n_cols columns form a complete Jacobian for the leading grid cells.
+ *
+ * \param J Block-diagonal Jacobian matrix to copy from
+ * \param n_cols Number of columns (and rows) to copy
+ * \return Sparse Jacobian matrix with the structure and data of the leading
+ *         grid cells
+ */
+SUNMatrix get_jac_init_cells(SUNMatrix J, int n_cols) {
+  int n_elem = SM_INDEXPTRS_S(J)[n_cols];
+  SUNMatrix M = SUNSparseMatrix(n_cols, n_cols, n_elem, CSC_MAT);
+
+  for (int i_col = 0; i_col <= n_cols; ++i_col)
+    SM_INDEXPTRS_S(M)[i_col] = SM_INDEXPTRS_S(J)[i_col];
+  for (int i_elem = 0; i_elem < n_elem; ++i_elem) {
+    SM_INDEXVALS_S(M)[i_elem] = SM_INDEXVALS_S(J)[i_elem];
+    SM_DATA_S(M)[i_elem] = SM_DATA_S(J)[i_elem];
+  }
+
+  return M;
+}
+
 /** \brief Check the return value of a SUNDIALS function
  *
  * \param flag_value A pointer to check (either for NULL, or as an int pointer
@@ -1757,21 +4333,30 @@ void check_flag_fail(void *flag_value, char *func_name, int opt) {
 }
 
 /** \brief Reset the timers for solver functions
+ *
+ * The profiler timers and counters are reset along with the debugging
+ * timers.
  *
  * \param solver_data Pointer to the SolverData object with timers to reset
  */
-#ifdef CAMP_USE_SUNDIALS
 void solver_reset_timers(void *solver_data) {
   SolverData *sd = (SolverData *)solver_data;
 
+  solver_profile_reset(&(sd->profile));
+#ifdef CAMP_USE_SUNDIALS
+  for (int i_view = 0; i_view < sd->n_cell_views; ++i_view)
+    solver_profile_reset(&(sd->cell_views[i_view].profile));
+  for (int i_batch = 0; i_batch < sd->n_batches; ++i_batch)
+    solver_reset_timers(&(sd->batches[i_batch]));
+
 #ifdef CAMP_DEBUG
   sd->counterDeriv = 0;
   sd->counterJac = 0;
   sd->timeDeriv = 0;
   sd->timeJac = 0;
 #endif
-}
 #endif
+}
 
 /** \brief Print solver statistics
  *
@@ -1833,11 +4418,34 @@ void solver_free(void *solver_data) {
   SolverData *sd = (SolverData *)solver_data;
 
 #ifdef CAMP_USE_SUNDIALS
+  // free the independent solvers for batches of grid cells
+  for (int i_batch = 0; i_batch < sd->n_batches; ++i_batch)
+    solver_free_batch(&(sd->batches[i_batch]));
+  free(sd->batches);
+
+  // free the grid cell views
+  solver_free_cell_views(sd);
+
   // free the SUNDIALS solver
   CVodeFree(&(sd->cvode_mem));
 
+  // free the Rosenbrock integrator
+  rosenbrock_free(sd->ros_mem);
+
   // free the absolute tolerance vector
-  N_VDestroy(sd->abs_tol_nv);
+  if (sd->abs_tol_nv != NULL) N_VDestroy(sd->abs_tol_nv);
+
+  // free the warm start state
+  if (sd->y_last != NULL) N_VDestroy(sd->y_last);
+  free(sd->env_data_last);
+
+  // free the list of active grid cells
+  free(sd->active_cells);
+
+  // free the per-grid-cell statistics
+  free(sd->cell_calc_time);
+  free(sd->cell_fails_start);
+  free(sd->cell_fails_end);
 
   // free the TimeDerivative
   time_derivative_free(sd->time_deriv);
@@ -1849,6 +4457,12 @@ void solver_free(void *solver_data) {
   N_VDestroy(sd->y);
   N_VDestroy(sd->deriv);
 
+  // free the per-grid-cell error norm data
+  cell_norm_free(sd->cell_norm);
+
+  // free the grid cell groups
+  solver_free_cell_groups(sd->cell_groups);
+
   // destroy the Jacobian marix
   SUNMatDestroy(sd->J);
 
@@ -1856,7 +4470,14 @@ void solver_free(void *solver_data) {
   SUNMatDestroy(sd->J_guess);
 
   // free the linear solver
-  SUNLinSolFree(sd->ls);
+  if (sd->ls_profiled != NULL) SUNLinSolFree(sd->ls_profiled);
+  if (sd->ls != NULL) SUNLinSolFree(sd->ls);
+
+  // free the preconditioner of the iterative linear solver
+  if (sd->prec_ls != NULL) SUNLinSolFree(sd->prec_ls);
+  if (sd->P != NULL) SUNMatDestroy(sd->P);
+  if (sd->ls_tmp1 != NULL) N_VDestroy(sd->ls_tmp1);
+  if (sd->ls_tmp2 != NULL) N_VDestroy(sd->ls_tmp2);
 #endif
 
   // Free the allocated ModelData
@@ -1867,34 +4488,118 @@ void solver_free(void *solver_data) {
 }
 
 #ifdef CAMP_USE_SUNDIALS
+/** \brief Free the solver objects owned by a batch of grid cells
+ *
+ * Model data shared with the parent solver is not freed.
+ *
+ * \param batch Pointer to the SolverData object for the batch
+ */
+void solver_free_batch(SolverData *batch) {
+  ModelData *md = &(batch->model_data);
+
+  solver_free_cell_views(batch);
+  CVodeFree(&(batch->cvode_mem));
+  rosenbrock_free(batch->ros_mem);
+  N_VDestroy(batch->abs_tol_nv);
+  if (batch->y_last != NULL) N_VDestroy(batch->y_last);
+  free(batch->env_data_last);
+  free(batch->active_cells);
+  free(batch->cell_calc_time);
+  free(batch->cell_fails_start);
+  free(batch->cell_fails_end);
+  SUNLinSolFree(batch->ls_profiled);
+  SUNLinSolFree(batch->ls);
+  if (batch->prec_ls != NULL) SUNLinSolFree(batch->prec_ls);
+  if (batch->P != NULL) SUNMatDestroy(batch->P);
+  if (batch->ls_tmp1 != NULL) N_VDestroy(batch->ls_tmp1);
+  if (batch->ls_tmp2 != NULL) N_VDestroy(batch->ls_tmp2);
+  time_derivative_free(batch->time_deriv);
+  jacobian_free(&(batch->jac));
+  N_VDestroy(batch->y);
+  N_VDestroy(batch->deriv);
+  cell_norm_free(batch->cell_norm);
+  if (batch->n_batch_threads > 1) {
+    free(md->rxn_float_data);
+    free(md->aero_rep_float_data);
+    free(md->sub_model_float_data);
+  }
+  SUNMatDestroy(batch->J);
+  SUNMatDestroy(batch->J_guess);
+  SUNMatDestroy(md->J_init);
+  SUNMatDestroy(md->J_solver);
+  N_VDestroy(md->J_state);
+  N_VDestroy(md->J_deriv);
+  N_VDestroy(md->J_tmp);
+  N_VDestroy(md->J_tmp2);
+}
+#endif
+
+#ifdef CAMP_USE_SUNDIALS
+/** \brief Set all the grid cells of a solver to be integrated
+ *
+ * \param sd Pointer to the solver data
+ */
+void solver_set_all_cells_active(SolverData *sd) {
+  sd->n_active_cells = sd->model_data.n_cells;
+  for (int i_cell = 0; i_cell < sd->n_active_cells; ++i_cell)
+    sd->active_cells[i_cell] = i_cell;
+}
+
 /** \brief Determine if there is anything to solve
  *
- * If the solver state concentrations and the derivative vector are very small,
- * there is no point running the solver
+ * If the solver state concentrations and the derivative vector of a grid
+ * cell are very small, there is no point integrating it. Such grid cells
+ * are removed from the list of active grid cells and are held constant
+ * during the call to the solver, so that f() and Jac() skip them.
+ *
+ * \param sd Pointer to the solver data with the solver variables set
+ * \param t_initial Initial time (s)
+ * \param t_final Final time (s)
+ * \return False if no grid cell needs to be integrated
  */
 bool is_anything_going_on_here(SolverData *sd, realtype t_initial,
                                realtype t_final) {
   ModelData *md = &(sd->model_data);
+  int n_dep_var = md->n_per_cell_dep_var;
+
+  // Evaluate the derivative for all the grid cells
+  solver_set_all_cells_active(sd);
+  if (f(t_initial, sd->y, sd->deriv, sd) != 0) return true;
 
-  if (f(t_initial, sd->y, sd->deriv, sd)) {
-    int i_dep_var = 0;
+  // Estimate the stiffness of each grid cell as the inverse of the shortest
+  // time scale of its solver variables
+  if (sd->cell_stiffness != NULL) {
     for (int i_cell = 0; i_cell < md->n_cells; ++i_cell) {
-      for (int i_spec = 0; i_spec < md->n_per_cell_state_var; ++i_spec) {
-        if (md->var_type[i_spec] == CHEM_SPEC_VARIABLE) {
-          if (NV_Ith_S(sd->y, i_dep_var) >
-              NV_Ith_S(sd->abs_tol_nv, i_dep_var) * 1.0e-10)
-            return true;
-          if (NV_Ith_S(sd->deriv, i_dep_var) * (t_final - t_initial) >
-              NV_Ith_S(sd->abs_tol_nv, i_dep_var) * 1.0e-10)
-            return true;
-          i_dep_var++;
-        }
+      double stiffness = 0.0;
+      for (int i_dep_var = i_cell * n_dep_var;
+           i_dep_var < (i_cell + 1) * n_dep_var; ++i_dep_var) {
+        double rate = fabs(NV_Ith_S(sd->deriv, i_dep_var)) /
+                      (fabs(NV_Ith_S(sd->y, i_dep_var)) +
+                       NV_Ith_S(sd->abs_tol_nv, i_dep_var));
+        if (rate > stiffness) stiffness = rate;
       }
+      sd->cell_stiffness[i_cell] = stiffness;
     }
-    return false;
   }
 
-  return true;
+#ifndef CAMP_USE_GPU
+  // Keep the grid cells with any non-negligible concentration or derivative
+  sd->n_active_cells = 0;
+  for (int i_cell = 0; i_cell < md->n_cells; ++i_cell) {
+    for (int i_dep_var = i_cell * n_dep_var;
+         i_dep_var < (i_cell + 1) * n_dep_var; ++i_dep_var) {
+      if (NV_Ith_S(sd->y, i_dep_var) >
+              NV_Ith_S(sd->abs_tol_nv, i_dep_var) * 1.0e-10 ||
+          NV_Ith_S(sd->deriv, i_dep_var) * (t_final - t_initial) >
+              NV_Ith_S(sd->abs_tol_nv, i_dep_var) * 1.0e-10) {
+        sd->active_cells[sd->n_active_cells++] = i_cell;
+        break;
+      }
+    }
+  }
+#endif
+
+  return sd->n_active_cells > 0;
 }
 #endif
 
@@ -1927,13 +4632,19 @@ void model_free(ModelData model_data) {
   N_VDestroy(model_data.J_deriv);
   N_VDestroy(model_data.J_tmp);
   N_VDestroy(model_data.J_tmp2);
+  rxn_codegen_free(model_data.rxn_kernel);
+  rxn_soa_free(model_data.rxn_soa);
+  rate_table_free(model_data.rate_table);
+  rxn_env_batch_free(model_data.rxn_env_batch);
 #endif
   free(model_data.jac_map);
   free(model_data.jac_map_params);
   free(model_data.var_type);
+  free(model_data.var_state_id);
   free(model_data.rxn_int_data);
   free(model_data.rxn_float_data);
   free(model_data.rxn_env_data);
+  free(model_data.last_env);
   free(model_data.rxn_int_indices);
   free(model_data.rxn_float_indices);
   free(model_data.rxn_env_idx);
@@ -27,8 +27,26 @@ void solver_initialize(void *solver_data, double *abs_tol, double rel_tol,
 int solver_set_debug_out(void *solver_data, bool do_output);
 int solver_set_eval_jac(void *solver_data, bool eval_Jac);
 #endif
+int solver_set_profiling(void *solver_data, bool enabled);
+int solver_set_cell_batch_size(void *solver_data, int n_cells_per_batch);
+int solver_set_cell_grouping(void *solver_data, bool group_cells);
+int solver_set_batch_threads(void *solver_data, int n_batch_threads);
+int solver_set_linear_solver(void *solver_data, int linear_solver);
+int solver_set_integrator(void *solver_data, int integrator);
+int solver_set_warm_start(void *solver_data, double warm_start_tol);
+int solver_set_rate_table(void *solver_data, double rate_table_tol);
+int solver_set_vector_rate_constants(void *solver_data,
+                                     bool vector_rate_constants);
+int solver_set_error_norm(void *solver_data, int error_norm);
+int solver_set_cell_chunk_size(void *solver_data, int n_cells_per_chunk);
+int solver_write_rxn_kernel(void *solver_data, const char *file_path);
+int solver_load_rxn_kernel(void *solver_data, const char *lib_path);
 int solver_run(void *solver_data, double *state, double *env, double t_initial,
                double t_final);
+void *solver_run_async_start(void *solver_data, double *state, double *env,
+                             double t_initial, double t_final);
+int solver_run_async_test(void *async);
+int solver_run_async_wait(void *async);
 void solver_get_statistics(void *solver_data, int *solver_flag, int *num_steps,
                            int *RHS_evals, int *LS_setups,
                            int *error_test_fails, int *NLS_iters,
@@ -37,7 +55,21 @@ void solver_get_statistics(void *solver_data, int *solver_flag, int *num_steps,
                            double *next_time_step__s, int *Jac_eval_fails,
                            int *RHS_evals_total, int *Jac_evals_total,
                            double *RHS_time__s, double *Jac_time__s,
-                           double *max_loss_precision);
+                           double *max_loss_precision, double *phase_time__s,
+                           long int *phase_calls, double *rxn_time__s,
+                           long int *rxn_calls);
+int solver_get_cell_error_test_fails(void *solver_data, int *n_fails);
+int solver_get_cell_statistics(void *solver_data, int *num_steps,
+                               int *RHS_evals, int *Jac_evals, int *NLS_iters,
+                               int *NLS_convergence_fails,
+                               int *error_test_fails,
+                               double *last_time_step__s,
+                               double *solve_time__s, double *calc_time__s);
+void solver_reset_timers(void *solver_data);
+void solver_add_profile(SolverData *sd, SolverProfile *total);
+void solver_set_profiled_eval_stats(const SolverProfile *profile,
+                                    int *RHS_evals_total, int *Jac_evals_total,
+                                    double *RHS_time__s, double *Jac_time__s);
 void solver_free(void *solver_data);
 void model_free(ModelData model_data);
 
@@ -46,6 +78,10 @@ void model_free(ModelData model_data);
 int f(realtype t, N_Vector y, N_Vector deriv, void *model_data);
 int Jac(realtype t, N_Vector y, N_Vector deriv, SUNMatrix J, void *model_data,
         N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+int Precond_setup(realtype t, N_Vector y, N_Vector fy, booleantype jok,
+                  booleantype *jcurPtr, realtype gamma, void *solver_data);
+int Precond_solve(realtype t, N_Vector y, N_Vector fy, N_Vector r, N_Vector z,
+                  realtype gamma, realtype delta, int lr, void *solver_data);
 int guess_helper(const realtype t_n, const realtype h_n, N_Vector y_n,
                  N_Vector y_n1, N_Vector hf, void *solver_data, N_Vector tmp1,
                  N_Vector corr);
@@ -53,15 +89,59 @@ void error_handler(int error_code, const char *module, const char *function,
                    char *msg, void *sd);
 
 /* SUNDIALS support functions */
+void solver_initialize_integrator(SolverData *sd, double rel_tol,
+                                  int max_steps, int max_conv_fails);
+void solver_initialize_cvode(SolverData *sd, double rel_tol, int max_steps,
+                             int max_conv_fails);
+void solver_initialize_spgmr(SolverData *sd);
+void solver_initialize_rosenbrock(SolverData *sd, double rel_tol,
+                                  int max_steps);
+void solver_set_abs_tol_nv(SolverData *sd);
+void solver_new_direct_linear_solver(SolverData *sd);
+realtype solver_get_current_step(SolverData *sd);
+bool solver_can_warm_start(SolverData *sd);
+int solver_get_env_data(SolverData *sd, double **data, int *size);
+bool solver_env_data_unchanged(SolverData *sd);
+void solver_save_warm_start(SolverData *sd);
+void solver_count_cell_error_test_fails(SolverData *sd);
+void solver_new_batch(SolverData *sd, SolverData *batch, int first_cell,
+                      int n_cells);
+int solver_run_batches(SolverData *sd, double *state, double *env,
+                       double t_initial, double t_final);
+CellGroups *solver_new_cell_groups(SolverData *sd);
+void solver_group_cells(SolverData *sd, double *state, double *env);
+void solver_ungroup_cells(SolverData *sd, double *state);
+void solver_free_cell_groups(CellGroups *groups);
+void solver_get_batch_statistics(
+    SolverData *sd, int *solver_flag, int *num_steps, int *RHS_evals,
+    int *LS_setups, int *error_test_fails, int *NLS_iters,
+    int *NLS_convergence_fails, int *DLS_Jac_evals, int *DLS_RHS_evals,
+    double *last_time_step__s, double *next_time_step__s, int *Jac_eval_fails,
+    int *RHS_evals_total, int *Jac_evals_total, double *RHS_time__s,
+    double *Jac_time__s, double *max_loss_precision);
+void solver_free_batch(SolverData *batch);
+void solver_initialize_cell_views(SolverData *sd);
+double *solver_copy_float_data(double *data, int n_data);
+void solver_update_env_state(SolverData *sd);
+void solver_update_cell_views(SolverData *sd);
+void solver_update_batch_params(SolverData *sd, SolverData *batch);
+GridCellView *solver_get_cell_view(SolverData *sd, int i_cell);
+GridCellView *solver_set_cell_view(SolverData *sd, GridCellView *view,
+                                   int i_cell);
+void solver_free_cell_views(SolverData *sd);
+void solver_calc_deriv_cell_chunk(SolverData *sd, const int *cell_ids,
+                                  int n_cells, realtype time_step,
+                                  double *deriv_data, double *jac_deriv_data);
+void solver_set_all_cells_active(SolverData *sd);
 int camp_solver_update_model_state(N_Vector solver_state, ModelData *model_data,
                                    realtype threshhold,
                                    realtype replacement_value);
 SUNMatrix get_jac_init(SolverData *solver_data);
+SUNMatrix get_jac_init_cells(SUNMatrix J, int n_cols);
 bool check_Jac(realtype t, N_Vector y, SUNMatrix J, N_Vector deriv,
                N_Vector tmp, N_Vector tmp1, void *solver_data);
 int check_flag(void *flag_value, char *func_name, int opt);
 void check_flag_fail(void *flag_value, char *func_name, int opt);
-void solver_reset_timers(void *solver_data);
 static void solver_print_stats(void *cvode_mem);
 static void print_data_sizes(ModelData *md);
 static void print_jacobian(SUNMatrix M);
@@ -0,0 +1,173 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Per-grid-cell error norm of multi-cell solver vectors
+ *
+ */
+/** \file
+ * \brief Per-grid-cell error norm of multi-cell solver vectors
+ */
+#include "cell_norm.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Serial vector operations with the cell norm data. The generic operations
+ * must be the first member, so that the structure can be used and freed as
+ * the vector operations. */
+typedef struct {
+  struct _generic_N_Vector_Ops ops;  // Vector operations
+  CellNorm *norm;                    // Cell norm data (not owned)
+} CellNormOps;
+
+/** \brief Replace the operations of a vector with cell norm operations
+ *
+ * \param v Serial vector whose operations are copied and replaced
+ * \param norm Cell norm data
+ * \return 0 on success, -1 if the operations could not be allocated
+ */
+static int cell_norm_set_ops(N_Vector v, CellNorm *norm) {
+  CellNormOps *ops = (CellNormOps *)malloc(sizeof(CellNormOps));
+  if (ops == NULL) return -1;
+  ops->ops = *(v->ops);
+  ops->norm = norm;
+  free(v->ops);
+  v->ops = &(ops->ops);
+  return 0;
+}
+
+/** \brief Clone a vector with the cell norm operations
+ *
+ * \param w Vector to clone
+ * \return New vector with allocated data, or NULL on failure
+ */
+static N_Vector cell_norm_clone(N_Vector w) {
+  N_Vector v = N_VClone_Serial(w);
+  if (v == NULL) return NULL;
+  if (cell_norm_set_ops(v, ((CellNormOps *)w->ops)->norm) != 0) {
+    N_VDestroy(v);
+    return NULL;
+  }
+  return v;
+}
+
+/** \brief Clone a vector with the cell norm operations without data
+ *
+ * \param w Vector to clone
+ * \return New vector without data, or NULL on failure
+ */
+static N_Vector cell_norm_clone_empty(N_Vector w) {
+  N_Vector v = N_VCloneEmpty_Serial(w);
+  if (v == NULL) return NULL;
+  if (cell_norm_set_ops(v, ((CellNormOps *)w->ops)->norm) != 0) {
+    N_VDestroy(v);
+    return NULL;
+  }
+  return v;
+}
+
+/** \brief Create the cell norm data for a multi-cell solver
+ *
+ * \param n_cells Number of grid cells
+ * \param cell_size Number of solver variables per grid cell
+ * \return New cell norm data
+ */
+CellNorm *cell_norm_new(int n_cells, int cell_size) {
+  CellNorm *norm = (CellNorm *)malloc(sizeof(CellNorm));
+  if (norm == NULL) {
+    printf("\n\nERROR allocating space for the cell norm\n\n");
+    exit(EXIT_FAILURE);
+  }
+  norm->n_cells = n_cells;
+  norm->cell_size = cell_size;
+  norm->last_worst_cell = 0;
+  norm->n_fails_counted = 0;
+  norm->n_err_test_fails = (long int *)calloc(n_cells, sizeof(long int));
+  if (norm->n_err_test_fails == NULL) {
+    printf("\n\nERROR allocating space for the cell error test failures\n\n");
+    exit(EXIT_FAILURE);
+  }
+  return norm;
+}
+
+/** \brief Use the per-grid-cell error norm for a serial vector and its
+ *         clones
+ *
+ * The vector must be attached before the integrator creates its work
+ * vectors from it. The cell norm data must outlive the vector and its
+ * clones.
+ *
+ * \param v Serial vector with n_cells * cell_size elements
+ * \param norm Cell norm data
+ * \return 0 on success, -1 on failure
+ */
+int cell_norm_attach(N_Vector v, CellNorm *norm) {
+  if (NV_LENGTH_S(v) != (sunindextype)norm->n_cells * norm->cell_size)
+    return -1;
+  if (cell_norm_set_ops(v, norm) != 0) return -1;
+  v->ops->nvclone = cell_norm_clone;
+  v->ops->nvcloneempty = cell_norm_clone_empty;
+  v->ops->nvwrmsnorm = cell_norm_wrms;
+  return 0;
+}
+
+/** \brief Largest of the weighted root-mean-square norms of the grid cells
+ *
+ * The grid cell with the largest norm is saved as the last worst cell.
+ *
+ * \param x Vector with the cell norm operations
+ * \param w Weights
+ * \return Largest WRMS norm of the grid cells of x
+ */
+realtype cell_norm_wrms(N_Vector x, N_Vector w) {
+  CellNorm *norm = ((CellNormOps *)x->ops)->norm;
+  realtype *x_data = NV_DATA_S(x);
+  realtype *w_data = NV_DATA_S(w);
+  int cell_size = norm->cell_size;
+  realtype max_sum = -1.0;
+  int worst_cell = 0;
+
+  for (int i_cell = 0; i_cell < norm->n_cells; ++i_cell) {
+    realtype *x_cell = &(x_data[i_cell * cell_size]);
+    realtype *w_cell = &(w_data[i_cell * cell_size]);
+    realtype sum = 0.0;
+    for (int i = 0; i < cell_size; ++i)
+      sum += (x_cell[i] * w_cell[i]) * (x_cell[i] * w_cell[i]);
+    if (sum > max_sum) {
+      max_sum = sum;
+      worst_cell = i_cell;
+    }
+  }
+  norm->last_worst_cell = worst_cell;
+  return sqrt(max_sum / cell_size);
+}
+
+/** \brief Attribute new rejected steps to the last worst grid cell
+ *
+ * The integrators evaluate the error norm of a step and then reject it or
+ * start the next step before evaluating the right-hand side again, so when
+ * this is called from the right-hand side function the last worst cell is
+ * the one that failed the last error test.
+ *
+ * \param norm Cell norm data
+ * \param n_fails Number of error test failures of the integrator in the
+ *                current integration
+ */
+void cell_norm_count_fails(CellNorm *norm, long int n_fails) {
+  if (n_fails > norm->n_fails_counted) {
+    norm->n_err_test_fails[norm->last_worst_cell] +=
+        n_fails - norm->n_fails_counted;
+  }
+  norm->n_fails_counted = n_fails;
+}
+
+/** \brief Free the cell norm data
+ *
+ * \param norm Cell norm data
+ */
+void cell_norm_free(CellNorm *norm) {
+  if (norm == NULL) return;
+  free(norm->n_err_test_fails);
+  free(norm);
+}
@@ -0,0 +1,47 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Header for the per-grid-cell error norm of multi-cell solver vectors
+ *
+ */
+/** \file
+ * \brief Header for the per-grid-cell error norm of multi-cell solver
+ *        vectors
+ *
+ * The integrators measure errors with the weighted root-mean-square norm of
+ * the full solver vector, so with many grid cells integrated as one system
+ * a large error in one grid cell can be averaged out by the others. Serial
+ * vectors with a cell norm attached instead return the largest of the WRMS
+ * norms of the grid cells, so the error tests enforce the tolerances in
+ * every grid cell. The norm is set through the vector operations, which
+ * are copied to every clone, so all the work vectors of an integrator
+ * created from an attached vector use it.
+ *
+ * The grid cell with the largest norm in the last evaluation is saved, so
+ * that rejected steps can be attributed to the grid cell that caused them.
+ */
+#ifndef CELL_NORM_H_
+#define CELL_NORM_H_
+
+#include <nvector/nvector_serial.h>
+
+/* Per-grid-cell error norm data shared by the vectors of a solver */
+typedef struct CellNorm {
+  int n_cells;                // Number of grid cells
+  int cell_size;              // Number of solver variables per grid cell
+  int last_worst_cell;        // Grid cell with the largest norm in the last
+                              // norm evaluation
+  long int n_fails_counted;   // Number of rejected steps of the current
+                              // integration already attributed to a cell
+  long int *n_err_test_fails; // Number of rejected steps attributed to each
+                              // grid cell
+} CellNorm;
+
+CellNorm *cell_norm_new(int n_cells, int cell_size);
+int cell_norm_attach(N_Vector v, CellNorm *norm);
+realtype cell_norm_wrms(N_Vector x, N_Vector w);
+void cell_norm_count_fails(CellNorm *norm, long int n_fails);
+void cell_norm_free(CellNorm *norm);
+
+#endif
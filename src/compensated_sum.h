@@ -0,0 +1,81 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Header file for the rate and partial derivative accumulators
+ *
+ */
+/** \file
+ * \brief Accumulators for the production and loss rates and partial
+ *        derivatives
+ *
+ * By default, production and loss terms are accumulated in long double, so
+ * that the cancellation when they are subtracted does not lose precision.
+ * When CAMP is built with CAMP_USE_COMPENSATED_SUM, they are instead
+ * accumulated in double with a separate array of running compensations for
+ * the rounding error of each addition (Neumaier's variant of Kahan
+ * summation), which keeps the extra precision without x87 arithmetic and
+ * halves the size of the accumulator arrays.
+ *
+ * Accumulator arrays are updated and read through the macros below, which
+ * ignore the compensation array in long double builds.
+ *
+ * The rate and partial derivative contributions added to the accumulators
+ * are calculated in CampSum as well, so compensated builds do no long double
+ * arithmetic in the f() and Jac() reaction loops.
+ */
+#ifndef COMPENSATED_SUM_H
+#define COMPENSATED_SUM_H
+#include <math.h>
+
+#ifdef CAMP_USE_COMPENSATED_SUM
+
+/* Accumulator and contribution type */
+typedef double CampSum;
+
+/** \brief Add a value to a compensated sum
+ *
+ * \param sum Pointer to the sum
+ * \param comp Pointer to the compensation for the sum
+ * \param value Value to add
+ */
+static inline void compensated_sum_add(double *sum, double *comp,
+                                       double value) {
+  double t = *sum + value;
+  if (fabs(*sum) >= fabs(value)) {
+    *comp += (*sum - t) + value;
+  } else {
+    *comp += (value - t) + *sum;
+  }
+  *sum = t;
+}
+
+// Add a value to element i of an accumulator array
+#define CAMP_SUM_ADD(sum, comp, i, value) \
+  compensated_sum_add(&((sum)[i]), &((comp)[i]), (value))
+
+// Value of element i of an accumulator array
+#define CAMP_SUM_VALUE(sum, comp, i) ((sum)[i] + (comp)[i])
+
+// Difference between element i of two accumulator arrays. The sums are
+// subtracted before the compensations so that no precision is lost when
+// they nearly cancel.
+#define CAMP_SUM_DIFF(sum_a, comp_a, sum_b, comp_b, i) \
+  (((sum_a)[i] - (sum_b)[i]) + ((comp_a)[i] - (comp_b)[i]))
+
+// Absolute value of an accumulator or contribution
+#define CAMP_SUM_FABS(x) fabs(x)
+
+#else
+
+/* Accumulator and contribution type */
+typedef long double CampSum;
+
+#define CAMP_SUM_ADD(sum, comp, i, value) ((sum)[i] += (value))
+#define CAMP_SUM_VALUE(sum, comp, i) ((sum)[i])
+#define CAMP_SUM_DIFF(sum_a, comp_a, sum_b, comp_b, i) \
+  ((sum_a)[i] - (sum_b)[i])
+#define CAMP_SUM_FABS(x) fabsl(x)
+
+#endif
+#endif
@@ -0,0 +1,408 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Tabulated temperature- and pressure-dependent reaction parameters
+ *
+ */
+/** \file
+ * \brief Construction and interpolation of the tabulated temperature- and
+ *        pressure-dependent reaction parameters
+ */
+#include "rate_table.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rxn_solver.h"
+
+// Number of grid intervals of the coarsest table
+#define RATE_TABLE_TEMP_START 16
+#define RATE_TABLE_PRESS_START 4
+
+// Number of grid intervals of the finest table
+#define RATE_TABLE_TEMP_MAX_INTERVALS 256
+#define RATE_TABLE_PRESS_MAX_INTERVALS 128
+
+// Number of parts each grid interval is divided into to check the
+// interpolation error (the error is checked at the interior points 1/4, 1/2
+// and 3/4 of the intervals in each dimension)
+#define RATE_TABLE_CHECK_DIV 4
+
+// Safety factor on the tolerance for the interpolation error at the checked
+// points, which covers the error between them
+#define RATE_TABLE_CHECK_SAFETY 2.0
+
+// Loops over the tabulated parameters have no dependencies between
+// iterations
+#ifdef CAMP_USE_OPENMP
+#define RATE_TABLE_SIMD _Pragma("omp simd")
+#else
+#define RATE_TABLE_SIMD
+#endif
+
+/** \brief Check whether the parameters of a reaction can be tabulated
+ *
+ * \param model_data Pointer to the model data
+ * \param i_rxn Index of the reaction
+ * \return true for reactions whose parameters only depend on temperature,
+ *         pressure and constant reaction data
+ */
+static bool rate_table_is_candidate(ModelData *model_data, int i_rxn) {
+  switch (model_data->rxn_int_data[model_data->rxn_int_indices[i_rxn]]) {
+    case RXN_AQUEOUS_EQUILIBRIUM:
+    case RXN_ARRHENIUS:
+    case RXN_CMAQ_H2O2:
+    case RXN_CMAQ_OH_HNO3:
+    case RXN_TERNARY_CHEMICAL_ACTIVATION:
+    case RXN_TROE:
+    case RXN_WENNBERG_NO_RO2:
+    case RXN_WENNBERG_TUNNELING:
+      return true;
+  }
+  return false;
+}
+
+/** \brief Calculate the environment-dependent parameters of all reactions
+ *         directly
+ *
+ * \param calc_md Model data whose grid cell environmental state and reaction
+ *                environment-dependent data point to work arrays
+ * \param temp Temperature (K)
+ * \param press Pressure (Pa)
+ */
+static void rate_table_calc(ModelData *calc_md, double temp, double press) {
+  calc_md->grid_cell_env[0] = temp;
+  calc_md->grid_cell_env[1] = press;
+  memset(calc_md->grid_cell_rxn_env_data, 0,
+         calc_md->n_rxn_env_data * sizeof(double));
+  rxn_update_env_state(calc_md);
+}
+
+/** \brief Get the cubic Lagrange interpolation weights on a uniform grid
+ *
+ * \param x Point to interpolate at
+ * \param x_min Position of the first grid node
+ * \param dx Grid spacing
+ * \param n Number of grid intervals (at least 3)
+ * \param w Weights of the four grid nodes used
+ * \return Index of the first grid node used
+ */
+static int rate_table_weights(double x, double x_min, double dx, int n,
+                              double *w) {
+  double s = (x - x_min) / dx;
+  int i = (int)floor(s);
+  if (i < 1) i = 1;
+  if (i > n - 2) i = n - 2;
+  double u = s - i;
+  w[0] = -u * (u - 1.0) * (u - 2.0) / 6.0;
+  w[1] = (u + 1.0) * (u - 1.0) * (u - 2.0) / 2.0;
+  w[2] = -(u + 1.0) * u * (u - 2.0) / 2.0;
+  w[3] = (u + 1.0) * u * (u - 1.0) / 6.0;
+  return i - 1;
+}
+
+/** \brief Interpolate the tabulated parameters
+ *
+ * \param table Rate table
+ * \param temp Temperature (K)
+ * \param press Pressure (Pa)
+ * \param param Interpolated parameters [n_param]
+ */
+static void rate_table_interpolate(RateTable *table, double temp, double press,
+                                   double *param) {
+  double w_temp[4], w_press[4];
+  int i_temp = rate_table_weights(temp, RATE_TABLE_TEMP_MIN, table->d_temp,
+                                  table->n_temp, w_temp);
+  int i_press = rate_table_weights(log(press), log(RATE_TABLE_PRESS_MIN),
+                                   table->d_log_press, table->n_press,
+                                   w_press);
+  int n_param = table->n_param;
+
+  RATE_TABLE_SIMD
+  for (int i_param = 0; i_param < n_param; ++i_param) param[i_param] = 0.0;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      double w = w_temp[i] * w_press[j];
+      const double *node =
+          &(table->values[((i_temp + i) * (table->n_press + 1) + i_press + j) *
+                          n_param]);
+      RATE_TABLE_SIMD
+      for (int i_param = 0; i_param < n_param; ++i_param)
+        param[i_param] += w * node[i_param];
+    }
+  }
+}
+
+/** \brief Set the tabulated parameters from the tabulated reactions
+ *
+ * \param table Rate table
+ * \param model_data Pointer to the model data
+ */
+static void rate_table_set_params(RateTable *table, ModelData *model_data) {
+  table->n_param = 0;
+  for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn) {
+    if (!table->tabulated[i_rxn]) continue;
+    for (int i_env = model_data->rxn_env_idx[i_rxn];
+         i_env < model_data->rxn_env_idx[i_rxn + 1]; ++i_env)
+      table->env_id[table->n_param++] = i_env;
+  }
+}
+
+/** \brief Get the temperature of a point on the grid
+ *
+ * \param table Rate table
+ * \param i_temp Index of the point in units of 1/RATE_TABLE_CHECK_DIV grid
+ *               intervals
+ * \return Temperature (K)
+ */
+static double rate_table_temp(RateTable *table, int i_temp) {
+  return RATE_TABLE_TEMP_MIN +
+         (double)i_temp / RATE_TABLE_CHECK_DIV * table->d_temp;
+}
+
+/** \brief Get the pressure of a point on the grid
+ *
+ * \param table Rate table
+ * \param i_press Index of the point in units of 1/RATE_TABLE_CHECK_DIV grid
+ *                intervals
+ * \return Pressure (Pa)
+ */
+static double rate_table_press(RateTable *table, int i_press) {
+  return RATE_TABLE_PRESS_MIN *
+         exp((double)i_press / RATE_TABLE_CHECK_DIV * table->d_log_press);
+}
+
+/** \brief Calculate the tabulated parameters at the grid nodes
+ *
+ * \param table Rate table
+ * \param calc_md Model data for direct calculations
+ */
+static void rate_table_fill(RateTable *table, ModelData *calc_md) {
+  int n_param = table->n_param;
+
+  table->d_temp = (RATE_TABLE_TEMP_MAX - RATE_TABLE_TEMP_MIN) / table->n_temp;
+  table->d_log_press =
+      log(RATE_TABLE_PRESS_MAX / RATE_TABLE_PRESS_MIN) / table->n_press;
+
+  free(table->values);
+  table->values = (double *)malloc((table->n_temp + 1) *
+                                   (table->n_press + 1) * n_param *
+                                   sizeof(double));
+  if (table->values == NULL) {
+    printf("\n\nERROR allocating space for the rate table\n\n");
+    exit(EXIT_FAILURE);
+  }
+  for (int i_temp = 0; i_temp <= table->n_temp; ++i_temp) {
+    for (int i_press = 0; i_press <= table->n_press; ++i_press) {
+      rate_table_calc(calc_md,
+                      rate_table_temp(table, RATE_TABLE_CHECK_DIV * i_temp),
+                      rate_table_press(table, RATE_TABLE_CHECK_DIV * i_press));
+      double *node = &(
+          table->values[(i_temp * (table->n_press + 1) + i_press) * n_param]);
+      for (int i_param = 0; i_param < n_param; ++i_param)
+        node[i_param] = calc_md->grid_cell_rxn_env_data[table->env_id[i_param]];
+    }
+  }
+}
+
+/** \brief Check the interpolation error at interior points of the grid
+ *         intervals
+ *
+ * The interpolation error of the cubic polynomials varies within each grid
+ * interval (e.g., it is largest off the midpoint in the first and last
+ * intervals, where the four grid nodes used are not centered). The error is
+ * therefore checked at the points 1/4, 1/2 and 3/4 of the intervals in each
+ * dimension, and must be within the tolerance divided by a safety factor
+ * for the error between these points.
+ *
+ * \param table Rate table
+ * \param model_data Pointer to the model data
+ * \param calc_md Model data for direct calculations
+ * \param failed Flags set for the tabulated reactions with any parameter
+ *               outside the tolerance [n_rxn]
+ * \param refine_temp Flag set when the temperature grid is too coarse
+ * \param refine_press Flag set when the pressure grid is too coarse
+ * \return Number of tabulated reactions outside the tolerance
+ */
+static int rate_table_check(RateTable *table, ModelData *model_data,
+                            ModelData *calc_md, bool *failed,
+                            bool *refine_temp, bool *refine_press) {
+  double *exact = calc_md->grid_cell_rxn_env_data;
+  double tol = table->tol / RATE_TABLE_CHECK_SAFETY;
+  int n_failed = 0;
+
+  *refine_temp = false;
+  *refine_press = false;
+  for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn) failed[i_rxn] = false;
+  for (int i_temp = 0; i_temp <= RATE_TABLE_CHECK_DIV * table->n_temp;
+       ++i_temp) {
+    for (int i_press = 0; i_press <= RATE_TABLE_CHECK_DIV * table->n_press;
+         ++i_press) {
+      bool temp_node = i_temp % RATE_TABLE_CHECK_DIV == 0;
+      bool press_node = i_press % RATE_TABLE_CHECK_DIV == 0;
+
+      // The interpolation is exact at the grid nodes
+      if (temp_node && press_node) continue;
+      double temp = rate_table_temp(table, i_temp);
+      double press = rate_table_press(table, i_press);
+      bool point_failed = false;
+      rate_table_calc(calc_md, temp, press);
+      rate_table_interpolate(table, temp, press, table->cell_param);
+      int i_param = 0;
+      for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn) {
+        if (!table->tabulated[i_rxn]) continue;
+        for (int i_env = model_data->rxn_env_idx[i_rxn];
+             i_env < model_data->rxn_env_idx[i_rxn + 1]; ++i_env) {
+          double approx = table->cell_param[i_param++];
+          if (!isfinite(exact[i_env]) ||
+              !(fabs(approx - exact[i_env]) <= tol * fabs(exact[i_env]))) {
+            if (!failed[i_rxn]) ++n_failed;
+            failed[i_rxn] = true;
+            point_failed = true;
+          }
+        }
+      }
+
+      // Points on pressure grid lines only have temperature interpolation
+      // errors, and vice versa
+      if (point_failed) {
+        if (!temp_node) *refine_temp = true;
+        if (!press_node) *refine_press = true;
+      }
+    }
+  }
+  return n_failed;
+}
+
+/** \brief Build the rate table for a set of reactions
+ *
+ * \param model_data Pointer to the model data with all the reactions added
+ * \param tol Maximum relative interpolation error
+ * \return New rate table, or NULL if no reaction parameters can be tabulated
+ */
+RateTable *rate_table_new(ModelData *model_data, double tol) {
+  int n_rxn = model_data->n_rxn;
+  int n_env_data = model_data->n_rxn_env_data;
+
+  RateTable *table = (RateTable *)malloc(sizeof(RateTable));
+  if (table == NULL) {
+    printf("\n\nERROR allocating space for the rate table\n\n");
+    exit(EXIT_FAILURE);
+  }
+  table->tol = tol;
+  table->n_temp = RATE_TABLE_TEMP_START;
+  table->n_press = RATE_TABLE_PRESS_START;
+  table->n_param = 0;
+  table->values = NULL;
+  table->tabulated = (bool *)malloc((n_rxn + 1) * sizeof(bool));
+  table->env_id = (int *)malloc((n_env_data + 1) * sizeof(int));
+  table->cell_param = (double *)malloc((n_env_data + 1) * sizeof(double));
+  table->cell_ids = (int *)malloc((model_data->n_cells + 1) * sizeof(int));
+  bool *failed = (bool *)malloc((n_rxn + 1) * sizeof(bool));
+  double *calc_env_data = (double *)malloc((n_env_data + 1) * sizeof(double));
+  if (table->tabulated == NULL || table->env_id == NULL ||
+      table->cell_param == NULL || table->cell_ids == NULL || failed == NULL ||
+      calc_env_data == NULL) {
+    printf("\n\nERROR allocating space for the rate table\n\n");
+    exit(EXIT_FAILURE);
+  }
+  for (int i_rxn = 0; i_rxn < n_rxn; ++i_rxn)
+    table->tabulated[i_rxn] = rate_table_is_candidate(model_data, i_rxn);
+
+  // Model data for direct calculations of all the reactions
+  double calc_env[CAMP_NUM_ENV_PARAM_];
+  ModelData calc_md = *model_data;
+  calc_md.rate_table = NULL;
+  calc_md.rxn_env_batch = NULL;
+  calc_md.grid_cell_env = calc_env;
+  calc_md.grid_cell_rxn_env_data = calc_env_data;
+
+  // Halve the grid spacing until all the tabulated reactions are within the
+  // tolerance, and calculate the remaining ones directly
+  for (;;) {
+    bool refine_temp, refine_press, refined = false;
+    rate_table_set_params(table, model_data);
+    if (table->n_param == 0) break;
+    rate_table_fill(table, &calc_md);
+    if (rate_table_check(table, model_data, &calc_md, failed, &refine_temp,
+                         &refine_press) == 0)
+      break;
+    if (refine_temp && table->n_temp < RATE_TABLE_TEMP_MAX_INTERVALS) {
+      table->n_temp *= 2;
+      refined = true;
+    }
+    if (refine_press && table->n_press < RATE_TABLE_PRESS_MAX_INTERVALS) {
+      table->n_press *= 2;
+      refined = true;
+    }
+    if (refined) continue;
+
+    // Start again from the coarsest grid without the reactions that cannot
+    // be tabulated, which may have forced a finer grid than the others need
+    for (int i_rxn = 0; i_rxn < n_rxn; ++i_rxn)
+      if (failed[i_rxn]) table->tabulated[i_rxn] = false;
+    table->n_temp = RATE_TABLE_TEMP_START;
+    table->n_press = RATE_TABLE_PRESS_START;
+  }
+
+  free(failed);
+  free(calc_env_data);
+  if (table->n_param == 0) {
+    rate_table_free(table);
+    return NULL;
+  }
+  return table;
+}
+
+/** \brief Check whether an environmental state is within the table range
+ *
+ * \param table Rate table
+ * \param env Environmental state of a grid cell
+ * \return true if the tabulated parameters can be interpolated
+ */
+bool rate_table_covers(RateTable *table, const double *env) {
+  return env[0] >= RATE_TABLE_TEMP_MIN && env[0] <= RATE_TABLE_TEMP_MAX &&
+         env[1] >= RATE_TABLE_PRESS_MIN && env[1] <= RATE_TABLE_PRESS_MAX;
+}
+
+/** \brief Interpolate the tabulated parameters of a set of grid cells
+ *
+ * The environmental states of the grid cells must be within the table range.
+ *
+ * \param table Rate table
+ * \param model_data Pointer to the model data with the total environmental
+ *                   state set
+ * \param cell_ids Grid cells to update
+ * \param n_cells Number of grid cells to update
+ */
+void rate_table_update_cells(RateTable *table, ModelData *model_data,
+                             const int *cell_ids, int n_cells) {
+  int n_param = table->n_param;
+  const int *env_id = table->env_id;
+  double *param = table->cell_param;
+
+  for (int i = 0; i < n_cells; ++i) {
+    int i_cell = cell_ids[i];
+    const double *env = &(model_data->total_env[i_cell * CAMP_NUM_ENV_PARAM_]);
+    double *cell_env_data =
+        &(model_data->rxn_env_data[i_cell * model_data->n_rxn_env_data]);
+    rate_table_interpolate(table, env[0], env[1], param);
+    for (int i_param = 0; i_param < n_param; ++i_param)
+      cell_env_data[env_id[i_param]] = param[i_param];
+  }
+}
+
+/** \brief Free the rate table
+ *
+ * \param table Rate table to free
+ */
+void rate_table_free(RateTable *table) {
+  if (table == NULL) return;
+  free(table->tabulated);
+  free(table->env_id);
+  free(table->values);
+  free(table->cell_param);
+  free(table->cell_ids);
+  free(table);
+}
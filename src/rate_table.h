@@ -0,0 +1,71 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Header file for the tabulated temperature- and pressure-dependent
+ * reaction parameters
+ *
+ */
+/** \file
+ * \brief Header file for the tabulated temperature- and pressure-dependent
+ *        reaction parameters
+ *
+ * The rate constants of the Arrhenius, Troe, CMAQ, ternary chemical
+ * activation, Wennberg and aqueous equilibrium reactions are smooth
+ * functions of temperature and pressure that are evaluated with exp(),
+ * pow() and log10() for every reaction in every grid cell whose
+ * environmental state changes. The rate table instead stores the
+ * environment-dependent parameters of these reactions on a grid covering the
+ * troposphere, uniform in temperature and in the logarithm of pressure, and
+ * interpolates them with bicubic Lagrange polynomials.
+ *
+ * The table is built during solver initialization, halving the spacing of
+ * the temperature and/or pressure grids until the interpolated parameters are
+ * within the requested relative tolerance of the directly calculated ones.
+ * The error is checked at the points 1/4, 1/2 and 3/4 of every grid interval
+ * in each dimension against half the tolerance, as a safety factor for the
+ * error between the checked points.
+ * Reactions that do not meet the tolerance on the finest grid are not
+ * tabulated. Grid cells outside the table range are calculated directly.
+ *
+ * The interpolation weights only depend on the environmental state, so the
+ * parameters of all the tabulated reactions of a grid cell are calculated
+ * together by loops over the parameters of the table.
+ */
+#ifndef RATE_TABLE_H
+#define RATE_TABLE_H
+#include "camp_common.h"
+
+// Temperature range of the table (K)
+#define RATE_TABLE_TEMP_MIN 180.0
+#define RATE_TABLE_TEMP_MAX 330.0
+
+// Pressure range of the table (Pa)
+#define RATE_TABLE_PRESS_MIN 5000.0
+#define RATE_TABLE_PRESS_MAX 110000.0
+
+/* Tabulated environment-dependent reaction parameters */
+typedef struct RateTable {
+  double tol;         // Maximum relative interpolation error
+  int n_temp;         // Number of temperature intervals
+  int n_press;        // Number of pressure intervals
+  double d_temp;      // Temperature grid spacing (K)
+  double d_log_press; // Pressure grid spacing (ln(Pa))
+  int n_param;        // Number of tabulated parameters per grid cell
+  int *env_id;        // Offsets of the tabulated parameters in the reaction
+                      // environment-dependent data of a grid cell [n_param]
+  bool *tabulated;    // Flags indicating which reactions are tabulated
+                      // [n_rxn]
+  double *values;     // Parameters at the grid nodes
+                      // [n_temp + 1][n_press + 1][n_param]
+  double *cell_param; // Interpolated parameters of a grid cell [n_param]
+  int *cell_ids;      // Grid cells to interpolate [n_cells]
+} RateTable;
+
+RateTable *rate_table_new(ModelData *model_data, double tol);
+bool rate_table_covers(RateTable *table, const double *env);
+void rate_table_update_cells(RateTable *table, ModelData *model_data,
+                             const int *cell_ids, int n_cells);
+void rate_table_free(RateTable *table);
+
+#endif
@@ -0,0 +1,451 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Rosenbrock integrators
+ *
+ */
+/** \file
+ * \brief Rosenbrock integrators
+ */
+#include "rosenbrock_solver.h"
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Step-size control parameters (KPP defaults)
+#define ROS_FAC_MIN 0.2   // Lower bound on the step size change factor
+#define ROS_FAC_MAX 6.0   // Upper bound on the step size change factor
+#define ROS_FAC_REJ 0.1   // Step size factor after repeated rejections
+#define ROS_FAC_SAFE 0.9  // Safety factor for the new step size
+#define ROS_MAX_SINGULAR 5  // Maximum number of consecutive singular
+                            // matrices before failing
+#define ROS_ROUNDOFF (10.0 * DBL_EPSILON)  // Relative step size limit
+
+// Index of the coefficient for stage i and earlier stage j in the packed
+// lower triangle of A and C
+#define ROS_ID(i, j) ((i) * ((i)-1) / 2 + (j))
+
+/** \brief Set the coefficients of a Rosenbrock method
+ *
+ * \param method Method to set up
+ * \param method_id Method (ROS_METHOD_*)
+ * \return 0 on success, -1 for an unknown method
+ */
+int rosenbrock_method_init(RosenbrockMethod *method, int method_id) {
+  double g;
+
+  for (int i = 0; i < ROS_MAX_STAGES * (ROS_MAX_STAGES - 1) / 2; ++i)
+    method->A[i] = method->C[i] = 0.0;
+  for (int i = 0; i < ROS_MAX_STAGES; ++i) {
+    method->M[i] = method->E[i] = 0.0;
+    method->alpha[i] = method->gamma[i] = 0.0;
+    method->new_f[i] = 1;
+  }
+
+  switch (method_id) {
+    case ROS_METHOD_ROS2:
+      g = 1.0 + 1.0 / sqrt(2.0);
+      method->n_stages = 2;
+      method->error_order = 2.0;
+      method->A[ROS_ID(1, 0)] = 1.0 / g;
+      method->C[ROS_ID(1, 0)] = -2.0 / g;
+      method->M[0] = 3.0 / (2.0 * g);
+      method->M[1] = 1.0 / (2.0 * g);
+      method->E[0] = 1.0 / (2.0 * g);
+      method->E[1] = 1.0 / (2.0 * g);
+      method->alpha[0] = 0.0;
+      method->alpha[1] = 1.0;
+      method->gamma[0] = g;
+      method->gamma[1] = -g;
+      break;
+    case ROS_METHOD_ROS3:
+      method->n_stages = 3;
+      method->error_order = 3.0;
+      method->A[ROS_ID(1, 0)] = 1.0;
+      method->A[ROS_ID(2, 0)] = 1.0;
+      method->A[ROS_ID(2, 1)] = 0.0;
+      method->C[ROS_ID(1, 0)] = -0.10156171083877702091975600115545e+01;
+      method->C[ROS_ID(2, 0)] = 0.40759956452537699824805835358067e+01;
+      method->C[ROS_ID(2, 1)] = 0.92076794298330791242156818474003e+01;
+      method->new_f[2] = 0;  // same stage state as stage 1
+      method->M[0] = 0.1e+01;
+      method->M[1] = 0.61697947043828245592553615689730e+01;
+      method->M[2] = -0.42772256543218573326238373806514;
+      method->E[0] = 0.5;
+      method->E[1] = -0.29079558716805469821718236208017e+01;
+      method->E[2] = 0.22354069897811569627360909276199;
+      method->alpha[0] = 0.0;
+      method->alpha[1] = 0.43586652150845899941601945119356;
+      method->alpha[2] = 0.43586652150845899941601945119356;
+      method->gamma[0] = 0.43586652150845899941601945119356;
+      method->gamma[1] = 0.24291996454816804366592249683314;
+      method->gamma[2] = 0.21851380027664058511513169485832e+01;
+      break;
+    case ROS_METHOD_RODAS3:
+      method->n_stages = 4;
+      method->error_order = 3.0;
+      method->A[ROS_ID(1, 0)] = 0.0;
+      method->A[ROS_ID(2, 0)] = 2.0;
+      method->A[ROS_ID(2, 1)] = 0.0;
+      method->A[ROS_ID(3, 0)] = 2.0;
+      method->A[ROS_ID(3, 1)] = 0.0;
+      method->A[ROS_ID(3, 2)] = 1.0;
+      method->C[ROS_ID(1, 0)] = 4.0;
+      method->C[ROS_ID(2, 0)] = 1.0;
+      method->C[ROS_ID(2, 1)] = -1.0;
+      method->C[ROS_ID(3, 0)] = 1.0;
+      method->C[ROS_ID(3, 1)] = -1.0;
+      method->C[ROS_ID(3, 2)] = -8.0 / 3.0;
+      method->new_f[1] = 0;  // same stage state as stage 0
+      method->M[0] = 2.0;
+      method->M[1] = 0.0;
+      method->M[2] = 1.0;
+      method->M[3] = 1.0;
+      method->E[3] = 1.0;
+      method->alpha[0] = 0.0;
+      method->alpha[1] = 0.0;
+      method->alpha[2] = 1.0;
+      method->alpha[3] = 1.0;
+      method->gamma[0] = 0.5;
+      method->gamma[1] = 1.5;
+      method->gamma[2] = 0.0;
+      method->gamma[3] = 0.0;
+      break;
+    case ROS_METHOD_RODAS4:
+      method->n_stages = 6;
+      method->error_order = 4.0;
+      method->A[ROS_ID(1, 0)] = 0.1544e+01;
+      method->A[ROS_ID(2, 0)] = 0.9466785280815826;
+      method->A[ROS_ID(2, 1)] = 0.2557011698983284;
+      method->A[ROS_ID(3, 0)] = 0.3314825187068521e+01;
+      method->A[ROS_ID(3, 1)] = 0.2896124015972201e+01;
+      method->A[ROS_ID(3, 2)] = 0.9986419139977817;
+      method->A[ROS_ID(4, 0)] = 0.1221224509226641e+01;
+      method->A[ROS_ID(4, 1)] = 0.6019134481288629e+01;
+      method->A[ROS_ID(4, 2)] = 0.1253708332932087e+02;
+      method->A[ROS_ID(4, 3)] = -0.6878860361058950;
+      method->A[ROS_ID(5, 0)] = 0.1221224509226641e+01;
+      method->A[ROS_ID(5, 1)] = 0.6019134481288629e+01;
+      method->A[ROS_ID(5, 2)] = 0.1253708332932087e+02;
+      method->A[ROS_ID(5, 3)] = -0.6878860361058950;
+      method->A[ROS_ID(5, 4)] = 1.0;
+      method->C[ROS_ID(1, 0)] = -0.5668800000000000e+01;
+      method->C[ROS_ID(2, 0)] = -0.2430093356833875e+01;
+      method->C[ROS_ID(2, 1)] = -0.2063599157091915;
+      method->C[ROS_ID(3, 0)] = -0.1073529058151375;
+      method->C[ROS_ID(3, 1)] = -0.9594562251023355e+01;
+      method->C[ROS_ID(3, 2)] = -0.2047028614809616e+02;
+      method->C[ROS_ID(4, 0)] = 0.7496443313967647e+01;
+      method->C[ROS_ID(4, 1)] = -0.1024680431464352e+02;
+      method->C[ROS_ID(4, 2)] = -0.3399990352819905e+02;
+      method->C[ROS_ID(4, 3)] = 0.1170890893206160e+02;
+      method->C[ROS_ID(5, 0)] = 0.8083246795921522e+01;
+      method->C[ROS_ID(5, 1)] = -0.7981132988064893e+01;
+      method->C[ROS_ID(5, 2)] = -0.3152159432874371e+02;
+      method->C[ROS_ID(5, 3)] = 0.1631930543123136e+02;
+      method->C[ROS_ID(5, 4)] = -0.6058818238834054e+01;
+      method->M[0] = method->A[ROS_ID(5, 0)];
+      method->M[1] = method->A[ROS_ID(5, 1)];
+      method->M[2] = method->A[ROS_ID(5, 2)];
+      method->M[3] = method->A[ROS_ID(5, 3)];
+      method->M[4] = 1.0;
+      method->M[5] = 1.0;
+      method->E[5] = 1.0;
+      method->alpha[0] = 0.000;
+      method->alpha[1] = 0.386;
+      method->alpha[2] = 0.210;
+      method->alpha[3] = 0.630;
+      method->alpha[4] = 1.000;
+      method->alpha[5] = 1.000;
+      method->gamma[0] = 0.2500000000000000;
+      method->gamma[1] = -0.1043000000000000;
+      method->gamma[2] = 0.1035000000000000;
+      method->gamma[3] = -0.3620000000000023e-01;
+      method->gamma[4] = 0.0;
+      method->gamma[5] = 0.0;
+      break;
+    default:
+      return -1;
+  }
+  return 0;
+}
+
+/** \brief Create a Rosenbrock integrator
+ *
+ * \param method_id Rosenbrock method (ROS_METHOD_*)
+ * \param y Solver state vector (used as a template for the work vectors)
+ * \param J Jacobian matrix with the sparsity pattern of the system
+ * \param ls Direct linear solver set up for the pattern of J
+ * \param f Right-hand side function
+ * \param jac Jacobian function, which also calculates f(t,y)
+ * \param user_data Data passed to f and jac
+ * \param rel_tol Relative tolerance
+ * \param abs_tol Absolute tolerances
+ * \param max_steps Maximum number of steps per call to
+ *                  \c rosenbrock_integrate()
+ * \return New integrator, or NULL for an unknown method
+ */
+RosenbrockMem *rosenbrock_create(int method_id, N_Vector y, SUNMatrix J,
+                                 SUNLinearSolver ls, RosRhsFn f, RosJacFn jac,
+                                 void *user_data, double rel_tol,
+                                 N_Vector abs_tol, long int max_steps) {
+  RosenbrockMem *ros = (RosenbrockMem *)malloc(sizeof(RosenbrockMem));
+  if (ros == NULL) {
+    printf("\n\nERROR allocating space for the Rosenbrock integrator\n\n");
+    exit(EXIT_FAILURE);
+  }
+  if (rosenbrock_method_init(&(ros->method), method_id) != 0) {
+    free(ros);
+    return NULL;
+  }
+
+  ros->f = f;
+  ros->jac = jac;
+  ros->user_data = user_data;
+  ros->ls = ls;
+  ros->J = J;
+  ros->M = SUNMatClone(J);
+  SUNMatCopy(J, ros->M);
+  ros->abs_tol = abs_tol;
+  ros->rel_tol = rel_tol;
+  ros->max_steps = max_steps;
+  for (int i_stage = 0; i_stage < ROS_MAX_STAGES; ++i_stage)
+    ros->K[i_stage] = i_stage < ros->method.n_stages ? N_VClone(y) : NULL;
+  ros->f0 = N_VClone(y);
+  ros->f_stage = N_VClone(y);
+  ros->y_stage = N_VClone(y);
+  ros->rhs = N_VClone(y);
+  ros->y_new = N_VClone(y);
+  ros->y_err = N_VClone(y);
+  ros->tmp1 = N_VClone(y);
+  ros->tmp2 = N_VClone(y);
+  ros->tmp3 = N_VClone(y);
+  ros->h = 0.0;
+  ros->h_last = 0.0;
+  ros->n_steps = 0;
+  ros->n_rejected = 0;
+  ros->n_err_test_fails = 0;
+  ros->n_rhs_evals = 0;
+  ros->n_jac_evals = 0;
+  ros->n_lin_setups = 0;
+
+  return ros;
+}
+
+/** \brief Weighted root-mean-square norm of the error estimate
+ *
+ * The norm is calculated with the norm operation of the error estimate
+ * vector, so vectors cloned from a solver vector with a different norm
+ * (e.g., per grid cell) use that norm.
+ *
+ * \param ros Rosenbrock integrator with the step results in y_new and y_err
+ * \param y State at the beginning of the step
+ * \return Error norm (values <= 1 pass the error test)
+ */
+static double rosenbrock_error_norm(RosenbrockMem *ros, N_Vector y) {
+  double *y_data = NV_DATA_S(y);
+  double *y_new_data = NV_DATA_S(ros->y_new);
+  double *abs_tol_data = NV_DATA_S(ros->abs_tol);
+  double *weight_data = NV_DATA_S(ros->tmp1);
+  long int n = NV_LENGTH_S(y);
+
+  for (long int i = 0; i < n; ++i) {
+    double y_max = fmax(fabs(y_data[i]), fabs(y_new_data[i]));
+    weight_data[i] = 1.0 / (abs_tol_data[i] + ros->rel_tol * y_max);
+  }
+  return fmax(N_VWrmsNorm(ros->y_err, ros->tmp1), 1.0e-10);
+}
+
+/** \brief Calculate the stages, new solution and error estimate of a step
+ *
+ * The linear system matrix must already be factored for the step size.
+ *
+ * \param ros Rosenbrock integrator with f0 set to f(t,y)
+ * \param t Time at the beginning of the step
+ * \param h Step size
+ * \param y State at the beginning of the step
+ * \return 0 on success, a positive value for a recoverable right-hand side
+ *         failure, or a negative ROS_* flag
+ */
+static int rosenbrock_step(RosenbrockMem *ros, realtype t, realtype h,
+                           N_Vector y) {
+  RosenbrockMethod *m = &(ros->method);
+  realtype h_gamma = h * m->gamma[0];
+  int flag;
+
+  for (int i_stage = 0; i_stage < m->n_stages; ++i_stage) {
+    // Right-hand side at the stage state
+    if (i_stage == 0) {
+      N_VScale(1.0, ros->f0, ros->f_stage);
+    } else if (m->new_f[i_stage]) {
+      N_VScale(1.0, y, ros->y_stage);
+      for (int j_stage = 0; j_stage < i_stage; ++j_stage)
+        N_VLinearSum(m->A[ROS_ID(i_stage, j_stage)], ros->K[j_stage], 1.0,
+                     ros->y_stage, ros->y_stage);
+      flag = ros->f(t + m->alpha[i_stage] * h, ros->y_stage, ros->f_stage,
+                    ros->user_data);
+      ++(ros->n_rhs_evals);
+      if (flag != 0) return flag < 0 ? ROS_RHS_FAIL : flag;
+    }
+
+    // Solve (I - h gamma J) K_i = h gamma (f_i + sum_j C_ij / h K_j)
+    N_VScale(h_gamma, ros->f_stage, ros->rhs);
+    for (int j_stage = 0; j_stage < i_stage; ++j_stage)
+      N_VLinearSum(m->C[ROS_ID(i_stage, j_stage)] * m->gamma[0],
+                   ros->K[j_stage], 1.0, ros->rhs, ros->rhs);
+    flag = SUNLinSolSolve(ros->ls, ros->M, ros->K[i_stage], ros->rhs, 0.0);
+    if (flag != SUNLS_SUCCESS) return ROS_LSOLVE_FAIL;
+  }
+
+  // New solution and error estimate
+  N_VScale(1.0, y, ros->y_new);
+  N_VConst(0.0, ros->y_err);
+  for (int i_stage = 0; i_stage < m->n_stages; ++i_stage) {
+    if (m->M[i_stage] != 0.0)
+      N_VLinearSum(m->M[i_stage], ros->K[i_stage], 1.0, ros->y_new,
+                   ros->y_new);
+    if (m->E[i_stage] != 0.0)
+      N_VLinearSum(m->E[i_stage], ros->K[i_stage], 1.0, ros->y_err,
+                   ros->y_err);
+  }
+
+  return 0;
+}
+
+/** \brief Integrate from t_initial to t_final
+ *
+ * The Jacobian is evaluated once per step, at the state at the beginning of
+ * the step, together with f(t,y). Rejected steps are repeated with a smaller
+ * step size using the same Jacobian. Recoverable right-hand side failures
+ * (e.g., negative concentrations at a stage state) reject the step. Small
+ * negative values in accepted solutions, which are within the error
+ * tolerances, are set to zero.
+ *
+ * \param ros Rosenbrock integrator
+ * \param t_initial Initial time
+ * \param t_final Final time
+ * \param h_initial Initial step size
+ * \param y Initial state, set to the state at t_final on success
+ * \return ROS_SUCCESS or a negative ROS_* flag
+ */
+int rosenbrock_integrate(RosenbrockMem *ros, realtype t_initial,
+                         realtype t_final, realtype h_initial, N_Vector y) {
+  RosenbrockMethod *m = &(ros->method);
+  realtype t = t_initial;
+  realtype h_max = t_final - t_initial;
+  realtype h = fmin(h_initial > 0.0 ? h_initial : h_max, h_max);
+  bool reject_last = false;  // The last step attempt was rejected
+  bool reject_more = false;  // The last two step attempts were rejected
+  long int n_attempts = 0;
+  int flag;
+
+  while (t < t_final) {
+    realtype h_min = ROS_ROUNDOFF * fmax(fabs(t), fabs(t_final));
+    bool last_step;
+    int n_singular = 0;
+
+    // Jacobian and derivative at the beginning of the step
+    ros->h = h;
+    flag = ros->jac(t, y, ros->f0, ros->J, ros->user_data, ros->tmp1,
+                    ros->tmp2, ros->tmp3);
+    ++(ros->n_jac_evals);
+    ++(ros->n_rhs_evals);
+    if (flag != 0) return ROS_JAC_FAIL;
+
+    // Repeat the step until it is accepted
+    while (true) {
+      if (++n_attempts > ros->max_steps) return ROS_TOO_MUCH_WORK;
+      if (h < h_min) return ROS_STEP_TOO_SMALL;
+      last_step = t + h >= t_final;
+      if (last_step) h = t_final - t;
+      ros->h = h;
+
+      // Factor I - h gamma J
+      SUNMatCopy(ros->J, ros->M);
+      SUNMatScaleAddI(-h * m->gamma[0], ros->M);
+      flag = SUNLinSolSetup(ros->ls, ros->M);
+      ++(ros->n_lin_setups);
+      if (flag < 0) return ROS_LSETUP_FAIL;
+      if (flag > 0) {
+        // Singular matrix: retry with a smaller step
+        if (++n_singular > ROS_MAX_SINGULAR) return ROS_LSETUP_FAIL;
+        h *= 0.5;
+        reject_last = true;
+        continue;
+      }
+
+      flag = rosenbrock_step(ros, t, h, y);
+      if (flag < 0) return flag;
+      if (flag > 0) {
+        // Recoverable right-hand side failure
+        ++(ros->n_rejected);
+        h *= ROS_FAC_REJ;
+        reject_more = reject_last;
+        reject_last = true;
+        continue;
+      }
+
+      // Error test and new step size
+      double err = rosenbrock_error_norm(ros, y);
+      double fac = fmin(ROS_FAC_MAX,
+                        fmax(ROS_FAC_MIN,
+                             ROS_FAC_SAFE / pow(err, 1.0 / m->error_order)));
+      realtype h_new = h * fac;
+
+      if (err <= 1.0) {
+        // Accept the step
+        double *y_data = NV_DATA_S(y);
+        double *y_new_data = NV_DATA_S(ros->y_new);
+        for (long int i = 0; i < NV_LENGTH_S(y); ++i)
+          y_data[i] = y_new_data[i] > 0.0 ? y_new_data[i] : 0.0;
+        t = last_step ? t_final : t + h;
+        ++(ros->n_steps);
+        ros->h_last = h;
+        h_new = fmax(h_min, fmin(h_new, h_max));
+        if (reject_last) h_new = fmin(h_new, h);
+        reject_last = false;
+        reject_more = false;
+        h = h_new;
+        break;
+      }
+
+      // Reject the step
+      ++(ros->n_rejected);
+      ++(ros->n_err_test_fails);
+      if (reject_more) h_new = h * ROS_FAC_REJ;
+      reject_more = reject_last;
+      reject_last = true;
+      h = h_new;
+    }
+  }
+
+  ros->h = h;
+  return ROS_SUCCESS;
+}
+
+/** \brief Free a Rosenbrock integrator
+ *
+ * The Jacobian matrix and linear solver are owned by the caller and are not
+ * freed.
+ *
+ * \param ros Rosenbrock integrator to free
+ */
+void rosenbrock_free(RosenbrockMem *ros) {
+  if (ros == NULL) return;
+  SUNMatDestroy(ros->M);
+  for (int i_stage = 0; i_stage < ROS_MAX_STAGES; ++i_stage)
+    if (ros->K[i_stage] != NULL) N_VDestroy(ros->K[i_stage]);
+  N_VDestroy(ros->f0);
+  N_VDestroy(ros->f_stage);
+  N_VDestroy(ros->y_stage);
+  N_VDestroy(ros->rhs);
+  N_VDestroy(ros->y_new);
+  N_VDestroy(ros->y_err);
+  N_VDestroy(ros->tmp1);
+  N_VDestroy(ros->tmp2);
+  N_VDestroy(ros->tmp3);
+  free(ros);
+}
@@ -0,0 +1,118 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Header for the Rosenbrock integrators
+ *
+ */
+/** \file
+ * \brief Header for the Rosenbrock integrators
+ *
+ * Rosenbrock methods are linearly implicit Runge-Kutta methods: each stage
+ * solves one linear system with the matrix \f$I - h \gamma J\f$, where
+ * \f$J\f$ is the Jacobian at the beginning of the step, so no Newton
+ * iteration is needed. The matrix is factored once per step and reused for
+ * all the stages. The step size is controlled with the embedded error
+ * estimate of each method.
+ *
+ * The methods and step-size control follow the Rosenbrock integrators
+ * generated by KPP (Sandu et al., Atmos. Environ. 31, 3459-3472, 1997). The
+ * right-hand side is assumed to not depend explicitly on time, as is the
+ * case for CAMP with a fixed environmental state during a call to the
+ * solver.
+ */
+#ifndef ROSENBROCK_SOLVER_H_
+#define ROSENBROCK_SOLVER_H_
+
+#include <nvector/nvector_serial.h>
+#include <sundials/sundials_linearsolver.h>
+#include <sunmatrix/sunmatrix_sparse.h>
+
+// Maximum number of stages of the Rosenbrock methods
+#define ROS_MAX_STAGES 6
+
+/* Rosenbrock methods */
+#define ROS_METHOD_ROS2 0    // 2 stages, order 2(1), L-stable
+#define ROS_METHOD_ROS3 1    // 3 stages, order 3(2), L-stable
+#define ROS_METHOD_RODAS3 2  // 4 stages, order 3(2), stiffly accurate
+#define ROS_METHOD_RODAS4 3  // 6 stages, order 4(3), stiffly accurate
+
+/* Return flags */
+#define ROS_SUCCESS 0          // Integration reached the final time
+#define ROS_TOO_MUCH_WORK -1   // Maximum number of steps reached
+#define ROS_STEP_TOO_SMALL -2  // Step size fell below the minimum
+#define ROS_RHS_FAIL -3        // Unrecoverable right-hand side failure
+#define ROS_JAC_FAIL -4        // Jacobian evaluation failure
+#define ROS_LSETUP_FAIL -5     // Linear solver setup failure
+#define ROS_LSOLVE_FAIL -6     // Linear solver solve failure
+
+/* Right-hand side function f(t,y) (same signature as CVRhsFn) */
+typedef int (*RosRhsFn)(realtype t, N_Vector y, N_Vector fy, void *user_data);
+
+/* Jacobian function (same signature as the CVODE Jacobian function). It
+ * must also set fy to f(t,y). */
+typedef int (*RosJacFn)(realtype t, N_Vector y, N_Vector fy, SUNMatrix J,
+                        void *user_data, N_Vector tmp1, N_Vector tmp2,
+                        N_Vector tmp3);
+
+/* Coefficients of a Rosenbrock method. The A and C coefficients are stored
+ * row by row for the strictly lower triangle (stage i, j < i). */
+typedef struct {
+  int n_stages;                            // Number of stages
+  double error_order;                      // Order of the error estimator
+  double A[ROS_MAX_STAGES * (ROS_MAX_STAGES - 1) / 2];  // Stage state
+                                                         // coefficients
+  double C[ROS_MAX_STAGES * (ROS_MAX_STAGES - 1) / 2];  // Stage coupling
+                                                         // coefficients
+  double M[ROS_MAX_STAGES];      // Weights for the new solution
+  double E[ROS_MAX_STAGES];      // Weights for the error estimate
+  double alpha[ROS_MAX_STAGES];  // Stage time fractions
+  double gamma[ROS_MAX_STAGES];  // Stage gamma coefficients
+  int new_f[ROS_MAX_STAGES];     // Flags for stages that need a new
+                                 // right-hand side evaluation
+} RosenbrockMethod;
+
+/* Rosenbrock integrator data */
+typedef struct RosenbrockMem {
+  RosenbrockMethod method;  // Method coefficients
+  RosRhsFn f;               // Right-hand side function
+  RosJacFn jac;             // Jacobian function
+  void *user_data;          // Data passed to f and jac
+  SUNLinearSolver ls;       // Direct linear solver for I - h gamma J
+                            // (owned by the caller)
+  SUNMatrix J;              // Jacobian matrix (owned by the caller)
+  SUNMatrix M;              // Linear system matrix I - h gamma J
+  N_Vector abs_tol;         // Absolute tolerances
+  double rel_tol;           // Relative tolerance
+  long int max_steps;       // Maximum number of steps per call
+  N_Vector K[ROS_MAX_STAGES];  // Stage vectors
+  N_Vector f0;              // f(t,y) at the beginning of the step
+  N_Vector f_stage;         // f(t,y) at the last evaluated stage state
+  N_Vector y_stage;         // Stage state
+  N_Vector rhs;             // Right-hand side of the stage linear systems
+  N_Vector y_new;           // Solution at the end of the step
+  N_Vector y_err;           // Error estimate
+  N_Vector tmp1;            // Work vectors for the Jacobian function
+  N_Vector tmp2;
+  N_Vector tmp3;
+  realtype h;               // Current step size (next step size after
+                            // integrating)
+  realtype h_last;          // Size of the last accepted step
+  long int n_steps;         // Number of accepted steps
+  long int n_rejected;      // Number of rejected steps
+  long int n_err_test_fails;  // Number of steps rejected by the error test
+  long int n_rhs_evals;     // Number of right-hand side evaluations
+  long int n_jac_evals;     // Number of Jacobian evaluations
+  long int n_lin_setups;    // Number of linear solver setups
+} RosenbrockMem;
+
+int rosenbrock_method_init(RosenbrockMethod *method, int method_id);
+RosenbrockMem *rosenbrock_create(int method_id, N_Vector y, SUNMatrix J,
+                                 SUNLinearSolver ls, RosRhsFn f, RosJacFn jac,
+                                 void *user_data, double rel_tol,
+                                 N_Vector abs_tol, long int max_steps);
+int rosenbrock_integrate(RosenbrockMem *ros, realtype t_initial,
+                         realtype t_final, realtype h_initial, N_Vector y);
+void rosenbrock_free(RosenbrockMem *ros);
+
+#endif
@@ -0,0 +1,555 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Generated reaction kernels
+ *
+ */
+/** \file
+ * \brief Generation, loading and validation of reaction kernels
+ */
+#include "rxn_codegen.h"
+#include <dlfcn.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "rxn_soa.h"
+#include "rxn_solver.h"
+#include "rxns.h"
+
+#ifdef CAMP_USE_SUNDIALS
+
+// Names of the symbols defined by generated kernels
+#define RXN_CODEGEN_SIGNATURE_ "camp_rxn_kernel_signature"
+#define RXN_CODEGEN_DERIV_ "camp_rxn_kernel_calc_deriv"
+#define RXN_CODEGEN_JAC_ "camp_rxn_kernel_calc_jac"
+
+// Accumulator type, parameters and arguments of the generated kernels, which
+// must match the build of CAMP that loads them
+#ifdef CAMP_USE_COMPENSATED_SUM
+#define RXN_CODEGEN_SUM_TYPE_ "double"
+#define RXN_CODEGEN_SUM_MODE_ 1
+#define RXN_CODEGEN_SUM_PARAM_(name) \
+  "camp_sum *" name ", double *" name "_comp"
+#define RXN_CODEGEN_SUM_ARG_(name) name ", " name "_comp"
+#define RXN_CODEGEN_SUM_ADD_                 \
+  "  double t = sum[i] + value;\n"           \
+  "  if (fabs(sum[i]) >= fabs(value)) {\n"   \
+  "    sum_comp[i] += (sum[i] - t) + value;\n" \
+  "  } else {\n"                             \
+  "    sum_comp[i] += (value - t) + sum[i];\n" \
+  "  }\n"                                    \
+  "  sum[i] = t;\n"
+#else
+#define RXN_CODEGEN_SUM_TYPE_ "long double"
+#define RXN_CODEGEN_SUM_MODE_ 0
+#define RXN_CODEGEN_SUM_PARAM_(name) "camp_sum *" name
+#define RXN_CODEGEN_SUM_ARG_(name) name
+#define RXN_CODEGEN_SUM_ADD_ "  sum[i] += value;\n"
+#endif
+
+// Relative tolerance for the validation of loaded kernels
+#define RXN_CODEGEN_VALIDATION_REL_TOL 1.0e-12
+
+/** \brief Add data to a 64-bit FNV-1a hash
+ *
+ * \param hash Current hash value
+ * \param data Data to add
+ * \param size Size of the data in bytes
+ * \return Updated hash value
+ */
+static unsigned long long rxn_codegen_hash(unsigned long long hash,
+                                           const void *data, size_t size) {
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/** \brief Calculate the signature of the reaction data for kernels
+ *
+ * The signature covers the reaction types, the integer data and yields of
+ * the reactions included in kernels, the state size and the type of rate
+ * accumulators, so that a kernel is only loaded for the reaction data and
+ * build it was generated for.
+ *
+ * \param model_data Pointer to the model data
+ * \return Signature of the reaction data
+ */
+static unsigned long long rxn_codegen_signature(ModelData *model_data) {
+  unsigned long long hash = 14695981039346656037ULL;
+  int sum_mode = RXN_CODEGEN_SUM_MODE_;
+  RxnMassAction rxn;
+
+  hash = rxn_codegen_hash(hash, &sum_mode, sizeof(int));
+  hash = rxn_codegen_hash(hash, &(model_data->n_per_cell_state_var),
+                          sizeof(int));
+  hash = rxn_codegen_hash(hash, &(model_data->n_rxn), sizeof(int));
+  for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn) {
+    if (rxn_mass_action_get(model_data, i_rxn, &rxn) == 0) {
+      hash = rxn_codegen_hash(hash, &(rxn.type), sizeof(int));
+      continue;
+    }
+    hash = rxn_codegen_hash(
+        hash, &(model_data->rxn_int_data[model_data->rxn_int_indices[i_rxn]]),
+        rxn.n_int_data * sizeof(int));
+    hash = rxn_codegen_hash(hash, &(rxn.env_idx), sizeof(int));
+    hash = rxn_codegen_hash(hash, rxn.yield, rxn.n_prod * sizeof(double));
+  }
+  return hash;
+}
+
+/** \brief Write the C source for a reaction kernel
+ *
+ * Must be called after the solver is initialized, once the derivative and
+ * Jacobian ids of the reactions are set.
+ *
+ * \param model_data Pointer to the model data
+ * \param file_path Path to the file to write
+ * \return 1 on success, 0 if the file could not be written
+ */
+int rxn_codegen_write_source(ModelData *model_data, const char *file_path) {
+  FILE *f = fopen(file_path, "w");
+  RxnMassAction rxn;
+  int n_kernel_rxn = 0;
+  const char *deriv_args[2] = {RXN_CODEGEN_SUM_ARG_("production_rates"),
+                               RXN_CODEGEN_SUM_ARG_("loss_rates")};
+  const char *jac_args[2] = {RXN_CODEGEN_SUM_ARG_("production_partials"),
+                             RXN_CODEGEN_SUM_ARG_("loss_partials")};
+
+  if (f == NULL) return 0;
+
+  for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn)
+    if (rxn_mass_action_get(model_data, i_rxn, &rxn)) ++n_kernel_rxn;
+
+  fprintf(f,
+          "/* Reaction kernel generated by CAMP for %d of %d reactions.\n"
+          " * Do not edit: regenerate after changing the mechanism. */\n\n",
+          n_kernel_rxn, model_data->n_rxn);
+  fprintf(f, "const unsigned long long %s = 0x%llxULL;\n\n",
+          RXN_CODEGEN_SIGNATURE_, rxn_codegen_signature(model_data));
+  fprintf(f,
+          "#include <math.h>\n\n"
+          "typedef " RXN_CODEGEN_SUM_TYPE_ " camp_sum;\n\n"
+          "static inline void add_value(" RXN_CODEGEN_SUM_PARAM_("sum") ",\n"
+          "                             int i, camp_sum value) {\n"
+          RXN_CODEGEN_SUM_ADD_
+          "}\n\n"
+          "static inline void add_deriv(\n"
+          "    " RXN_CODEGEN_SUM_PARAM_("production_rates") ",\n"
+          "    " RXN_CODEGEN_SUM_PARAM_("loss_rates") ",\n"
+          "    int i_spec, camp_sum rate) {\n"
+          "  if (rate > 0.0) {\n"
+          "    add_value(" RXN_CODEGEN_SUM_ARG_("production_rates")
+          ", i_spec, rate);\n"
+          "  } else {\n"
+          "    add_value(" RXN_CODEGEN_SUM_ARG_("loss_rates")
+          ", i_spec, -rate);\n"
+          "  }\n"
+          "}\n\n");
+
+  // Time derivative
+  fprintf(f,
+          "void %s(const double *state, const double *rxn_env_data,\n"
+          "    " RXN_CODEGEN_SUM_PARAM_("production_rates") ",\n"
+          "    " RXN_CODEGEN_SUM_PARAM_("loss_rates") ",\n"
+          "    double time_step) {\n"
+          "  camp_sum rate;\n",
+          RXN_CODEGEN_DERIV_);
+  for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn) {
+    int i_dep = 0;
+    if (rxn_mass_action_get(model_data, i_rxn, &rxn) == 0) continue;
+    fprintf(f, "\n  /* reaction %d (type %d) */\n", i_rxn, rxn.type);
+    fprintf(f, "  rate = rxn_env_data[%d];\n", rxn.env_idx);
+    for (int i_spec = 0; i_spec < rxn.n_react; ++i_spec)
+      fprintf(f, "  rate *= state[%d];\n", rxn.react[i_spec] - 1);
+    fprintf(f, "  if (rate != 0.0) {\n");
+    for (int i_spec = 0; i_spec < rxn.n_react; ++i_spec, ++i_dep) {
+      if (rxn.deriv_id[i_dep] < 0) continue;
+      fprintf(f, "    add_deriv(%s, %s, %d, -rate);\n", deriv_args[0],
+              deriv_args[1], rxn.deriv_id[i_dep]);
+    }
+    for (int i_spec = 0; i_spec < rxn.n_prod; ++i_spec, ++i_dep) {
+      if (rxn.deriv_id[i_dep] < 0) continue;
+      fprintf(f,
+              "    if (-rate * %a * time_step <= state[%d])\n"
+              "      add_deriv(%s, %s, %d, rate * %a);\n",
+              rxn.yield[i_spec], rxn.prod[i_spec] - 1, deriv_args[0],
+              deriv_args[1], rxn.deriv_id[i_dep], rxn.yield[i_spec]);
+    }
+    fprintf(f, "  }\n");
+  }
+  fprintf(f, "}\n\n");
+
+  // Jacobian
+  fprintf(f,
+          "void %s(const double *state, const double *rxn_env_data,\n"
+          "    " RXN_CODEGEN_SUM_PARAM_("production_partials") ",\n"
+          "    " RXN_CODEGEN_SUM_PARAM_("loss_partials") ",\n"
+          "    double time_step) {\n"
+          "  double rate;\n",
+          RXN_CODEGEN_JAC_);
+  for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn) {
+    int i_elem = 0;
+    if (rxn_mass_action_get(model_data, i_rxn, &rxn) == 0) continue;
+    fprintf(f, "\n  /* reaction %d (type %d) */\n", i_rxn, rxn.type);
+    for (int i_ind = 0; i_ind < rxn.n_react; ++i_ind) {
+      fprintf(f, "  rate = rxn_env_data[%d];\n", rxn.env_idx);
+      for (int i_spec = 0; i_spec < rxn.n_react; ++i_spec)
+        if (i_spec != i_ind)
+          fprintf(f, "  rate *= state[%d];\n", rxn.react[i_spec] - 1);
+      for (int i_dep = 0; i_dep < rxn.n_react; ++i_dep, ++i_elem) {
+        if (rxn.jac_id[i_elem] < 0) continue;
+        fprintf(f, "  add_value(%s, %d, rate);\n", jac_args[1],
+                rxn.jac_id[i_elem]);
+      }
+      for (int i_dep = 0; i_dep < rxn.n_prod; ++i_dep, ++i_elem) {
+        if (rxn.jac_id[i_elem] < 0) continue;
+        fprintf(f,
+                "  if (-rate * state[%d] * %a * time_step <= state[%d])\n"
+                "    add_value(%s, %d, %a * rate);\n",
+                rxn.react[i_ind] - 1, rxn.yield[i_dep], rxn.prod[i_dep] - 1,
+                jac_args[0], rxn.jac_id[i_elem], rxn.yield[i_dep]);
+      }
+    }
+  }
+  fprintf(f, "}\n");
+
+  return fclose(f) == 0;
+}
+
+/** \brief Add the contributions of a reaction using the generic functions
+ *
+ * \param model_data Pointer to the model data
+ * \param time_deriv TimeDerivative to add contributions to (or NULL)
+ * \param jac Jacobian to add contributions to (or NULL)
+ * \param i_rxn Index of the reaction
+ * \param time_step Current time step [s]
+ */
+static void rxn_codegen_generic_contrib(ModelData *model_data,
+                                        TimeDerivative *time_deriv,
+                                        Jacobian *jac, int i_rxn,
+                                        double time_step) {
+  int *rxn_int_data =
+      &(model_data->rxn_int_data[model_data->rxn_int_indices[i_rxn]]);
+  double *rxn_float_data =
+      &(model_data->rxn_float_data[model_data->rxn_float_indices[i_rxn]]);
+  double *rxn_env_data =
+      &(model_data->grid_cell_rxn_env_data[model_data->rxn_env_idx[i_rxn]]);
+  int rxn_type = *(rxn_int_data++);
+
+  switch (rxn_type) {
+    case RXN_ARRHENIUS:
+      if (time_deriv)
+        rxn_arrhenius_calc_deriv_contrib(model_data, *time_deriv, rxn_int_data,
+                                         rxn_float_data, rxn_env_data,
+                                         time_step);
+      if (jac)
+        rxn_arrhenius_calc_jac_contrib(model_data, *jac, rxn_int_data,
+                                       rxn_float_data, rxn_env_data,
+                                       time_step);
+      break;
+    case RXN_CMAQ_H2O2:
+      if (time_deriv)
+        rxn_CMAQ_H2O2_calc_deriv_contrib(model_data, *time_deriv, rxn_int_data,
+                                         rxn_float_data, rxn_env_data,
+                                         time_step);
+      if (jac)
+        rxn_CMAQ_H2O2_calc_jac_contrib(model_data, *jac, rxn_int_data,
+                                       rxn_float_data, rxn_env_data,
+                                       time_step);
+      break;
+    case RXN_CMAQ_OH_HNO3:
+      if (time_deriv)
+        rxn_CMAQ_OH_HNO3_calc_deriv_contrib(model_data, *time_deriv,
+                                            rxn_int_data, rxn_float_data,
+                                            rxn_env_data, time_step);
+      if (jac)
+        rxn_CMAQ_OH_HNO3_calc_jac_contrib(model_data, *jac, rxn_int_data,
+                                          rxn_float_data, rxn_env_data,
+                                          time_step);
+      break;
+    case RXN_PHOTOLYSIS:
+      if (time_deriv)
+        rxn_photolysis_calc_deriv_contrib(model_data, *time_deriv,
+                                          rxn_int_data, rxn_float_data,
+                                          rxn_env_data, time_step);
+      if (jac)
+        rxn_photolysis_calc_jac_contrib(model_data, *jac, rxn_int_data,
+                                        rxn_float_data, rxn_env_data,
+                                        time_step);
+      break;
+    case RXN_TERNARY_CHEMICAL_ACTIVATION:
+      if (time_deriv)
+        rxn_ternary_chemical_activation_calc_deriv_contrib(
+            model_data, *time_deriv, rxn_int_data, rxn_float_data,
+            rxn_env_data, time_step);
+      if (jac)
+        rxn_ternary_chemical_activation_calc_jac_contrib(
+            model_data, *jac, rxn_int_data, rxn_float_data, rxn_env_data,
+            time_step);
+      break;
+    case RXN_TROE:
+      if (time_deriv)
+        rxn_troe_calc_deriv_contrib(model_data, *time_deriv, rxn_int_data,
+                                    rxn_float_data, rxn_env_data, time_step);
+      if (jac)
+        rxn_troe_calc_jac_contrib(model_data, *jac, rxn_int_data,
+                                  rxn_float_data, rxn_env_data, time_step);
+      break;
+    case RXN_WENNBERG_TUNNELING:
+      if (time_deriv)
+        rxn_wennberg_tunneling_calc_deriv_contrib(
+            model_data, *time_deriv, rxn_int_data, rxn_float_data,
+            rxn_env_data, time_step);
+      if (jac)
+        rxn_wennberg_tunneling_calc_jac_contrib(model_data, *jac, rxn_int_data,
+                                                rxn_float_data, rxn_env_data,
+                                                time_step);
+      break;
+  }
+}
+
+/** \brief Compare two contributions calculated during validation
+ *
+ * \param generic Value from the generic reaction functions
+ * \param kernel Value from the kernel
+ * \return 1 if the values agree, 0 otherwise
+ */
+static int rxn_codegen_is_close(CampSum generic, CampSum kernel) {
+  return generic == kernel ||
+         CAMP_SUM_FABS(generic - kernel) <=
+             RXN_CODEGEN_VALIDATION_REL_TOL * CAMP_SUM_FABS(generic);
+}
+
+/** \brief Validate a kernel against the generic reaction functions
+ *
+ * Both paths are evaluated on a synthetic state and set of rate constants.
+ *
+ * \param model_data Pointer to the model data
+ * \param kernel Loaded kernel
+ * \return 1 if the kernel results agree with the generic functions, 0
+ *         otherwise
+ */
+static int rxn_codegen_validate(ModelData *model_data, RxnKernel *kernel) {
+  ModelData md = *model_data;
+  RxnMassAction rxn;
+  int n_deriv = 1, n_jac = 1, n_env = model_data->n_rxn_env_data;
+  double env[CAMP_NUM_ENV_PARAM_] = {298.15, 101325.0};
+  double *state, *rxn_env_data;
+  CampSum *rates, *partials;
+  TimeDerivative deriv_generic, deriv_kernel;
+  Jacobian jac_generic, jac_kernel;
+  int n_failed = 0;
+
+  // Get the sizes of the derivative and Jacobian
+  for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn) {
+    if (rxn_mass_action_get(model_data, i_rxn, &rxn) == 0) continue;
+    for (int i = 0; i < rxn.n_react + rxn.n_prod; ++i)
+      if (rxn.deriv_id[i] >= n_deriv) n_deriv = rxn.deriv_id[i] + 1;
+    for (int i = 0; i < rxn.n_react * (rxn.n_react + rxn.n_prod); ++i)
+      if (rxn.jac_id[i] >= n_jac) n_jac = rxn.jac_id[i] + 1;
+  }
+
+  state = (double *)malloc(md.n_per_cell_state_var * sizeof(double));
+  rxn_env_data = (double *)malloc((n_env > 0 ? n_env : 1) * sizeof(double));
+  rates = (CampSum *)calloc(4 * n_deriv, sizeof(CampSum));
+  partials = (CampSum *)calloc(4 * n_jac, sizeof(CampSum));
+  if (state == NULL || rxn_env_data == NULL || rates == NULL ||
+      partials == NULL) {
+    printf("\n\nERROR allocating space for reaction kernel validation\n\n");
+    exit(EXIT_FAILURE);
+  }
+  deriv_generic.num_spec = deriv_kernel.num_spec = n_deriv;
+  deriv_generic.production_rates = rates;
+  deriv_generic.loss_rates = &(rates[n_deriv]);
+  deriv_kernel.production_rates = &(rates[2 * n_deriv]);
+  deriv_kernel.loss_rates = &(rates[3 * n_deriv]);
+  jac_generic.num_elem = jac_kernel.num_elem = n_jac;
+  jac_generic.production_partials = partials;
+  jac_generic.loss_partials = &(partials[n_jac]);
+  jac_kernel.production_partials = &(partials[2 * n_jac]);
+  jac_kernel.loss_partials = &(partials[3 * n_jac]);
+#ifdef CAMP_USE_COMPENSATED_SUM
+  double *rates_comp = (double *)calloc(4 * n_deriv, sizeof(double));
+  double *partials_comp = (double *)calloc(4 * n_jac, sizeof(double));
+  if (rates_comp == NULL || partials_comp == NULL) {
+    printf("\n\nERROR allocating space for reaction kernel validation\n\n");
+    exit(EXIT_FAILURE);
+  }
+  deriv_generic.production_rates_comp = rates_comp;
+  deriv_generic.loss_rates_comp = &(rates_comp[n_deriv]);
+  deriv_kernel.production_rates_comp = &(rates_comp[2 * n_deriv]);
+  deriv_kernel.loss_rates_comp = &(rates_comp[3 * n_deriv]);
+  jac_generic.production_partials_comp = partials_comp;
+  jac_generic.loss_partials_comp = &(partials_comp[n_jac]);
+  jac_kernel.production_partials_comp = &(partials_comp[2 * n_jac]);
+  jac_kernel.loss_partials_comp = &(partials_comp[3 * n_jac]);
+#endif
+  for (int i = 0; i < md.n_per_cell_state_var; ++i)
+    state[i] = 1.0 + 0.1 * (i % 10);
+  for (int i = 0; i < n_env; ++i) rxn_env_data[i] = 1.0e-2 * (1 + i % 7);
+  md.grid_cell_state = state;
+  md.grid_cell_env = env;
+  md.grid_cell_rxn_env_data = rxn_env_data;
+
+  // Generic reaction functions
+  for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn)
+    if (rxn_mass_action_get(model_data, i_rxn, &rxn))
+      rxn_codegen_generic_contrib(&md, &deriv_generic, &jac_generic, i_rxn,
+                                  1.0);
+
+  // Kernel
+  rxn_codegen_calc_deriv(kernel, state, rxn_env_data, deriv_kernel, 1.0);
+  rxn_codegen_calc_jac(kernel, state, rxn_env_data, jac_kernel, 1.0);
+
+  for (int i = 0; i < 2 * n_deriv; ++i)
+    if (!rxn_codegen_is_close(CAMP_SUM_VALUE(rates, rates_comp, i),
+                              CAMP_SUM_VALUE(rates, rates_comp,
+                                             2 * n_deriv + i)))
+      ++n_failed;
+  for (int i = 0; i < 2 * n_jac; ++i)
+    if (!rxn_codegen_is_close(CAMP_SUM_VALUE(partials, partials_comp, i),
+                              CAMP_SUM_VALUE(partials, partials_comp,
+                                             2 * n_jac + i)))
+      ++n_failed;
+
+  free(state);
+  free(rxn_env_data);
+  free(rates);
+  free(partials);
+#ifdef CAMP_USE_COMPENSATED_SUM
+  free(rates_comp);
+  free(partials_comp);
+#endif
+  return n_failed == 0;
+}
+
+/** \brief Load a compiled reaction kernel
+ *
+ * Must be called after the solver is initialized.
+ *
+ * \param model_data Pointer to the model data
+ * \param lib_path Path to the shared library with the compiled kernel
+ * \return Loaded kernel, or NULL if the library could not be loaded, was
+ *         generated for different reaction data or fails validation
+ */
+RxnKernel *rxn_codegen_load(ModelData *model_data, const char *lib_path) {
+  RxnKernel *kernel;
+  const unsigned long long *signature;
+  RxnMassAction rxn;
+  void *handle = dlopen(lib_path, RTLD_NOW | RTLD_LOCAL);
+
+  if (handle == NULL) {
+    printf("\n\nERROR Cannot load reaction kernel: %s\n\n", dlerror());
+    return NULL;
+  }
+
+  kernel = (RxnKernel *)malloc(sizeof(RxnKernel));
+  if (kernel == NULL) {
+    printf("\n\nERROR allocating space for reaction kernel\n\n");
+    exit(EXIT_FAILURE);
+  }
+  kernel->lib_handle = handle;
+  kernel->n_generic_rxn = 0;
+  kernel->generic_rxn = (int *)malloc(
+      (model_data->n_rxn > 0 ? model_data->n_rxn : 1) * sizeof(int));
+  if (kernel->generic_rxn == NULL) {
+    printf("\n\nERROR allocating space for reaction kernel\n\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Get the kernel functions (POSIX-recommended conversion of the object
+  // pointers returned by dlsym)
+  signature =
+      (const unsigned long long *)dlsym(handle, RXN_CODEGEN_SIGNATURE_);
+  *(void **)(&(kernel->calc_deriv)) = dlsym(handle, RXN_CODEGEN_DERIV_);
+  *(void **)(&(kernel->calc_jac)) = dlsym(handle, RXN_CODEGEN_JAC_);
+  if (signature == NULL || kernel->calc_deriv == NULL ||
+      kernel->calc_jac == NULL) {
+    printf("\n\nERROR Invalid reaction kernel library '%s'\n\n", lib_path);
+    rxn_codegen_free(kernel);
+    return NULL;
+  }
+  if (*signature != rxn_codegen_signature(model_data)) {
+    printf(
+        "\n\nERROR Reaction kernel '%s' was generated for different "
+        "reaction data\n\n",
+        lib_path);
+    rxn_codegen_free(kernel);
+    return NULL;
+  }
+
+  // Reactions not included in the kernel use the generic functions
+  for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn)
+    if (rxn_mass_action_get(model_data, i_rxn, &rxn) == 0)
+      kernel->generic_rxn[kernel->n_generic_rxn++] = i_rxn;
+
+  if (rxn_codegen_validate(model_data, kernel) == 0) {
+    printf(
+        "\n\nERROR Reaction kernel '%s' does not match the reaction "
+        "functions\n\n",
+        lib_path);
+    rxn_codegen_free(kernel);
+    return NULL;
+  }
+
+  return kernel;
+}
+
+/** \brief Add the time derivative contributions of a loaded kernel
+ *
+ * \param kernel Loaded kernel
+ * \param state Model state of the grid cell
+ * \param rxn_env_data Reaction environment-dependent data of the grid cell
+ * \param time_deriv TimeDerivative object to add the contributions to
+ * \param time_step Current time step [s]
+ */
+void rxn_codegen_calc_deriv(RxnKernel *kernel, const double *state,
+                            const double *rxn_env_data,
+                            TimeDerivative time_deriv, double time_step) {
+#ifdef CAMP_USE_COMPENSATED_SUM
+  kernel->calc_deriv(state, rxn_env_data, time_deriv.production_rates,
+                     time_deriv.production_rates_comp, time_deriv.loss_rates,
+                     time_deriv.loss_rates_comp, time_step);
+#else
+  kernel->calc_deriv(state, rxn_env_data, time_deriv.production_rates,
+                     time_deriv.loss_rates, time_step);
+#endif
+}
+
+/** \brief Add the Jacobian contributions of a loaded kernel
+ *
+ * \param kernel Loaded kernel
+ * \param state Model state of the grid cell
+ * \param rxn_env_data Reaction environment-dependent data of the grid cell
+ * \param jac Jacobian object to add the contributions to
+ * \param time_step Current time step [s]
+ */
+void rxn_codegen_calc_jac(RxnKernel *kernel, const double *state,
+                          const double *rxn_env_data, Jacobian jac,
+                          double time_step) {
+#ifdef CAMP_USE_COMPENSATED_SUM
+  kernel->calc_jac(state, rxn_env_data, jac.production_partials,
+                   jac.production_partials_comp, jac.loss_partials,
+                   jac.loss_partials_comp, time_step);
+#else
+  kernel->calc_jac(state, rxn_env_data, jac.production_partials,
+                   jac.loss_partials, time_step);
+#endif
+}
+
+/** \brief Free a reaction kernel
+ *
+ * \param kernel Kernel to free
+ */
+void rxn_codegen_free(RxnKernel *kernel) {
+  if (kernel == NULL) return;
+  dlclose(kernel->lib_handle);
+  free(kernel->generic_rxn);
+  free(kernel);
+}
+
+#endif
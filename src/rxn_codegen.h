@@ -0,0 +1,78 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Header file for the generated reaction kernels
+ *
+ */
+/** \file
+ * \brief Header file for the generated reaction kernels
+ *
+ * For the gas-phase mass-action reactions (Arrhenius, Troe, CMAQ, photolysis,
+ * ternary chemical activation and Wennberg tunneling), the reaction network
+ * of an initialized solver can be written out as C source with the
+ * reactions unrolled: state, derivative and Jacobian indices are constants
+ * and product yields are folded into the code. Once compiled into a shared
+ * library, e.g.:
+ *
+ *   cc -O2 -fPIC -shared -o rxn_kernel.so rxn_kernel.c
+ *
+ * the kernel can be loaded in place of the generic reaction functions for
+ * the reactions it includes (library paths without a '/' are searched for
+ * by the dynamic linker). Loading checks that the kernel was generated
+ * for the same reaction data and validates its results against the generic
+ * reaction functions. The generated source depends on the type of rate
+ * accumulators (see compensated_sum.h) of the CAMP build that writes it.
+ */
+#ifndef RXN_CODEGEN_H
+#define RXN_CODEGEN_H
+#include "camp_common.h"
+
+#ifdef CAMP_USE_COMPENSATED_SUM
+/* Generated time derivative kernel for one grid cell */
+typedef void (*RxnKernelDerivFn)(const double *state,
+                                 const double *rxn_env_data,
+                                 CampSum *production_rates,
+                                 double *production_rates_comp,
+                                 CampSum *loss_rates, double *loss_rates_comp,
+                                 double time_step);
+
+/* Generated Jacobian kernel for one grid cell */
+typedef void (*RxnKernelJacFn)(const double *state, const double *rxn_env_data,
+                               CampSum *production_partials,
+                               double *production_partials_comp,
+                               CampSum *loss_partials,
+                               double *loss_partials_comp, double time_step);
+#else
+/* Generated time derivative kernel for one grid cell */
+typedef void (*RxnKernelDerivFn)(const double *state,
+                                 const double *rxn_env_data,
+                                 CampSum *production_rates,
+                                 CampSum *loss_rates, double time_step);
+
+/* Generated Jacobian kernel for one grid cell */
+typedef void (*RxnKernelJacFn)(const double *state, const double *rxn_env_data,
+                               CampSum *production_partials,
+                               CampSum *loss_partials, double time_step);
+#endif
+
+/* Loaded reaction kernel */
+typedef struct RxnKernel {
+  void *lib_handle;             // Handle of the shared library
+  RxnKernelDerivFn calc_deriv;  // Time derivative contributions
+  RxnKernelJacFn calc_jac;      // Jacobian contributions
+  int n_generic_rxn;  // Number of reactions not included in the kernel
+  int *generic_rxn;   // Indices of the reactions not included in the kernel
+} RxnKernel;
+
+int rxn_codegen_write_source(ModelData *model_data, const char *file_path);
+RxnKernel *rxn_codegen_load(ModelData *model_data, const char *lib_path);
+void rxn_codegen_calc_deriv(RxnKernel *kernel, const double *state,
+                            const double *rxn_env_data,
+                            TimeDerivative time_deriv, double time_step);
+void rxn_codegen_calc_jac(RxnKernel *kernel, const double *state,
+                          const double *rxn_env_data, Jacobian jac,
+                          double time_step);
+void rxn_codegen_free(RxnKernel *kernel);
+
+#endif
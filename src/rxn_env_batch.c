@@ -0,0 +1,317 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Batch evaluation of rate constants
+ *
+ */
+/** \file
+ * \brief Repacking of the rate expression parameters and batch evaluation
+ *        of the rate constants
+ */
+#include "rxn_env_batch.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "rate_table.h"
+#include "rxn_solver.h"
+#include "vec_math.h"
+
+// Number of groups of reactions
+#define RXN_ENV_BATCH_N_GROUPS 3
+
+// Loops over the reactions of a group have no dependencies between
+// iterations
+#ifdef CAMP_USE_OPENMP
+#define RXN_ENV_BATCH_SIMD _Pragma("omp simd")
+#else
+#define RXN_ENV_BATCH_SIMD
+#endif
+
+// Reaction types and number of parameters of the rate expression of each
+// group. The parameters are the leading floating-point data of the
+// reactions in src/rxns/, except for the Troe fall-off parameter Fc, which
+// is stored as log(Fc).
+static const int group_type[RXN_ENV_BATCH_N_GROUPS] = {
+    RXN_ARRHENIUS, RXN_TROE, RXN_WENNBERG_TUNNELING};
+static const int group_n_param[RXN_ENV_BATCH_N_GROUPS] = {6, 10, 4};
+
+/** \brief Get the group of a reaction
+ *
+ * \param model_data Pointer to the model data
+ * \param i_rxn Index of the reaction
+ * \return Index of the group, or -1 if the reaction is not evaluated in a
+ *         batch
+ */
+static int rxn_env_batch_group(ModelData *model_data, int i_rxn) {
+  int *int_data =
+      &(model_data->rxn_int_data[model_data->rxn_int_indices[i_rxn]]);
+  double *float_data =
+      &(model_data->rxn_float_data[model_data->rxn_float_indices[i_rxn]]);
+
+  switch (int_data[0]) {
+    case RXN_ARRHENIUS:
+      return 0;
+    case RXN_TROE:
+    case RXN_TERNARY_CHEMICAL_ACTIVATION:
+      // Fc^x is calculated as exp(x log(Fc))
+      return float_data[6] > 0.0 ? 1 : -1;
+    case RXN_WENNBERG_TUNNELING:
+      return 2;
+  }
+  return -1;
+}
+
+/** \brief Allocate an array for the batch data
+ *
+ * \param n_elem Number of elements
+ * \param elem_size Size of each element
+ * \return Pointer to the array
+ */
+static void *rxn_env_batch_alloc(int n_elem, size_t elem_size) {
+  void *array = malloc((n_elem > 0 ? n_elem : 1) * elem_size);
+  if (array == NULL) {
+    printf("\n\nERROR allocating space for batch rate constants\n\n");
+    exit(EXIT_FAILURE);
+  }
+  return array;
+}
+
+/** \brief Copy the parameters of a reaction into its group
+ *
+ * \param group Group of the reaction
+ * \param model_data Pointer to the model data
+ * \param i_rxn Index of the reaction
+ * \param i Position of the reaction in the group
+ */
+static void rxn_env_batch_add(RxnEnvBatchGroup *group, ModelData *model_data,
+                              int i_rxn, int i) {
+  int *int_data =
+      &(model_data->rxn_int_data[model_data->rxn_int_indices[i_rxn]]);
+  double *float_data =
+      &(model_data->rxn_float_data[model_data->rxn_float_indices[i_rxn]]);
+  int n_rxn = group->n_rxn;
+
+  group->env_idx[i] = model_data->rxn_env_idx[i_rxn];
+  group->conv_pow[i] = int_data[1] - 1;
+  for (int i_param = 0; i_param < group->n_param; ++i_param)
+    group->param[i_param * n_rxn + i] = float_data[i_param];
+  if (group->type == RXN_TROE) {
+    group->param[6 * n_rxn + i] = log(float_data[6]);
+    // Ternary chemical activation rate constants are scaled by 1e-6
+    if (int_data[0] == RXN_TERNARY_CHEMICAL_ACTIVATION)
+      group->param[8 * n_rxn + i] *= 1.0e-6;
+  }
+}
+
+/** \brief Repack the reactions with batch-evaluated rate constants
+ *
+ * Must be called after the rate table, if any, is built.
+ *
+ * \param model_data Pointer to the model data with all the reactions added
+ * \return New batch data, or NULL if there are no reactions to evaluate in
+ *         batches
+ */
+RxnEnvBatch *rxn_env_batch_new(ModelData *model_data) {
+  RateTable *table = model_data->rate_table;
+  int n_rxn = model_data->n_rxn;
+  int n_batched = 0;
+  int n_filled[RXN_ENV_BATCH_N_GROUPS];
+
+  RxnEnvBatch *batch =
+      (RxnEnvBatch *)rxn_env_batch_alloc(1, sizeof(RxnEnvBatch));
+  batch->n_groups = RXN_ENV_BATCH_N_GROUPS;
+  batch->groups = (RxnEnvBatchGroup *)rxn_env_batch_alloc(
+      RXN_ENV_BATCH_N_GROUPS, sizeof(RxnEnvBatchGroup));
+  batch->batched = (bool *)rxn_env_batch_alloc(n_rxn, sizeof(bool));
+  batch->cell_ids = (int *)rxn_env_batch_alloc(model_data->n_cells, sizeof(int));
+
+  // Count the reactions in each group
+  for (int i_group = 0; i_group < RXN_ENV_BATCH_N_GROUPS; ++i_group) {
+    batch->groups[i_group].type = group_type[i_group];
+    batch->groups[i_group].n_rxn = 0;
+    batch->groups[i_group].n_untabulated = 0;
+    batch->groups[i_group].n_param = group_n_param[i_group];
+    n_filled[i_group] = 0;
+  }
+  for (int i_rxn = 0; i_rxn < n_rxn; ++i_rxn) {
+    int i_group = rxn_env_batch_group(model_data, i_rxn);
+    batch->batched[i_rxn] = i_group >= 0;
+    if (i_group < 0) continue;
+    ++n_batched;
+    ++(batch->groups[i_group].n_rxn);
+    if (table == NULL || !table->tabulated[i_rxn])
+      ++(batch->groups[i_group].n_untabulated);
+  }
+  if (n_batched == 0) {
+    batch->n_groups = 0;
+    rxn_env_batch_free(batch);
+    return NULL;
+  }
+
+  // Allocate the groups
+  for (int i_group = 0; i_group < RXN_ENV_BATCH_N_GROUPS; ++i_group) {
+    RxnEnvBatchGroup *g = &(batch->groups[i_group]);
+    g->env_idx = (int *)rxn_env_batch_alloc(g->n_rxn, sizeof(int));
+    g->conv_pow = (double *)rxn_env_batch_alloc(g->n_rxn, sizeof(double));
+    g->param = (double *)rxn_env_batch_alloc(g->n_param * g->n_rxn,
+                                             sizeof(double));
+    g->rate = (double *)rxn_env_batch_alloc(g->n_rxn, sizeof(double));
+  }
+
+  // Fill the groups with the reactions that are not in the rate table first
+  for (int tabulated = 0; tabulated <= 1; ++tabulated) {
+    for (int i_rxn = 0; i_rxn < n_rxn; ++i_rxn) {
+      int i_group = rxn_env_batch_group(model_data, i_rxn);
+      if (i_group < 0) continue;
+      if ((table != NULL && table->tabulated[i_rxn]) != tabulated) continue;
+      rxn_env_batch_add(&(batch->groups[i_group]), model_data, i_rxn,
+                        n_filled[i_group]++);
+    }
+  }
+
+  return batch;
+}
+
+/** \brief Calculate Arrhenius rate constants
+ *
+ * \param g Group of Arrhenius reactions
+ * \param n_rxn Number of reactions to calculate
+ * \param temp Temperature (K)
+ * \param press Pressure (Pa)
+ */
+static void rxn_env_batch_arrhenius(RxnEnvBatchGroup *g, int n_rxn,
+                                    double temp, double press) {
+  const double *A = &(g->param[0 * g->n_rxn]);
+  const double *B = &(g->param[1 * g->n_rxn]);
+  const double *C = &(g->param[2 * g->n_rxn]);
+  const double *D = &(g->param[3 * g->n_rxn]);
+  const double *E = &(g->param[4 * g->n_rxn]);
+  const double *conv = &(g->param[5 * g->n_rxn]);
+  const double *conv_pow = g->conv_pow;
+  double *rate = g->rate;
+
+  RXN_ENV_BATCH_SIMD
+  for (int i = 0; i < n_rxn; ++i)
+    rate[i] = A[i] * vec_exp(C[i] / temp) * vec_pow(temp / D[i], B[i]) *
+              (1.0 + E[i] * press) *
+              vec_pow_int(conv[i] * press / temp, conv_pow[i]);
+}
+
+/** \brief Calculate Troe and ternary chemical activation rate constants
+ *
+ * \param g Group of Troe reactions
+ * \param n_rxn Number of reactions to calculate
+ * \param temp Temperature (K)
+ * \param press Pressure (Pa)
+ */
+static void rxn_env_batch_troe(RxnEnvBatchGroup *g, int n_rxn, double temp,
+                               double press) {
+  const double *k0_A = &(g->param[0 * g->n_rxn]);
+  const double *k0_B = &(g->param[1 * g->n_rxn]);
+  const double *k0_C = &(g->param[2 * g->n_rxn]);
+  const double *kinf_A = &(g->param[3 * g->n_rxn]);
+  const double *kinf_B = &(g->param[4 * g->n_rxn]);
+  const double *kinf_C = &(g->param[5 * g->n_rxn]);
+  const double *log_fc = &(g->param[6 * g->n_rxn]);
+  const double *N = &(g->param[7 * g->n_rxn]);
+  const double *scaling = &(g->param[8 * g->n_rxn]);
+  const double *conv_factor = &(g->param[9 * g->n_rxn]);
+  const double *conv_pow = g->conv_pow;
+  double *rate = g->rate;
+
+  RXN_ENV_BATCH_SIMD
+  for (int i = 0; i < n_rxn; ++i) {
+    double conv = conv_factor[i] * press / temp;
+    double k0 = k0_A[i] * vec_exp(k0_C[i] / temp) *
+                vec_pow(temp / 300.0, k0_B[i]) * conv;
+    double kinf = k0 / (kinf_A[i] * vec_exp(kinf_C[i] / temp) *
+                        vec_pow(temp / 300.0, kinf_B[i]));
+    double x = vec_log10(kinf) / N[i];
+    rate[i] = (k0 / (1.0 + kinf)) * vec_exp(log_fc[i] * (1.0 / (1.0 + x * x))) *
+              vec_pow_int(conv, conv_pow[i]) * scaling[i];
+  }
+}
+
+/** \brief Calculate Wennberg tunneling rate constants
+ *
+ * \param g Group of Wennberg tunneling reactions
+ * \param n_rxn Number of reactions to calculate
+ * \param temp Temperature (K)
+ * \param press Pressure (Pa)
+ */
+static void rxn_env_batch_wennberg_tunneling(RxnEnvBatchGroup *g, int n_rxn,
+                                             double temp, double press) {
+  const double *A = &(g->param[0 * g->n_rxn]);
+  const double *B = &(g->param[1 * g->n_rxn]);
+  const double *C = &(g->param[2 * g->n_rxn]);
+  const double *conv = &(g->param[3 * g->n_rxn]);
+  const double *conv_pow = g->conv_pow;
+  double *rate = g->rate;
+  double temp_3 = temp * temp * temp;
+
+  RXN_ENV_BATCH_SIMD
+  for (int i = 0; i < n_rxn; ++i)
+    rate[i] = A[i] * vec_exp(-B[i] / temp) * vec_exp(C[i] / temp_3) *
+              vec_pow_int(conv[i] * press / temp, conv_pow[i]);
+}
+
+/** \brief Calculate the batch-evaluated rate constants of a set of grid
+ *         cells
+ *
+ * \param batch Batch data
+ * \param model_data Pointer to the model data with the total environmental
+ *                   state set
+ * \param cell_ids Grid cells to update
+ * \param n_cells Number of grid cells to update
+ * \param skip_tabulated Flag indicating whether to skip the reactions in the
+ *                       rate table (for grid cells within the table range)
+ */
+void rxn_env_batch_update_cells(RxnEnvBatch *batch, ModelData *model_data,
+                                const int *cell_ids, int n_cells,
+                                bool skip_tabulated) {
+  for (int i = 0; i < n_cells; ++i) {
+    int i_cell = cell_ids[i];
+    const double *env = &(model_data->total_env[i_cell * CAMP_NUM_ENV_PARAM_]);
+    double *cell_env_data =
+        &(model_data->rxn_env_data[i_cell * model_data->n_rxn_env_data]);
+
+    for (int i_group = 0; i_group < batch->n_groups; ++i_group) {
+      RxnEnvBatchGroup *g = &(batch->groups[i_group]);
+      int n_rxn = skip_tabulated ? g->n_untabulated : g->n_rxn;
+      if (n_rxn == 0) continue;
+      switch (g->type) {
+        case RXN_ARRHENIUS:
+          rxn_env_batch_arrhenius(g, n_rxn, env[0], env[1]);
+          break;
+        case RXN_TROE:
+          rxn_env_batch_troe(g, n_rxn, env[0], env[1]);
+          break;
+        case RXN_WENNBERG_TUNNELING:
+          rxn_env_batch_wennberg_tunneling(g, n_rxn, env[0], env[1]);
+          break;
+      }
+      for (int i_rxn = 0; i_rxn < n_rxn; ++i_rxn)
+        cell_env_data[g->env_idx[i_rxn]] = g->rate[i_rxn];
+    }
+  }
+}
+
+/** \brief Free the batch data
+ *
+ * \param batch Batch data to free
+ */
+void rxn_env_batch_free(RxnEnvBatch *batch) {
+  if (batch == NULL) return;
+  for (int i_group = 0; i_group < batch->n_groups; ++i_group) {
+    RxnEnvBatchGroup *g = &(batch->groups[i_group]);
+    free(g->env_idx);
+    free(g->conv_pow);
+    free(g->param);
+    free(g->rate);
+  }
+  free(batch->groups);
+  free(batch->batched);
+  free(batch->cell_ids);
+  free(batch);
+}
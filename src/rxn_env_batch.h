@@ -0,0 +1,59 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Header file for the batch evaluation of rate constants
+ *
+ */
+/** \file
+ * \brief Header file for the batch evaluation of rate constants
+ *
+ * The rate constants of the Arrhenius, Troe, ternary chemical activation
+ * and Wennberg tunneling reactions are calculated with exp(), pow() and
+ * log10() by the update functions of each reaction, one reaction and grid
+ * cell at a time. When enabled, the parameters of these reactions are
+ * repacked during solver initialization into one group per rate
+ * expression, with each parameter in its own array, and the rate constants
+ * of all the reactions in a group are calculated together for each grid
+ * cell whose environmental state changed, by loops that use the
+ * vectorizable functions of vec_math.h. The results differ from those of
+ * the update functions only by rounding.
+ *
+ * Reactions in the rate table (see rate_table.h) are placed last in each
+ * group, so they are skipped for the grid cells within the table range.
+ */
+#ifndef RXN_ENV_BATCH_H
+#define RXN_ENV_BATCH_H
+#include "camp_common.h"
+
+/* Reactions that share a rate expression */
+typedef struct {
+  int type;           // Reaction type of the rate expression
+  int n_rxn;          // Number of reactions
+  int n_untabulated;  // Number of reactions (first in the arrays) not in the
+                      // rate table
+  int n_param;        // Number of parameters per reaction
+  int *env_idx;       // Offsets of the rate constants in the reaction
+                      // environment-dependent data [n_rxn]
+  double *conv_pow;   // Power of the concentration conversion (number of
+                      // reactants - 1) [n_rxn]
+  double *param;      // Rate expression parameters [n_param][n_rxn]
+  double *rate;       // Rate constants of one grid cell [n_rxn]
+} RxnEnvBatchGroup;
+
+/* Batch evaluation of rate constants */
+typedef struct RxnEnvBatch {
+  int n_groups;               // Number of groups
+  RxnEnvBatchGroup *groups;   // Groups of reactions
+  bool *batched;              // Flags indicating which reactions are in the
+                              // groups [n_rxn]
+  int *cell_ids;              // Grid cells to update [n_cells]
+} RxnEnvBatch;
+
+RxnEnvBatch *rxn_env_batch_new(ModelData *model_data);
+void rxn_env_batch_update_cells(RxnEnvBatch *batch, ModelData *model_data,
+                                const int *cell_ids, int n_cells,
+                                bool skip_tabulated);
+void rxn_env_batch_free(RxnEnvBatch *batch);
+
+#endif
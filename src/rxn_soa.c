@@ -0,0 +1,519 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Structure-of-arrays reaction tables
+ *
+ */
+/** \file
+ * \brief Repacking and evaluation of the structure-of-arrays reaction tables
+ */
+#include "rxn_soa.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "rxn_solver.h"
+
+// Number of reactions whose rates are calculated together
+#define RXN_SOA_CHUNK 64
+
+// Loops over the reactions of a chunk have no dependencies between
+// iterations
+#ifdef CAMP_USE_OPENMP
+#define RXN_SOA_SIMD _Pragma("omp simd")
+#else
+#define RXN_SOA_SIMD
+#endif
+
+/** \brief Get the data of a mass-action reaction
+ *
+ * The data layouts must match those of the reactions in src/rxns/.
+ *
+ * \param model_data Pointer to the model data
+ * \param i_rxn Index of the reaction
+ * \param rxn Reaction data to set
+ * \return 1 if the reaction is a mass-action reaction, 0 otherwise
+ */
+int rxn_mass_action_get(ModelData *model_data, int i_rxn, RxnMassAction *rxn) {
+  int *int_data =
+      &(model_data->rxn_int_data[model_data->rxn_int_indices[i_rxn]]);
+  double *float_data =
+      &(model_data->rxn_float_data[model_data->rxn_float_indices[i_rxn]]);
+  int n_int_prop, n_float_prop;
+
+  rxn->type = *(int_data++);
+  switch (rxn->type) {
+    case RXN_ARRHENIUS:
+      n_int_prop = 2;
+      n_float_prop = 6;
+      break;
+    case RXN_TROE:
+    case RXN_TERNARY_CHEMICAL_ACTIVATION:
+      n_int_prop = 2;
+      n_float_prop = 10;
+      break;
+    case RXN_CMAQ_H2O2:
+      n_int_prop = 2;
+      n_float_prop = 7;
+      break;
+    case RXN_CMAQ_OH_HNO3:
+      n_int_prop = 2;
+      n_float_prop = 11;
+      break;
+    case RXN_PHOTOLYSIS:
+      n_int_prop = 3;
+      n_float_prop = 1;
+      break;
+    case RXN_WENNBERG_TUNNELING:
+      n_int_prop = 2;
+      n_float_prop = 4;
+      break;
+    default:
+      return 0;
+  }
+  rxn->n_react = int_data[0];
+  rxn->n_prod = int_data[1];
+  rxn->react = &(int_data[n_int_prop]);
+  rxn->prod = &(int_data[n_int_prop + rxn->n_react]);
+  rxn->deriv_id = &(int_data[n_int_prop + rxn->n_react + rxn->n_prod]);
+  rxn->jac_id = &(int_data[n_int_prop + 2 * (rxn->n_react + rxn->n_prod)]);
+  rxn->yield = &(float_data[n_float_prop]);
+  rxn->env_idx = model_data->rxn_env_idx[i_rxn];
+  rxn->n_int_data = model_data->rxn_int_indices[i_rxn + 1] -
+                    model_data->rxn_int_indices[i_rxn];
+  return 1;
+}
+
+/** \brief Allocate an array for a reaction table
+ *
+ * \param n_elem Number of elements
+ * \param elem_size Size of each element
+ * \return Pointer to the array
+ */
+static void *rxn_soa_alloc(int n_elem, size_t elem_size) {
+  void *array = malloc((n_elem > 0 ? n_elem : 1) * elem_size);
+  if (array == NULL) {
+    printf("\n\nERROR allocating space for reaction tables\n\n");
+    exit(EXIT_FAILURE);
+  }
+  return array;
+}
+
+/** \brief Repack the mass-action reactions into structure-of-arrays tables
+ *
+ * Must be called after the derivative and Jacobian ids of the reactions are
+ * set. The tables copy the reaction ids and yields, which are not changed by
+ * the reaction update functions.
+ *
+ * \param model_data Pointer to the model data
+ * \return Reaction tables
+ */
+RxnSoA *rxn_soa_new(ModelData *model_data) {
+  RxnSoA *soa;
+  RxnMassAction rxn;
+  int max_react = -1;
+  int *n_filled;
+
+  soa = (RxnSoA *)rxn_soa_alloc(1, sizeof(RxnSoA));
+  soa->n_generic_rxn = 0;
+  soa->generic_rxn = (int *)rxn_soa_alloc(model_data->n_rxn, sizeof(int));
+
+  // Find the reactions to use the generic reaction functions for and the
+  // largest number of reactants
+  for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn) {
+    if (rxn_mass_action_get(model_data, i_rxn, &rxn) == 0) {
+      soa->generic_rxn[soa->n_generic_rxn++] = i_rxn;
+      continue;
+    }
+    if (rxn.n_react > max_react) max_react = rxn.n_react;
+  }
+
+  // Count the reactions and products in each table
+  soa->n_tables = max_react + 1;
+  soa->tables =
+      (RxnSoATable *)rxn_soa_alloc(soa->n_tables, sizeof(RxnSoATable));
+  n_filled = (int *)rxn_soa_alloc(soa->n_tables, sizeof(int));
+  for (int i_table = 0; i_table < soa->n_tables; ++i_table) {
+    soa->tables[i_table].n_react = i_table;
+    soa->tables[i_table].n_rxn = 0;
+    soa->tables[i_table].n_prod = 0;
+    n_filled[i_table] = 0;
+  }
+  for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn) {
+    if (rxn_mass_action_get(model_data, i_rxn, &rxn) == 0) continue;
+    ++(soa->tables[rxn.n_react].n_rxn);
+    soa->tables[rxn.n_react].n_prod += rxn.n_prod;
+  }
+
+  // Allocate the tables
+  for (int i_table = 0; i_table < soa->n_tables; ++i_table) {
+    RxnSoATable *t = &(soa->tables[i_table]);
+    t->env_idx = (int *)rxn_soa_alloc(t->n_rxn, sizeof(int));
+    t->react = (int *)rxn_soa_alloc(t->n_react * t->n_rxn, sizeof(int));
+    t->react_deriv = (int *)rxn_soa_alloc(t->n_react * t->n_rxn, sizeof(int));
+    t->prod_ptr = (int *)rxn_soa_alloc(t->n_rxn + 1, sizeof(int));
+    t->prod = (int *)rxn_soa_alloc(t->n_prod, sizeof(int));
+    t->prod_deriv = (int *)rxn_soa_alloc(t->n_prod, sizeof(int));
+    t->yield = (double *)rxn_soa_alloc(t->n_prod, sizeof(double));
+    t->loss_jac = (int *)rxn_soa_alloc(t->n_react * t->n_react * t->n_rxn,
+                                       sizeof(int));
+    t->prod_jac = (int *)rxn_soa_alloc(t->n_react * t->n_prod, sizeof(int));
+    t->prod_ptr[0] = 0;
+  }
+
+  // Fill the tables, keeping the reactions in their original order
+  for (int i_rxn = 0; i_rxn < model_data->n_rxn; ++i_rxn) {
+    RxnSoATable *t;
+    int i_soa, first_prod, n_dep;
+    if (rxn_mass_action_get(model_data, i_rxn, &rxn) == 0) continue;
+    t = &(soa->tables[rxn.n_react]);
+    i_soa = n_filled[rxn.n_react]++;
+    first_prod = t->prod_ptr[i_soa];
+    n_dep = rxn.n_react + rxn.n_prod;
+    t->env_idx[i_soa] = rxn.env_idx;
+    t->prod_ptr[i_soa + 1] = first_prod + rxn.n_prod;
+    for (int i_ind = 0; i_ind < rxn.n_react; ++i_ind) {
+      t->react[i_ind * t->n_rxn + i_soa] = rxn.react[i_ind] - 1;
+      t->react_deriv[i_ind * t->n_rxn + i_soa] = rxn.deriv_id[i_ind];
+      for (int i_dep = 0; i_dep < rxn.n_react; ++i_dep)
+        t->loss_jac[(i_ind * t->n_react + i_dep) * t->n_rxn + i_soa] =
+            rxn.jac_id[i_ind * n_dep + i_dep];
+      for (int i_prod = 0; i_prod < rxn.n_prod; ++i_prod)
+        t->prod_jac[i_ind * t->n_prod + first_prod + i_prod] =
+            rxn.jac_id[i_ind * n_dep + rxn.n_react + i_prod];
+    }
+    for (int i_prod = 0; i_prod < rxn.n_prod; ++i_prod) {
+      t->prod[first_prod + i_prod] = rxn.prod[i_prod] - 1;
+      t->prod_deriv[first_prod + i_prod] = rxn.deriv_id[rxn.n_react + i_prod];
+      t->yield[first_prod + i_prod] = rxn.yield[i_prod];
+    }
+  }
+
+  free(n_filled);
+  return soa;
+}
+
+/** \brief Calculate the rates (or rate partial derivatives) for a chunk of
+ *         reactions in a table
+ *
+ * \param t Reaction table
+ * \param state Model state for the current grid cell
+ * \param rxn_env_data Reaction environment-dependent data for the current
+ *                     grid cell
+ * \param first Index of the first reaction in the chunk
+ * \param n Number of reactions in the chunk
+ * \param i_skip Index of a reactant to leave out of the rates (for partial
+ *               derivatives), or -1 to include all reactants
+ * \param rate Calculated rates
+ */
+static void rxn_soa_calc_rates(const RxnSoATable *t, const double *state,
+                               const double *rxn_env_data, int first, int n,
+                               int i_skip, double *rate) {
+  const int *env_idx = &(t->env_idx[first]);
+
+  RXN_SOA_SIMD
+  for (int i = 0; i < n; ++i) rate[i] = rxn_env_data[env_idx[i]];
+  for (int i_spec = 0; i_spec < t->n_react; ++i_spec) {
+    const int *react = &(t->react[i_spec * t->n_rxn + first]);
+    if (i_spec == i_skip) continue;
+    RXN_SOA_SIMD
+    for (int i = 0; i < n; ++i) rate[i] *= state[react[i]];
+  }
+}
+
+/** \brief Add the time derivative contributions of the reaction tables
+ *
+ * \param model_data Pointer to the model data for the current grid cell
+ * \param soa Reaction tables
+ * \param time_deriv TimeDerivative to add contributions to
+ * \param time_step Current time step [s]
+ */
+void rxn_soa_calc_deriv(ModelData *model_data, RxnSoA *soa,
+                        TimeDerivative time_deriv, double time_step) {
+  const double *state = model_data->grid_cell_state;
+  const double *rxn_env_data = model_data->grid_cell_rxn_env_data;
+  double rate[RXN_SOA_CHUNK];
+
+  for (int i_table = 0; i_table < soa->n_tables; ++i_table) {
+    const RxnSoATable *t = &(soa->tables[i_table]);
+    for (int first = 0; first < t->n_rxn; first += RXN_SOA_CHUNK) {
+      int n = t->n_rxn - first < RXN_SOA_CHUNK ? t->n_rxn - first
+                                               : RXN_SOA_CHUNK;
+      rxn_soa_calc_rates(t, state, rxn_env_data, first, n, -1, rate);
+      for (int i = 0; i < n; ++i) {
+        int i_soa = first + i;
+        if (rate[i] == 0.0) continue;
+        for (int i_spec = 0; i_spec < t->n_react; ++i_spec) {
+          int deriv_id = t->react_deriv[i_spec * t->n_rxn + i_soa];
+          if (deriv_id < 0) continue;
+          time_derivative_add_value(time_deriv, deriv_id, -rate[i]);
+        }
+        for (int i_prod = t->prod_ptr[i_soa]; i_prod < t->prod_ptr[i_soa + 1];
+             ++i_prod) {
+          if (t->prod_deriv[i_prod] < 0) continue;
+          // Negative yields are allowed, but prevented from causing negative
+          // concentrations that lead to solver failures
+          if (-rate[i] * t->yield[i_prod] * time_step <= state[t->prod[i_prod]])
+            time_derivative_add_value(time_deriv, t->prod_deriv[i_prod],
+                                      rate[i] * t->yield[i_prod]);
+        }
+      }
+    }
+  }
+}
+
+/** \brief Add the time derivative contributions of the reaction tables for
+ *         a chunk of grid cells
+ *
+ * All arrays are species-major: element i_cell of variable i is at
+ * [i * stride + i_cell]. For each grid cell, the contributions are added in
+ * the same order as by \c rxn_soa_calc_deriv().
+ *
+ * \param soa Reaction tables
+ * \param state Model state of the grid cells
+ * \param rxn_env_data Reaction environment-dependent data of the grid cells
+ * \param time_deriv TimeDerivative object for the grid cells, indexed by
+ *                   derivative id
+ * \param n_cells Number of grid cells
+ * \param stride Stride between the variables in the arrays
+ *               (>= n_cells)
+ * \param time_step Current time step [s]
+ */
+void rxn_soa_calc_deriv_cells(RxnSoA *soa, const double *state,
+                              const double *rxn_env_data,
+                              TimeDerivative time_deriv, int n_cells,
+                              int stride, double time_step) {
+  double rate[RXN_SOA_CHUNK];
+
+  for (int i_table = 0; i_table < soa->n_tables; ++i_table) {
+    const RxnSoATable *t = &(soa->tables[i_table]);
+    for (int i_soa = 0; i_soa < t->n_rxn; ++i_soa) {
+      const double *k = &(rxn_env_data[t->env_idx[i_soa] * stride]);
+      for (int first = 0; first < n_cells; first += RXN_SOA_CHUNK) {
+        int n = n_cells - first < RXN_SOA_CHUNK ? n_cells - first
+                                                : RXN_SOA_CHUNK;
+
+        // Calculate the rates for the grid cells
+        RXN_SOA_SIMD
+        for (int i = 0; i < n; ++i) rate[i] = k[first + i];
+        for (int i_spec = 0; i_spec < t->n_react; ++i_spec) {
+          const double *conc =
+              &(state[t->react[i_spec * t->n_rxn + i_soa] * stride + first]);
+          RXN_SOA_SIMD
+          for (int i = 0; i < n; ++i) rate[i] *= conc[i];
+        }
+
+        // Add the reactant contributions
+        for (int i_spec = 0; i_spec < t->n_react; ++i_spec) {
+          int deriv_id = t->react_deriv[i_spec * t->n_rxn + i_soa];
+          if (deriv_id < 0) continue;
+          for (int i = 0, i_deriv = deriv_id * stride + first; i < n;
+               ++i, ++i_deriv) {
+            if (rate[i] > 0.0) {
+              CAMP_SUM_ADD(time_deriv.loss_rates, time_deriv.loss_rates_comp,
+                           i_deriv, rate[i]);
+            } else if (rate[i] < 0.0) {
+              CAMP_SUM_ADD(time_deriv.production_rates,
+                           time_deriv.production_rates_comp, i_deriv,
+                           -rate[i]);
+            }
+          }
+        }
+
+        // Add the product contributions. Negative yields are allowed, but
+        // prevented from causing negative concentrations that lead to solver
+        // failures
+        for (int i_prod = t->prod_ptr[i_soa]; i_prod < t->prod_ptr[i_soa + 1];
+             ++i_prod) {
+          int deriv_id = t->prod_deriv[i_prod];
+          double yield = t->yield[i_prod];
+          const double *conc = &(state[t->prod[i_prod] * stride + first]);
+          if (deriv_id < 0) continue;
+          for (int i = 0, i_deriv = deriv_id * stride + first; i < n;
+               ++i, ++i_deriv) {
+            double contrib = rate[i] * yield;
+            if (rate[i] == 0.0 || -rate[i] * yield * time_step > conc[i])
+              continue;
+            if (contrib > 0.0) {
+              CAMP_SUM_ADD(time_deriv.production_rates,
+                           time_deriv.production_rates_comp, i_deriv, contrib);
+            } else {
+              CAMP_SUM_ADD(time_deriv.loss_rates, time_deriv.loss_rates_comp,
+                           i_deriv, -contrib);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+/** \brief Add the Jacobian contributions of the reaction tables
+ *
+ * \param model_data Pointer to the model data for the current grid cell
+ * \param soa Reaction tables
+ * \param jac Jacobian to add contributions to
+ * \param time_step Current time step [s]
+ */
+void rxn_soa_calc_jac(ModelData *model_data, RxnSoA *soa, Jacobian jac,
+                      double time_step) {
+  const double *state = model_data->grid_cell_state;
+  const double *rxn_env_data = model_data->grid_cell_rxn_env_data;
+  double rate[RXN_SOA_CHUNK];
+
+  for (int i_table = 0; i_table < soa->n_tables; ++i_table) {
+    const RxnSoATable *t = &(soa->tables[i_table]);
+    for (int first = 0; first < t->n_rxn; first += RXN_SOA_CHUNK) {
+      int n = t->n_rxn - first < RXN_SOA_CHUNK ? t->n_rxn - first
+                                               : RXN_SOA_CHUNK;
+      for (int i_ind = 0; i_ind < t->n_react; ++i_ind) {
+        const int *react = &(t->react[i_ind * t->n_rxn]);
+        const int *prod_jac = &(t->prod_jac[i_ind * t->n_prod]);
+
+        // Calculate d_rate / d_i_ind
+        rxn_soa_calc_rates(t, state, rxn_env_data, first, n, i_ind, rate);
+        for (int i = 0; i < n; ++i) {
+          int i_soa = first + i;
+          for (int i_dep = 0; i_dep < t->n_react; ++i_dep) {
+            int jac_id =
+                t->loss_jac[(i_ind * t->n_react + i_dep) * t->n_rxn + i_soa];
+            if (jac_id < 0) continue;
+            jacobian_add_value(jac, (unsigned int)jac_id, JACOBIAN_LOSS,
+                               rate[i]);
+          }
+          for (int i_prod = t->prod_ptr[i_soa];
+               i_prod < t->prod_ptr[i_soa + 1]; ++i_prod) {
+            if (prod_jac[i_prod] < 0) continue;
+            // Negative yields are allowed, but prevented from causing
+            // negative concentrations that lead to solver failures
+            if (-rate[i] * state[react[i_soa]] * t->yield[i_prod] *
+                    time_step <=
+                state[t->prod[i_prod]])
+              jacobian_add_value(jac, (unsigned int)prod_jac[i_prod],
+                                 JACOBIAN_PRODUCTION,
+                                 t->yield[i_prod] * rate[i]);
+          }
+        }
+      }
+    }
+  }
+}
+
+/** \brief Add the time derivative and Jacobian contributions of the reaction
+ *         tables in one pass
+ *
+ * The products of the rate constants and the reactant concentrations are
+ * built up one reactant at a time, and each partial product is shared by
+ * the rate partial derivative with respect to that reactant and by the
+ * overall rate. The contributions are the same as those of
+ * \c rxn_soa_calc_deriv() and \c rxn_soa_calc_jac().
+ *
+ * \param model_data Pointer to the model data for the current grid cell
+ * \param soa Reaction tables
+ * \param time_deriv TimeDerivative to add contributions to
+ * \param jac Jacobian to add contributions to
+ * \param time_step Current time step [s]
+ */
+void rxn_soa_calc_deriv_jac(ModelData *model_data, RxnSoA *soa,
+                            TimeDerivative time_deriv, Jacobian jac,
+                            double time_step) {
+  const double *state = model_data->grid_cell_state;
+  const double *rxn_env_data = model_data->grid_cell_rxn_env_data;
+  double rate[RXN_SOA_CHUNK];
+  double partial[RXN_SOA_CHUNK];
+
+  for (int i_table = 0; i_table < soa->n_tables; ++i_table) {
+    const RxnSoATable *t = &(soa->tables[i_table]);
+    for (int first = 0; first < t->n_rxn; first += RXN_SOA_CHUNK) {
+      int n = t->n_rxn - first < RXN_SOA_CHUNK ? t->n_rxn - first
+                                               : RXN_SOA_CHUNK;
+      const int *env_idx = &(t->env_idx[first]);
+
+      // rate holds the rate constant times the concentrations of the
+      // reactants before i_ind
+      RXN_SOA_SIMD
+      for (int i = 0; i < n; ++i) rate[i] = rxn_env_data[env_idx[i]];
+      for (int i_ind = 0; i_ind < t->n_react; ++i_ind) {
+        const int *react = &(t->react[i_ind * t->n_rxn]);
+        const int *prod_jac = &(t->prod_jac[i_ind * t->n_prod]);
+
+        // Calculate d_rate / d_i_ind from the shared partial product
+        RXN_SOA_SIMD
+        for (int i = 0; i < n; ++i) partial[i] = rate[i];
+        for (int i_spec = i_ind + 1; i_spec < t->n_react; ++i_spec) {
+          const int *conc_id = &(t->react[i_spec * t->n_rxn + first]);
+          RXN_SOA_SIMD
+          for (int i = 0; i < n; ++i) partial[i] *= state[conc_id[i]];
+        }
+        for (int i = 0; i < n; ++i) {
+          int i_soa = first + i;
+          for (int i_dep = 0; i_dep < t->n_react; ++i_dep) {
+            int jac_id =
+                t->loss_jac[(i_ind * t->n_react + i_dep) * t->n_rxn + i_soa];
+            if (jac_id < 0) continue;
+            jacobian_add_value(jac, (unsigned int)jac_id, JACOBIAN_LOSS,
+                               partial[i]);
+          }
+          for (int i_prod = t->prod_ptr[i_soa];
+               i_prod < t->prod_ptr[i_soa + 1]; ++i_prod) {
+            if (prod_jac[i_prod] < 0) continue;
+            // Negative yields are allowed, but prevented from causing
+            // negative concentrations that lead to solver failures
+            if (-partial[i] * state[react[i_soa]] * t->yield[i_prod] *
+                    time_step <=
+                state[t->prod[i_prod]])
+              jacobian_add_value(jac, (unsigned int)prod_jac[i_prod],
+                                 JACOBIAN_PRODUCTION,
+                                 t->yield[i_prod] * partial[i]);
+          }
+        }
+
+        // Include reactant i_ind in the partial product
+        RXN_SOA_SIMD
+        for (int i = 0; i < n; ++i) rate[i] *= state[react[first + i]];
+      }
+
+      // rate now holds the overall rates
+      for (int i = 0; i < n; ++i) {
+        int i_soa = first + i;
+        if (rate[i] == 0.0) continue;
+        for (int i_spec = 0; i_spec < t->n_react; ++i_spec) {
+          int deriv_id = t->react_deriv[i_spec * t->n_rxn + i_soa];
+          if (deriv_id < 0) continue;
+          time_derivative_add_value(time_deriv, deriv_id, -rate[i]);
+        }
+        for (int i_prod = t->prod_ptr[i_soa]; i_prod < t->prod_ptr[i_soa + 1];
+             ++i_prod) {
+          if (t->prod_deriv[i_prod] < 0) continue;
+          // Negative yields are allowed, but prevented from causing negative
+          // concentrations that lead to solver failures
+          if (-rate[i] * t->yield[i_prod] * time_step <= state[t->prod[i_prod]])
+            time_derivative_add_value(time_deriv, t->prod_deriv[i_prod],
+                                      rate[i] * t->yield[i_prod]);
+        }
+      }
+    }
+  }
+}
+
+/** \brief Free the reaction tables
+ *
+ * \param soa Reaction tables to free
+ */
+void rxn_soa_free(RxnSoA *soa) {
+  if (soa == NULL) return;
+  for (int i_table = 0; i_table < soa->n_tables; ++i_table) {
+    RxnSoATable *t = &(soa->tables[i_table]);
+    free(t->env_idx);
+    free(t->react);
+    free(t->react_deriv);
+    free(t->prod_ptr);
+    free(t->prod);
+    free(t->prod_deriv);
+    free(t->yield);
+    free(t->loss_jac);
+    free(t->prod_jac);
+  }
+  free(soa->tables);
+  free(soa->generic_rxn);
+  free(soa);
+}
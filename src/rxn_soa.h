@@ -0,0 +1,89 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Header file for the structure-of-arrays reaction tables
+ *
+ */
+/** \file
+ * \brief Header file for the structure-of-arrays reaction tables
+ *
+ * The gas-phase mass-action reactions (Arrhenius, Troe, CMAQ, photolysis,
+ * ternary chemical activation and Wennberg tunneling) only differ in how
+ * their rate constants are calculated, which is done when the environmental
+ * state is updated. Their derivative and Jacobian contributions depend only
+ * on the rate constant, the reactant and product ids and the yields. During
+ * solver initialization these reactions are repacked into one table per
+ * number of reactants, with each parameter in its own array, so the rates
+ * for a set of reactions are calculated by loops without branches on the
+ * reaction type. The flat reaction data is still used by the remaining
+ * reactions and by the reaction update functions.
+ *
+ * As the tables are the same for every grid cell, the time derivative
+ * contributions can also be calculated for a chunk of grid cells at once
+ * from a species-major ([species][grid cell]) copy of their state, with the
+ * innermost loops over the grid cells.
+ */
+#ifndef RXN_SOA_H
+#define RXN_SOA_H
+#include "camp_common.h"
+
+/* Data for a mass-action reaction in the flat reaction data */
+typedef struct {
+  int type;        // Reaction type
+  int n_react;     // Number of reactants
+  int n_prod;      // Number of products
+  int *react;      // Reactant state ids (1-based)
+  int *prod;       // Product state ids (1-based)
+  int *deriv_id;   // Derivative ids for reactants and products
+  int *jac_id;     // Jacobian element ids
+  double *yield;   // Product yields
+  int env_idx;     // Offset of the rate constant in the reaction
+                   // environment-dependent data
+  int n_int_data;  // Number of integer parameters (incl. type)
+} RxnMassAction;
+
+/* Mass-action reactions with the same number of reactants */
+typedef struct {
+  int n_react;       // Number of reactants per reaction
+  int n_rxn;         // Number of reactions
+  int n_prod;        // Total number of products
+  int *env_idx;      // Offsets of the rate constants in the reaction
+                     // environment-dependent data [n_rxn]
+  int *react;        // Reactant state ids [n_react][n_rxn]
+  int *react_deriv;  // Reactant derivative ids [n_react][n_rxn]
+  int *prod_ptr;     // Index of the first product of each reaction
+                     // [n_rxn + 1]
+  int *prod;         // Product state ids [n_prod]
+  int *prod_deriv;   // Product derivative ids [n_prod]
+  double *yield;     // Product yields [n_prod]
+  int *loss_jac;     // Jacobian ids for d(reactant)/d(reactant)
+                     // [n_react][n_react][n_rxn]
+  int *prod_jac;     // Jacobian ids for d(product)/d(reactant)
+                     // [n_react][n_prod]
+} RxnSoATable;
+
+/* Structure-of-arrays reaction tables */
+typedef struct RxnSoA {
+  int n_tables;         // Number of tables
+  RxnSoATable *tables;  // Tables of mass-action reactions
+  int n_generic_rxn;    // Number of reactions not included in the tables
+  int *generic_rxn;     // Indices of the reactions not included in the tables
+} RxnSoA;
+
+int rxn_mass_action_get(ModelData *model_data, int i_rxn, RxnMassAction *rxn);
+RxnSoA *rxn_soa_new(ModelData *model_data);
+void rxn_soa_calc_deriv(ModelData *model_data, RxnSoA *soa,
+                        TimeDerivative time_deriv, double time_step);
+void rxn_soa_calc_deriv_cells(RxnSoA *soa, const double *state,
+                              const double *rxn_env_data,
+                              TimeDerivative time_deriv, int n_cells,
+                              int stride, double time_step);
+void rxn_soa_calc_jac(ModelData *model_data, RxnSoA *soa, Jacobian jac,
+                      double time_step);
+void rxn_soa_calc_deriv_jac(ModelData *model_data, RxnSoA *soa,
+                            TimeDerivative time_deriv, Jacobian jac,
+                            double time_step);
+void rxn_soa_free(RxnSoA *soa);
+
+#endif
@@ -11,28 +11,15 @@
 #define CAMP_DEBUG_SPEC_ 118
 
 #include "rxn_solver.h"
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "rate_table.h"
+#include "rxn_codegen.h"
+#include "rxn_env_batch.h"
+#include "rxn_soa.h"
 #include "rxns.h"
-
-// Reaction types (Must match parameters defined in camp_rxn_factory)
-#define RXN_ARRHENIUS 1
-#define RXN_TROE 2
-#define RXN_CMAQ_H2O2 3
-#define RXN_CMAQ_OH_HNO3 4
-#define RXN_PHOTOLYSIS 5
-#define RXN_HL_PHASE_TRANSFER 6
-#define RXN_AQUEOUS_EQUILIBRIUM 7
-#define RXN_SIMPOL_PHASE_TRANSFER 10
-#define RXN_CONDENSED_PHASE_ARRHENIUS 11
-#define RXN_FIRST_ORDER_LOSS 12
-#define RXN_EMISSION 13
-#define RXN_WET_DEPOSITION 14
-#define RXN_TERNARY_CHEMICAL_ACTIVATION 15
-#define RXN_WENNBERG_TUNNELING 16
-#define RXN_WENNBERG_NO_RO2 17
-#define RXN_CONDENSED_PHASE_PHOTOLYSIS 18
-#define RXN_SURFACE 19
+#include "solver_profile.h"
 
 /** \brief Get the Jacobian elements used by a particular reaction
  *
@@ -225,8 +212,19 @@ void rxn_update_env_state(ModelData *model_data) {
   // Get the number of reactions
   int n_rxn = model_data->n_rxn;
 
+  // Tabulated reactions are interpolated separately when the environmental
+  // state is within the table range, and batch-evaluated reactions are
+  // calculated separately otherwise
+  RateTable *table = model_data->rate_table;
+  RxnEnvBatch *batch = model_data->rxn_env_batch;
+  bool use_table =
+      table != NULL && rate_table_covers(table, model_data->grid_cell_env);
+
   // Loop through the reactions advancing the rxn_data pointer each time
   for (int i_rxn = 0; i_rxn < n_rxn; i_rxn++) {
+    if (use_table && table->tabulated[i_rxn]) continue;
+    if (batch != NULL && batch->batched[i_rxn]) continue;
+
     // Get pointers to the reaction data
     int *rxn_int_data =
         &(model_data->rxn_int_data[model_data->rxn_int_indices[i_rxn]]);
@@ -312,20 +310,33 @@ void rxn_update_env_state(ModelData *model_data) {
   }
 }
 
-/** \brief Calculate the time derivative \f$f(t,y)\f$
+/** \brief Add the time derivative contributions of a set of reactions using
+ *         the type-specific reaction functions
  *
  * \param model_data Pointer to the model data
  * \param time_deriv TimeDerivative to use to build derivative array
  * \param time_step Current model time step (s)
+ * \param n_rxn Number of reactions to include
+ * \param rxn_ids Indices of the reactions to include (NULL for the first
+ *                n_rxn reactions)
+ * \param profile Profile to add the time of each reaction type to (NULL to
+ *                not time the reactions). The clock is only read when the
+ *                reaction type changes, so consecutive reactions of the same
+ *                type are timed together.
  */
 #ifdef CAMP_USE_SUNDIALS
-void rxn_calc_deriv(ModelData *model_data, TimeDerivative time_deriv,
-                    realtype time_step) {
-  // Get the number of reactions
-  int n_rxn = model_data->n_rxn;
+static void rxn_calc_deriv_rxns(ModelData *model_data,
+                                TimeDerivative time_deriv, realtype time_step,
+                                int n_rxn, int *rxn_ids,
+                                SolverProfile *profile) {
+  bool timed = profile != NULL && profile->enabled;
+  double run_start = timed ? solver_profile_now() : 0.0;
+  int run_type = -1, run_calls = 0;
 
   // Loop through the reactions advancing the rxn_data pointer each time
-  for (int i_rxn = 0; i_rxn < n_rxn; i_rxn++) {
+  for (int i_loop = 0; i_loop < n_rxn; i_loop++) {
+    int i_rxn = rxn_ids == NULL ? i_loop : rxn_ids[i_loop];
+
     // Get pointers to the reaction data
     int *rxn_int_data =
         &(model_data->rxn_int_data[model_data->rxn_int_indices[i_rxn]]);
@@ -337,6 +348,16 @@ void rxn_calc_deriv(ModelData *model_data, TimeDerivative time_deriv,
     // Get the reaction type
     int rxn_type = *(rxn_int_data++);
 
+    // Time runs of reactions of the same type
+    if (timed && rxn_type != run_type) {
+      if (run_calls > 0)
+        run_start =
+            solver_profile_stop_rxn(profile, run_type, run_calls, run_start);
+      run_type = rxn_type;
+      run_calls = 0;
+    }
+    ++run_calls;
+
     // Call the appropriate function
     switch (rxn_type) {
       case RXN_AQUEOUS_EQUILIBRIUM:
@@ -425,6 +446,74 @@ void rxn_calc_deriv(ModelData *model_data, TimeDerivative time_deriv,
         break;
     }
   }
+
+  if (timed && run_calls > 0)
+    solver_profile_stop_rxn(profile, run_type, run_calls, run_start);
+}
+#endif
+
+/** \brief Calculate the time derivative \f$f(t,y)\f$
+ *
+ * \param model_data Pointer to the model data
+ * \param time_deriv TimeDerivative to use to build derivative array
+ * \param time_step Current model time step (s)
+ */
+#ifdef CAMP_USE_SUNDIALS
+void rxn_calc_deriv(ModelData *model_data, TimeDerivative time_deriv,
+                    realtype time_step) {
+  // Get the number of reactions
+  int n_rxn = model_data->n_rxn;
+  int *rxn_ids = NULL;
+  SolverProfile *profile = model_data->profile;
+  double profile_start = solver_profile_start(profile);
+
+  // Add contributions from the generated kernel or the reaction tables and
+  // loop through the reactions they do not include
+  if (model_data->rxn_kernel != NULL) {
+    rxn_codegen_calc_deriv(model_data->rxn_kernel, model_data->grid_cell_state,
+                           model_data->grid_cell_rxn_env_data, time_deriv,
+                           time_step);
+    n_rxn = model_data->rxn_kernel->n_generic_rxn;
+    rxn_ids = model_data->rxn_kernel->generic_rxn;
+  } else if (model_data->rxn_soa != NULL) {
+    rxn_soa_calc_deriv(model_data, model_data->rxn_soa, time_deriv,
+                       time_step);
+    n_rxn = model_data->rxn_soa->n_generic_rxn;
+    rxn_ids = model_data->rxn_soa->generic_rxn;
+  }
+  if (rxn_ids != NULL && profile != NULL && profile->enabled)
+    solver_profile_stop_rxn(profile, 0, model_data->n_rxn - n_rxn,
+                            profile_start);
+
+  rxn_calc_deriv_rxns(model_data, time_deriv, time_step, n_rxn, rxn_ids,
+                      profile);
+  solver_profile_stop(profile, CAMP_PROFILE_RXN_DERIV, profile_start);
+}
+
+/** \brief Calculate the time derivative contributions of the reactions not
+ *         included in the structure-of-arrays reaction tables
+ *
+ * Used with \c rxn_soa_calc_deriv_cells(), which calculates the
+ * contributions of the table reactions for several grid cells at once.
+ *
+ * \param model_data Pointer to the model data
+ * \param time_deriv TimeDerivative to use to build derivative array
+ * \param time_step Current model time step (s)
+ */
+void rxn_calc_deriv_generic(ModelData *model_data, TimeDerivative time_deriv,
+                            realtype time_step) {
+  SolverProfile *profile = model_data->profile;
+  double profile_start = solver_profile_start(profile);
+
+  if (model_data->rxn_soa == NULL) {
+    rxn_calc_deriv_rxns(model_data, time_deriv, time_step, model_data->n_rxn,
+                        NULL, profile);
+  } else {
+    rxn_calc_deriv_rxns(model_data, time_deriv, time_step,
+                        model_data->rxn_soa->n_generic_rxn,
+                        model_data->rxn_soa->generic_rxn, profile);
+  }
+  solver_profile_stop(profile, CAMP_PROFILE_RXN_DERIV, profile_start);
 }
 #endif
 
@@ -472,19 +561,23 @@ void rxn_calc_deriv_specific_types(ModelData *model_data,
 }
 #endif
 
-/** \brief Calculate the Jacobian
+/** \brief Add the Jacobian contributions of a set of reactions using the
+ *         type-specific reaction functions
  *
  * \param model_data Pointer to the model data
  * \param jac The reaction Jacobian (for one grid cell)
  * \param time_step Current model time step (s)
+ * \param n_rxn Number of reactions to include
+ * \param rxn_ids Indices of the reactions to include (NULL for the first
+ *                n_rxn reactions)
  */
 #ifdef CAMP_USE_SUNDIALS
-void rxn_calc_jac(ModelData *model_data, Jacobian jac, realtype time_step) {
-  // Get the number of reactions
-  int n_rxn = model_data->n_rxn;
-
+static void rxn_calc_jac_rxns(ModelData *model_data, Jacobian jac,
+                              realtype time_step, int n_rxn, int *rxn_ids) {
   // Loop through the reactions advancing the rxn_data pointer each time
-  for (int i_rxn = 0; i_rxn < n_rxn; i_rxn++) {
+  for (int i_loop = 0; i_loop < n_rxn; i_loop++) {
+    int i_rxn = rxn_ids == NULL ? i_loop : rxn_ids[i_loop];
+
     // Get pointers to the reaction data
     int *rxn_int_data =
         &(model_data->rxn_int_data[model_data->rxn_int_indices[i_rxn]]);
@@ -582,6 +675,107 @@ void rxn_calc_jac(ModelData *model_data, Jacobian jac, realtype time_step) {
     }
   }
 }
+
+/** \brief Calculate the Jacobian
+ *
+ * \param model_data Pointer to the model data
+ * \param jac The reaction Jacobian (for one grid cell)
+ * \param time_step Current model time step (s)
+ */
+void rxn_calc_jac(ModelData *model_data, Jacobian jac, realtype time_step) {
+  // Get the number of reactions
+  int n_rxn = model_data->n_rxn;
+  int *rxn_ids = NULL;
+
+  // Add contributions from the generated kernel or the reaction tables and
+  // loop through the reactions they do not include
+  if (model_data->rxn_kernel != NULL) {
+    rxn_codegen_calc_jac(model_data->rxn_kernel, model_data->grid_cell_state,
+                         model_data->grid_cell_rxn_env_data, jac, time_step);
+    n_rxn = model_data->rxn_kernel->n_generic_rxn;
+    rxn_ids = model_data->rxn_kernel->generic_rxn;
+  } else if (model_data->rxn_soa != NULL) {
+    rxn_soa_calc_jac(model_data, model_data->rxn_soa, jac, time_step);
+    n_rxn = model_data->rxn_soa->n_generic_rxn;
+    rxn_ids = model_data->rxn_soa->generic_rxn;
+  }
+
+  rxn_calc_jac_rxns(model_data, jac, time_step, n_rxn, rxn_ids);
+}
+
+/** \brief Calculate the time derivative \f$f(t,y)\f$ and the Jacobian in
+ *         one pass
+ *
+ * Each reaction adds its derivative and Jacobian contributions before the
+ * next reaction is evaluated. Rates and rate partial derivatives are shared
+ * for the reaction tables and for the reaction types with a fused
+ * calculation; the remaining types call their derivative and Jacobian
+ * functions one after the other. The contributions are the same as those of
+ * \c rxn_calc_deriv() and \c rxn_calc_jac().
+ *
+ * \param model_data Pointer to the model data
+ * \param time_deriv TimeDerivative to use to build derivative array
+ * \param jac The reaction Jacobian (for one grid cell)
+ * \param time_step Current model time step (s)
+ */
+void rxn_calc_deriv_jac(ModelData *model_data, TimeDerivative time_deriv,
+                        Jacobian jac, realtype time_step) {
+  // Get the number of reactions
+  int n_rxn = model_data->n_rxn;
+  int *rxn_ids = NULL;
+
+  // Add contributions from the generated kernel or the reaction tables and
+  // loop through the reactions they do not include
+  if (model_data->rxn_kernel != NULL) {
+    rxn_codegen_calc_deriv(model_data->rxn_kernel, model_data->grid_cell_state,
+                           model_data->grid_cell_rxn_env_data, time_deriv,
+                           time_step);
+    rxn_codegen_calc_jac(model_data->rxn_kernel, model_data->grid_cell_state,
+                         model_data->grid_cell_rxn_env_data, jac, time_step);
+    n_rxn = model_data->rxn_kernel->n_generic_rxn;
+    rxn_ids = model_data->rxn_kernel->generic_rxn;
+  } else if (model_data->rxn_soa != NULL) {
+    rxn_soa_calc_deriv_jac(model_data, model_data->rxn_soa, time_deriv, jac,
+                           time_step);
+    n_rxn = model_data->rxn_soa->n_generic_rxn;
+    rxn_ids = model_data->rxn_soa->generic_rxn;
+  }
+
+  // Loop through the remaining reactions
+  for (int i_loop = 0; i_loop < n_rxn; i_loop++) {
+    int i_rxn = rxn_ids == NULL ? i_loop : rxn_ids[i_loop];
+
+    // Get pointers to the reaction data
+    int *rxn_int_data =
+        &(model_data->rxn_int_data[model_data->rxn_int_indices[i_rxn]]);
+    double *rxn_float_data =
+        &(model_data->rxn_float_data[model_data->rxn_float_indices[i_rxn]]);
+    double *rxn_env_data =
+        &(model_data->grid_cell_rxn_env_data[model_data->rxn_env_idx[i_rxn]]);
+
+    // Get the reaction type
+    int rxn_type = *(rxn_int_data++);
+
+    // Call the appropriate function
+    switch (rxn_type) {
+      case RXN_HL_PHASE_TRANSFER:
+        rxn_HL_phase_transfer_calc_deriv_jac_contrib(
+            model_data, time_deriv, jac, rxn_int_data, rxn_float_data,
+            rxn_env_data, time_step);
+        break;
+      case RXN_SIMPOL_PHASE_TRANSFER:
+        rxn_SIMPOL_phase_transfer_calc_deriv_jac_contrib(
+            model_data, time_deriv, jac, rxn_int_data, rxn_float_data,
+            rxn_env_data, time_step);
+        break;
+      default:
+        rxn_calc_deriv_rxns(model_data, time_deriv, time_step, 1, &i_rxn,
+                            NULL);
+        rxn_calc_jac_rxns(model_data, jac, time_step, 1, &i_rxn);
+        break;
+    }
+  }
+}
 #endif
 
 /** \brief Calculate the Jacobian for only some specific types
@@ -714,6 +908,10 @@ void rxn_update_data(int cell_id, int *rxn_id, int update_rxn_type,
   model_data->grid_cell_rxn_env_data =
       &(model_data->rxn_env_data[cell_id * model_data->n_rxn_env_data]);
 
+  // Recalculate the environment-dependent data of the grid cell on the next
+  // call to the solver
+  model_data->last_env[cell_id * CAMP_NUM_ENV_PARAM_] = NAN;
+
   // Get the number of reactions
   int n_rxn = model_data->n_rxn;
 
@@ -13,6 +13,25 @@
 #include "Jacobian.h"
 #include "camp_common.h"
 
+// Reaction types (Must match parameters defined in camp_rxn_factory)
+#define RXN_ARRHENIUS 1
+#define RXN_TROE 2
+#define RXN_CMAQ_H2O2 3
+#define RXN_CMAQ_OH_HNO3 4
+#define RXN_PHOTOLYSIS 5
+#define RXN_HL_PHASE_TRANSFER 6
+#define RXN_AQUEOUS_EQUILIBRIUM 7
+#define RXN_SIMPOL_PHASE_TRANSFER 10
+#define RXN_CONDENSED_PHASE_ARRHENIUS 11
+#define RXN_FIRST_ORDER_LOSS 12
+#define RXN_EMISSION 13
+#define RXN_WET_DEPOSITION 14
+#define RXN_TERNARY_CHEMICAL_ACTIVATION 15
+#define RXN_WENNBERG_TUNNELING 16
+#define RXN_WENNBERG_NO_RO2 17
+#define RXN_CONDENSED_PHASE_PHOTOLYSIS 18
+#define RXN_SURFACE 19
+
 /** Public reaction functions **/
 
 /* Solver functions */
@@ -25,9 +44,13 @@ void rxn_print_data(void *solver_data);
 #ifdef CAMP_USE_SUNDIALS
 void rxn_calc_deriv(ModelData *model_data, TimeDerivative time_deriv,
                     double time_step);
+void rxn_calc_deriv_generic(ModelData *model_data, TimeDerivative time_deriv,
+                            double time_step);
 void rxn_calc_deriv_specific_types(ModelData *model_data,
                                    TimeDerivative time_deriv, double time_step);
 void rxn_calc_jac(ModelData *model_data, Jacobian jac, double time_step);
+void rxn_calc_deriv_jac(ModelData *model_data, TimeDerivative time_deriv,
+                        Jacobian jac, double time_step);
 void rxn_calc_jac_specific_types(ModelData *model_data, Jacobian jac,
                                  double time_step);
 // void rxn_calc_jac_specific_types(ModelData *model_data, double *J_data,
@@ -227,6 +227,10 @@ void rxn_HL_phase_transfer_calc_jac_contrib(ModelData *model_data, Jacobian jac,
                                             double *rxn_float_data,
                                             double *rxn_env_data,
                                             realtype time_step);
+void rxn_HL_phase_transfer_calc_deriv_jac_contrib(
+    ModelData *model_data, TimeDerivative time_deriv, Jacobian jac,
+    int *rxn_int_data, double *rxn_float_data, double *rxn_env_data,
+    realtype time_step);
 #endif
 
 // photolysis
@@ -275,6 +279,10 @@ void rxn_SIMPOL_phase_transfer_calc_jac_contrib(ModelData *model_data,
                                                 double *rxn_float_data,
                                                 double *rxn_env_data,
                                                 realtype time_step);
+void rxn_SIMPOL_phase_transfer_calc_deriv_jac_contrib(
+    ModelData *model_data, TimeDerivative time_deriv, Jacobian jac,
+    int *rxn_int_data, double *rxn_float_data, double *rxn_env_data,
+    realtype time_step);
 #endif
 
 // surface
@@ -303,18 +303,18 @@ void rxn_HL_phase_transfer_calc_deriv_contrib(
 
     // this was replaced with transition-regime rate equation
 #if 0
-    long double cond_rate =
-        ((long double)1.0) / (radius * radius / (3.0 * DIFF_COEFF_) +
-                              4.0 * radius / (3.0 * MFP_M_));
+    CampSum cond_rate =
+        ((CampSum)1.0) / (radius * radius / (3.0 * DIFF_COEFF_) +
+                          4.0 * radius / (3.0 * MFP_M_));
 #endif
 
     // Calculate the rate constant for diffusion limited mass transfer to the
     // aerosol phase (1/s)
-    long double cond_rate =
+    CampSum cond_rate =
         gas_aerosol_transition_rxn_rate_constant(DIFF_COEFF_, MFP_M_, radius, ALPHA_);
 
     // Calculate the evaporation rate constant (1/s)
-    long double evap_rate = cond_rate / (EQUIL_CONST_);
+    CampSum evap_rate = cond_rate / (EQUIL_CONST_);
 
     // Calculate the evaporation and condensation rates (ppm/s)
     cond_rate *= state[GAS_SPEC_];
@@ -341,9 +341,11 @@ void rxn_HL_phase_transfer_calc_deriv_contrib(
 }
 #endif
 
-/** \brief Calculate contributions to the Jacobian from this reaction
+/** \brief Calculate contributions to the Jacobian, and optionally to the
+ *         time derivative, from this reaction
  *
  * \param model_data Pointer to the model data
+ * \param time_deriv TimeDerivative object (NULL for the Jacobian only)
  * \param jac Reaction Jacobian
  * \param rxn_int_data Pointer to the reaction integer data
  * \param rxn_float_data Pointer to the reaction floating-point data
@@ -351,11 +353,10 @@ void rxn_HL_phase_transfer_calc_deriv_contrib(
  * \param time_step Current time step being calculated (s)
  */
 #ifdef CAMP_USE_SUNDIALS
-void rxn_HL_phase_transfer_calc_jac_contrib(ModelData *model_data, Jacobian jac,
-                                            int *rxn_int_data,
-                                            double *rxn_float_data,
-                                            double *rxn_env_data,
-                                            realtype time_step) {
+static void rxn_HL_phase_transfer_calc_contrib(
+    ModelData *model_data, TimeDerivative *time_deriv, Jacobian jac,
+    int *rxn_int_data, double *rxn_float_data, double *rxn_env_data,
+    realtype time_step) {
   int *int_data = rxn_int_data;
   double *float_data = rxn_float_data;
   double *state = model_data->grid_cell_state;
@@ -397,17 +398,17 @@ void rxn_HL_phase_transfer_calc_jac_contrib(ModelData *model_data, Jacobian jac,
 
     // this was replaced with transition-regime rate equation
 #if 0
-    long double cond_rate = 1.0 / (radius * radius / (3.0 * DIFF_COEFF_) +
-                                   4.0 * radius / (3.0 * MFP_M_));
+    CampSum cond_rate = 1.0 / (radius * radius / (3.0 * DIFF_COEFF_) +
+                               4.0 * radius / (3.0 * MFP_M_));
 #endif
 
     // Calculate the rate constant for diffusion limited mass transfer to the
     // aerosol phase (1/s)
-    long double cond_rate =
+    CampSum cond_rate =
         gas_aerosol_transition_rxn_rate_constant(DIFF_COEFF_, MFP_M_, radius, ALPHA_);
 
     // Calculate the evaporation rate constant (1/s)
-    long double evap_rate = cond_rate / (EQUIL_CONST_);
+    CampSum evap_rate = cond_rate / (EQUIL_CONST_);
 
     // Change in the gas-phase is evaporation - condensation (ppm/s)
     if (JAC_ID_(0) >= 0)
@@ -442,21 +443,37 @@ void rxn_HL_phase_transfer_calc_jac_contrib(ModelData *model_data, Jacobian jac,
     cond_rate *= state[GAS_SPEC_];
     evap_rate *= state[AERO_SPEC_(i_phase)] / state[AERO_WATER_(i_phase)];
 
+    // Add the time derivative contributions with the same rates
+    if (time_deriv != NULL) {
+      if (DERIV_ID_(0) >= 0) {
+        time_derivative_add_value(*time_deriv, DERIV_ID_(0),
+                                  number_conc * evap_rate);
+        time_derivative_add_value(*time_deriv, DERIV_ID_(0),
+                                  -number_conc * cond_rate);
+      }
+      if (DERIV_ID_(1 + i_phase) >= 0) {
+        time_derivative_add_value(*time_deriv, DERIV_ID_(1 + i_phase),
+                                  -evap_rate / KGM3_TO_PPM_);
+        time_derivative_add_value(*time_deriv, DERIV_ID_(1 + i_phase),
+                                  cond_rate / KGM3_TO_PPM_);
+      }
+    }
+
     // Add contributions from species used in aerosol property calculations
 
     // Calculate d_rate/d_effecive_radius and d_rate/d_number_concentration
     // ( This was replaced with transition-regime rate equation. )
 #if 0
-    long double d_rate_d_radius =
+    CampSum d_rate_d_radius =
         -rate * cond_rate *
         (2.0 * radius / (3.0 * DIFF_COEFF_) + 4.0 / (3.0 * MFP_M_));
 #endif
-    long double d_cond_d_radius =
+    CampSum d_cond_d_radius =
         d_gas_aerosol_transition_rxn_rate_constant_d_radius(
             DIFF_COEFF_, MFP_M_, radius, ALPHA_) * state[GAS_SPEC_];
-    long double d_evap_d_radius = d_cond_d_radius / state[GAS_SPEC_] /
-                                  (EQUIL_CONST_)*state[AERO_SPEC_(i_phase)] /
-                                  state[AERO_WATER_(i_phase)];
+    CampSum d_evap_d_radius = d_cond_d_radius / state[GAS_SPEC_] /
+                              (EQUIL_CONST_)*state[AERO_SPEC_(i_phase)] /
+                              state[AERO_WATER_(i_phase)];
 
     // Loop through Jac elements and update
     for (int i_elem = 0; i_elem < NUM_AERO_PHASE_JAC_ELEM_(i_phase); ++i_elem) {
@@ -500,6 +517,46 @@ void rxn_HL_phase_transfer_calc_jac_contrib(ModelData *model_data, Jacobian jac,
   }
   return;
 }
+
+/** \brief Calculate contributions to the Jacobian from this reaction
+ *
+ * \param model_data Pointer to the model data
+ * \param jac Reaction Jacobian
+ * \param rxn_int_data Pointer to the reaction integer data
+ * \param rxn_float_data Pointer to the reaction floating-point data
+ * \param rxn_env_data Pointer to the environment-dependent parameters
+ * \param time_step Current time step being calculated (s)
+ */
+void rxn_HL_phase_transfer_calc_jac_contrib(ModelData *model_data, Jacobian jac,
+                                            int *rxn_int_data,
+                                            double *rxn_float_data,
+                                            double *rxn_env_data,
+                                            realtype time_step) {
+  rxn_HL_phase_transfer_calc_contrib(model_data, NULL, jac, rxn_int_data,
+                                     rxn_float_data, rxn_env_data, time_step);
+}
+
+/** \brief Calculate contributions to the time derivative and the Jacobian
+ *         from this reaction in one pass
+ *
+ * The aerosol properties and rate constants are calculated once for both.
+ *
+ * \param model_data Pointer to the model data, including the state array
+ * \param time_deriv TimeDerivative object
+ * \param jac Reaction Jacobian
+ * \param rxn_int_data Pointer to the reaction integer data
+ * \param rxn_float_data Pointer to the reaction floating-point data
+ * \param rxn_env_data Pointer to the environment-dependent parameters
+ * \param time_step Current time step being calculated (s)
+ */
+void rxn_HL_phase_transfer_calc_deriv_jac_contrib(
+    ModelData *model_data, TimeDerivative time_deriv, Jacobian jac,
+    int *rxn_int_data, double *rxn_float_data, double *rxn_env_data,
+    realtype time_step) {
+  rxn_HL_phase_transfer_calc_contrib(model_data, &time_deriv, jac,
+                                     rxn_int_data, rxn_float_data,
+                                     rxn_env_data, time_step);
+}
 #endif
 
 /** \brief Print the Phase Transfer reaction parameters
@@ -332,22 +332,22 @@ void rxn_SIMPOL_phase_transfer_calc_deriv_contrib(
     // This was replaced with the transition-regime condensation rate
     // equations
 #if 0
-    long double cond_rate =
-        ((long double)1.0) / (radius * radius / (3.0 * DIFF_COEFF_) +
-                              4.0 * radius / (3.0 * MFP_M_));
+    CampSum cond_rate =
+        ((CampSum)1.0) / (radius * radius / (3.0 * DIFF_COEFF_) +
+                          4.0 * radius / (3.0 * MFP_M_));
 #endif
 
     // Calculate the rate constant for diffusion limited mass transfer to the
     // aerosol phase (m3/#/s)
-    long double cond_rate =
+    CampSum cond_rate =
         gas_aerosol_transition_rxn_rate_constant(DIFF_COEFF_, MFP_M_, radius, ALPHA_);
 
     // Calculate the evaporation rate constant (ppm_x*m^3/kg_x/s)
-    long double evap_rate =
+    CampSum evap_rate =
         cond_rate * (EQUIL_CONST_ * aero_phase_avg_MW / aero_phase_mass);
 
     // Get the activity coefficient (if one exists)
-    long double act_coeff = 1.0;
+    CampSum act_coeff = 1.0;
     if (AERO_ACT_ID_(i_phase) > -1) {
       act_coeff = state[AERO_ACT_ID_(i_phase)];
     }
@@ -402,9 +402,11 @@ void rxn_SIMPOL_phase_transfer_calc_deriv_contrib(
 }
 #endif
 
-/** \brief Calculate contributions to the Jacobian from this reaction
+/** \brief Calculate contributions to the Jacobian, and optionally to the
+ *         time derivative, from this reaction
  *
  * \param model_data Pointer to the model data
+ * \param time_deriv TimeDerivative object (NULL for the Jacobian only)
  * \param jac Reaction Jacobian
  * \param rxn_int_data Pointer to the reaction integer data
  * \param rxn_float_data Pointer to the reaction floating-point data
@@ -412,11 +414,10 @@ void rxn_SIMPOL_phase_transfer_calc_deriv_contrib(
  * \param time_step Current time step being calculated (s)
  */
 #ifdef CAMP_USE_SUNDIALS
-void rxn_SIMPOL_phase_transfer_calc_jac_contrib(ModelData *model_data,
-                                                Jacobian jac, int *rxn_int_data,
-                                                double *rxn_float_data,
-                                                double *rxn_env_data,
-                                                realtype time_step) {
+static void rxn_SIMPOL_phase_transfer_calc_contrib(
+    ModelData *model_data, TimeDerivative *time_deriv, Jacobian jac,
+    int *rxn_int_data, double *rxn_float_data, double *rxn_env_data,
+    realtype time_step) {
   int *int_data = rxn_int_data;
   double *float_data = rxn_float_data;
   double *state = model_data->grid_cell_state;
@@ -470,22 +471,22 @@ void rxn_SIMPOL_phase_transfer_calc_jac_contrib(ModelData *model_data,
     // This was replaced with the transition-regime condensation rate
     // equations
 #if 0
-    long double cond_rate =
-        ((long double)1.0) / (radius * radius / (3.0 * DIFF_COEFF_) +
-                              4.0 * radius / (3.0 * MFP_M_));
+    CampSum cond_rate =
+        ((CampSum)1.0) / (radius * radius / (3.0 * DIFF_COEFF_) +
+                          4.0 * radius / (3.0 * MFP_M_));
 #endif
 
     // Calculate the rate constant for diffusion limited mass transfer to the
     // aerosol phase (m3/#/s)
-    long double cond_rate =
+    CampSum cond_rate =
         gas_aerosol_transition_rxn_rate_constant(DIFF_COEFF_, MFP_M_, radius, ALPHA_);
 
     // Calculate the evaporation rate constant (ppm_x*m^3/kg_x/s)
-    long double evap_rate =
+    CampSum evap_rate =
         cond_rate * (EQUIL_CONST_ * aero_phase_avg_MW / aero_phase_mass);
 
     // Get the activity coefficient (if one exists)
-    long double act_coeff = 1.0;
+    CampSum act_coeff = 1.0;
     if (AERO_ACT_ID_(i_phase) > -1) {
       act_coeff = state[AERO_ACT_ID_(i_phase)];
     }
@@ -571,6 +572,33 @@ void rxn_SIMPOL_phase_transfer_calc_jac_contrib(ModelData *model_data,
     cond_rate *= state[GAS_SPEC_];
     evap_rate *= state[AERO_SPEC_(i_phase)];
 
+    // Add the time derivative contributions with the same rates
+    if (time_deriv != NULL) {
+      // Change in the gas-phase is evaporation - condensation (ppm/s)
+      if (DERIV_ID_(0) >= 0) {
+        time_derivative_add_value(*time_deriv, DERIV_ID_(0),
+                                  number_conc * evap_rate);
+        time_derivative_add_value(*time_deriv, DERIV_ID_(0),
+                                  -number_conc * cond_rate);
+      }
+
+      // Change in the aerosol-phase species is condensation - evaporation
+      // (kg/m^3/s)
+      if (DERIV_ID_(1 + i_phase) >= 0) {
+        if (aero_conc_type == PER_PARTICLE_MASS) {
+          time_derivative_add_value(*time_deriv, DERIV_ID_(1 + i_phase),
+                                    -evap_rate / KGM3_TO_PPM_);
+          time_derivative_add_value(*time_deriv, DERIV_ID_(1 + i_phase),
+                                    cond_rate / KGM3_TO_PPM_);
+        } else {
+          time_derivative_add_value(*time_deriv, DERIV_ID_(1 + i_phase),
+                                    -number_conc * evap_rate / KGM3_TO_PPM_);
+          time_derivative_add_value(*time_deriv, DERIV_ID_(1 + i_phase),
+                                    number_conc * cond_rate / KGM3_TO_PPM_);
+        }
+      }
+    }
+
     // Calculate partial derivatives
 
     // this was replaced with the transition regime rate equations
@@ -741,6 +769,48 @@ void rxn_SIMPOL_phase_transfer_calc_jac_contrib(ModelData *model_data,
   }
   return;
 }
+
+/** \brief Calculate contributions to the Jacobian from this reaction
+ *
+ * \param model_data Pointer to the model data
+ * \param jac Reaction Jacobian
+ * \param rxn_int_data Pointer to the reaction integer data
+ * \param rxn_float_data Pointer to the reaction floating-point data
+ * \param rxn_env_data Pointer to the environment-dependent parameters
+ * \param time_step Current time step being calculated (s)
+ */
+void rxn_SIMPOL_phase_transfer_calc_jac_contrib(ModelData *model_data,
+                                                Jacobian jac, int *rxn_int_data,
+                                                double *rxn_float_data,
+                                                double *rxn_env_data,
+                                                realtype time_step) {
+  rxn_SIMPOL_phase_transfer_calc_contrib(model_data, NULL, jac, rxn_int_data,
+                                         rxn_float_data, rxn_env_data,
+                                         time_step);
+}
+
+/** \brief Calculate contributions to the time derivative and the Jacobian
+ *         from this reaction in one pass
+ *
+ * The aerosol-phase radius, number concentration, mass and average MW are
+ * looked up once for both.
+ *
+ * \param model_data Pointer to the model data, including the state array
+ * \param time_deriv TimeDerivative object
+ * \param jac Reaction Jacobian
+ * \param rxn_int_data Pointer to the reaction integer data
+ * \param rxn_float_data Pointer to the reaction floating-point data
+ * \param rxn_env_data Pointer to the environment-dependent parameters
+ * \param time_step Current time step being calculated (s)
+ */
+void rxn_SIMPOL_phase_transfer_calc_deriv_jac_contrib(
+    ModelData *model_data, TimeDerivative time_deriv, Jacobian jac,
+    int *rxn_int_data, double *rxn_float_data, double *rxn_env_data,
+    realtype time_step) {
+  rxn_SIMPOL_phase_transfer_calc_contrib(model_data, &time_deriv, jac,
+                                         rxn_int_data, rxn_float_data,
+                                         rxn_env_data, time_step);
+}
 #endif
 
 /** \brief Print the Phase Transfer reaction parameters
@@ -0,0 +1,188 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Solver profiler
+ *
+ */
+/** \file
+ * \brief Timers for the solver phases and the profiled linear solver
+ */
+// clock_gettime() is not part of C99
+#define _POSIX_C_SOURCE 199309L
+#include "solver_profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** \brief Get the time from a monotonic clock
+ *
+ * \return Time since an arbitrary start (s)
+ */
+double solver_profile_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1.0e-9 * (double)ts.tv_nsec;
+}
+
+/** \brief Reset the timers and counters of a profile
+ *
+ * \param profile Profile to reset (the enabled flag is kept)
+ */
+void solver_profile_reset(SolverProfile *profile) {
+  bool enabled = profile->enabled;
+  memset(profile, 0, sizeof(SolverProfile));
+  profile->enabled = enabled;
+}
+
+/** \brief Add the timers and counters of a profile to a total
+ *
+ * \param total Profile to add to
+ * \param profile Profile to add
+ */
+void solver_profile_add(SolverProfile *total, const SolverProfile *profile) {
+  for (int i = 0; i < CAMP_PROFILE_NUM_PHASES; ++i) {
+    total->phase_time[i] += profile->phase_time[i];
+    total->phase_calls[i] += profile->phase_calls[i];
+  }
+  for (int i = 0; i < CAMP_PROFILE_NUM_RXN_TYPES; ++i) {
+    total->rxn_time[i] += profile->rxn_time[i];
+    total->rxn_calls[i] += profile->rxn_calls[i];
+  }
+}
+
+#ifdef CAMP_USE_SUNDIALS
+/* Profiled linear solver data */
+typedef struct {
+  SUNLinearSolver ls;      // Linear solver that does the work
+  SolverProfile *profile;  // Profile to add the setup and solve times to
+} ProfiledLinSolContent;
+
+#define PROFILED_LS(S) (((ProfiledLinSolContent *)(S->content))->ls)
+#define PROFILED_LS_PROFILE(S) \
+  (((ProfiledLinSolContent *)(S->content))->profile)
+
+static SUNLinearSolver_Type profiled_ls_gettype(SUNLinearSolver S) {
+  return SUNLinSolGetType(PROFILED_LS(S));
+}
+
+static int profiled_ls_setatimes(SUNLinearSolver S, void *A_data,
+                                 ATimesFn ATimes) {
+  return SUNLinSolSetATimes(PROFILED_LS(S), A_data, ATimes);
+}
+
+static int profiled_ls_setpreconditioner(SUNLinearSolver S, void *P_data,
+                                         PSetupFn Pset, PSolveFn Psol) {
+  return SUNLinSolSetPreconditioner(PROFILED_LS(S), P_data, Pset, Psol);
+}
+
+static int profiled_ls_setscalingvectors(SUNLinearSolver S, N_Vector s1,
+                                         N_Vector s2) {
+  return SUNLinSolSetScalingVectors(PROFILED_LS(S), s1, s2);
+}
+
+static int profiled_ls_initialize(SUNLinearSolver S) {
+  return SUNLinSolInitialize(PROFILED_LS(S));
+}
+
+static int profiled_ls_setup(SUNLinearSolver S, SUNMatrix A) {
+  SolverProfile *profile = PROFILED_LS_PROFILE(S);
+  double start = solver_profile_start(profile);
+  int flag = SUNLinSolSetup(PROFILED_LS(S), A);
+  solver_profile_stop(profile, CAMP_PROFILE_LS_SETUP, start);
+  return flag;
+}
+
+static int profiled_ls_solve(SUNLinearSolver S, SUNMatrix A, N_Vector x,
+                             N_Vector b, realtype tol) {
+  SolverProfile *profile = PROFILED_LS_PROFILE(S);
+  double start = solver_profile_start(profile);
+  int flag = SUNLinSolSolve(PROFILED_LS(S), A, x, b, tol);
+  solver_profile_stop(profile, CAMP_PROFILE_LS_SOLVE, start);
+  return flag;
+}
+
+static int profiled_ls_numiters(SUNLinearSolver S) {
+  return SUNLinSolNumIters(PROFILED_LS(S));
+}
+
+static realtype profiled_ls_resnorm(SUNLinearSolver S) {
+  return SUNLinSolResNorm(PROFILED_LS(S));
+}
+
+static long int profiled_ls_lastflag(SUNLinearSolver S) {
+  return SUNLinSolLastFlag(PROFILED_LS(S));
+}
+
+static int profiled_ls_space(SUNLinearSolver S, long int *lenrwLS,
+                             long int *leniwLS) {
+  return SUNLinSolSpace(PROFILED_LS(S), lenrwLS, leniwLS);
+}
+
+static N_Vector profiled_ls_resid(SUNLinearSolver S) {
+  return SUNLinSolResid(PROFILED_LS(S));
+}
+
+static int profiled_ls_free(SUNLinearSolver S) {
+  if (S == NULL) return SUNLS_SUCCESS;
+  free(S->content);
+  free(S->ops);
+  free(S);
+  return SUNLS_SUCCESS;
+}
+
+/** \brief Create a linear solver that times the setups and solves of
+ *         another linear solver
+ *
+ * The new solver forwards all operations to \c ls and has the same
+ * optional operations. It is passed to the integrator in place of \c ls,
+ * which can still be used directly (e.g., to reinitialize it). Freeing the
+ * new solver does not free \c ls.
+ *
+ * \param ls Linear solver to time
+ * \param profile Profile to add the times to
+ * \return New SUNLinearSolver, or NULL if memory allocation fails
+ */
+SUNLinearSolver SUNProfiledLinSol(SUNLinearSolver ls, SolverProfile *profile) {
+  SUNLinearSolver S;
+  SUNLinearSolver_Ops ops;
+  ProfiledLinSolContent *content;
+
+  if (ls == NULL) return NULL;
+
+  S = (SUNLinearSolver)malloc(sizeof *S);
+  if (S == NULL) return NULL;
+  ops = (SUNLinearSolver_Ops)malloc(
+      sizeof(struct _generic_SUNLinearSolver_Ops));
+  content = (ProfiledLinSolContent *)malloc(sizeof(ProfiledLinSolContent));
+  if (ops == NULL || content == NULL) {
+    free(ops);
+    free(content);
+    free(S);
+    return NULL;
+  }
+  ops->gettype = profiled_ls_gettype;
+  ops->setatimes = ls->ops->setatimes ? profiled_ls_setatimes : NULL;
+  ops->setpreconditioner =
+      ls->ops->setpreconditioner ? profiled_ls_setpreconditioner : NULL;
+  ops->setscalingvectors =
+      ls->ops->setscalingvectors ? profiled_ls_setscalingvectors : NULL;
+  ops->initialize = ls->ops->initialize ? profiled_ls_initialize : NULL;
+  ops->setup = ls->ops->setup ? profiled_ls_setup : NULL;
+  ops->solve = profiled_ls_solve;
+  ops->numiters = ls->ops->numiters ? profiled_ls_numiters : NULL;
+  ops->resnorm = ls->ops->resnorm ? profiled_ls_resnorm : NULL;
+  ops->lastflag = ls->ops->lastflag ? profiled_ls_lastflag : NULL;
+  ops->space = ls->ops->space ? profiled_ls_space : NULL;
+  ops->resid = ls->ops->resid ? profiled_ls_resid : NULL;
+  ops->free = profiled_ls_free;
+  S->ops = ops;
+
+  content->ls = ls;
+  content->profile = profile;
+  S->content = content;
+
+  return S;
+}
+#endif
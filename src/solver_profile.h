@@ -0,0 +1,77 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Header file for the solver profiler
+ *
+ */
+/** \file
+ * \brief Header file for the solver profiler
+ *
+ * The profiler accumulates the wall time (from a monotonic clock) and the
+ * number of calls of the solver phases listed in camp_common.h, and the time
+ * spent in the f() contributions of each reaction type. It is enabled and
+ * disabled at runtime with \c solver_set_profiling(). While disabled, each
+ * timed section costs a single test of the \c enabled flag.
+ *
+ * Phases that run in the OpenMP grid cell loops accumulate into the profile
+ * of the grid cell view of each thread, and each batch of grid cells has
+ * its own profiles, so no timer is shared between threads. The profiles are
+ * combined when the statistics are retrieved. Phases are nested (e.g., the
+ * reaction contributions are part of the calls to f(), and the guess helper
+ * calls f()), so the phase times do not add up to the solver time.
+ */
+#ifndef SOLVER_PROFILE_H
+#define SOLVER_PROFILE_H
+#include "camp_common.h"
+
+double solver_profile_now();
+void solver_profile_reset(SolverProfile *profile);
+void solver_profile_add(SolverProfile *total, const SolverProfile *profile);
+#ifdef CAMP_USE_SUNDIALS
+SUNLinearSolver SUNProfiledLinSol(SUNLinearSolver ls, SolverProfile *profile);
+#endif
+
+/** \brief Start timing a section
+ *
+ * \param profile Profile to time the section for (may be NULL)
+ * \return Start time (s), or 0 if the profiler is disabled
+ */
+static inline double solver_profile_start(const SolverProfile *profile) {
+  if (profile == NULL || !profile->enabled) return 0.0;
+  return solver_profile_now();
+}
+
+/** \brief Stop timing a solver phase
+ *
+ * \param profile Profile to add the time to (may be NULL)
+ * \param phase Solver phase (CAMP_PROFILE_*)
+ * \param start Start time from \c solver_profile_start()
+ */
+static inline void solver_profile_stop(SolverProfile *profile, int phase,
+                                       double start) {
+  if (profile == NULL || !profile->enabled) return;
+  profile->phase_time[phase] += solver_profile_now() - start;
+  ++(profile->phase_calls[phase]);
+}
+
+/** \brief Add the time of a run of reaction contributions of one type
+ *
+ * \param profile Profile to add the time to (enabled)
+ * \param rxn_type Reaction type (RXN_*, or 0 for generated kernels and
+ *                 structure-of-arrays tables)
+ * \param n_calls Number of reaction contributions calculated
+ * \param start Start time from \c solver_profile_start()
+ * \return Current time (s), to start timing the next run
+ */
+static inline double solver_profile_stop_rxn(SolverProfile *profile,
+                                             int rxn_type, int n_calls,
+                                             double start) {
+  double now = solver_profile_now();
+  if (rxn_type < 0 || rxn_type >= CAMP_PROFILE_NUM_RXN_TYPES) return now;
+  profile->rxn_time[rxn_type] += now - start;
+  profile->rxn_calls[rxn_type] += n_calls;
+  return now;
+}
+
+#endif
@@ -8,8 +8,10 @@
  * \brief Sub model solver functions
  */
 #include "sub_model_solver.h"
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "solver_profile.h"
 #include "sub_models.h"
 
 // Sub model types (Must match parameters in camp_sub_model_factory)
@@ -308,6 +310,7 @@ void sub_model_update_env_state(ModelData *model_data) {
 void sub_model_calculate(ModelData *model_data) {
   // Get the number of sub models
   int n_sub_model = model_data->n_sub_model;
+  double profile_start = solver_profile_start(model_data->profile);
 
   // Loop through the sub models to trigger their calculation
   // advancing the sub_model_data pointer each time
@@ -342,6 +345,9 @@ void sub_model_calculate(ModelData *model_data) {
         break;
     }
   }
+
+  solver_profile_stop(model_data->profile, CAMP_PROFILE_SUB_MODEL_CALC,
+                      profile_start);
 }
 
 /** \brief Calculate the Jacobian constributions from sub model calculations
@@ -476,6 +482,10 @@ void sub_model_update_data(int cell_id, int *sub_model_id,
       &(model_data
             ->sub_model_env_data[cell_id * model_data->n_sub_model_env_data]);
 
+  // Recalculate the environment-dependent data of the grid cell on the next
+  // call to the solver
+  model_data->last_env[cell_id * CAMP_NUM_ENV_PARAM_] = NAN;
+
   // Get the number of sub models
   int n_sub_model = model_data->n_sub_model;
 
@@ -16,17 +16,29 @@ int time_derivative_initialize(TimeDerivative *time_deriv,
                                unsigned int num_spec) {
   if (num_spec <= 0) return 0;
 
-  time_deriv->production_rates =
-      (long double *)malloc(num_spec * sizeof(long double));
+  time_deriv->production_rates = (CampSum *)malloc(num_spec * sizeof(CampSum));
   if (time_deriv->production_rates == NULL) return 0;
 
-  time_deriv->loss_rates =
-      (long double *)malloc(num_spec * sizeof(long double));
+  time_deriv->loss_rates = (CampSum *)malloc(num_spec * sizeof(CampSum));
   if (time_deriv->loss_rates == NULL) {
     free(time_deriv->production_rates);
     return 0;
   }
 
+#ifdef CAMP_USE_COMPENSATED_SUM
+  time_deriv->production_rates_comp =
+      (double *)malloc(num_spec * sizeof(double));
+  time_deriv->loss_rates_comp = (double *)malloc(num_spec * sizeof(double));
+  if (time_deriv->production_rates_comp == NULL ||
+      time_deriv->loss_rates_comp == NULL) {
+    free(time_deriv->production_rates);
+    free(time_deriv->loss_rates);
+    free(time_deriv->production_rates_comp);
+    free(time_deriv->loss_rates_comp);
+    return 0;
+  }
+#endif
+
   time_deriv->num_spec = num_spec;
 
 #ifdef CAMP_DEBUG
@@ -40,34 +52,41 @@ void time_derivative_reset(TimeDerivative time_deriv) {
   for (unsigned int i_spec = 0; i_spec < time_deriv.num_spec; ++i_spec) {
     time_deriv.production_rates[i_spec] = 0.0;
     time_deriv.loss_rates[i_spec] = 0.0;
+#ifdef CAMP_USE_COMPENSATED_SUM
+    time_deriv.production_rates_comp[i_spec] = 0.0;
+    time_deriv.loss_rates_comp[i_spec] = 0.0;
+#endif
   }
 }
 
 void time_derivative_output(TimeDerivative time_deriv, double *dest_array,
                             double *deriv_est, unsigned int output_precision) {
-  long double *r_p = time_deriv.production_rates;
-  long double *r_l = time_deriv.loss_rates;
-
 #ifdef CAMP_DEBUG
   time_deriv.last_max_loss_precision = 1.0;
 #endif
 
   for (unsigned int i_spec = 0; i_spec < time_deriv.num_spec; ++i_spec) {
     double prec_loss = 1.0;
-    if (*r_p + *r_l != 0.0) {
+    CampSum r_p = CAMP_SUM_VALUE(time_deriv.production_rates,
+                                 time_deriv.production_rates_comp, i_spec);
+    CampSum r_l = CAMP_SUM_VALUE(time_deriv.loss_rates,
+                                 time_deriv.loss_rates_comp, i_spec);
+    CampSum r_net =
+        CAMP_SUM_DIFF(time_deriv.production_rates,
+                      time_deriv.production_rates_comp, time_deriv.loss_rates,
+                      time_deriv.loss_rates_comp, i_spec);
+    if (r_p + r_l != 0.0) {
       if (deriv_est) {
-        long double scale_fact;
-        scale_fact =
-            1.0 / (*r_p + *r_l) /
-            (1.0 / (*r_p + *r_l) + MAX_PRECISION_LOSS / fabsl(*r_p - *r_l));
-        *dest_array =
-            scale_fact * (*r_p - *r_l) + (1.0 - scale_fact) * (*deriv_est);
+        CampSum scale_fact;
+        scale_fact = 1.0 / (r_p + r_l) /
+                     (1.0 / (r_p + r_l) + MAX_PRECISION_LOSS / CAMP_SUM_FABS(r_net));
+        *dest_array = scale_fact * r_net + (1.0 - scale_fact) * (*deriv_est);
       } else {
-        *dest_array = *r_p - *r_l;
+        *dest_array = r_net;
       }
 #ifdef CAMP_DEBUG
-      if (*r_p != 0.0 && *r_l != 0.0) {
-        prec_loss = *r_p > *r_l ? 1.0 - *r_l / *r_p : 1.0 - *r_p / *r_l;
+      if (r_p != 0.0 && r_l != 0.0) {
+        prec_loss = r_p > r_l ? 1.0 - r_l / r_p : 1.0 - r_p / r_l;
         if (prec_loss < time_deriv.last_max_loss_precision)
           time_deriv.last_max_loss_precision = prec_loss;
       }
@@ -75,8 +94,6 @@ void time_derivative_output(TimeDerivative time_deriv, double *dest_array,
     } else {
       *dest_array = 0.0;
     }
-    ++r_p;
-    ++r_l;
     ++dest_array;
     if (deriv_est) ++deriv_est;
 #ifdef CAMP_DEBUG
@@ -88,11 +105,27 @@ void time_derivative_output(TimeDerivative time_deriv, double *dest_array,
 }
 
 void time_derivative_add_value(TimeDerivative time_deriv, unsigned int spec_id,
-                               long double rate_contribution) {
+                               CampSum rate_contribution) {
   if (rate_contribution > 0.0) {
-    time_deriv.production_rates[spec_id] += rate_contribution;
+    CAMP_SUM_ADD(time_deriv.production_rates, time_deriv.production_rates_comp,
+                 spec_id, rate_contribution);
   } else {
-    time_deriv.loss_rates[spec_id] += -rate_contribution;
+    CAMP_SUM_ADD(time_deriv.loss_rates, time_deriv.loss_rates_comp, spec_id,
+                 -rate_contribution);
+  }
+}
+
+void time_derivative_set_from(TimeDerivative time_deriv, TimeDerivative source,
+                              unsigned int offset, unsigned int stride) {
+  for (unsigned int i_spec = 0; i_spec < time_deriv.num_spec; ++i_spec) {
+    unsigned int i_source = offset + i_spec * stride;
+    time_deriv.production_rates[i_spec] = source.production_rates[i_source];
+    time_deriv.loss_rates[i_spec] = source.loss_rates[i_source];
+#ifdef CAMP_USE_COMPENSATED_SUM
+    time_deriv.production_rates_comp[i_spec] =
+        source.production_rates_comp[i_source];
+    time_deriv.loss_rates_comp[i_spec] = source.loss_rates_comp[i_source];
+#endif
   }
 }
 
@@ -105,4 +138,8 @@ double time_derivative_max_loss_precision(TimeDerivative time_deriv) {
 void time_derivative_free(TimeDerivative time_deriv) {
   free(time_deriv.production_rates);
   free(time_deriv.loss_rates);
+#ifdef CAMP_USE_COMPENSATED_SUM
+  free(time_deriv.production_rates_comp);
+  free(time_deriv.loss_rates_comp);
+#endif
 }
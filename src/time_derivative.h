@@ -13,6 +13,7 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include "compensated_sum.h"
 
 // Threshhold for precisition loss in rate calculations
 #define MAX_PRECISION_LOSS 1.0e-14
@@ -20,8 +21,12 @@
 /* Time derivative for solver species */
 typedef struct {
   unsigned int num_spec;          // Number of species in the derivative
-  long double *production_rates;  // Production rates for all species
-  long double *loss_rates;        // Loss rates for all species
+  CampSum *production_rates;      // Production rates for all species
+  CampSum *loss_rates;            // Loss rates for all species
+#ifdef CAMP_USE_COMPENSATED_SUM
+  double *production_rates_comp;  // Compensations for the production rates
+  double *loss_rates_comp;        // Compensations for the loss rates
+#endif
 #ifdef CAMP_DEBUG
   double last_max_loss_precision;  // Maximum loss of precision at last output
 #endif
@@ -62,7 +67,21 @@ void time_derivative_output(TimeDerivative time_deriv, double *dest_array,
  * spec_id
  */
 void time_derivative_add_value(TimeDerivative time_deriv, unsigned int spec_id,
-                               long double rate_contribution);
+                               CampSum rate_contribution);
+
+/** \brief Set the derivative from strided elements of another derivative
+ *
+ * Element i of the destination is set to element offset + i * stride of the
+ * source, e.g., to extract one grid cell from a derivative for several grid
+ * cells stored species-major.
+ *
+ * \param time_deriv TimeDerivative object to set
+ * \param source TimeDerivative object to copy from
+ * \param offset Index of the source element for the first species
+ * \param stride Distance between the source elements of adjacent species
+ */
+void time_derivative_set_from(TimeDerivative time_deriv, TimeDerivative source,
+                              unsigned int offset, unsigned int stride);
 
 #ifdef CAMP_DEBUG
 /** \brief Maximum loss of precision at the last output of the derivative
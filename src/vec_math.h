@@ -0,0 +1,194 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ *
+ * Header file for vectorizable elementary functions
+ *
+ */
+/** \file
+ * \brief Header file for vectorizable elementary functions
+ *
+ * Calls to exp(), log() and pow() from libm prevent the compiler from
+ * vectorizing the loops that contain them. The functions here are written
+ * without branches or library calls (range reduction with integer
+ * arithmetic on the bits of the arguments, polynomial approximations and
+ * bit-mask selects for the special cases), so loops marked with \c omp
+ * \c simd that call them are vectorized on instruction sets with 64-bit
+ * integer vector comparisons (e.g., x86-64 with SSE4.2 or AVX2, or AArch64).
+ * Results of vec_exp() and vec_log() are within 2 units in the last place of
+ * the libm results, including subnormal, infinite and NaN arguments and
+ * results.
+ *
+ * The rounding of the range reduction relies on IEEE double arithmetic
+ * being evaluated as written, so code using these functions must not be
+ * compiled with \c -ffast-math or similar options.
+ */
+#ifndef VEC_MATH_H
+#define VEC_MATH_H
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// 1.5 * 2^52: adding it to a double with magnitude below 2^51 rounds it to
+// an integer, stored in the low bits of the significand of the sum
+#define VEC_MATH_SHIFT 6755399441055744.0
+
+// ln(2) split so that multiples of the high part by integers up to 2^20 are
+// exact
+#define VEC_MATH_LN2_HI 6.93147180369123816490e-01
+#define VEC_MATH_LN2_LO 1.90821492927058770002e-10
+
+/** \brief Get the bits of a double */
+static inline uint64_t vec_math_to_bits(double x) {
+  uint64_t i;
+  memcpy(&i, &x, sizeof(i));
+  return i;
+}
+
+/** \brief Get the double with the given bits */
+static inline double vec_math_from_bits(uint64_t i) {
+  double x;
+  memcpy(&x, &i, sizeof(x));
+  return x;
+}
+
+/** \brief Select a if c is 1, b if c is 0
+ *
+ * Conditional expressions whose operands may trap are not if-converted by
+ * the compiler, which then cannot vectorize the loop.
+ */
+static inline double vec_math_select(int64_t c, double a, double b) {
+  uint64_t mask = (uint64_t)0 - (uint64_t)c;
+  return vec_math_from_bits((vec_math_to_bits(a) & mask) |
+                            (vec_math_to_bits(b) & ~mask));
+}
+
+/** \brief Calculate 2^n for an integer-valued n in [-1022, 1023] */
+static inline double vec_math_pow2i(double n) {
+  return vec_math_from_bits((vec_math_to_bits(n + VEC_MATH_SHIFT) + 1023)
+                            << 52);
+}
+
+/** \brief Vectorizable exponential function
+ *
+ * \param x Argument
+ * \return exp(x)
+ */
+static inline double vec_exp(double x) {
+  // Limit the argument so the scaling factors below stay in range (results
+  // outside these limits overflow or underflow anyway)
+  double xc = vec_math_select(x > 710.0, 710.0, x);
+  xc = vec_math_select(xc < -746.0, -746.0, xc);
+
+  // x = k ln(2) + r, |r| <= ln(2)/2
+  double k = (xc * 1.4426950408889634 + VEC_MATH_SHIFT) - VEC_MATH_SHIFT;
+  double r = (xc - k * VEC_MATH_LN2_HI) - k * VEC_MATH_LN2_LO;
+
+  // exp(r) from its Taylor series (truncation error below 1e-17)
+  double p = 1.0 / 6227020800.0;
+  p = p * r + 1.0 / 479001600.0;
+  p = p * r + 1.0 / 39916800.0;
+  p = p * r + 1.0 / 3628800.0;
+  p = p * r + 1.0 / 362880.0;
+  p = p * r + 1.0 / 40320.0;
+  p = p * r + 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+
+  // Scale by 2^k in two steps, so subnormal results are rounded once
+  double k1 = (k * 0.5 + VEC_MATH_SHIFT) - VEC_MATH_SHIFT;
+  return p * vec_math_pow2i(k1) * vec_math_pow2i(k - k1);
+}
+
+/** \brief Vectorizable natural logarithm
+ *
+ * \param x Argument
+ * \return log(x)
+ */
+static inline double vec_log(double x) {
+  // Scale subnormal arguments into the normal range
+  int64_t subnormal = x < 2.2250738585072014e-308;
+  double xs = vec_math_select(subnormal, x * 18014398509481984.0, x);
+
+  // x = m 2^e, sqrt(1/2) <= m < sqrt(2)
+  uint64_t ix = vec_math_to_bits(xs);
+  double e = vec_math_from_bits((ix >> 52) + vec_math_to_bits(VEC_MATH_SHIFT)) -
+             VEC_MATH_SHIFT - vec_math_select(subnormal, 1077.0, 1023.0);
+  double m = vec_math_from_bits((ix & 0x000FFFFFFFFFFFFFULL) |
+                                0x3FF0000000000000ULL);
+  int64_t high = m > 1.4142135623730951;
+  m = vec_math_select(high, 0.5 * m, m);
+  e = vec_math_select(high, e + 1.0, e);
+
+  // log(m) = 2 atanh(f), f = (m - 1) / (m + 1), |f| < 0.172
+  double f = (m - 1.0) / (m + 1.0);
+  double f2 = f * f;
+  double s = 2.0 / 23.0;
+  s = s * f2 + 2.0 / 21.0;
+  s = s * f2 + 2.0 / 19.0;
+  s = s * f2 + 2.0 / 17.0;
+  s = s * f2 + 2.0 / 15.0;
+  s = s * f2 + 2.0 / 13.0;
+  s = s * f2 + 2.0 / 11.0;
+  s = s * f2 + 2.0 / 9.0;
+  s = s * f2 + 2.0 / 7.0;
+  s = s * f2 + 2.0 / 5.0;
+  s = s * f2 + 2.0 / 3.0;
+  double log_m = 2.0 * f + f * f2 * s;
+  double result = e * VEC_MATH_LN2_HI + (log_m + e * VEC_MATH_LN2_LO);
+
+  // Special cases
+  result = vec_math_select(x == INFINITY, x, result);
+  result = vec_math_select(x == 0.0, -INFINITY, result);
+  result = vec_math_select(x < 0.0, NAN, result);
+  return vec_math_select(x != x, x, result);
+}
+
+/** \brief Vectorizable base-10 logarithm
+ *
+ * \param x Argument
+ * \return log10(x)
+ */
+static inline double vec_log10(double x) {
+  return vec_log(x) * 0.43429448190325182765;
+}
+
+/** \brief Vectorizable power function for positive bases
+ *
+ * \param x Base (> 0)
+ * \param y Exponent
+ * \return x^y
+ */
+static inline double vec_pow(double x, double y) {
+  double p = vec_exp(y * vec_log(x));
+  return vec_math_select(y == 0.0, 1.0, p);
+}
+
+/** \brief Vectorizable power function for small non-negative integer
+ *         exponents
+ *
+ * Exponents up to 4 are calculated by multiplication, as for the
+ * concentration conversions of reactions with up to five reactants. The
+ * exponent is passed as a double, as mixing integer and floating-point
+ * conditions in a loop prevents its vectorization.
+ *
+ * \param x Base (> 0 for exponents above 4)
+ * \param n Integer-valued exponent (>= 0)
+ * \return x^n
+ */
+static inline double vec_pow_int(double x, double n) {
+  double x2 = x * x;
+  double p = vec_exp(n * vec_log(x));
+  p = vec_math_select(n == 4, x2 * x2, p);
+  p = vec_math_select(n == 3, x2 * x, p);
+  p = vec_math_select(n == 2, x2, p);
+  p = vec_math_select(n == 1, x, p);
+  return vec_math_select(n == 0, 1.0, p);
+}
+
+#endif
@@ -0,0 +1,137 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ */
+/** \file
+ * \brief Tests for the block-diagonal KLU linear solver
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "../test_common.h"
+#include "../../src/block_klu_solver.h"
+
+// Number of diagonal blocks
+#define NUM_BLOCKS 3
+
+// Number of rows (and columns) per block
+#define BLOCK_SIZE 3
+
+// Number of non-zero elements per block
+#define BLOCK_NNZ 6
+
+// Per-block pattern (CSC):
+//   | x . x |
+//   | x x . |
+//   | . x x |
+static const int col_ptrs[] = {0, 2, 4, 6};
+static const int row_ids[] = {0, 1, 1, 2, 0, 2};
+
+// Set up a block-diagonal matrix with the test pattern
+SUNMatrix new_block_matrix() {
+  SUNMatrix A = SUNSparseMatrix(NUM_BLOCKS * BLOCK_SIZE,
+                                NUM_BLOCKS * BLOCK_SIZE,
+                                NUM_BLOCKS * BLOCK_NNZ, CSC_MAT);
+  for (int i_block = 0; i_block < NUM_BLOCKS; ++i_block) {
+    for (int i_col = 0; i_col < BLOCK_SIZE; ++i_col)
+      SM_INDEXPTRS_S(A)[i_block * BLOCK_SIZE + i_col] =
+          i_block * BLOCK_NNZ + col_ptrs[i_col];
+    for (int i_elem = 0; i_elem < BLOCK_NNZ; ++i_elem)
+      SM_INDEXVALS_S(A)[i_block * BLOCK_NNZ + i_elem] =
+          i_block * BLOCK_SIZE + row_ids[i_elem];
+  }
+  SM_INDEXPTRS_S(A)[NUM_BLOCKS * BLOCK_SIZE] = NUM_BLOCKS * BLOCK_NNZ;
+  return A;
+}
+
+// Set values that differ between blocks
+void set_block_values(SUNMatrix A, double scale) {
+  for (int i_block = 0; i_block < NUM_BLOCKS; ++i_block)
+    for (int i_elem = 0; i_elem < BLOCK_NNZ; ++i_elem)
+      SM_DATA_S(A)[i_block * BLOCK_NNZ + i_elem] =
+          scale * (1.0 + i_block) * (row_ids[i_elem] == 0 ? 4.0 : 1.0) +
+          0.5 * i_elem;
+}
+
+// Check that A x = b
+int check_solution(SUNMatrix A, N_Vector x, N_Vector b, const char *msg) {
+  int errors = 0;
+  double Ax[NUM_BLOCKS * BLOCK_SIZE];
+  for (int i = 0; i < NUM_BLOCKS * BLOCK_SIZE; ++i) Ax[i] = 0.0;
+  for (int i_col = 0; i_col < NUM_BLOCKS * BLOCK_SIZE; ++i_col)
+    for (int i_elem = SM_INDEXPTRS_S(A)[i_col];
+         i_elem < SM_INDEXPTRS_S(A)[i_col + 1]; ++i_elem)
+      Ax[SM_INDEXVALS_S(A)[i_elem]] +=
+          SM_DATA_S(A)[i_elem] * NV_Ith_S(x, i_col);
+  for (int i = 0; i < NUM_BLOCKS * BLOCK_SIZE; ++i)
+    errors += ASSERT_CLOSE_MSG(Ax[i], NV_Ith_S(b, i), msg);
+  return errors;
+}
+
+int main(int argc, char *argv[]) {
+  int errors = 0;
+
+  SUNMatrix A = new_block_matrix();
+  N_Vector x = N_VNew_Serial(NUM_BLOCKS * BLOCK_SIZE);
+  N_Vector b = N_VNew_Serial(NUM_BLOCKS * BLOCK_SIZE);
+  for (int i = 0; i < NUM_BLOCKS * BLOCK_SIZE; ++i)
+    NV_Ith_S(b, i) = 1.0 + 0.25 * i;
+
+  SUNLinearSolver S = SUNBlockKLU(x, A, NUM_BLOCKS);
+  errors += ASSERT_MSG(S != NULL, "318302745");
+  errors += ASSERT_MSG(SUNLinSolGetType_BlockKLU(S) == SUNLINEARSOLVER_DIRECT,
+                       "582271090");
+  errors += ASSERT_MSG(SUNLinSolInitialize_BlockKLU(S) == SUNLS_SUCCESS,
+                       "116694903");
+
+  // first factorization
+  set_block_values(A, 1.0);
+  errors += ASSERT_MSG(SUNLinSolSetup_BlockKLU(S, A) == SUNLS_SUCCESS,
+                       "935027358");
+  errors += ASSERT_MSG(SUNLinSolSolve_BlockKLU(S, A, x, b, 0.0) ==
+                           SUNLS_SUCCESS,
+                       "209483637");
+  errors += check_solution(A, x, b, "491876327");
+
+  // refactorization with new values
+  set_block_values(A, 3.0);
+  errors += ASSERT_MSG(SUNLinSolSetup_BlockKLU(S, A) == SUNLS_SUCCESS,
+                       "760243146");
+  errors += ASSERT_MSG(SUNLinSolSolve_BlockKLU(S, A, x, b, 0.0) ==
+                           SUNLS_SUCCESS,
+                       "803553722");
+  errors += check_solution(A, x, b, "260116592");
+
+  // factorization after discarding the numeric factorizations
+  set_block_values(A, 0.5);
+  errors += ASSERT_MSG(SUNBlockKLUReInit(S) == SUNLS_SUCCESS, "482094616");
+  errors += ASSERT_MSG(SUNLinSolSetup_BlockKLU(S, A) == SUNLS_SUCCESS,
+                       "149725286");
+  errors += ASSERT_MSG(SUNLinSolSolve_BlockKLU(S, A, x, b, 0.0) ==
+                           SUNLS_SUCCESS,
+                       "960911743");
+  errors += check_solution(A, x, b, "687212470");
+
+  // a singular block is a recoverable failure
+  for (int i_elem = 0; i_elem < BLOCK_NNZ; ++i_elem)
+    SM_DATA_S(A)[BLOCK_NNZ + i_elem] = 0.0;
+  errors += ASSERT_MSG(SUNLinSolSetup_BlockKLU(S, A) == SUNLS_LUFACT_FAIL,
+                       "357436385");
+  errors += ASSERT_MSG(SUNLinSolLastFlag_BlockKLU(S) == SUNLS_LUFACT_FAIL,
+                       "874011931");
+
+  SUNLinSolFree_BlockKLU(S);
+
+  // blocks with different patterns are rejected
+  SM_INDEXVALS_S(A)[BLOCK_NNZ] = BLOCK_SIZE + 2;
+  errors += ASSERT_MSG(SUNBlockKLU(x, A, NUM_BLOCKS) == NULL, "548283660");
+
+  SUNMatDestroy(A);
+  N_VDestroy(x);
+  N_VDestroy(b);
+
+  if (errors == 0) {
+    printf("\nPASS\n");
+  } else {
+    printf("\nFAIL\n");
+  }
+}
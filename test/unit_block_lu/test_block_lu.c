@@ -0,0 +1,265 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ */
+/** \file
+ * \brief Tests for the cell-interleaved block-diagonal sparse LU linear solver
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../test_common.h"
+#include "../../src/block_lu_solver.h"
+
+// Number of diagonal blocks (not a multiple of the interleaving width)
+#define NUM_BLOCKS (BLOCK_LU_VECTOR_WIDTH + 3)
+
+// Number of rows (and columns) per block
+#define BLOCK_SIZE 4
+
+// Number of non-zero elements per block
+#define BLOCK_NNZ 10
+
+// Per-block pattern (CSC), with fill-in at (1,3), (2,3), (3,1) and (3,2)
+// in the natural order and none in the Markowitz order (2, 1, 0, 3):
+//   | x x . x |
+//   | x x x . |
+//   | . x x . |
+//   | x . . x |
+static const int col_ptrs[] = {0, 3, 6, 8, 10};
+static const int row_ids[] = {0, 1, 3, 0, 1, 2, 1, 2, 0, 3};
+
+// Number of rows (and columns) per block of the cyclic pattern
+#define CYCLIC_SIZE 3
+
+// Number of non-zero elements per block of the cyclic pattern
+#define CYCLIC_NNZ 6
+
+// Cyclic per-block pattern (CSC), with one fill-in element in any order:
+//   | x . x |
+//   | x x . |
+//   | . x x |
+static const int cyclic_col_ptrs[] = {0, 2, 4, 6};
+static const int cyclic_row_ids[] = {0, 1, 1, 2, 0, 2};
+
+// Set up a block-diagonal matrix with the test pattern
+SUNMatrix new_block_matrix() {
+  SUNMatrix A = SUNSparseMatrix(NUM_BLOCKS * BLOCK_SIZE,
+                                NUM_BLOCKS * BLOCK_SIZE,
+                                NUM_BLOCKS * BLOCK_NNZ, CSC_MAT);
+  for (int i_block = 0; i_block < NUM_BLOCKS; ++i_block) {
+    for (int i_col = 0; i_col < BLOCK_SIZE; ++i_col)
+      SM_INDEXPTRS_S(A)[i_block * BLOCK_SIZE + i_col] =
+          i_block * BLOCK_NNZ + col_ptrs[i_col];
+    for (int i_elem = 0; i_elem < BLOCK_NNZ; ++i_elem)
+      SM_INDEXVALS_S(A)[i_block * BLOCK_NNZ + i_elem] =
+          i_block * BLOCK_SIZE + row_ids[i_elem];
+  }
+  SM_INDEXPTRS_S(A)[NUM_BLOCKS * BLOCK_SIZE] = NUM_BLOCKS * BLOCK_NNZ;
+  return A;
+}
+
+// Set values that differ between blocks
+void set_block_values(SUNMatrix A, double scale) {
+  for (int i_block = 0; i_block < NUM_BLOCKS; ++i_block)
+    for (int i_col = 0; i_col < BLOCK_SIZE; ++i_col)
+      for (int i_elem = col_ptrs[i_col]; i_elem < col_ptrs[i_col + 1];
+           ++i_elem)
+        SM_DATA_S(A)[i_block * BLOCK_NNZ + i_elem] =
+            row_ids[i_elem] == i_col
+                ? scale * (4.0 + 0.5 * i_block)
+                : -scale * (0.3 + 0.1 * i_elem) * (1.0 + 0.2 * i_block);
+}
+
+// Check that A x = b
+int check_solution(SUNMatrix A, N_Vector x, N_Vector b, const char *msg) {
+  int errors = 0;
+  double Ax[NUM_BLOCKS * BLOCK_SIZE];
+  for (int i = 0; i < NUM_BLOCKS * BLOCK_SIZE; ++i) Ax[i] = 0.0;
+  for (int i_col = 0; i_col < NUM_BLOCKS * BLOCK_SIZE; ++i_col)
+    for (int i_elem = SM_INDEXPTRS_S(A)[i_col];
+         i_elem < SM_INDEXPTRS_S(A)[i_col + 1]; ++i_elem)
+      Ax[SM_INDEXVALS_S(A)[i_elem]] +=
+          SM_DATA_S(A)[i_elem] * NV_Ith_S(x, i_col);
+  for (int i = 0; i < NUM_BLOCKS * BLOCK_SIZE; ++i)
+    errors += ASSERT_CLOSE_MSG(Ax[i], NV_Ith_S(b, i), msg);
+  return errors;
+}
+
+// Set up a diagonally dominant block-diagonal matrix with the cyclic pattern
+SUNMatrix new_cyclic_matrix() {
+  SUNMatrix A = SUNSparseMatrix(NUM_BLOCKS * CYCLIC_SIZE,
+                                NUM_BLOCKS * CYCLIC_SIZE,
+                                NUM_BLOCKS * CYCLIC_NNZ, CSC_MAT);
+  for (int i_block = 0; i_block < NUM_BLOCKS; ++i_block) {
+    for (int i_col = 0; i_col < CYCLIC_SIZE; ++i_col) {
+      SM_INDEXPTRS_S(A)[i_block * CYCLIC_SIZE + i_col] =
+          i_block * CYCLIC_NNZ + cyclic_col_ptrs[i_col];
+      for (int i_elem = cyclic_col_ptrs[i_col];
+           i_elem < cyclic_col_ptrs[i_col + 1]; ++i_elem) {
+        SM_INDEXVALS_S(A)[i_block * CYCLIC_NNZ + i_elem] =
+            i_block * CYCLIC_SIZE + cyclic_row_ids[i_elem];
+        SM_DATA_S(A)[i_block * CYCLIC_NNZ + i_elem] =
+            cyclic_row_ids[i_elem] == i_col ? 2.0 + 0.1 * i_block
+                                            : -0.5 - 0.1 * i_elem;
+      }
+    }
+  }
+  SM_INDEXPTRS_S(A)[NUM_BLOCKS * CYCLIC_SIZE] = NUM_BLOCKS * CYCLIC_NNZ;
+  return A;
+}
+
+// Calculate the norm of the residual b - A x
+double residual_norm(SUNMatrix A, N_Vector x, N_Vector b) {
+  double norm = 0.0;
+  double Ax[NUM_BLOCKS * BLOCK_SIZE];
+  int n_rows = SM_ROWS_S(A);
+  for (int i = 0; i < n_rows; ++i) Ax[i] = 0.0;
+  for (int i_col = 0; i_col < n_rows; ++i_col)
+    for (int i_elem = SM_INDEXPTRS_S(A)[i_col];
+         i_elem < SM_INDEXPTRS_S(A)[i_col + 1]; ++i_elem)
+      Ax[SM_INDEXVALS_S(A)[i_elem]] +=
+          SM_DATA_S(A)[i_elem] * NV_Ith_S(x, i_col);
+  for (int i = 0; i < n_rows; ++i)
+    norm += (NV_Ith_S(b, i) - Ax[i]) * (NV_Ith_S(b, i) - Ax[i]);
+  return sqrt(norm);
+}
+
+// Test the incomplete ILU(0) factorization
+int test_ilu() {
+  int errors = 0;
+
+  // without fill-in in the pivot order, the incomplete factorization is
+  // exact
+  SUNMatrix A = new_block_matrix();
+  N_Vector x = N_VNew_Serial(NUM_BLOCKS * BLOCK_SIZE);
+  N_Vector b = N_VNew_Serial(NUM_BLOCKS * BLOCK_SIZE);
+  for (int i = 0; i < NUM_BLOCKS * BLOCK_SIZE; ++i)
+    NV_Ith_S(b, i) = 1.0 + 0.25 * i;
+
+  SUNLinearSolver S = SUNBlockILU(x, A, NUM_BLOCKS);
+  errors += ASSERT_MSG(S != NULL, "517302846");
+  errors += ASSERT_MSG(BLOCK_LU_CONTENT(S)->program.n_elem == BLOCK_NNZ,
+                       "264819573");
+  set_block_values(A, 2.0);
+  errors += ASSERT_MSG(SUNLinSolSetup_BlockLU(S, A) == SUNLS_SUCCESS,
+                       "930175628");
+  errors += ASSERT_MSG(SUNLinSolSolve_BlockLU(S, A, x, b, 0.0) ==
+                           SUNLS_SUCCESS,
+                       "481630295");
+  errors += check_solution(A, x, b, "753920164");
+  SUNLinSolFree_BlockLU(S);
+  SUNMatDestroy(A);
+  N_VDestroy(x);
+  N_VDestroy(b);
+
+  // the fill-in of the cyclic pattern is dropped, and the approximate
+  // solution reduces the residual
+  A = new_cyclic_matrix();
+  x = N_VNew_Serial(NUM_BLOCKS * CYCLIC_SIZE);
+  b = N_VNew_Serial(NUM_BLOCKS * CYCLIC_SIZE);
+  for (int i = 0; i < NUM_BLOCKS * CYCLIC_SIZE; ++i)
+    NV_Ith_S(b, i) = 1.0 + 0.25 * i;
+
+  S = SUNBlockLU(x, A, NUM_BLOCKS);
+  errors += ASSERT_MSG(S != NULL, "148263907");
+  errors += ASSERT_MSG(BLOCK_LU_CONTENT(S)->program.n_elem == CYCLIC_NNZ + 1,
+                       "692084351");
+  SUNLinSolFree_BlockLU(S);
+
+  S = SUNBlockILU(x, A, NUM_BLOCKS);
+  errors += ASSERT_MSG(S != NULL, "305718462");
+  errors += ASSERT_MSG(BLOCK_LU_CONTENT(S)->program.n_elem == CYCLIC_NNZ,
+                       "876243019");
+  errors += ASSERT_MSG(SUNLinSolSetup_BlockLU(S, A) == SUNLS_SUCCESS,
+                       "219546730");
+  errors += ASSERT_MSG(SUNLinSolSolve_BlockLU(S, A, x, b, 0.0) ==
+                           SUNLS_SUCCESS,
+                       "564102897");
+  double resid = residual_norm(A, x, b);
+  N_VConst(0.0, x);
+  double resid_0 = residual_norm(A, x, b);
+  errors += ASSERT_MSG(resid > 0.0 && resid < 0.1 * resid_0, "397352184");
+  SUNLinSolFree_BlockLU(S);
+  SUNMatDestroy(A);
+  N_VDestroy(x);
+  N_VDestroy(b);
+
+  return errors;
+}
+
+int main(int argc, char *argv[]) {
+  int errors = 0;
+
+  SUNMatrix A = new_block_matrix();
+  N_Vector x = N_VNew_Serial(NUM_BLOCKS * BLOCK_SIZE);
+  N_Vector b = N_VNew_Serial(NUM_BLOCKS * BLOCK_SIZE);
+  for (int i = 0; i < NUM_BLOCKS * BLOCK_SIZE; ++i)
+    NV_Ith_S(b, i) = 1.0 + 0.25 * i;
+
+  SUNLinearSolver S = SUNBlockLU(x, A, NUM_BLOCKS);
+  errors += ASSERT_MSG(S != NULL, "270936254");
+  errors += ASSERT_MSG(SUNLinSolGetType_BlockLU(S) == SUNLINEARSOLVER_DIRECT,
+                       "891063624");
+  errors += ASSERT_MSG(SUNLinSolInitialize_BlockLU(S) == SUNLS_SUCCESS,
+                       "452617849");
+
+  // the pivot order avoids the fill-in
+  errors += ASSERT_MSG(BLOCK_LU_CONTENT(S)->program.n_elem == BLOCK_NNZ,
+                       "103866215");
+  errors += ASSERT_MSG(BLOCK_LU_CONTENT(S)->program.perm[0] == 2 &&
+                           BLOCK_LU_CONTENT(S)->program.perm[1] == 1 &&
+                           BLOCK_LU_CONTENT(S)->program.perm[2] == 0 &&
+                           BLOCK_LU_CONTENT(S)->program.perm[3] == 3,
+                       "629184350");
+
+  // first factorization
+  set_block_values(A, 1.0);
+  errors += ASSERT_MSG(SUNLinSolSetup_BlockLU(S, A) == SUNLS_SUCCESS,
+                       "671384012");
+  errors += ASSERT_MSG(SUNLinSolSolve_BlockLU(S, A, x, b, 0.0) ==
+                           SUNLS_SUCCESS,
+                       "229583160");
+  errors += check_solution(A, x, b, "798311640");
+
+  // refactorization with new values
+  set_block_values(A, 3.0);
+  errors += ASSERT_MSG(SUNLinSolSetup_BlockLU(S, A) == SUNLS_SUCCESS,
+                       "314905827");
+  errors += ASSERT_MSG(SUNLinSolSolve_BlockLU(S, A, x, b, 0.0) ==
+                           SUNLS_SUCCESS,
+                       "946120538");
+  errors += check_solution(A, x, b, "582047931");
+
+  // a zero pivot in any block is a recoverable failure
+  for (int i_elem = 0; i_elem < BLOCK_NNZ; ++i_elem)
+    SM_DATA_S(A)[(NUM_BLOCKS - 1) * BLOCK_NNZ + i_elem] = 0.0;
+  errors += ASSERT_MSG(SUNLinSolSetup_BlockLU(S, A) == SUNLS_LUFACT_FAIL,
+                       "605271843");
+  errors += ASSERT_MSG(SUNLinSolLastFlag_BlockLU(S) == SUNLS_LUFACT_FAIL,
+                       "137460952");
+
+  SUNLinSolFree_BlockLU(S);
+
+  // blocks with different patterns are rejected
+  SM_INDEXVALS_S(A)[BLOCK_NNZ + 1] = BLOCK_SIZE + 2;
+  errors += ASSERT_MSG(SUNBlockLU(x, A, NUM_BLOCKS) == NULL, "438195076");
+
+  // patterns without the full diagonal are rejected
+  SM_INDEXVALS_S(A)[BLOCK_NNZ + 1] = BLOCK_SIZE + 1;
+  for (int i_block = 0; i_block < NUM_BLOCKS; ++i_block)
+    SM_INDEXVALS_S(A)[i_block * BLOCK_NNZ + 4] = i_block * BLOCK_SIZE + 3;
+  errors += ASSERT_MSG(SUNBlockLU(x, A, NUM_BLOCKS) == NULL, "820746315");
+
+  errors += test_ilu();
+
+  SUNMatDestroy(A);
+  N_VDestroy(x);
+  N_VDestroy(b);
+
+  if (errors == 0) {
+    printf("\nPASS\n");
+  } else {
+    printf("\nFAIL\n");
+  }
+}
@@ -0,0 +1,69 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ */
+/** \file
+ * \brief Tests for the per-grid-cell error norm
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../test_common.h"
+#include "../../src/cell_norm.h"
+
+// Number of grid cells
+#define NUM_CELLS 3
+
+// Number of solver variables per grid cell
+#define CELL_SIZE 2
+
+int main(int argc, char *argv[]) {
+  int errors = 0;
+  CellNorm *norm = cell_norm_new(NUM_CELLS, CELL_SIZE);
+  N_Vector y = N_VNew_Serial(NUM_CELLS * CELL_SIZE);
+  N_Vector w = N_VNew_Serial(NUM_CELLS * CELL_SIZE);
+  N_Vector short_vec = N_VNew_Serial(CELL_SIZE);
+
+  // vectors of the wrong length are rejected
+  errors += ASSERT_MSG(cell_norm_attach(short_vec, norm) == -1, "418270593");
+
+  // the largest norm is in grid cell 1
+  double y_data[NUM_CELLS * CELL_SIZE] = {1.0, 1.0, 3.0, 4.0, 0.5, 0.0};
+  for (int i = 0; i < NUM_CELLS * CELL_SIZE; ++i) NV_Ith_S(y, i) = y_data[i];
+  N_VConst(2.0, w);
+  errors += ASSERT_MSG(cell_norm_attach(y, norm) == 0, "736104928");
+  errors += ASSERT_MSG(
+      fabs(N_VWrmsNorm(y, w) - 2.0 * sqrt(12.5)) < 1.0e-12, "290518374");
+  errors += ASSERT_MSG(norm->last_worst_cell == 1, "851627049");
+
+  // clones use the cell norm
+  N_Vector y_clone = N_VClone(y);
+  N_VConst(0.0, y_clone);
+  NV_Ith_S(y_clone, 5) = 1.0;
+  errors += ASSERT_MSG(
+      fabs(N_VWrmsNorm(y_clone, w) - 2.0 * sqrt(0.5)) < 1.0e-12, "507316842");
+  errors += ASSERT_MSG(norm->last_worst_cell == 2, "163940527");
+
+  // new error test failures are attributed to the last worst cell
+  cell_norm_count_fails(norm, 2);
+  cell_norm_count_fails(norm, 2);
+  errors += ASSERT_MSG(norm->n_err_test_fails[0] == 0, "972384150");
+  errors += ASSERT_MSG(norm->n_err_test_fails[1] == 0, "648201735");
+  errors += ASSERT_MSG(norm->n_err_test_fails[2] == 2, "315794062");
+  N_VWrmsNorm(y, w);
+  cell_norm_count_fails(norm, 3);
+  errors += ASSERT_MSG(norm->n_err_test_fails[1] == 1, "829046153");
+  errors += ASSERT_MSG(norm->n_fails_counted == 3, "046392817");
+
+  N_VDestroy(y_clone);
+  N_VDestroy(y);
+  N_VDestroy(w);
+  N_VDestroy(short_vec);
+  cell_norm_free(norm);
+
+  if (errors == 0) {
+    printf("\nPASS\n");
+  } else {
+    printf("\nFAIL\n");
+  }
+}
@@ -81,6 +81,22 @@ int main(int argc, char * argv[]) {
   errors+=ASSERT_CLOSE_MSG(out_vals[3],  50.0, "991997956");
   errors+=ASSERT_MSG(out_vals[4]==REF_VAL, "256890554");
 
+  // check that a copied Jacobian has the same structure and its own data
+  Jacobian jac_copy;
+  errors+=ASSERT_MSG(jacobian_initialize_copy(&jac_copy, jac)==1, "730193516");
+  errors+=ASSERT_MSG(jacobian_number_of_elements(jac_copy)==4, "542866270");
+  errors+=ASSERT_MSG(jacobian_column_pointer_value(jac_copy,3)==3, "116932804");
+  errors+=ASSERT_MSG(jacobian_get_element_id(jac_copy, 2, 4)==3, "880731427");
+  jacobian_add_value(jac_copy, 3, 0, 5.0);
+  for(int i=0; i<NUM_ELEM+1; ++i)out_vals[i] = REF_VAL;
+  jacobian_output(jac_copy, out_vals);
+  errors+=ASSERT_MSG(out_vals[0]==0.0, "370985516");
+  errors+=ASSERT_CLOSE_MSG(out_vals[3], 5.0, "604367792");
+  jacobian_output(jac, out_vals);
+  errors+=ASSERT_CLOSE_MSG(out_vals[0], -70.0, "237713380");
+  errors+=ASSERT_CLOSE_MSG(out_vals[3],  50.0, "987221065");
+  jacobian_free(&jac_copy);
+
   jacobian_free(&jac);
 
   // check Jacobian with a column with more than the buffer size of rows
@@ -112,6 +128,15 @@ int main(int argc, char * argv[]) {
   }
   errors+=ASSERT_MSG(out_vals2[20]==REF_VAL, "174374468");
 
+  // check that small contributions are not lost when large production and
+  // loss partials cancel
+  jacobian_reset(jac);
+  jacobian_add_value(jac, 0, 0, 1.0);
+  for (int i=0; i<100; ++i) jacobian_add_value(jac, 0, 0, 1.0e-17);
+  jacobian_add_value(jac, 0, 1, 1.0);
+  jacobian_output(jac, out_vals2);
+  errors+=ASSERT_MSG(fabs(out_vals2[0]-1.0e-15) < 1.0e-17, "562093817");
+
   jacobian_free(&jac);
 
   if (errors==0) {
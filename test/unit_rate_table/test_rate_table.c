@@ -0,0 +1,152 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ */
+/** \file
+ * \brief Tests for the tabulated temperature- and pressure-dependent
+ *        reaction parameters
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../test_common.h"
+#include "../../src/rate_table.h"
+#include "../../src/rxn_solver.h"
+
+// Number of reactions
+#define NUM_RXN 4
+
+// Number of reaction environment-dependent parameters per grid cell
+#define NUM_ENV_DATA 5
+
+// Number of grid cells (the last one is outside the table range)
+#define NUM_CELLS 40
+
+// Maximum relative interpolation error of the table
+#define TABLE_TOL 1.0e-6
+
+// Conversion from Pa/K to molecules/cm3
+#define CONV 7.243e16
+
+static int rxn_int_data[] = {
+    RXN_ARRHENIUS,   2, 1, 1, 2, 3, 0, 1, 2, -1, -1, -1, 0, 1, 2,
+    RXN_PHOTOLYSIS,  1, 1, 1, 1, 2, 0, 1, -1, 3,
+    RXN_TROE,        2, 1, 1, 2, 3, 0, 1, 2, -1, -1, -1, 0, 1, 2,
+    RXN_ARRHENIUS,   1, 1, 3, 1, 2, 0, 4, 5};
+static double rxn_float_data[] = {
+    // Arrhenius
+    1.8e-12, 0.0, -1500.0, 300.0, 0.0, 1.0e-6 * CONV, 1.0,
+    // photolysis
+    0.7, 1.0,
+    // Troe
+    2.0e-30, -4.4, 0.0, 1.4e-12, -0.7, 0.0, 0.6, 1.0, 1.0, 1.0e-6 * CONV, 1.0,
+    // Arrhenius too steep to tabulate
+    1.0e10, 0.0, -1.0e5, 300.0, 0.0, 1.0e-6 * CONV, 1.0};
+static int rxn_int_indices[NUM_RXN + 1] = {0, 15, 25, 40, 49};
+static int rxn_float_indices[NUM_RXN + 1] = {0, 7, 9, 20, 27};
+static int rxn_env_idx[NUM_RXN + 1] = {0, 1, 3, 4, 5};
+
+// Calculate the reaction parameters of a grid cell directly
+static void calc_direct(ModelData *md, double *env, double *rxn_env_data) {
+  md->rate_table = NULL;
+  md->grid_cell_env = env;
+  md->grid_cell_rxn_env_data = rxn_env_data;
+  rxn_update_env_state(md);
+}
+
+int main(int argc, char *argv[]) {
+  int errors = 0;
+  ModelData md;
+  double env[NUM_CELLS * CAMP_NUM_ENV_PARAM_];
+  double rxn_env_data[NUM_CELLS * NUM_ENV_DATA];
+  double expected[NUM_CELLS * NUM_ENV_DATA];
+  int n_table_cells = 0;
+
+  memset(&md, 0, sizeof(ModelData));
+  md.n_cells = NUM_CELLS;
+  md.n_rxn = NUM_RXN;
+  md.n_added_rxns = NUM_RXN;
+  md.rxn_int_data = rxn_int_data;
+  md.rxn_float_data = rxn_float_data;
+  md.rxn_int_indices = rxn_int_indices;
+  md.rxn_float_indices = rxn_float_indices;
+  md.rxn_env_idx = rxn_env_idx;
+  md.n_rxn_env_data = NUM_ENV_DATA;
+  md.total_env = env;
+  md.rxn_env_data = rxn_env_data;
+
+  // environmental states spread over the table range, including the edges
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    double x = (double)i_cell / (NUM_CELLS - 2);
+    env[i_cell * CAMP_NUM_ENV_PARAM_] =
+        RATE_TABLE_TEMP_MIN + (RATE_TABLE_TEMP_MAX - RATE_TABLE_TEMP_MIN) * x;
+    env[i_cell * CAMP_NUM_ENV_PARAM_ + 1] =
+        RATE_TABLE_PRESS_MIN +
+        (RATE_TABLE_PRESS_MAX - RATE_TABLE_PRESS_MIN) * fmod(7.31 * x, 1.0);
+  }
+  env[(NUM_CELLS - 1) * CAMP_NUM_ENV_PARAM_] = RATE_TABLE_TEMP_MAX + 20.0;
+
+  // the photolysis base rate is set by an update function
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    expected[i_cell * NUM_ENV_DATA + 2] = 0.01 * (i_cell + 1);
+    calc_direct(&md, &(env[i_cell * CAMP_NUM_ENV_PARAM_]),
+                &(expected[i_cell * NUM_ENV_DATA]));
+  }
+  memcpy(rxn_env_data, expected, sizeof(expected));
+  for (int i = 0; i < NUM_CELLS * NUM_ENV_DATA; ++i)
+    if (i % NUM_ENV_DATA != 2) rxn_env_data[i] = 0.0;
+
+  // only the Arrhenius and Troe reactions within the tolerance are tabulated
+  RateTable *table = rate_table_new(&md, TABLE_TOL);
+  errors += ASSERT_MSG(table != NULL, "418273905");
+  if (table == NULL) {
+    printf("\nFAIL\n");
+    return 0;
+  }
+  errors += ASSERT_MSG(table->tabulated[0], "653019284");
+  errors += ASSERT_MSG(!table->tabulated[1], "207946531");
+  errors += ASSERT_MSG(table->tabulated[2], "831502746");
+  errors += ASSERT_MSG(!table->tabulated[3], "390674125");
+  errors += ASSERT_MSG(table->n_param == 2, "946120385");
+
+  // update the grid cells as the solver does
+  md.rate_table = table;
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    md.grid_cell_env = &(env[i_cell * CAMP_NUM_ENV_PARAM_]);
+    md.grid_cell_rxn_env_data = &(rxn_env_data[i_cell * NUM_ENV_DATA]);
+    rxn_update_env_state(&md);
+    if (rate_table_covers(table, md.grid_cell_env))
+      table->cell_ids[n_table_cells++] = i_cell;
+  }
+  errors += ASSERT_MSG(n_table_cells == NUM_CELLS - 1, "572039481");
+  rate_table_update_cells(table, &md, table->cell_ids, n_table_cells);
+
+  // the tolerance is met anywhere in the table range
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    double *actual = &(rxn_env_data[i_cell * NUM_ENV_DATA]);
+    double *exact = &(expected[i_cell * NUM_ENV_DATA]);
+    if (i_cell < NUM_CELLS - 1) {
+      errors += ASSERT_MSG(
+          fabs(actual[0] - exact[0]) <= TABLE_TOL * fabs(exact[0]),
+          "168305927");
+      errors += ASSERT_MSG(
+          fabs(actual[3] - exact[3]) <= TABLE_TOL * fabs(exact[3]),
+          "725190463");
+    } else {
+      errors += ASSERT_CLOSE_MSG(actual[0], exact[0], "304816259");
+      errors += ASSERT_CLOSE_MSG(actual[3], exact[3], "859241067");
+    }
+    errors += ASSERT_CLOSE_MSG(actual[1], exact[1], "481620395");
+    errors += ASSERT_CLOSE_MSG(actual[2], exact[2], "937502816");
+    errors += ASSERT_CLOSE_MSG(actual[4], exact[4], "260391748");
+  }
+
+  rate_table_free(table);
+
+  if (errors == 0) {
+    printf("\nPASS\n");
+  } else {
+    printf("\nFAIL\n");
+  }
+}
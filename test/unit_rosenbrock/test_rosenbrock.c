@@ -0,0 +1,177 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ */
+/** \file
+ * \brief Tests for the Rosenbrock integrators
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../test_common.h"
+#include "../../src/block_klu_solver.h"
+#include "../../src/rosenbrock_solver.h"
+
+// Number of grid cells (diagonal blocks)
+#define NUM_CELLS 3
+
+// Number of species per grid cell
+#define NUM_SPEC 2
+
+// Number of non-zero Jacobian elements per grid cell
+#define CELL_NNZ 3
+
+// Index of the coefficient for stage i and earlier stage j
+#define ROS_ID(i, j) ((i) * ((i)-1) / 2 + (j))
+
+// Rate constants for A -> B -> C in each grid cell
+typedef struct {
+  double k1[NUM_CELLS];
+  double k2[NUM_CELLS];
+} ChainData;
+
+// Time derivative of the chain reaction
+int chain_f(realtype t, N_Vector y, N_Vector fy, void *user_data) {
+  ChainData *data = (ChainData *)user_data;
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    double A = NV_Ith_S(y, i_cell * NUM_SPEC);
+    double B = NV_Ith_S(y, i_cell * NUM_SPEC + 1);
+    NV_Ith_S(fy, i_cell * NUM_SPEC) = -data->k1[i_cell] * A;
+    NV_Ith_S(fy, i_cell * NUM_SPEC + 1) =
+        data->k1[i_cell] * A - data->k2[i_cell] * B;
+  }
+  return 0;
+}
+
+// Jacobian (CSC: (0,0), (1,0), (1,1) per cell) and time derivative
+int chain_jac(realtype t, N_Vector y, N_Vector fy, SUNMatrix J,
+              void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3) {
+  ChainData *data = (ChainData *)user_data;
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    SM_DATA_S(J)[i_cell * CELL_NNZ] = -data->k1[i_cell];
+    SM_DATA_S(J)[i_cell * CELL_NNZ + 1] = data->k1[i_cell];
+    SM_DATA_S(J)[i_cell * CELL_NNZ + 2] = -data->k2[i_cell];
+  }
+  return chain_f(t, y, fy, user_data);
+}
+
+// Solve y' = -y^3, y(0) = 1 to t = 1 with a fixed step size
+double scalar_solve(RosenbrockMethod *m, int n_steps) {
+  double h = 1.0 / n_steps;
+  double y = 1.0;
+  for (int i_step = 0; i_step < n_steps; ++i_step) {
+    double K[ROS_MAX_STAGES];
+    double h_gamma = h * m->gamma[0];
+    double jac = -3.0 * y * y;
+    double f = -y * y * y;
+    for (int i = 0; i < m->n_stages; ++i) {
+      if (i > 0 && m->new_f[i]) {
+        double y_stage = y;
+        for (int j = 0; j < i; ++j) y_stage += m->A[ROS_ID(i, j)] * K[j];
+        f = -y_stage * y_stage * y_stage;
+      }
+      double rhs = h_gamma * f;
+      for (int j = 0; j < i; ++j)
+        rhs += m->C[ROS_ID(i, j)] * m->gamma[0] * K[j];
+      K[i] = rhs / (1.0 - h_gamma * jac);
+    }
+    for (int i = 0; i < m->n_stages; ++i) y += m->M[i] * K[i];
+  }
+  return y;
+}
+
+// Check the order of convergence of a method
+int check_order(int method_id, double order, const char *msg) {
+  RosenbrockMethod m;
+  int errors = 0;
+
+  errors += ASSERT_MSG(rosenbrock_method_init(&m, method_id) == 0, msg);
+  double y_exact = 1.0 / sqrt(3.0);
+  double err_coarse = fabs(scalar_solve(&m, 80) - y_exact);
+  double err_fine = fabs(scalar_solve(&m, 160) - y_exact);
+  double obs_order = log2(err_coarse / err_fine);
+  errors += ASSERT_MSG(fabs(obs_order - order) < 0.35, msg);
+  return errors;
+}
+
+// Integrate the multi-cell chain reaction and compare with the analytic
+// solution
+int check_chain(int method_id, const char *msg) {
+  int errors = 0;
+  ChainData data;
+  SUNMatrix J = SUNSparseMatrix(NUM_CELLS * NUM_SPEC, NUM_CELLS * NUM_SPEC,
+                                NUM_CELLS * CELL_NNZ, CSC_MAT);
+  N_Vector y = N_VNew_Serial(NUM_CELLS * NUM_SPEC);
+  N_Vector abs_tol = N_VNew_Serial(NUM_CELLS * NUM_SPEC);
+
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    data.k1[i_cell] = 1.0e3 * (i_cell + 1);
+    data.k2[i_cell] = 1.0 + 0.5 * i_cell;
+    SM_INDEXPTRS_S(J)[i_cell * NUM_SPEC] = i_cell * CELL_NNZ;
+    SM_INDEXPTRS_S(J)[i_cell * NUM_SPEC + 1] = i_cell * CELL_NNZ + 2;
+    SM_INDEXVALS_S(J)[i_cell * CELL_NNZ] = i_cell * NUM_SPEC;
+    SM_INDEXVALS_S(J)[i_cell * CELL_NNZ + 1] = i_cell * NUM_SPEC + 1;
+    SM_INDEXVALS_S(J)[i_cell * CELL_NNZ + 2] = i_cell * NUM_SPEC + 1;
+    NV_Ith_S(y, i_cell * NUM_SPEC) = 1.0;
+    NV_Ith_S(y, i_cell * NUM_SPEC + 1) = 0.5;
+  }
+  SM_INDEXPTRS_S(J)[NUM_CELLS * NUM_SPEC] = NUM_CELLS * CELL_NNZ;
+  N_VConst(1.0e-12, abs_tol);
+
+  SUNLinearSolver ls = SUNBlockKLU(y, J, NUM_CELLS);
+  RosenbrockMem *ros = rosenbrock_create(method_id, y, J, ls, chain_f,
+                                         chain_jac, &data, 1.0e-4, abs_tol,
+                                         10000);
+  errors += ASSERT_MSG(ros != NULL, msg);
+  if (ros == NULL) return errors;
+
+  errors += ASSERT_MSG(rosenbrock_integrate(ros, 0.0, 1.0, 1.0e-6, y) ==
+                           ROS_SUCCESS,
+                       msg);
+  errors += ASSERT_MSG(ros->n_steps > 0, msg);
+  errors += ASSERT_MSG(ros->n_jac_evals == ros->n_steps, msg);
+
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    double k1 = data.k1[i_cell];
+    double k2 = data.k2[i_cell];
+    double A = exp(-k1);
+    double B = k1 / (k2 - k1) * (exp(-k1) - exp(-k2)) + 0.5 * exp(-k2);
+    errors += ASSERT_MSG(fabs(NV_Ith_S(y, i_cell * NUM_SPEC) - A) < 1.0e-8,
+                         msg);
+    errors += ASSERT_MSG(
+        fabs(NV_Ith_S(y, i_cell * NUM_SPEC + 1) - B) < 1.0e-3 * B, msg);
+  }
+
+  rosenbrock_free(ros);
+  SUNLinSolFree(ls);
+  SUNMatDestroy(J);
+  N_VDestroy(y);
+  N_VDestroy(abs_tol);
+  return errors;
+}
+
+int main(int argc, char *argv[]) {
+  int errors = 0;
+  RosenbrockMethod m;
+
+  // order of convergence of each method
+  errors += check_order(ROS_METHOD_ROS2, 2.0, "395027164");
+  errors += check_order(ROS_METHOD_ROS3, 3.0, "716283049");
+  errors += check_order(ROS_METHOD_RODAS3, 3.0, "240591836");
+  errors += check_order(ROS_METHOD_RODAS4, 4.0, "859134702");
+
+  // unknown methods are rejected
+  errors += ASSERT_MSG(rosenbrock_method_init(&m, -1) == -1, "603728415");
+
+  // stiff multi-cell integration
+  errors += check_chain(ROS_METHOD_ROS2, "172950483");
+  errors += check_chain(ROS_METHOD_ROS3, "938461025");
+  errors += check_chain(ROS_METHOD_RODAS3, "514072398");
+  errors += check_chain(ROS_METHOD_RODAS4, "287305916");
+
+  if (errors == 0) {
+    printf("\nPASS\n");
+  } else {
+    printf("\nFAIL\n");
+  }
+}
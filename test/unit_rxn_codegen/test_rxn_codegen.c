@@ -0,0 +1,158 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ */
+/** \file
+ * \brief Tests for the generated reaction kernels
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../test_common.h"
+#include "../../src/rxn_codegen.h"
+#include "../../src/rxn_solver.h"
+
+#ifndef CAMP_TEST_C_COMPILER
+#define CAMP_TEST_C_COMPILER "cc"
+#endif
+
+// Number of state variables
+#define NUM_STATE_VAR 4
+
+// Number of reaction Jacobian elements
+#define NUM_JAC_ELEM 10
+
+// Files for the generated kernel
+#define KERNEL_SOURCE "test_rxn_codegen_kernel.c"
+#define KERNEL_LIB "./test_rxn_codegen_kernel.so"
+
+// Accumulated value of element i of a rate or partial derivative array
+#define SUM_VALUE(obj, array, i) CAMP_SUM_VALUE(obj.array, obj.array##_comp, i)
+
+// Reaction data:
+//   0: Arrhenius   A + B -> 0.5 C + D
+//   1: photolysis  C -> A
+//   2: emission    D  (not included in kernels)
+static int rxn_int_data[] = {
+    RXN_ARRHENIUS, 2, 2, 1, 2, 3, 4, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 6, 7,
+    RXN_PHOTOLYSIS, 1, 1, 1, 3, 1, 2, 0, 8, 9,
+    RXN_EMISSION, 2, 4, 3};
+static int rxn_int_indices[] = {0, 19, 29, 33};
+static double rxn_float_data[] = {1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.5, 1.0,
+                                  1.0, 1.0, 1.0};
+static int rxn_float_indices[] = {0, 8, 10, 11};
+static int rxn_env_idx[] = {0, 1, 3, 5};
+
+// Set up the model data for the test reactions
+void set_model_data(ModelData *md, double *state, double *env,
+                    double *rxn_env_data) {
+  memset(md, 0, sizeof(ModelData));
+  md->n_per_cell_state_var = NUM_STATE_VAR;
+  md->n_per_cell_dep_var = NUM_STATE_VAR;
+  md->n_rxn = 3;
+  md->n_added_rxns = 3;
+  md->rxn_int_data = rxn_int_data;
+  md->rxn_float_data = rxn_float_data;
+  md->rxn_int_indices = rxn_int_indices;
+  md->rxn_float_indices = rxn_float_indices;
+  md->rxn_env_idx = rxn_env_idx;
+  md->n_rxn_env_data = 5;
+  md->grid_cell_state = state;
+  md->total_state = state;
+  md->grid_cell_env = env;
+  md->total_env = env;
+  md->grid_cell_rxn_env_data = rxn_env_data;
+  md->rxn_env_data = rxn_env_data;
+  md->rxn_kernel = NULL;
+}
+
+// Calculate the reaction contributions
+void calc_contrib(ModelData *md, TimeDerivative time_deriv, Jacobian jac) {
+  time_derivative_reset(time_deriv);
+  jacobian_reset(jac);
+  rxn_calc_deriv(md, time_deriv, 1.0);
+  rxn_calc_jac(md, jac, 1.0);
+}
+
+int main(int argc, char *argv[]) {
+  int errors = 0;
+  ModelData md;
+  double state[NUM_STATE_VAR] = {1.2, 3.4, 0.7, 2.5};
+  double env[CAMP_NUM_ENV_PARAM_] = {298.15, 101325.0};
+  double rxn_env_data[] = {0.03, 0.2, 0.2, 1.5, 1.5};
+  TimeDerivative deriv_generic, deriv_kernel;
+  Jacobian jac_generic, jac_kernel;
+  CampSum partials[4 * NUM_JAC_ELEM];
+#ifdef CAMP_USE_COMPENSATED_SUM
+  double partials_comp[4 * NUM_JAC_ELEM];
+#endif
+
+  set_model_data(&md, state, env, rxn_env_data);
+  time_derivative_initialize(&deriv_generic, NUM_STATE_VAR);
+  time_derivative_initialize(&deriv_kernel, NUM_STATE_VAR);
+  jac_generic.production_partials = &(partials[0]);
+  jac_generic.loss_partials = &(partials[NUM_JAC_ELEM]);
+  jac_kernel.production_partials = &(partials[2 * NUM_JAC_ELEM]);
+  jac_kernel.loss_partials = &(partials[3 * NUM_JAC_ELEM]);
+  jac_generic.num_elem = jac_kernel.num_elem = NUM_JAC_ELEM;
+#ifdef CAMP_USE_COMPENSATED_SUM
+  jac_generic.production_partials_comp = &(partials_comp[0]);
+  jac_generic.loss_partials_comp = &(partials_comp[NUM_JAC_ELEM]);
+  jac_kernel.production_partials_comp = &(partials_comp[2 * NUM_JAC_ELEM]);
+  jac_kernel.loss_partials_comp = &(partials_comp[3 * NUM_JAC_ELEM]);
+#endif
+
+  // generic reaction functions
+  calc_contrib(&md, deriv_generic, jac_generic);
+
+  // generate, compile and load the kernel
+  errors += ASSERT_MSG(rxn_codegen_write_source(&md, KERNEL_SOURCE) == 1,
+                       "395728113");
+  errors += ASSERT_MSG(system(CAMP_TEST_C_COMPILER
+                              " -O2 -fPIC -shared -o " KERNEL_LIB
+                              " " KERNEL_SOURCE) == 0,
+                       "874402962");
+  md.rxn_kernel = rxn_codegen_load(&md, KERNEL_LIB);
+  errors += ASSERT_MSG(md.rxn_kernel != NULL, "116030587");
+  if (md.rxn_kernel == NULL) {
+    printf("\nFAIL\n");
+    return 1;
+  }
+  errors += ASSERT_MSG(md.rxn_kernel->n_generic_rxn == 1, "531196447");
+  errors += ASSERT_MSG(md.rxn_kernel->generic_rxn[0] == 2, "208455796");
+
+  // kernel with the generic functions for the remaining reactions
+  calc_contrib(&md, deriv_kernel, jac_kernel);
+  for (int i = 0; i < NUM_STATE_VAR; ++i) {
+    errors += ASSERT_CLOSE_MSG(SUM_VALUE(deriv_kernel, production_rates, i),
+                               SUM_VALUE(deriv_generic, production_rates, i),
+                               "627380911");
+    errors += ASSERT_CLOSE_MSG(SUM_VALUE(deriv_kernel, loss_rates, i),
+                               SUM_VALUE(deriv_generic, loss_rates, i),
+                               "950237418");
+  }
+  for (int i = 0; i < NUM_JAC_ELEM; ++i) {
+    errors += ASSERT_CLOSE_MSG(SUM_VALUE(jac_kernel, production_partials, i),
+                               SUM_VALUE(jac_generic, production_partials, i),
+                               "473305186");
+    errors += ASSERT_CLOSE_MSG(SUM_VALUE(jac_kernel, loss_partials, i),
+                               SUM_VALUE(jac_generic, loss_partials, i),
+                               "184926605");
+  }
+  rxn_codegen_free(md.rxn_kernel);
+  md.rxn_kernel = NULL;
+
+  // kernels generated for other reaction data are rejected
+  rxn_float_data[6] = 0.25;
+  errors +=
+      ASSERT_MSG(rxn_codegen_load(&md, KERNEL_LIB) == NULL, "762114439");
+
+  time_derivative_free(deriv_generic);
+  time_derivative_free(deriv_kernel);
+
+  if (errors == 0) {
+    printf("\nPASS\n");
+  } else {
+    printf("\nFAIL\n");
+  }
+}
@@ -0,0 +1,213 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ */
+/** \file
+ * \brief Tests for the batch evaluation of rate constants
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../test_common.h"
+#include "../../src/rate_table.h"
+#include "../../src/rxn_env_batch.h"
+#include "../../src/rxn_solver.h"
+
+// Number of reactions
+#define NUM_RXN 6
+
+// Number of reaction environment-dependent parameters per grid cell
+#define NUM_ENV_DATA 7
+
+// Number of grid cells (the last one is outside the rate table range)
+#define NUM_CELLS 30
+
+// Maximum relative difference from the reaction update functions
+#define BATCH_TOL 1.0e-12
+
+// Maximum relative interpolation error of the rate table
+#define TABLE_TOL 1.0e-6
+
+// Value of the tabulated rate constants before interpolation
+#define NOT_SET -999.0
+
+// Conversion from Pa/K to molecules/cm3
+#define CONV 7.243e16
+
+static int rxn_int_data[] = {
+    RXN_ARRHENIUS,   2, 1, 1, 2, 3, 0, 1, 2, -1, -1, -1, 0, 1, 2,
+    RXN_PHOTOLYSIS,  1, 1, 1, 1, 2, 0, 1, -1, 3,
+    RXN_TROE,        2, 1, 1, 2, 3, 0, 1, 2, -1, -1, -1, 0, 1, 2,
+    RXN_TERNARY_CHEMICAL_ACTIVATION,
+                     2, 1, 1, 2, 3, 0, 1, 2, -1, -1, -1, 0, 1, 2,
+    RXN_WENNBERG_TUNNELING,
+                     2, 1, 1, 2, 3, 0, 1, 2, -1, -1, -1, 0, 1, 2,
+    RXN_TROE,        2, 1, 1, 2, 3, 0, 1, 2, -1, -1, -1, 0, 1, 2};
+static double rxn_float_data[] = {
+    // Arrhenius
+    1.2e-11, -0.9, -150.0, 300.0, 1.0e-6, 1.0e-6 * CONV, 1.0,
+    // photolysis
+    0.7, 1.0,
+    // Troe
+    2.0e-30, -4.4, 0.0, 1.4e-12, -0.7, 0.0, 0.6, 1.0, 1.0, 1.0e-6 * CONV, 1.0,
+    // ternary chemical activation
+    5.2e-30, -2.4, 0.0, 2.2e-10, -0.7, 0.0, 0.6, 1.0, 1.0, 1.0e-6 * CONV, 1.0,
+    // Wennberg tunneling
+    1.5e11, 9750.0, 1.03e8, 1.0e-6 * CONV, 1.0,
+    // Troe with Fc = 0 (calculated by its update function)
+    2.0e-30, -4.4, 0.0, 1.4e-12, -0.7, 0.0, 0.0, 1.0, 1.0, 1.0e-6 * CONV, 1.0};
+static int rxn_int_indices[NUM_RXN + 1] = {0, 15, 25, 40, 55, 70, 85};
+static int rxn_float_indices[NUM_RXN + 1] = {0, 7, 9, 20, 31, 36, 47};
+static int rxn_env_idx[NUM_RXN + 1] = {0, 1, 3, 4, 5, 6, 7};
+
+// Calculate the reaction parameters of a grid cell directly
+static void calc_direct(ModelData *md, double *env, double *rxn_env_data) {
+  md->rate_table = NULL;
+  md->rxn_env_batch = NULL;
+  md->grid_cell_env = env;
+  md->grid_cell_rxn_env_data = rxn_env_data;
+  rxn_update_env_state(md);
+}
+
+int main(int argc, char *argv[]) {
+  int errors = 0;
+  ModelData md;
+  double env[NUM_CELLS * CAMP_NUM_ENV_PARAM_];
+  double rxn_env_data[NUM_CELLS * NUM_ENV_DATA];
+  double expected[NUM_CELLS * NUM_ENV_DATA];
+  int cell_ids[NUM_CELLS];
+  int n_table_cells = 0, n_batch_cells = 0;
+
+  memset(&md, 0, sizeof(ModelData));
+  md.n_cells = NUM_CELLS;
+  md.n_rxn = NUM_RXN;
+  md.n_added_rxns = NUM_RXN;
+  md.rxn_int_data = rxn_int_data;
+  md.rxn_float_data = rxn_float_data;
+  md.rxn_int_indices = rxn_int_indices;
+  md.rxn_float_indices = rxn_float_indices;
+  md.rxn_env_idx = rxn_env_idx;
+  md.n_rxn_env_data = NUM_ENV_DATA;
+  md.total_env = env;
+  md.rxn_env_data = rxn_env_data;
+
+  // environmental states spread over the rate table range
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    double x = (double)i_cell / (NUM_CELLS - 2);
+    env[i_cell * CAMP_NUM_ENV_PARAM_] =
+        RATE_TABLE_TEMP_MIN + (RATE_TABLE_TEMP_MAX - RATE_TABLE_TEMP_MIN) * x;
+    env[i_cell * CAMP_NUM_ENV_PARAM_ + 1] =
+        RATE_TABLE_PRESS_MIN +
+        (RATE_TABLE_PRESS_MAX - RATE_TABLE_PRESS_MIN) * fmod(5.17 * x, 1.0);
+  }
+  env[(NUM_CELLS - 1) * CAMP_NUM_ENV_PARAM_] = RATE_TABLE_TEMP_MAX + 20.0;
+
+  // the photolysis base rate is set by an update function
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    expected[i_cell * NUM_ENV_DATA + 2] = 0.01 * (i_cell + 1);
+    calc_direct(&md, &(env[i_cell * CAMP_NUM_ENV_PARAM_]),
+                &(expected[i_cell * NUM_ENV_DATA]));
+  }
+
+  // only the reactions with rate expressions and Fc > 0 are batched
+  RxnEnvBatch *batch = rxn_env_batch_new(&md);
+  errors += ASSERT_MSG(batch != NULL, "502918374");
+  if (batch == NULL) {
+    printf("\nFAIL\n");
+    return 0;
+  }
+  errors += ASSERT_MSG(batch->batched[0], "183650927");
+  errors += ASSERT_MSG(!batch->batched[1], "729104653");
+  errors += ASSERT_MSG(batch->batched[2], "361875029");
+  errors += ASSERT_MSG(batch->batched[3], "948207163");
+  errors += ASSERT_MSG(batch->batched[4], "270493816");
+  errors += ASSERT_MSG(!batch->batched[5], "815362904");
+  for (int i_group = 0; i_group < batch->n_groups; ++i_group) {
+    RxnEnvBatchGroup *g = &(batch->groups[i_group]);
+    errors += ASSERT_MSG(g->n_rxn == (g->type == RXN_TROE ? 2 : 1),
+                         "406281937");
+    errors += ASSERT_MSG(g->n_untabulated == g->n_rxn, "637019258");
+  }
+
+  // update all the grid cells as the solver does without a rate table
+  memcpy(rxn_env_data, expected, sizeof(expected));
+  for (int i = 0; i < NUM_CELLS * NUM_ENV_DATA; ++i)
+    if (i % NUM_ENV_DATA != 2) rxn_env_data[i] = 0.0;
+  md.rxn_env_batch = batch;
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    md.grid_cell_env = &(env[i_cell * CAMP_NUM_ENV_PARAM_]);
+    md.grid_cell_rxn_env_data = &(rxn_env_data[i_cell * NUM_ENV_DATA]);
+    rxn_update_env_state(&md);
+    cell_ids[i_cell] = i_cell;
+  }
+  rxn_env_batch_update_cells(batch, &md, cell_ids, NUM_CELLS, false);
+
+  for (int i = 0; i < NUM_CELLS * NUM_ENV_DATA; ++i)
+    errors += ASSERT_MSG(
+        fabs(rxn_env_data[i] - expected[i]) <= BATCH_TOL * fabs(expected[i]),
+        "592730148");
+  rxn_env_batch_free(batch);
+  md.rxn_env_batch = NULL;
+
+  // with a rate table, the tabulated reactions are placed last in each group
+  RateTable *table = rate_table_new(&md, TABLE_TOL);
+  errors += ASSERT_MSG(table != NULL, "284619073");
+  if (table == NULL) {
+    printf("\nFAIL\n");
+    return 0;
+  }
+  md.rate_table = table;
+  batch = rxn_env_batch_new(&md);
+  md.rxn_env_batch = batch;
+  for (int i_group = 0; i_group < batch->n_groups; ++i_group) {
+    RxnEnvBatchGroup *g = &(batch->groups[i_group]);
+    for (int i = 0; i < g->n_rxn; ++i) {
+      int i_rxn = 0;
+      while (rxn_env_idx[i_rxn] != g->env_idx[i]) ++i_rxn;
+      errors += ASSERT_MSG(table->tabulated[i_rxn] == (i >= g->n_untabulated),
+                           "713086529");
+    }
+  }
+
+  // only the untabulated reactions are batched within the table range
+  memcpy(rxn_env_data, expected, sizeof(expected));
+  for (int i = 0; i < NUM_CELLS * NUM_ENV_DATA; ++i)
+    if (i % NUM_ENV_DATA != 2) rxn_env_data[i] = NOT_SET;
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    md.grid_cell_env = &(env[i_cell * CAMP_NUM_ENV_PARAM_]);
+    md.grid_cell_rxn_env_data = &(rxn_env_data[i_cell * NUM_ENV_DATA]);
+    rxn_update_env_state(&md);
+    if (rate_table_covers(table, md.grid_cell_env))
+      table->cell_ids[n_table_cells++] = i_cell;
+    else
+      batch->cell_ids[n_batch_cells++] = i_cell;
+  }
+  errors += ASSERT_MSG(n_table_cells == NUM_CELLS - 1, "851294637");
+  rxn_env_batch_update_cells(batch, &md, table->cell_ids, n_table_cells,
+                             true);
+  rxn_env_batch_update_cells(batch, &md, batch->cell_ids, n_batch_cells,
+                             false);
+
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    for (int i_rxn = 0; i_rxn < NUM_RXN; ++i_rxn) {
+      int i = i_cell * NUM_ENV_DATA + rxn_env_idx[i_rxn];
+      if (i_cell < NUM_CELLS - 1 && table->tabulated[i_rxn]) {
+        errors += ASSERT_MSG(rxn_env_data[i] == NOT_SET, "426907318");
+      } else {
+        errors += ASSERT_MSG(fabs(rxn_env_data[i] - expected[i]) <=
+                                 BATCH_TOL * fabs(expected[i]),
+                             "390571846");
+      }
+    }
+  }
+
+  rxn_env_batch_free(batch);
+  rate_table_free(table);
+
+  if (errors == 0) {
+    printf("\nPASS\n");
+  } else {
+    printf("\nFAIL\n");
+  }
+}
@@ -0,0 +1,320 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ */
+/** \file
+ * \brief Tests for the structure-of-arrays reaction tables
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../test_common.h"
+#include "../../src/rxn_soa.h"
+#include "../../src/rxn_solver.h"
+
+// Number of state variables (the last one has no derivative id)
+#define NUM_STATE_VAR 7
+
+// Number of reactions (more than one chunk for the largest table)
+#define NUM_RXN 200
+
+// Number of reaction Jacobian elements
+#define NUM_JAC_ELEM 23
+
+// Number of grid cells and stride for the species-major arrays
+#define NUM_CELLS 5
+#define CELL_STRIDE 8
+
+// Size of the reaction data arrays
+#define MAX_INT_DATA (NUM_RXN * 40)
+#define MAX_FLOAT_DATA (NUM_RXN * 20)
+
+// Accumulated value of element i of a rate or partial derivative array
+#define SUM_VALUE(obj, array, i) CAMP_SUM_VALUE(obj.array, obj.array##_comp, i)
+
+static int rxn_int_data[MAX_INT_DATA];
+static double rxn_float_data[MAX_FLOAT_DATA];
+static int rxn_int_indices[NUM_RXN + 1];
+static int rxn_float_indices[NUM_RXN + 1];
+static int rxn_env_idx[NUM_RXN + 1];
+
+// Derivative id of a state variable
+static int deriv_id(int i_spec) {
+  return i_spec == NUM_STATE_VAR - 1 ? -1 : i_spec;
+}
+
+// Add a mass-action reaction to the reaction data
+static void add_mass_action(int i_rxn, int type, int n_react, int n_prod,
+                            int *n_int, int *n_float) {
+  int n_int_prop = type == RXN_PHOTOLYSIS ? 3 : 2;
+  int n_float_prop = type == RXN_PHOTOLYSIS ? 1 : type == RXN_TROE ? 10 : 6;
+  int *int_data = &(rxn_int_data[*n_int]);
+  double *float_data = &(rxn_float_data[*n_float]);
+  int *react, *prod;
+
+  int_data[0] = type;
+  int_data[1] = n_react;
+  int_data[2] = n_prod;
+  if (type == RXN_PHOTOLYSIS) int_data[3] = i_rxn;
+  react = &(int_data[1 + n_int_prop]);
+  prod = &(react[n_react]);
+  for (int i = 0; i < n_react; ++i)
+    react[i] = (i_rxn + 2 * i) % NUM_STATE_VAR + 1;
+  for (int i = 0; i < n_prod; ++i)
+    prod[i] = (3 * i_rxn + i + 1) % NUM_STATE_VAR + 1;
+  for (int i = 0; i < n_react + n_prod; ++i)
+    prod[n_prod + i] = deriv_id(react[i] - 1);
+  for (int i = 0; i < n_react * (n_react + n_prod); ++i)
+    prod[n_prod + n_react + n_prod + i] =
+        (i_rxn + i) % 5 == 0 ? -1 : (i_rxn * 7 + i) % NUM_JAC_ELEM;
+
+  for (int i = 0; i < n_float_prop; ++i) float_data[i] = 0.0;
+  for (int i = 0; i < n_prod; ++i)
+    float_data[n_float_prop + i] =
+        (i_rxn + i) % 11 == 0 ? -40.0 : 0.3 + 0.1 * ((i_rxn + i) % 6);
+
+  *n_int += 1 + n_int_prop + 2 * (n_react + n_prod) +
+            n_react * (n_react + n_prod);
+  *n_float += n_float_prop + n_prod;
+}
+
+// Set up the model data for the test reactions
+static void set_model_data(ModelData *md, double *state, double *env,
+                           double *rxn_env_data) {
+  int n_int = 0, n_float = 0;
+
+  for (int i_rxn = 0; i_rxn < NUM_RXN; ++i_rxn) {
+    rxn_int_indices[i_rxn] = n_int;
+    rxn_float_indices[i_rxn] = n_float;
+    rxn_env_idx[i_rxn] = 2 * i_rxn;
+    switch (i_rxn % 6) {
+      case 0:
+        add_mass_action(i_rxn, RXN_ARRHENIUS, 2, 2, &n_int, &n_float);
+        break;
+      case 1:
+        add_mass_action(i_rxn, RXN_PHOTOLYSIS, 1, 3, &n_int, &n_float);
+        break;
+      case 2:
+        add_mass_action(i_rxn, RXN_TROE, 2, 1, &n_int, &n_float);
+        break;
+      case 3:
+        add_mass_action(i_rxn, RXN_ARRHENIUS, 3, 2, &n_int, &n_float);
+        break;
+      case 4:
+        add_mass_action(i_rxn, RXN_ARRHENIUS, 2, 0, &n_int, &n_float);
+        break;
+      default:
+        // emission of a species with a derivative id
+        rxn_int_data[n_int++] = RXN_EMISSION;
+        rxn_int_data[n_int++] = i_rxn;
+        rxn_int_data[n_int++] = i_rxn % (NUM_STATE_VAR - 1) + 1;
+        rxn_int_data[n_int++] = i_rxn % (NUM_STATE_VAR - 1);
+        rxn_float_data[n_float++] = 1.0;
+    }
+  }
+  rxn_int_indices[NUM_RXN] = n_int;
+  rxn_float_indices[NUM_RXN] = n_float;
+  for (int i = 0; i < 2 * NUM_RXN; ++i)
+    rxn_env_data[i] = 0.01 * (1 + i % 13);
+
+  memset(md, 0, sizeof(ModelData));
+  md->n_per_cell_state_var = NUM_STATE_VAR;
+  md->n_per_cell_dep_var = NUM_STATE_VAR - 1;
+  md->n_rxn = NUM_RXN;
+  md->n_added_rxns = NUM_RXN;
+  md->rxn_int_data = rxn_int_data;
+  md->rxn_float_data = rxn_float_data;
+  md->rxn_int_indices = rxn_int_indices;
+  md->rxn_float_indices = rxn_float_indices;
+  md->rxn_env_idx = rxn_env_idx;
+  md->n_rxn_env_data = 2 * NUM_RXN;
+  md->grid_cell_state = state;
+  md->total_state = state;
+  md->grid_cell_env = env;
+  md->total_env = env;
+  md->grid_cell_rxn_env_data = rxn_env_data;
+  md->rxn_env_data = rxn_env_data;
+  md->rxn_kernel = NULL;
+  md->rxn_soa = NULL;
+}
+
+// Calculate the reaction contributions
+static void calc_contrib(ModelData *md, TimeDerivative time_deriv,
+                         Jacobian jac) {
+  time_derivative_reset(time_deriv);
+  jacobian_reset(jac);
+  rxn_calc_deriv(md, time_deriv, 1.0);
+  rxn_calc_jac(md, jac, 1.0);
+}
+
+// Compare the fused derivative and Jacobian calculation with the separate
+// calculations
+static int check_fused(ModelData *md, TimeDerivative deriv_ref,
+                       Jacobian jac_ref) {
+  int errors = 0;
+  TimeDerivative time_deriv;
+  Jacobian jac;
+  CampSum partials[2 * NUM_JAC_ELEM];
+#ifdef CAMP_USE_COMPENSATED_SUM
+  double partials_comp[2 * NUM_JAC_ELEM];
+  jac.production_partials_comp = &(partials_comp[0]);
+  jac.loss_partials_comp = &(partials_comp[NUM_JAC_ELEM]);
+#endif
+  jac.production_partials = &(partials[0]);
+  jac.loss_partials = &(partials[NUM_JAC_ELEM]);
+  jac.num_elem = NUM_JAC_ELEM;
+
+  time_derivative_initialize(&time_deriv, NUM_STATE_VAR - 1);
+  time_derivative_reset(time_deriv);
+  jacobian_reset(jac);
+  rxn_calc_deriv_jac(md, time_deriv, jac, 1.0);
+  for (int i = 0; i < NUM_STATE_VAR - 1; ++i) {
+    errors += ASSERT_CLOSE_MSG(SUM_VALUE(time_deriv, production_rates, i),
+                               SUM_VALUE(deriv_ref, production_rates, i),
+                               "530718264");
+    errors += ASSERT_CLOSE_MSG(SUM_VALUE(time_deriv, loss_rates, i),
+                               SUM_VALUE(deriv_ref, loss_rates, i),
+                               "871402356");
+  }
+  for (int i = 0; i < NUM_JAC_ELEM; ++i) {
+    errors += ASSERT_CLOSE_MSG(SUM_VALUE(jac, production_partials, i),
+                               SUM_VALUE(jac_ref, production_partials, i),
+                               "294615083");
+    errors += ASSERT_CLOSE_MSG(SUM_VALUE(jac, loss_partials, i),
+                               SUM_VALUE(jac_ref, loss_partials, i),
+                               "617350942");
+  }
+  time_derivative_free(time_deriv);
+  return errors;
+}
+
+// Compare the species-major calculation for several grid cells with the
+// calculation for each grid cell
+static int check_cells(ModelData *md, double *state, double *rxn_env_data) {
+  int errors = 0;
+  double cell_state[NUM_CELLS][NUM_STATE_VAR];
+  double cell_rxn_env_data[NUM_CELLS][2 * NUM_RXN];
+  double chunk_state[NUM_STATE_VAR * CELL_STRIDE];
+  double chunk_rxn_env_data[2 * NUM_RXN * CELL_STRIDE];
+  TimeDerivative chunk_deriv, time_deriv;
+
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    for (int i = 0; i < NUM_STATE_VAR; ++i) {
+      cell_state[i_cell][i] = state[i] * (1.0 + 0.3 * i_cell);
+      chunk_state[i * CELL_STRIDE + i_cell] = cell_state[i_cell][i];
+    }
+    for (int i = 0; i < 2 * NUM_RXN; ++i) {
+      cell_rxn_env_data[i_cell][i] = rxn_env_data[i] / (1.0 + i_cell);
+      chunk_rxn_env_data[i * CELL_STRIDE + i_cell] =
+          cell_rxn_env_data[i_cell][i];
+    }
+  }
+  time_derivative_initialize(&chunk_deriv, (NUM_STATE_VAR - 1) * CELL_STRIDE);
+  time_derivative_reset(chunk_deriv);
+  rxn_soa_calc_deriv_cells(md->rxn_soa, chunk_state, chunk_rxn_env_data,
+                           chunk_deriv, NUM_CELLS, CELL_STRIDE, 1.0);
+
+  time_derivative_initialize(&time_deriv, NUM_STATE_VAR - 1);
+  for (int i_cell = 0; i_cell < NUM_CELLS; ++i_cell) {
+    int i_chunk = i_cell;
+    md->grid_cell_state = cell_state[i_cell];
+    md->grid_cell_rxn_env_data = cell_rxn_env_data[i_cell];
+    time_derivative_reset(time_deriv);
+    rxn_soa_calc_deriv(md, md->rxn_soa, time_deriv, 1.0);
+    for (int i = 0; i < NUM_STATE_VAR - 1; ++i, i_chunk += CELL_STRIDE) {
+      errors += ASSERT_CLOSE_MSG(
+          SUM_VALUE(chunk_deriv, production_rates, i_chunk),
+          SUM_VALUE(time_deriv, production_rates, i), "482019375");
+      errors += ASSERT_CLOSE_MSG(SUM_VALUE(chunk_deriv, loss_rates, i_chunk),
+                                 SUM_VALUE(time_deriv, loss_rates, i),
+                                 "920374615");
+    }
+  }
+  time_derivative_free(chunk_deriv);
+  time_derivative_free(time_deriv);
+  md->grid_cell_state = state;
+  md->grid_cell_rxn_env_data = rxn_env_data;
+  return errors;
+}
+
+int main(int argc, char *argv[]) {
+  int errors = 0;
+  int n_soa_rxn = 0;
+  ModelData md;
+  double state[NUM_STATE_VAR] = {1.2, 3.4, 0.7, 2.5, 0.05, 1.9, 4.0};
+  double env[CAMP_NUM_ENV_PARAM_] = {298.15, 101325.0};
+  double rxn_env_data[2 * NUM_RXN];
+  TimeDerivative deriv_generic, deriv_soa;
+  Jacobian jac_generic, jac_soa;
+  CampSum partials[4 * NUM_JAC_ELEM];
+#ifdef CAMP_USE_COMPENSATED_SUM
+  double partials_comp[4 * NUM_JAC_ELEM];
+#endif
+
+  set_model_data(&md, state, env, rxn_env_data);
+  time_derivative_initialize(&deriv_generic, NUM_STATE_VAR - 1);
+  time_derivative_initialize(&deriv_soa, NUM_STATE_VAR - 1);
+  jac_generic.production_partials = &(partials[0]);
+  jac_generic.loss_partials = &(partials[NUM_JAC_ELEM]);
+  jac_soa.production_partials = &(partials[2 * NUM_JAC_ELEM]);
+  jac_soa.loss_partials = &(partials[3 * NUM_JAC_ELEM]);
+  jac_generic.num_elem = jac_soa.num_elem = NUM_JAC_ELEM;
+#ifdef CAMP_USE_COMPENSATED_SUM
+  jac_generic.production_partials_comp = &(partials_comp[0]);
+  jac_generic.loss_partials_comp = &(partials_comp[NUM_JAC_ELEM]);
+  jac_soa.production_partials_comp = &(partials_comp[2 * NUM_JAC_ELEM]);
+  jac_soa.loss_partials_comp = &(partials_comp[3 * NUM_JAC_ELEM]);
+#endif
+
+  // generic reaction functions
+  calc_contrib(&md, deriv_generic, jac_generic);
+  errors += check_fused(&md, deriv_generic, jac_generic);
+
+  // repack the mass-action reactions
+  md.rxn_soa = rxn_soa_new(&md);
+  errors += ASSERT_MSG(md.rxn_soa->n_tables == 4, "512847390");
+  errors += ASSERT_MSG(md.rxn_soa->n_generic_rxn == NUM_RXN / 6, "961302587");
+  for (int i = 0; i < md.rxn_soa->n_generic_rxn; ++i)
+    errors +=
+        ASSERT_MSG(md.rxn_soa->generic_rxn[i] == 6 * i + 5, "204736158");
+  for (int i = 0; i < md.rxn_soa->n_tables; ++i)
+    n_soa_rxn += md.rxn_soa->tables[i].n_rxn;
+  errors += ASSERT_MSG(md.rxn_soa->tables[0].n_rxn == 0, "837105264");
+  errors += ASSERT_MSG(n_soa_rxn + md.rxn_soa->n_generic_rxn == NUM_RXN,
+                       "390561724");
+
+  // tables with the generic functions for the remaining reactions
+  calc_contrib(&md, deriv_soa, jac_soa);
+  for (int i = 0; i < NUM_STATE_VAR - 1; ++i) {
+    errors += ASSERT_CLOSE_MSG(SUM_VALUE(deriv_soa, production_rates, i),
+                               SUM_VALUE(deriv_generic, production_rates, i),
+                               "716248093");
+    errors += ASSERT_CLOSE_MSG(SUM_VALUE(deriv_soa, loss_rates, i),
+                               SUM_VALUE(deriv_generic, loss_rates, i),
+                               "158930472");
+  }
+  for (int i = 0; i < NUM_JAC_ELEM; ++i) {
+    errors += ASSERT_CLOSE_MSG(SUM_VALUE(jac_soa, production_partials, i),
+                               SUM_VALUE(jac_generic, production_partials, i),
+                               "643019825");
+    errors += ASSERT_CLOSE_MSG(SUM_VALUE(jac_soa, loss_partials, i),
+                               SUM_VALUE(jac_generic, loss_partials, i),
+                               "275891436");
+  }
+
+  // fused calculation with the tables
+  errors += check_fused(&md, deriv_soa, jac_soa);
+
+  // species-major calculation for several grid cells
+  errors += check_cells(&md, state, rxn_env_data);
+
+  rxn_soa_free(md.rxn_soa);
+  time_derivative_free(deriv_generic);
+  time_derivative_free(deriv_soa);
+
+  if (errors == 0) {
+    printf("\nPASS\n");
+  } else {
+    printf("\nFAIL\n");
+  }
+}
@@ -0,0 +1,184 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ */
+/** \file
+ * \brief Tests for the solver profiler
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../test_common.h"
+#include "../../src/rxn_solver.h"
+#include "../../src/solver_profile.h"
+
+// Number of solver variables of the test linear system
+#define NUM_VAR 5
+
+// Calls to the operations of the test linear solver
+static int n_setups = 0, n_solves = 0, n_frees = 0;
+
+// Test linear solver, which solves 2 x = b
+static SUNLinearSolver_Type test_ls_gettype(SUNLinearSolver S) {
+  return SUNLINEARSOLVER_DIRECT;
+}
+static int test_ls_setup(SUNLinearSolver S, SUNMatrix A) {
+  ++n_setups;
+  return SUNLS_SUCCESS;
+}
+static int test_ls_solve(SUNLinearSolver S, SUNMatrix A, N_Vector x,
+                         N_Vector b, realtype tol) {
+  ++n_solves;
+  N_VScale(0.5, b, x);
+  return SUNLS_SUCCESS;
+}
+static long int test_ls_lastflag(SUNLinearSolver S) { return 42; }
+static int test_ls_free(SUNLinearSolver S) {
+  ++n_frees;
+  free(S->ops);
+  free(S);
+  return SUNLS_SUCCESS;
+}
+
+// Create the test linear solver
+static SUNLinearSolver new_test_ls() {
+  SUNLinearSolver S = (SUNLinearSolver)malloc(sizeof *S);
+  S->ops = (SUNLinearSolver_Ops)calloc(
+      1, sizeof(struct _generic_SUNLinearSolver_Ops));
+  S->ops->gettype = test_ls_gettype;
+  S->ops->setup = test_ls_setup;
+  S->ops->solve = test_ls_solve;
+  S->ops->lastflag = test_ls_lastflag;
+  S->ops->free = test_ls_free;
+  S->content = NULL;
+  return S;
+}
+
+// Test the timers and counters of the solver phases
+static int test_phases() {
+  int errors = 0;
+  SolverProfile profile, total;
+
+  memset(&profile, 0, sizeof(SolverProfile));
+  memset(&total, 0, sizeof(SolverProfile));
+
+  // nothing is timed while the profiler is disabled
+  double start = solver_profile_start(&profile);
+  errors += ASSERT_MSG(start == 0.0, "Disabled profiler read the clock");
+  solver_profile_stop(&profile, CAMP_PROFILE_DERIV, start);
+  errors += ASSERT_MSG(profile.phase_calls[CAMP_PROFILE_DERIV] == 0,
+                       "Disabled profiler counted a call");
+  errors += ASSERT_MSG(solver_profile_start(NULL) == 0.0, "NULL profile");
+  solver_profile_stop(NULL, CAMP_PROFILE_DERIV, 0.0);
+
+  // enabled profiles accumulate time and calls
+  profile.enabled = true;
+  for (int i = 0; i < 3; ++i) {
+    start = solver_profile_start(&profile);
+    errors += ASSERT_MSG(start > 0.0, "Enabled profiler did not start");
+    solver_profile_stop(&profile, CAMP_PROFILE_JAC, start);
+  }
+  errors += ASSERT_MSG(profile.phase_calls[CAMP_PROFILE_JAC] == 3,
+                       "Wrong number of calls");
+  errors += ASSERT_MSG(profile.phase_time[CAMP_PROFILE_JAC] >= 0.0,
+                       "Negative phase time");
+  errors += ASSERT_MSG(profile.phase_calls[CAMP_PROFILE_DERIV] == 0,
+                       "Call counted for the wrong phase");
+
+  // runs of reactions are timed by type and out-of-range types are ignored
+  start = solver_profile_start(&profile);
+  double now = solver_profile_stop_rxn(&profile, RXN_ARRHENIUS, 4, start);
+  errors += ASSERT_MSG(now >= start, "Clock went backwards");
+  now = solver_profile_stop_rxn(&profile, RXN_TROE, 2, now);
+  now = solver_profile_stop_rxn(&profile, RXN_ARRHENIUS, 1, now);
+  now = solver_profile_stop_rxn(&profile, CAMP_PROFILE_NUM_RXN_TYPES, 7, now);
+  errors += ASSERT_MSG(profile.rxn_calls[RXN_ARRHENIUS] == 5,
+                       "Wrong number of reaction calls");
+  errors += ASSERT_MSG(profile.rxn_calls[RXN_TROE] == 2,
+                       "Wrong number of reaction calls");
+
+  // profiles are combined and reset without changing the enabled flag
+  solver_profile_add(&total, &profile);
+  solver_profile_add(&total, &profile);
+  errors += ASSERT_MSG(total.phase_calls[CAMP_PROFILE_JAC] == 6,
+                       "Wrong combined number of calls");
+  errors += ASSERT_MSG(total.rxn_calls[RXN_ARRHENIUS] == 10,
+                       "Wrong combined number of reaction calls");
+  errors += ASSERT_MSG(!total.enabled, "Combining changed the enabled flag");
+  solver_profile_reset(&profile);
+  errors += ASSERT_MSG(profile.enabled, "Reset disabled the profiler");
+  errors += ASSERT_MSG(profile.phase_calls[CAMP_PROFILE_JAC] == 0 &&
+                           profile.phase_time[CAMP_PROFILE_JAC] == 0.0 &&
+                           profile.rxn_calls[RXN_ARRHENIUS] == 0,
+                       "Reset did not clear the timers");
+
+  return errors;
+}
+
+// Test the profiled linear solver
+static int test_linear_solver() {
+  int errors = 0;
+  SolverProfile profile;
+  N_Vector x = N_VNew_Serial(NUM_VAR);
+  N_Vector b = N_VNew_Serial(NUM_VAR);
+  SUNLinearSolver ls = new_test_ls();
+
+  memset(&profile, 0, sizeof(SolverProfile));
+  SUNLinearSolver S = SUNProfiledLinSol(ls, &profile);
+  errors += ASSERT_MSG(S != NULL, "Could not create the profiled solver");
+
+  // the wrapper has the same optional operations as the wrapped solver
+  errors += ASSERT_MSG(SUNLinSolGetType(S) == SUNLINEARSOLVER_DIRECT,
+                       "Wrong linear solver type");
+  errors += ASSERT_MSG(
+      S->ops->setatimes == NULL && S->ops->initialize == NULL &&
+          S->ops->numiters == NULL && S->ops->space == NULL,
+      "Wrapper added an optional operation");
+  errors += ASSERT_MSG(S->ops->setup != NULL && S->ops->lastflag != NULL,
+                       "Wrapper dropped an operation");
+  errors += ASSERT_MSG(SUNLinSolLastFlag(S) == 42, "Wrong last flag");
+
+  // setups and solves are forwarded, and timed only while enabled
+  for (int i = 0; i < NUM_VAR; ++i) NV_Ith_S(b, i) = 2.0 * (i + 1);
+  errors += ASSERT_MSG(SUNLinSolSetup(S, NULL) == SUNLS_SUCCESS, "Setup");
+  errors += ASSERT_MSG(SUNLinSolSolve(S, NULL, x, b, 0.0) == SUNLS_SUCCESS,
+                       "Solve");
+  errors += ASSERT_MSG(profile.phase_calls[CAMP_PROFILE_LS_SETUP] == 0 &&
+                           profile.phase_calls[CAMP_PROFILE_LS_SOLVE] == 0,
+                       "Disabled profiler timed the linear solver");
+  profile.enabled = true;
+  errors += ASSERT_MSG(SUNLinSolSetup(S, NULL) == SUNLS_SUCCESS, "Setup");
+  for (int i = 0; i < 2; ++i)
+    errors += ASSERT_MSG(SUNLinSolSolve(S, NULL, x, b, 0.0) == SUNLS_SUCCESS,
+                         "Solve");
+  errors += ASSERT_MSG(n_setups == 2 && n_solves == 3,
+                       "Calls were not forwarded");
+  errors += ASSERT_MSG(profile.phase_calls[CAMP_PROFILE_LS_SETUP] == 1 &&
+                           profile.phase_calls[CAMP_PROFILE_LS_SOLVE] == 2,
+                       "Wrong number of timed linear solver calls");
+  for (int i = 0; i < NUM_VAR; ++i)
+    errors += ASSERT_MSG(NV_Ith_S(x, i) == i + 1, "Wrong solution");
+
+  // freeing the wrapper does not free the wrapped solver
+  SUNLinSolFree(S);
+  errors += ASSERT_MSG(n_frees == 0, "Wrapper freed the wrapped solver");
+  SUNLinSolFree(ls);
+  errors += ASSERT_MSG(n_frees == 1, "Wrapped solver was not freed");
+
+  N_VDestroy(x);
+  N_VDestroy(b);
+  return errors;
+}
+
+int main(int argc, char *argv[]) {
+  int errors = 0;
+
+  errors += test_phases();
+  errors += test_linear_solver();
+
+  if (errors == 0) {
+    printf("\nPASS\n");
+  } else {
+    printf("\nFAIL\n");
+  }
+}
@@ -0,0 +1,160 @@
+/* Copyright (C) 2021 Barcelona Supercomputing Center and University of
+ * Illinois at Urbana-Champaign
+ * SPDX-License-Identifier: MIT
+ */
+/** \file
+ * \brief Tests for the vectorizable elementary functions
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../test_common.h"
+#include "../../src/vec_math.h"
+
+// Number of random arguments per test
+#define NUM_SAMPLES 1000000
+
+// Number of arguments evaluated together
+#define CHUNK 64
+
+// Pseudo-random number generator state
+static uint64_t rand_state = 88172645463325252ULL;
+
+// Uniform pseudo-random number in [0, 1)
+static double rand_uniform() {
+  rand_state ^= rand_state << 13;
+  rand_state ^= rand_state >> 7;
+  rand_state ^= rand_state << 17;
+  return (rand_state >> 11) * 0x1p-53;
+}
+
+// Distance in units in the last place between two finite doubles of the
+// same sign (or any two NaNs)
+static double ulp_diff(double a, double b) {
+  if (isnan(a) && isnan(b)) return 0.0;
+  if (a == b) return 0.0;
+  if (isnan(a) || isnan(b) || isinf(a) || isinf(b) || (a < 0.0) != (b < 0.0))
+    return INFINITY;
+  int64_t ia = (int64_t)vec_math_to_bits(fabs(a));
+  int64_t ib = (int64_t)vec_math_to_bits(fabs(b));
+  return (double)(ia > ib ? ia - ib : ib - ia);
+}
+
+// Compare vec_exp() with exp() over the whole range of finite results
+static int test_exp() {
+  int errors = 0;
+  double x[CHUNK], y[CHUNK], max_ulp = 0.0;
+
+  for (int i_sample = 0; i_sample < NUM_SAMPLES; i_sample += CHUNK) {
+    for (int i = 0; i < CHUNK; ++i) x[i] = -750.0 + 1462.0 * rand_uniform();
+#ifdef CAMP_USE_OPENMP
+#pragma omp simd
+#endif
+    for (int i = 0; i < CHUNK; ++i) y[i] = vec_exp(x[i]);
+    for (int i = 0; i < CHUNK; ++i) {
+      double ulp = ulp_diff(y[i], exp(x[i]));
+      if (ulp > max_ulp) max_ulp = ulp;
+    }
+  }
+  errors += ASSERT_MSG(max_ulp <= 2.0, "Inaccurate vec_exp()");
+  errors += ASSERT_MSG(vec_exp(0.0) == 1.0, "vec_exp(0)");
+  errors += ASSERT_MSG(vec_exp(INFINITY) == INFINITY, "vec_exp(inf)");
+  errors += ASSERT_MSG(vec_exp(-INFINITY) == 0.0, "vec_exp(-inf)");
+  errors += ASSERT_MSG(vec_exp(800.0) == INFINITY, "vec_exp() overflow");
+  errors += ASSERT_MSG(vec_exp(-800.0) == 0.0, "vec_exp() underflow");
+  errors += ASSERT_MSG(vec_exp(-745.0) == exp(-745.0), "vec_exp() subnormal");
+  errors += ASSERT_MSG(isnan(vec_exp(NAN)), "vec_exp(nan)");
+  return errors;
+}
+
+// Compare vec_log() and vec_log10() with log() and log10() over the whole
+// range of positive doubles and near 1
+static int test_log() {
+  int errors = 0;
+  double x[CHUNK], y[CHUNK], y10[CHUNK], max_ulp = 0.0, max_ulp10 = 0.0;
+
+  for (int i_sample = 0; i_sample < NUM_SAMPLES; i_sample += CHUNK) {
+    for (int i = 0; i < CHUNK; ++i)
+      x[i] = i % 2 == 0 ? exp2(-1074.0 + 2098.0 * rand_uniform())
+                        : 0.5 + rand_uniform();
+#ifdef CAMP_USE_OPENMP
+#pragma omp simd
+#endif
+    for (int i = 0; i < CHUNK; ++i) {
+      y[i] = vec_log(x[i]);
+      y10[i] = vec_log10(x[i]);
+    }
+    for (int i = 0; i < CHUNK; ++i) {
+      double ulp = ulp_diff(y[i], log(x[i]));
+      if (ulp > max_ulp) max_ulp = ulp;
+      ulp = ulp_diff(y10[i], log10(x[i]));
+      if (ulp > max_ulp10) max_ulp10 = ulp;
+    }
+  }
+  errors += ASSERT_MSG(max_ulp <= 2.0, "Inaccurate vec_log()");
+  errors += ASSERT_MSG(max_ulp10 <= 4.0, "Inaccurate vec_log10()");
+  errors += ASSERT_MSG(vec_log(1.0) == 0.0, "vec_log(1)");
+  errors += ASSERT_MSG(vec_log(0.0) == -INFINITY, "vec_log(0)");
+  errors += ASSERT_MSG(vec_log(INFINITY) == INFINITY, "vec_log(inf)");
+  errors += ASSERT_MSG(isnan(vec_log(-1.0)), "vec_log(-1)");
+  errors += ASSERT_MSG(isnan(vec_log(NAN)), "vec_log(nan)");
+  return errors;
+}
+
+// Compare vec_pow() and vec_pow_int() with pow() for the arguments of rate
+// expressions
+static int test_pow() {
+  int errors = 0;
+  double x[CHUNK], e[CHUNK], y[CHUNK], y_int[CHUNK];
+  double n[CHUNK];
+  double max_rel = 0.0, max_ulp_int = 0.0;
+
+  for (int i_sample = 0; i_sample < NUM_SAMPLES; i_sample += CHUNK) {
+    for (int i = 0; i < CHUNK; ++i) {
+      x[i] = exp(-50.0 + 100.0 * rand_uniform());
+      e[i] = -10.0 + 20.0 * rand_uniform();
+      n[i] = (double)(i % 6);
+    }
+#ifdef CAMP_USE_OPENMP
+#pragma omp simd
+#endif
+    for (int i = 0; i < CHUNK; ++i) {
+      y[i] = vec_pow(x[i], e[i]);
+      y_int[i] = vec_pow_int(x[i], n[i]);
+    }
+    for (int i = 0; i < CHUNK; ++i) {
+      double ref = pow(x[i], e[i]);
+      double rel = fabs(y[i] - ref) / ref;
+      if (rel > max_rel) max_rel = rel;
+      ref = pow(x[i], n[i]);
+      if (n[i] <= 4) {
+        double ulp = ulp_diff(y_int[i], ref);
+        if (ulp > max_ulp_int) max_ulp_int = ulp;
+      } else {
+        rel = fabs(y_int[i] - ref) / ref;
+        if (rel > max_rel) max_rel = rel;
+      }
+    }
+  }
+  // exp(y log(x)) amplifies the rounding error of y log(x) (up to 500 here)
+  errors += ASSERT_MSG(max_rel <= 1.0e-13, "Inaccurate vec_pow()");
+  errors += ASSERT_MSG(max_ulp_int <= 4.0, "Inaccurate vec_pow_int()");
+  errors += ASSERT_MSG(vec_pow(0.0, 0.0) == 1.0, "vec_pow(0, 0)");
+  errors += ASSERT_MSG(vec_pow_int(-2.0, 3) == -8.0, "vec_pow_int(-2, 3)");
+  return errors;
+}
+
+int main(int argc, char *argv[]) {
+  int errors = 0;
+
+  errors += test_exp();
+  errors += test_log();
+  errors += test_pow();
+
+  if (errors == 0) {
+    printf("\nPASS\n");
+  } else {
+    printf("\nFAIL\n");
+  }
+}